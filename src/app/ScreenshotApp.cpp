@@ -6,6 +6,7 @@
 #include "../util/PathUtils.hpp"
 #include "../util/StringUtils.hpp"
 #include "../util/TimeUtils.hpp"
+#include "../util/Trace.hpp"
 #include "../ui/TrayIcon.hpp"
 #include "../ui/HotkeyManager.hpp"
 #include "../ui/SelectionOverlay.hpp"
@@ -19,6 +20,9 @@
 #include <format>
 #include <cassert>
 
+// 连拍期间提高系统定时器精度
+#pragma comment(lib, "winmm.lib")
+
 // ============================================================================
 // 修复注释
 // ---- 初始化窗口 & 资源 ----------------------------------------------------
@@ -36,10 +40,15 @@ namespace screenshot_tool {
 	// 自定义消息 ID
 	static constexpr UINT WM_ST_TRAYICON = WM_APP + 1;
 	static constexpr UINT WM_ST_REGION_DONE = WM_APP + 2;
+	static constexpr UINT WM_ST_BURST_DONE = WM_APP + 3;
 
 	// 热键 ID（与 HotkeyManager 内部映射一致）
 	static constexpr int HOTKEY_ID_REGION = 1;
 	static constexpr int HOTKEY_ID_FULLSCREEN = 2;
+	static constexpr int HOTKEY_ID_BURST = 3;
+
+	// 定时器 ID
+	static constexpr UINT_PTR TIMER_ID_IDLE_TRIM = 1;
 
 	// ----------------------------------------------------------------------------
 	// 多显示器支持的工具函数
@@ -148,6 +157,39 @@ namespace screenshot_tool {
 		return dirW;
 	}
 
+	// ----------------------------------------------------------------------------
+	// 上次冻结帧文件路径；未配置时返回空（默认不保存）。
+	// 冻结帧是整块屏幕内容，相对路径放在当前用户的 %LOCALAPPDATA%\HDR Screenshot Tool 下，
+	// 取不到时放在用户临时目录，不写到程序目录
+	// ----------------------------------------------------------------------------
+	static std::wstring lastFramePath(const Config& cfg) {
+		std::wstring pathW = StringUtils::Utf8ToWide(cfg.lastFrameFile);
+		if (pathW.empty() || PathUtils::IsAbsolute(pathW)) {
+			return pathW;
+		}
+
+		std::wstring dirW;
+		PWSTR localAppData = nullptr;
+		if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, &localAppData))) {
+			dirW = localAppData;
+			PathUtils::JoinInplace(dirW, L"HDR Screenshot Tool");
+		}
+		CoTaskMemFree(localAppData);
+		if (dirW.empty()) {
+			wchar_t temp[MAX_PATH + 1];
+			const DWORD len = GetTempPathW(MAX_PATH + 1, temp);
+			if (len == 0 || len > MAX_PATH) {
+				return L"";
+			}
+			dirW.assign(temp, len);
+		}
+		if (!PathUtils::CreateDirectoriesRecursive(dirW)) {
+			return L"";
+		}
+		PathUtils::JoinInplace(dirW, pathW);
+		return dirW;
+	}
+
 	// ----------------------------------------------------------------------------
 	// ScreenshotApp 实现
 	// ----------------------------------------------------------------------------
@@ -161,6 +203,7 @@ namespace screenshot_tool {
 
 	bool ScreenshotApp::Initialize(HINSTANCE hInst) {
 		hInst_ = hInst;
+		Logger::InstallCrashHandler();
 
 		// 1) 加载配置，确保配置文件存在并包含所有配置项
 		bool configLoaded = LoadConfig(cfg_, L"config.ini");
@@ -178,6 +221,16 @@ namespace screenshot_tool {
 			EnsureConfigFile(cfg_, L"config.ini");
 		}
 
+		// 1.5) 日志级别与调试日志文件；阶段耗时追踪在调试模式或配置了导出文件时启用
+		Logger::SetLevel(cfg_.debugMode ? LogLevel::Debug : LogLevel::Info);
+		if (cfg_.debugMode) {
+			std::wstring logPath = PathUtils::GetModuleDirectoryW();
+			PathUtils::JoinInplace(logPath, L"HDR_Screenshot_Tool.log");
+			Logger::EnableFileLogging(logPath);
+		}
+		Trace::SetEnabled(cfg_.debugMode || !cfg_.traceFile.empty());
+		Trace::SetOutputFile(StringUtils::Utf8ToWide(cfg_.traceFile));
+
 		// 2) 确保截图保存目录存在
 		ensureSaveDir(cfg_);
 
@@ -226,6 +279,9 @@ namespace screenshot_tool {
 		if (!hotkeys_.RegisterHotkey(hwnd_, HOTKEY_ID_FULLSCREEN, cfg_.fullscreenHotkey)) {
 			Logger::Warn(L"Register fullscreen hotkey failed: {}", StringUtils::Utf8ToWide(cfg_.fullscreenHotkey));
 		}
+		if (!cfg_.burstHotkey.empty() && !hotkeys_.RegisterHotkey(hwnd_, HOTKEY_ID_BURST, cfg_.burstHotkey)) {
+			Logger::Warn(L"Register burst hotkey failed: {}", StringUtils::Utf8ToWide(cfg_.burstHotkey));
+		}
 
 		// 6) Overlay初始化（区域选择）
 		auto regionCallback = [this](const RECT& rect) {
@@ -234,6 +290,9 @@ namespace screenshot_tool {
 		if (!overlay_.Create(hInst_, hwnd_, regionCallback)) {
 			Logger::Warn(L"Overlay create failed (region capture disabled)");
 		}
+		overlay_.SetBatchCallback([this](const std::vector<RECT>& rects) {
+			onRegionsSelected(rects);
+		});
 
 		// 7) Capture 初始化（底层 DXGI + GDI 捕获）
 		if (!capture_.Initialize()) {
@@ -267,8 +326,14 @@ namespace screenshot_tool {
 
 		hotkeys_.UnregisterHotkey(hwnd_, HOTKEY_ID_REGION);
 		hotkeys_.UnregisterHotkey(hwnd_, HOTKEY_ID_FULLSCREEN);
+		hotkeys_.UnregisterHotkey(hwnd_, HOTKEY_ID_BURST);
 		tray_.Destroy();
 
+		// 连拍线程会向窗口投递完成消息，先等它结束
+		if (burstThread_.joinable()) {
+			burstThread_.join();
+		}
+
 		if (hwnd_) {
 			DestroyWindow(hwnd_);
 			hwnd_ = nullptr;
@@ -276,6 +341,7 @@ namespace screenshot_tool {
 
 		SaveConfig(cfg_, L"config.ini");
 		Logger::Info(L"App shutdown.");
+		Logger::Shutdown();
 	}
 
 	// ----------------------------------------------------------------------------
@@ -285,6 +351,8 @@ namespace screenshot_tool {
 		switch (cmd) {
 		case TrayMenuId::IDM_TRAY_CAPTURE_REGION:     doCaptureRegion();      break;
 		case TrayMenuId::IDM_TRAY_CAPTURE_FULLSCREEN: doCaptureFullscreen();  break;
+		case TrayMenuId::IDM_TRAY_CAPTURE_BURST:      doCaptureBurst();       break;
+		case TrayMenuId::IDM_TRAY_RECROP_LAST:        doRecropLast();         break;
 		case TrayMenuId::IDM_TRAY_OPEN_FOLDER: {
 			auto dirW = ensureSaveDir(cfg_);
 			ShellExecute(nullptr, L"open", dirW.c_str(), nullptr, nullptr, SW_SHOWNORMAL);
@@ -325,6 +393,12 @@ namespace screenshot_tool {
 	// 区域截图
 	// ----------------------------------------------------------------------------
 	void ScreenshotApp::doCaptureRegion() {
+		if (burstRunning_) {
+			Logger::Warn(L"Burst capture in progress, region capture ignored");
+			return;
+		}
+		Trace::BeginCapture();
+		armIdleTrim();
 		if (!overlay_.IsValid()) {
 			Logger::Warn(L"Region overlay invalid");
 			return;
@@ -355,14 +429,16 @@ namespace screenshot_tool {
 		}
 		
 		// 先捕获相应区域的数据到缓存（确保overlay不在屏幕上）
-		// 在捕获前确保没有任何overlay窗口可见
-		if (!capture_.CaptureFullscreenToCache()) {
+		// 在捕获前确保没有任何overlay窗口可见；缓存范围与 overlay 一致，限制在单个显示器时只冻结该显示器
+		if (!capture_.CaptureFullscreenToCache(overlayRect)) {
 			Logger::Error(L"Failed to cache fullscreen for region selection");
 			return;
 		}
 		
 		// 首先显示overlay，不设置背景图像
 		Logger::Info(L"Showing overlay without background, will wait for background data");
+		overlay_.SetSnapEnabled(cfg_.selectionSnap);
+		overlay_.SetMultiSelect(cfg_.multiSelect);
 		if (cfg_.regionFullscreenMonitor) {
             overlay_.BeginSelectOnMonitor(overlayRect);
         } else {
@@ -370,25 +446,61 @@ namespace screenshot_tool {
         }
         
         // 启动背景检测循环
-        overlay_.StartWaitingForBackground([this]() {
-            // 尝试获取缓存的图像数据
-            ImageBuffer rgb8Image;
-            if (capture_.GetCachedImageAsRGB8(rgb8Image)) {
-                Logger::Info(L"Background data ready! Setting background image for overlay: {}x{}", rgb8Image.width, rgb8Image.height);
-                overlay_.SetBackgroundImage(rgb8Image.data.data(), 
-                                          rgb8Image.width, 
-                                          rgb8Image.height, 
-                                          rgb8Image.stride);
-            } else {
-                Logger::Debug(L"Background data not ready yet, continuing to wait...");
-            }
-        });
+        overlay_.StartWaitingForBackground([this]() { setOverlayBackgroundFromCache(); });
+	}
+
+	// ----------------------------------------------------------------------------
+	// overlay 背景：整帧转换结果由 SmartCapture 按帧缓存，重复调用和最终裁剪都不会再次转换
+	// ----------------------------------------------------------------------------
+	void ScreenshotApp::setOverlayBackgroundFromCache() {
+		const ImageBuffer* rgb8Image = capture_.GetCachedImageAsRGB8();
+		if (rgb8Image) {
+			Logger::Info(L"Background data ready! Setting background image for overlay: {}x{}", rgb8Image->width, rgb8Image->height);
+			overlay_.SetBackgroundImage(rgb8Image->data.data(), rgb8Image->width, rgb8Image->height, rgb8Image->stride);
+		} else {
+			Logger::Debug(L"Background data not ready yet, continuing to wait...");
+		}
+	}
+
+	// ----------------------------------------------------------------------------
+	// 重新裁剪上一张：从映射文件恢复冻结帧，不抓屏；文件带预览时也不重新转换
+	// ----------------------------------------------------------------------------
+	void ScreenshotApp::doRecropLast() {
+		if (burstRunning_) {
+			Logger::Warn(L"Burst capture in progress, re-crop ignored");
+			return;
+		}
+		Trace::BeginCapture();
+		armIdleTrim();
+		if (!overlay_.IsValid()) {
+			Logger::Warn(L"Region overlay invalid");
+			return;
+		}
+
+		const std::wstring path = lastFramePath(cfg_);
+		if (path.empty() || !capture_.RestoreCache(path)) {
+			Logger::Warn(L"No last frame to re-crop");
+			return;
+		}
+		const RECT frameRect = capture_.GetCachedRect();
+
+		// 先登记背景回调：ShowWithRect 会立即调用，背景在窗口显示前就绪
+		overlay_.StartWaitingForBackground([this]() { setOverlayBackgroundFromCache(); });
+		overlay_.SetSnapEnabled(cfg_.selectionSnap);
+		overlay_.SetMultiSelect(cfg_.multiSelect);
+		overlay_.BeginSelectOnMonitor(frameRect);
 	}
 
 	// ----------------------------------------------------------------------------
 	// 全屏截图
 	// ----------------------------------------------------------------------------
 	void ScreenshotApp::doCaptureFullscreen() {
+		if (burstRunning_) {
+			Logger::Warn(L"Burst capture in progress, fullscreen capture ignored");
+			return;
+		}
+		Trace::BeginCapture();
+		armIdleTrim();
 		RECT captureRect;
 		
 		if (cfg_.fullscreenCurrentMonitor) {
@@ -417,6 +529,86 @@ namespace screenshot_tool {
 		CaptureRectDirect(captureRect);
 	}
 
+	// ----------------------------------------------------------------------------
+	// 连拍：后台线程按固定间隔抓取原始帧，编码线程同时转换保存，结束后输出节奏统计。
+	// 连拍期间捕获对象归该线程使用，其他截图和空闲回收都让路
+	// ----------------------------------------------------------------------------
+	void ScreenshotApp::doCaptureBurst() {
+		if (burstRunning_) {
+			Logger::Warn(L"Burst capture already in progress");
+			return;
+		}
+		// 连拍线程会使用 capture_ 的缓存，overlay 显示期间（冻结帧正被选择、提取）不能开始
+		if (overlay_.IsActive()) {
+			Logger::Warn(L"Region selection in progress, burst capture ignored");
+			return;
+		}
+		if (burstThread_.joinable()) {
+			burstThread_.join();
+		}
+		if (!ensureCaptureReady()) {
+			Logger::Error(L"Failed to ensure capture system ready");
+			return;
+		}
+		Trace::BeginCapture();
+		KillTimer(hwnd_, TIMER_ID_IDLE_TRIM);
+
+		const RECT captureRect = cfg_.fullscreenCurrentMonitor ? getCurrentMonitorRect() : capture_.GetVirtualDesktop();
+
+		BurstOptions options;
+		options.frameCount = cfg_.burstCount;
+		options.intervalMs = cfg_.burstIntervalMs;
+		options.ringSize = cfg_.burstRingSize;
+
+		// 文件名：连拍开始时刻（精确到毫秒）+ 三位序号，互不重名且按名称排序即拍摄顺序
+		std::vector<std::wstring> paths;
+		if (cfg_.saveToFile) {
+			std::wstring dir = ensureSaveDir(cfg_);
+			if (!dir.empty() && dir.back() != L'\\') {
+				dir += L'\\';
+			}
+			const std::wstring stem = PathUtils::MakeTimestampedStemMsW();
+			paths.reserve(options.frameCount);
+			for (int i = 0; i < options.frameCount; ++i) {
+				wchar_t suffix[16];
+				swprintf_s(suffix, L"_%03d.png", i + 1);
+				paths.push_back(dir + stem + suffix);
+			}
+		}
+
+		Logger::Info(L"Burst capture: {} frames every {} ms, ring {} frames, area {}x{} at ({}, {})",
+			options.frameCount, options.intervalMs, options.ringSize,
+			captureRect.right - captureRect.left, captureRect.bottom - captureRect.top, captureRect.left, captureRect.top);
+
+		burstRunning_ = true;
+		burstThread_ = std::thread([this, captureRect, options, paths = std::move(paths)] {
+			// 默认约 15.6 ms 的定时器粒度会直接变成抖动
+			timeBeginPeriod(1);
+			const BurstStats s = capture_.CaptureBurst(captureRect, options, paths);
+			timeEndPeriod(1);
+
+			Logger::Info(L"Burst finished: captured {}/{} ({} failed), encoded {} ({} failed), ring {} MB",
+				s.captured, s.requested, s.captureFailures, s.encoded, s.encodeFailures, s.ringBytes >> 20);
+			Logger::Info(L"Burst cadence: target {:.1f} ms, avg {:.2f} ms, median {:.2f} ms, min {:.2f} ms, max {:.2f} ms, "
+				L"jitter {:.2f} ms, lateness avg {:.2f} / max {:.2f} ms, ring stalls {} ({:.1f} ms), span {:.0f} ms, total {:.0f} ms",
+				s.targetIntervalMs, s.avgIntervalMs, s.medianIntervalMs, s.minIntervalMs, s.maxIntervalMs,
+				s.jitterMs, s.avgLatenessMs, s.maxLatenessMs, s.ringStalls, s.stallMs, s.captureSpanMs, s.totalMs);
+
+			PostMessage(hwnd_, WM_ST_BURST_DONE, 0, 0);
+		});
+	}
+
+	void ScreenshotApp::onBurstDone() {
+		if (burstThread_.joinable()) {
+			burstThread_.join();
+		}
+		burstRunning_ = false;
+
+		Trace::EndCapture(L"burst");
+		armIdleTrim();
+		logMemoryUsage(L"after burst");
+	}
+
 	// ----------------------------------------------------------------------------
 	// Overlay 区域选择 -> App 接收 WM_ST_REGION_DONE
 	// ----------------------------------------------------------------------------
@@ -426,6 +618,11 @@ namespace screenshot_tool {
 		CaptureRect(r);
 	}
 
+	void ScreenshotApp::onRegionsSelected(const std::vector<RECT>& rects) {
+		Logger::Info(L">>> onRegionsSelected called with {} regions", rects.size());
+		CaptureRects(rects);
+	}
+
 	// ----------------------------------------------------------------------------
 	// 实现执行截图逻辑，支持全屏
 	// ----------------------------------------------------------------------------
@@ -462,8 +659,59 @@ namespace screenshot_tool {
 			break;
 		}
 		
+		Trace::EndCapture(L"region");
+
+		// 冻结帧（及已转换的预览）在后台写入映射文件，供“重新裁剪上一张”使用（LastFrameFile 为空时不保存）
+		const std::wstring framePath = lastFramePath(cfg_);
+		if (!framePath.empty()) {
+			capture_.PersistCache(framePath);
+		}
+
+		armIdleTrim();
+		logMemoryUsage(L"after region capture");
 		Logger::Info(L"<<< CaptureRect finished");
 	}
+
+	// ----------------------------------------------------------------------------
+	// 多选导出：同一冻结帧的多个区域共用一次转换，文件名为 毫秒时间戳_序号.png
+	// ----------------------------------------------------------------------------
+	void ScreenshotApp::CaptureRects(const std::vector<RECT>& rects) {
+		std::wstring savePath = ensureSaveDir(cfg_);
+		if (!savePath.empty() && savePath.back() != L'\\') {
+			savePath += L'\\';
+		}
+
+		// 各区域共用精确到毫秒的时间戳，按选择顺序追加序号：同一秒内提交的两批不会互相覆盖，按名称排序即选择顺序
+		const std::wstring stem = PathUtils::MakeTimestampedStemMsW();
+
+		std::vector<std::wstring> paths;
+		if (cfg_.saveToFile) {
+			paths.reserve(rects.size());
+			for (size_t i = 0; i < rects.size(); ++i) {
+				wchar_t suffix[16];
+				swprintf_s(suffix, L"_%02zu.png", i + 1);
+				paths.push_back(savePath + stem + suffix);
+			}
+		}
+
+		SmartCapture::Result res = capture_.ExtractRegionsFromCache(hwnd_, rects, paths);
+		if (res == SmartCapture::Result::OK) {
+			Logger::Info(L"Saved {} screenshots: {}_01.png ...", rects.size(), stem);
+		} else {
+			Logger::Error(L"Some screenshots of the batch failed");
+		}
+
+		Trace::EndCapture(L"region batch");
+
+		const std::wstring framePath = lastFramePath(cfg_);
+		if (!framePath.empty()) {
+			capture_.PersistCache(framePath);
+		}
+
+		armIdleTrim();
+		logMemoryUsage(L"after region batch");
+		Logger::Info(L"<<< CaptureRects finished");
+	}
 	
 	// ----------------------------------------------------------------------------
 	// 直接捕获指定区域（不依赖缓存，用于全屏截图）
@@ -501,13 +749,47 @@ namespace screenshot_tool {
 			break;
 		}
 		
+		Trace::EndCapture(L"fullscreen");
+		armIdleTrim();
+		logMemoryUsage(L"after fullscreen capture");
 		Logger::Info(L"<<< CaptureRectDirect finished");
 	}
 
+	// ----------------------------------------------------------------------------
+	// 空闲回收：每次截图重新计时，空闲满 idleTrimSeconds 后回收冻结帧和 overlay 资源
+	// ----------------------------------------------------------------------------
+	void ScreenshotApp::armIdleTrim() {
+		if (cfg_.idleTrimSeconds <= 0) return;
+		SetTimer(hwnd_, TIMER_ID_IDLE_TRIM, static_cast<UINT>(cfg_.idleTrimSeconds) * 1000, nullptr);
+	}
+
+	void ScreenshotApp::onIdleTrim() {
+		// overlay 仍在显示（用户正在选区）或正在连拍时保留定时器，下个周期再试
+		if (burstRunning_ || !overlay_.TrimIdle()) return;
+		KillTimer(hwnd_, TIMER_ID_IDLE_TRIM);
+
+		capture_.TrimIdle(cfg_.idleTrimMode != "free");
+		logMemoryUsage(L"after idle trim");
+	}
+
+	void ScreenshotApp::logMemoryUsage(const wchar_t* when) {
+		const size_t cache = capture_.CacheResidentBytes();
+		const size_t cacheRaw = capture_.CacheRawBytes();
+		const size_t converted = capture_.ConvertedBytes();
+		const size_t staging = capture_.StagingBytes();
+		const size_t background = overlay_.BackgroundBytes();
+		const size_t swapChain = overlay_.SwapChainBytes();
+		Logger::Info(L"Memory usage {}: freeze cache {} KB (raw {} KB), converted frame {} KB, DXGI staging {} KB ({} allocations), "
+			L"overlay background {} KB, overlay swap chain {} KB, total {} KB",
+			when, cache / 1024, cacheRaw / 1024, converted / 1024, staging / 1024, capture_.StagingAllocations(),
+			background / 1024, swapChain / 1024, (cache + converted + staging + background + swapChain) / 1024);
+	}
+
 	// ----------------------------------------------------------------------------
 	// 确保捕获系统就绪，检测显示配置变化
 	// ----------------------------------------------------------------------------
 	bool ScreenshotApp::ensureCaptureReady() {
+		TraceScope trace("ScreenshotApp::ensureCaptureReady");
 		// 检查显示配置是否发生变化
 		UINT currentWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
 		UINT currentHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
@@ -591,6 +873,7 @@ namespace screenshot_tool {
 			int id = (int)wParam;
 			if (id == HOTKEY_ID_REGION)      doCaptureRegion();
 			else if (id == HOTKEY_ID_FULLSCREEN) doCaptureFullscreen();
+			else if (id == HOTKEY_ID_BURST)      doCaptureBurst();
 			return 0;
 		}
 
@@ -603,6 +886,10 @@ namespace screenshot_tool {
                 HMENU menu = CreatePopupMenu();
                 AppendMenu(menu, MF_STRING, TrayMenuId::IDM_TRAY_CAPTURE_REGION, L"区域截图");
                 AppendMenu(menu, MF_STRING, TrayMenuId::IDM_TRAY_CAPTURE_FULLSCREEN, L"全屏截图");
+                AppendMenu(menu, MF_STRING | (burstRunning_ ? MF_GRAYED : 0),
+                          TrayMenuId::IDM_TRAY_CAPTURE_BURST, L"连拍全屏");
+                AppendMenu(menu, MF_STRING | (cfg_.lastFrameFile.empty() ? MF_GRAYED : 0),
+                          TrayMenuId::IDM_TRAY_RECROP_LAST, L"重新裁剪上一张");
                 AppendMenu(menu, MF_SEPARATOR, 0, nullptr);
                 
                 // 多显示器选项子菜单
@@ -630,6 +917,17 @@ namespace screenshot_tool {
 			return 0;
 		}
 
+		case WM_TIMER:
+			if (wParam == TIMER_ID_IDLE_TRIM) {
+				onIdleTrim();
+				return 0;
+			}
+			break;
+
+		case WM_ST_BURST_DONE:
+			onBurstDone();
+			return 0;
+
 		case WM_ST_REGION_DONE: {
 			// Overlay 将 lParam 传递 RECT* 或 encoded rect，此处简化，RECT 直接拷贝
 			RECT r = *reinterpret_cast<RECT*>(lParam); // TODO: 从 Overlay 实现获取
@@ -8,6 +8,8 @@
 #include "../platform/WinGDIPlusInit.hpp"
 #include "../platform/WinShell.hpp"
 #include "../util/Logger.hpp"
+#include <thread>
+#include <vector>
 
 namespace screenshot_tool {
 
@@ -27,11 +29,20 @@ namespace screenshot_tool {
         void onTrayMenu(UINT cmd);
         void doCaptureRegion();
         void doCaptureFullscreen();
+        void doRecropLast();
+        void doCaptureBurst();
+        void onBurstDone();        // 连拍线程结束（WM_ST_BURST_DONE）
+        void setOverlayBackgroundFromCache();
         void onRegionSelected(const RECT& r);
+        void onRegionsSelected(const std::vector<RECT>& rects);
         void applyAutoStart();
         void CaptureRect(const RECT& r);          // 从缓存中提取区域
+        void CaptureRects(const std::vector<RECT>& rects);  // 从缓存中一次提取多个区域（多选）
         void CaptureRectDirect(const RECT& r);    // 直接捕获区域
         bool ensureCaptureReady(); // 确保捕获系统就绪，检测显示配置变化
+        void armIdleTrim();        // 重新开始空闲计时
+        void onIdleTrim();         // 空闲到期：回收冻结帧、暂存纹理和 overlay 资源
+        void logMemoryUsage(const wchar_t* when);  // 按子系统输出当前驻留字节数
 
         HINSTANCE      hInst_ = nullptr;
         HWND           hwnd_ = nullptr;
@@ -43,6 +54,10 @@ namespace screenshot_tool {
         SmartCapture   capture_;
         bool           running_ = false;
         
+        // 连拍线程；burstRunning_ 只在 UI 线程读写
+        std::thread    burstThread_;
+        bool           burstRunning_ = false;
+        
         // 显示配置监控
         UINT           lastDisplayWidth_ = 0;
         UINT           lastDisplayHeight_ = 0;
@@ -0,0 +1,185 @@
+#include "BurstCapture.hpp"
+#include "../util/ParallelFor.hpp"
+#include "../util/Trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        int64_t elapsedUs(Clock::time_point from, Clock::time_point to) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+        }
+
+        void summarizeCadence(const std::vector<int64_t>& timesUs, const std::vector<int64_t>& latenessUs, BurstStats& s) {
+            if (!latenessUs.empty()) {
+                int64_t sum = 0, worst = 0;
+                for (int64_t v : latenessUs) {
+                    sum += v;
+                    worst = std::max(worst, v);
+                }
+                s.avgLatenessMs = static_cast<double>(sum) / latenessUs.size() / 1000.0;
+                s.maxLatenessMs = worst / 1000.0;
+            }
+            if (timesUs.size() < 2) return;
+
+            std::vector<int64_t> intervals;
+            intervals.reserve(timesUs.size() - 1);
+            for (size_t i = 1; i < timesUs.size(); ++i) intervals.push_back(timesUs[i] - timesUs[i - 1]);
+
+            double sum = 0.0;
+            for (int64_t v : intervals) sum += static_cast<double>(v);
+            const double mean = sum / intervals.size();
+            double var = 0.0;
+            for (int64_t v : intervals) var += (v - mean) * (v - mean);
+
+            std::vector<int64_t> sorted = intervals;
+            auto mid = sorted.begin() + sorted.size() / 2;
+            std::nth_element(sorted.begin(), mid, sorted.end());
+
+            s.avgIntervalMs = mean / 1000.0;
+            s.medianIntervalMs = *mid / 1000.0;
+            s.minIntervalMs = *std::min_element(intervals.begin(), intervals.end()) / 1000.0;
+            s.maxIntervalMs = *std::max_element(intervals.begin(), intervals.end()) / 1000.0;
+            s.jitterMs = std::sqrt(var / intervals.size()) / 1000.0;
+            s.captureSpanMs = (timesUs.back() - timesUs.front()) / 1000.0;
+        }
+
+    } // namespace
+
+    ImageBuffer BurstFrame::TakeSpare(size_t bytes) {
+        if (spare.empty()) return {};
+
+        auto better = [bytes](const ImageBuffer& a, const ImageBuffer& b) {
+            const size_t ca = a.data.capacity(), cb = b.data.capacity();
+            if ((ca >= bytes) != (cb >= bytes)) return ca >= bytes;
+            return ca >= bytes ? ca < cb : ca > cb;
+        };
+        auto best = spare.begin();
+        for (auto it = spare.begin() + 1; it != spare.end(); ++it) {
+            if (better(*it, *best)) best = it;
+        }
+
+        ImageBuffer b = std::move(*best);
+        spare.erase(best);
+        return b;
+    }
+
+    BurstStats BurstCapture::Run(const BurstOptions& options, const PrepareFn& prepare,
+                                 const CaptureFn& capture, const EncodeFn& encode)
+    {
+        TraceScope trace("BurstCapture::Run");
+        BurstStats stats;
+        const int count = std::max(0, options.frameCount);
+        const int64_t intervalUs = static_cast<int64_t>(std::max(0, options.intervalMs)) * 1000;
+        stats.requested = count;
+        stats.targetIntervalMs = intervalUs / 1000.0;
+        if (count == 0) return stats;
+
+        // 槽位一次性分配：连拍过程中不再为原始帧申请内存
+        std::vector<BurstFrame> ring(std::clamp(options.ringSize, 1, count));
+        for (auto& slot : ring) {
+            if (prepare) prepare(slot);
+            for (const auto& b : slot.spare) stats.ringBytes += b.data.capacity();
+        }
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<int> freeSlots;
+        std::deque<int> ready;
+        bool producerDone = false;
+        for (int i = 0; i < static_cast<int>(ring.size()); ++i) freeSlots.push_back(i);
+
+        // 编码线程：转换与编码各帧互不依赖，取到即处理，完成后归还槽位
+        int encoders = options.encodeThreads > 0 ? options.encodeThreads : std::clamp(ParallelWorkerCount() / 2, 1, 4);
+        encoders = std::min(encoders, static_cast<int>(ring.size()));
+        std::vector<std::thread> threads;
+        threads.reserve(encoders);
+        for (int t = 0; t < encoders; ++t) {
+            threads.emplace_back([&] {
+                std::unique_lock<std::mutex> lock(mutex);
+                for (;;) {
+                    cv.wait(lock, [&] { return !ready.empty() || producerDone; });
+                    if (ready.empty()) break;
+                    const int slot = ready.front();
+                    ready.pop_front();
+
+                    lock.unlock();
+                    const bool ok = encode && encode(ring[slot]);
+                    ring[slot].image.Recycle(ring[slot].spare);
+                    lock.lock();
+
+                    if (ok) ++stats.encoded; else ++stats.encodeFailures;
+                    freeSlots.push_back(slot);
+                    cv.notify_all();
+                }
+            });
+        }
+
+        // 抓取：按绝对时间表，第 i 帧计划在 start + i * interval
+        std::vector<int64_t> timesUs;
+        std::vector<int64_t> latenessUs;
+        timesUs.reserve(count);
+        latenessUs.reserve(count);
+        int64_t stallUs = 0;
+
+        const Clock::time_point start = Clock::now();
+        for (int i = 0; i < count; ++i) {
+            const Clock::time_point deadline = start + std::chrono::microseconds(intervalUs * i);
+            std::this_thread::sleep_until(deadline);
+
+            int slot = -1;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (freeSlots.empty()) {
+                    ++stats.ringStalls;
+                    const Clock::time_point waitStart = Clock::now();
+                    cv.wait(lock, [&] { return !freeSlots.empty(); });
+                    stallUs += elapsedUs(waitStart, Clock::now());
+                }
+                slot = freeSlots.front();
+                freeSlots.pop_front();
+            }
+
+            BurstFrame& frame = ring[slot];
+            const Clock::time_point now = Clock::now();
+            frame.index = i;
+            frame.captureUs = elapsedUs(start, now);
+            latenessUs.push_back(std::max<int64_t>(0, elapsedUs(deadline, now)));
+
+            const bool ok = capture && capture(frame);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ok) {
+                ++stats.captured;
+                timesUs.push_back(frame.captureUs);
+                ready.push_back(slot);
+            } else {
+                ++stats.captureFailures;
+                frame.image.Recycle(frame.spare);
+                freeSlots.push_back(slot);
+            }
+            cv.notify_all();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            producerDone = true;
+        }
+        cv.notify_all();
+        for (auto& t : threads) t.join();
+
+        summarizeCadence(timesUs, latenessUs, stats);
+        stats.stallMs = stallUs / 1000.0;
+        stats.totalMs = elapsedUs(start, Clock::now()) / 1000.0;
+        return stats;
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
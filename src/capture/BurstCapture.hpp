@@ -0,0 +1,65 @@
+#pragma once
+#include "../image/ImageBuffer.hpp"
+#include "../image/TiledImage.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 连拍：按固定间隔抓取原始帧放入预分配的环形缓冲，后台线程转换和编码。
+    // 与平台无关，抓取与编码由调用方提供（Windows 上是 DXGI/GDI + PNG，也可以是合成的测试源）。
+
+    struct BurstOptions {
+        int frameCount = 30;
+        int intervalMs = 100;
+        int ringSize = 6;           // 同时驻留的原始帧数，即抓取最多领先编码多少帧
+        int encodeThreads = 0;      // 0 = 按 CPU 核数自动选择
+    };
+
+    // 环形缓冲中的一个槽
+    struct BurstFrame {
+        TiledImage image;                   // 原始帧，各显示器保持原生格式
+        std::vector<ImageBuffer> spare;     // 可复用的像素缓冲区（预分配的 / 上一轮用过的块）
+        int index = -1;                     // 在本次连拍中的序号
+        int64_t captureUs = 0;              // 相对连拍开始的抓取时刻
+
+        // 取一块可复用的缓冲区：优先容量够 bytes 的最小一块，都不够时取最大的一块（没有时返回空缓冲区）
+        ImageBuffer TakeSpare(size_t bytes);
+    };
+
+    struct BurstStats {
+        int     requested = 0;
+        int     captured = 0;
+        int     captureFailures = 0;
+        int     encoded = 0;
+        int     encodeFailures = 0;
+        double  targetIntervalMs = 0.0;
+        double  avgIntervalMs = 0.0;        // 相邻两次成功抓取的间隔
+        double  medianIntervalMs = 0.0;
+        double  minIntervalMs = 0.0;
+        double  maxIntervalMs = 0.0;
+        double  jitterMs = 0.0;             // 间隔的标准差
+        double  avgLatenessMs = 0.0;        // 实际抓取时刻相对计划时刻的延迟
+        double  maxLatenessMs = 0.0;
+        int     ringStalls = 0;             // 环形缓冲已满、抓取等待编码腾出槽位的次数
+        double  stallMs = 0.0;
+        double  captureSpanMs = 0.0;        // 第一帧到最后一帧
+        double  totalMs = 0.0;              // 含编码收尾
+        size_t  ringBytes = 0;              // 环形缓冲预分配的字节数
+    };
+
+    class BurstCapture {
+    public:
+        using PrepareFn = std::function<void(BurstFrame& slot)>;        // 开始计时前为每个槽预分配缓冲区
+        using CaptureFn = std::function<bool(BurstFrame& frame)>;       // 抓取一帧到槽中，应优先使用 TakeSpare 的缓冲区
+        using EncodeFn  = std::function<bool(BurstFrame& frame)>;       // 在编码线程上调用，多个线程并发
+
+        // 阻塞直到所有帧抓取并编码完成。抓取在调用线程上按绝对时间表进行（晚了不补拍也不跳帧），
+        // 环形缓冲满时等待编码线程释放槽位，这段等待计入延迟和 ringStalls
+        static BurstStats Run(const BurstOptions& options, const PrepareFn& prepare,
+                              const CaptureFn& capture, const EncodeFn& encode);
+    };
+
+} // namespace screenshot_tool
\ No newline at end of file
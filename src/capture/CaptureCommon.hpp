@@ -7,11 +7,13 @@ namespace screenshot_tool {
         float maxLuminance = 1000.0f;
         float minLuminance = 0.1f;
         float maxContentLightLevel = 1000.0f;
+        bool  hdrEnabled = false;   // 输出当前处于 HDR（PQ / BT.2020）模式
     };
 
     enum class CaptureResult {
         Success,
         TemporaryFailure,      // 可重试，不需要重新初始化
+        NoNewFrame,            // 画面没有更新且没有可复用的上一次复制（重新初始化后会立即得到当前画面）
         NeedsReinitialization, // 需要重新初始化 (设备丢失、配置变化等)
         NotSupported          // 完全不支持，需要fallback
     };
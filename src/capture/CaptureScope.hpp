@@ -0,0 +1,46 @@
+#pragma once
+#include "OutputRotation.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// 冻结帧缓存的范围：选择可能到达的矩形与虚拟桌面求交，再按显示器切块。
+// 只处理虚拟桌面坐标（半开区间），与 Win32 无关，以便用合成的显示器布局测试
+namespace screenshot_tool {
+
+    // 交集非空时写入 out 并返回 true；只有边相接不算相交
+    inline bool IntersectBox(const PixelBox& a, const PixelBox& b, PixelBox& out) {
+        const PixelBox r{ std::max(a.left, b.left), std::max(a.top, b.top), std::min(a.right, b.right), std::min(a.bottom, b.bottom) };
+        if (r.left >= r.right || r.top >= r.bottom) return false;
+        out = r;
+        return true;
+    }
+
+    // 缓存范围 = 选择范围 ∩ 虚拟桌面。选择限制在单个显示器时即为该显示器，转换、上传和内存都只与它相关
+    inline bool CacheScope(const PixelBox& selectionScope, const PixelBox& virtualDesktop, PixelBox& out) {
+        return IntersectBox(selectionScope, virtualDesktop, out);
+    }
+
+    struct CacheTile {
+        size_t monitor;     // 在显示器列表中的下标
+        PixelBox box;       // 该显示器与缓存范围的交集
+    };
+
+    // 每个与缓存范围相交的显示器一块，显示器之间的空洞不分配
+    inline std::vector<CacheTile> CacheTiles(const PixelBox& cacheRect, const std::vector<PixelBox>& monitors) {
+        std::vector<CacheTile> tiles;
+        for (size_t i = 0; i < monitors.size(); ++i) {
+            PixelBox box;
+            if (IntersectBox(cacheRect, monitors[i], box)) tiles.push_back({ i, box });
+        }
+        return tiles;
+    }
+
+    // 选中的区域能否从缓存提取：非空且完全位于缓存范围内
+    inline bool RegionInCache(const PixelBox& region, const PixelBox& cacheRect) {
+        return region.Width() > 0 && region.Height() > 0 &&
+            region.left >= cacheRect.left && region.top >= cacheRect.top &&
+            region.right <= cacheRect.right && region.bottom <= cacheRect.bottom;
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
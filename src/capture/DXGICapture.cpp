@@ -1,5 +1,6 @@
 #include "DXGICapture.hpp"
 #include "../util/Logger.hpp"
+#include "../util/Trace.hpp"
 #include "../platform/WinHeaders.hpp"
 #include <algorithm>
 #include <vector>
@@ -25,6 +26,8 @@ namespace screenshot_tool {
             monitor.device.Reset();
         }
         monitors_.clear();
+        staging_.Clear();       // 暂存纹理属于旧设备
+        devices_.clear();
         initialized_ = false;
         hdrEnabled_ = false;
         hdrMeta_ = {};
@@ -85,179 +88,273 @@ namespace screenshot_tool {
         return true;
     }
 
-    bool DXGICapture::InitMonitor(MonitorInfo& info) {
-        // 清理之前的资源
-        info.dupl.Reset();
-        info.context.Reset();
-        info.device.Reset();
-        
+    bool DXGICapture::acquireDevice(MonitorInfo& info) {
+        DXGI_ADAPTER_DESC1 ad{};
+        if (FAILED(info.adapter->GetDesc1(&ad))) return false;
+        info.adapterLuid = ad.AdapterLuid;
 
+        for (auto it = devices_.begin(); it != devices_.end(); ++it) {
+            if (it->luid.LowPart != ad.AdapterLuid.LowPart || it->luid.HighPart != ad.AdapterLuid.HighPart) continue;
+            if (it->device->GetDeviceRemovedReason() != S_OK) {
+                devices_.erase(it);     // 驱动重置等情况下重新创建
+                break;
+            }
+            info.device = it->device;
+            info.context = it->context;
+            return true;
+        }
+
+        AdapterDevice entry;
+        entry.luid = ad.AdapterLuid;
         D3D_FEATURE_LEVEL fl;
         HRESULT hr = D3D11CreateDevice(
             info.adapter.Get(), D3D_DRIVER_TYPE_UNKNOWN, nullptr,
             0, nullptr, 0, D3D11_SDK_VERSION,
-            &info.device, &fl, &info.context);
+            &entry.device, &fl, &entry.context);
         if (FAILED(hr)) {
             Logger::Error(L"Failed to create D3D11 device, HRESULT: 0x{:x}", static_cast<unsigned>(hr));
             return false;
         }
+        Logger::Debug(L"Created D3D11 device for adapter {}", ad.Description);
 
-        // 尝试使用更好的格式
-        DXGI_FORMAT fmt = DXGI_FORMAT_R16G16B16A16_FLOAT;
-        hr = info.output6->DuplicateOutput1(info.device.Get(), 0, 1, &fmt, &info.dupl);
-        if (FAILED(hr)) {
-            // 回退到标准输出复制
+        info.device = entry.device;
+        info.context = entry.context;
+        devices_.push_back(std::move(entry));
+        return true;
+    }
+
+    DXGICapture::StagingSlot* DXGICapture::acquireStaging(const MonitorInfo& info, DXGI_FORMAT format, UINT width, UINT height) {
+        if (!info.device) return nullptr;
+
+        // 已有纹理格式相同且足够大时直接复用，否则按本次子矩形重新分配（保留的上一次复制随之作废）
+        return staging_.Acquire(info.stagingKey, format, static_cast<int>(width), static_cast<int>(height),
+            BytesPerPixel(PixelFormatFromDXGI(format)), [&](uint32_t, int w, int h) {
+                D3D11_TEXTURE2D_DESC desc{};
+                desc.Width = static_cast<UINT>(w);
+                desc.Height = static_cast<UINT>(h);
+                desc.MipLevels = 1;
+                desc.ArraySize = 1;
+                desc.Format = format;
+                desc.SampleDesc.Count = 1;
+                desc.Usage = D3D11_USAGE_STAGING;
+                desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+                ComPtr<ID3D11Texture2D> texture;
+                HRESULT hr = info.device->CreateTexture2D(&desc, nullptr, &texture);
+                if (FAILED(hr)) {
+                    Logger::Error(L"Failed to create {}x{} staging texture, HRESULT: 0x{:x}", w, h, static_cast<unsigned>(hr));
+                    return ComPtr<ID3D11Texture2D>();
+                }
+                Logger::Debug(L"Allocated {}x{} staging texture for {} ({} allocations so far)", w, h,
+                    info.stagingKey.output, staging_.Allocations() + 1);
+                return texture;
+            });
+    }
+
+    bool DXGICapture::readStaging(const MonitorInfo& info, StagingSlot& slot, const OutputRegion& part, ImageBuffer& out, bool& hasContent) {
+        const PixelBox& sb = slot.box;
+        const PixelBox& tb = part.texture;
+        if (!slot.Holds(tb)) return false;
+
+        const PixelFormat srcFmt = PixelFormatFromDXGI(static_cast<DXGI_FORMAT>(slot.format));
+        if (!OutputCopyCompatible(srcFmt, out.format)) return false;
+
+        ID3D11Texture2D* staging = slot.texture.Get();
+        D3D11_MAPPED_SUBRESOURCE mapped{};
+        if (FAILED(info.context->Map(staging, 0, D3D11_MAP_READ, 0, &mapped))) {
+            slot.valid = false;
+            return false;
+        }
+        auto unmap = [&](void*) { info.context->Unmap(staging, 0); };
+        std::unique_ptr<void, decltype(unmap)> mapGuard(reinterpret_cast<void*>(1), unmap);
+
+        // 请求的子矩形可以只是保留内容的一部分：按偏移定位到它的左上角
+        const uint8_t* data = static_cast<const uint8_t*>(mapped.pData) +
+            static_cast<std::ptrdiff_t>(tb.top - sb.top) * mapped.RowPitch +
+            static_cast<std::ptrdiff_t>(tb.left - sb.left) * BytesPerPixel(srcFmt);
+        const MappedTexture src{ data, static_cast<std::ptrdiff_t>(mapped.RowPitch), srcFmt };
+        if (CopyOutputRegion(src, part, out)) hasContent = true;
+        return true;
+    }
+
+    void DXGICapture::ReleaseStaging() {
+        staging_.Release();
+    }
+
+    size_t DXGICapture::StagingBytes() const {
+        return staging_.Bytes();
+    }
+
+    bool DXGICapture::InitMonitor(MonitorInfo& info) {
+        // 清理之前的资源
+        info.dupl.Reset();
+        info.context.Reset();
+        info.device.Reset();
+
+        if (!acquireDevice(info)) return false;
+
+        // 按输出当前是否处于 HDR 模式请求原生格式
+        DXGI_OUTPUT_DESC1 desc1{};
+        bool hdr = SUCCEEDED(info.output6->GetDesc1(&desc1)) &&
+            desc1.ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020;
+        DXGI_FORMAT fmt = NativeDuplicationFormat(hdr);
+        HRESULT hr = info.output6->DuplicateOutput1(info.device.Get(), 0, 1, &fmt, &info.dupl);
+        const bool native = SUCCEEDED(hr);
+        if (!native) {
+            // 回退到标准输出复制（始终为 BGRA8）
             hr = info.output6->DuplicateOutput(info.device.Get(), &info.dupl);
             if (FAILED(hr)) {
                 Logger::Error(L"Failed to duplicate output, HRESULT: 0x{:x}", static_cast<unsigned>(hr));
                 return false;
             }
         }
+        info.format = NegotiateCaptureFormat(hdr, native);
+
+        // 暂存纹理按输出保存在池中，重新枚举后同一输出继续使用已分配的纹理。其中的内容来自旧的复制接口，
+        // 不能用来顶替新接口的超时（新接口第一次取帧会返回当前画面，之后才重新生效）
+        DXGI_OUTPUT_DESC od{};
+        info.output6->GetDesc(&od);
+        info.stagingKey.adapter = (static_cast<uint64_t>(static_cast<uint32_t>(info.adapterLuid.HighPart)) << 32) | info.adapterLuid.LowPart;
+        info.stagingKey.output = od.DeviceName;
+        staging_.At(info.stagingKey).valid = false;
 
         DXGI_OUTDUPL_DESC dd{};
         info.dupl->GetDesc(&dd);
-        info.rotation = dd.Rotation;
+        info.rotation = OutputRotationFromDXGI(dd.Rotation);
         info.width = dd.ModeDesc.Width;
         info.height = dd.ModeDesc.Height;
 
+        Logger::Debug(L"Output {}x{} at ({}, {}): {} duplication", info.width, info.height,
+            info.desktopRect.left, info.desktopRect.top, info.format == PixelFormat::RGBA_F16 ? L"FP16" : L"BGRA8");
         return true;
     }
 
     void DXGICapture::detectHDR() {
         hdrEnabled_ = false;
+        hdrMeta_ = {};
         
-        if (!monitors_.empty()) {
+        // 逐个输出检测：混合 HDR/SDR 多屏时各显示器分别色调映射
+        for (size_t i = 0; i < monitors_.size(); ++i) {
+            auto& monitor = monitors_[i];
+            monitor.hdr = {};
+
             DXGI_OUTPUT_DESC1 outputDesc1;
-            if (SUCCEEDED(monitors_.front().output6->GetDesc1(&outputDesc1))) {
-                // 检测 HDR10/PQ 色彩空间
-                hdrEnabled_ = (outputDesc1.ColorSpace == 12); // DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020
-                
-                // 额外检查：如果 MaxLuminance > 400nits，可能是 HDR 显示器
-                if (!hdrEnabled_ && outputDesc1.MaxLuminance > 400.0f) {
-                    hdrEnabled_ = true;
-                }
-                
-                hdrMeta_.maxLuminance = outputDesc1.MaxLuminance;
-                hdrMeta_.minLuminance = outputDesc1.MinLuminance;
-                hdrMeta_.maxContentLightLevel = outputDesc1.MaxFullFrameLuminance;
-                
-                Logger::Info(L"HDR detection: {} (ColorSpace: {}, MaxLuminance: {})", 
-                    hdrEnabled_ ? L"Yes" : L"No", 
-                    static_cast<int>(outputDesc1.ColorSpace), 
-                    outputDesc1.MaxLuminance);
+            if (FAILED(monitor.output6->GetDesc1(&outputDesc1))) continue;
+
+            // 只有 PQ 色彩空间才表示输出处于 HDR 模式；
+            // 支持 HDR 但当前运行在 SDR 模式的显示器同样会报告较高的 MaxLuminance，不能据此判断
+            monitor.colorSpace = outputDesc1.ColorSpace;
+            monitor.hdr.hdrEnabled = (outputDesc1.ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020);
+            monitor.hdr.maxLuminance = outputDesc1.MaxLuminance;
+            monitor.hdr.minLuminance = outputDesc1.MinLuminance;
+            monitor.hdr.maxContentLightLevel = outputDesc1.MaxFullFrameLuminance;
+
+            if (monitor.hdr.hdrEnabled && !hdrEnabled_) {
+                hdrEnabled_ = true;
+                hdrMeta_ = monitor.hdr;
             }
+
+            Logger::Info(L"HDR detection [{}]: {} (ColorSpace: {}, MaxLuminance: {}, MinLuminance: {})", 
+                i,
+                monitor.hdr.hdrEnabled ? L"Yes" : L"No", 
+                static_cast<int>(outputDesc1.ColorSpace), 
+                outputDesc1.MaxLuminance,
+                outputDesc1.MinLuminance);
+        }
+
+        if (!hdrEnabled_ && !monitors_.empty()) {
+            hdrMeta_ = monitors_.front().hdr;
         }
     }
 
-    CaptureResult DXGICapture::CaptureRegion(int x, int y, int w, int h, DXGI_FORMAT& fmt, ImageBuffer& out) {
-        RECT regionRect{ x, y, x + w, y + h };
+    CaptureResult DXGICapture::CaptureRegion(int x, int y, int w, int h, PixelFormat& fmt, ImageBuffer& out, bool compactHDR,
+        UINT acquireTimeoutMs) {
+        TraceScope trace("DXGICapture::CaptureRegion");
+        const PixelBox region{ x, y, x + w, y + h };
         
-        fmt = DXGI_FORMAT_UNKNOWN;
-        UINT bpp = 0;
-        out.data.clear();
-        bool gotFrame = false;
-        bool allSuccess = true;
+        // 各输出以原生格式复制；区域跨越 HDR 与 SDR 输出时整块使用 FP16
+        std::vector<CaptureOutput> layout;
+        layout.reserve(monitors_.size());
+        for (const auto& m : monitors_) layout.push_back({ ToPixelBox(m.desktopRect), m.format });
+        fmt = CaptureBufferFormat(RegionCaptureFormat(region, layout), compactHDR);
+        PrepareCaptureBuffer(out, fmt, w, h);
+        bool lost = false;          // 复制接口失效（访问丢失、设备移除、会话断开）或输出与初始化时不符
+        bool stale = false;         // 有输出没出新帧，也没有可复用的上一次复制
+        bool anyOutput = false;
+        bool hasContent = false;    // 复制到的像素中是否有非零值（尚未出帧时纹理为全零）
 
         for (auto& m : monitors_) {
-            RECT inter{};
-            if (!IntersectRect(&inter, &regionRect, &m.desktopRect)) continue;
+            OutputRegion part;
+            if (!IntersectOutput(region, ToPixelBox(m.desktopRect), m.rotation, part)) continue;
+            anyOutput = true;
 
             ComPtr<IDXGIResource> resource;
             DXGI_OUTDUPL_FRAME_INFO frameInfo;
-            HRESULT hr = m.dupl->AcquireNextFrame(100, &frameInfo, &resource);
+            HRESULT hr = m.dupl->AcquireNextFrame(acquireTimeoutMs, &frameInfo, &resource);
+            if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
+                // 画面没有更新：暂存纹理中上一次复制的内容就是当前画面
+                if (!readStaging(m, staging_.At(m.stagingKey), part, out, hasContent)) stale = true;
+                continue;
+            }
             if (FAILED(hr)) {
-                if (hr == DXGI_ERROR_ACCESS_LOST || 
-                    hr == DXGI_ERROR_DEVICE_REMOVED ||
-                    hr == DXGI_ERROR_SESSION_DISCONNECTED) {
-                    allSuccess = false;
-                    gotFrame = false;
-                    continue;
-                } else if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
-                    allSuccess = false;
-                    continue;
-                } else {
-                    allSuccess = false; 
-                    continue; 
+                if (hr != DXGI_ERROR_ACCESS_LOST && hr != DXGI_ERROR_DEVICE_REMOVED && hr != DXGI_ERROR_SESSION_DISCONNECTED) {
+                    Logger::Warn(L"AcquireNextFrame failed, HRESULT: 0x{:x}", static_cast<unsigned>(hr));
                 }
+                lost = true;
+                continue;
             }
-            gotFrame = true;
 
             auto cleanup = [&](void*) { m.dupl->ReleaseFrame(); };
             std::unique_ptr<void, decltype(cleanup)> frameGuard(reinterpret_cast<void*>(1), cleanup);
+            staging_.At(m.stagingKey).valid = false;    // 出了新帧，保留的内容过时，复制成功后才重新生效
 
             ComPtr<ID3D11Texture2D> texture;
-            if (FAILED(resource.As(&texture))) continue;
+            if (FAILED(resource.As(&texture))) {
+                Logger::Warn(L"Duplication frame is not a D3D11 texture");
+                lost = true;
+                continue;
+            }
 
             D3D11_TEXTURE2D_DESC desc{};
             texture->GetDesc(&desc);
-            if (fmt == DXGI_FORMAT_UNKNOWN) {
-                fmt = desc.Format;
-                bpp = desc.Format == DXGI_FORMAT_R16G16B16A16_FLOAT ? 8 : 4;
-                out.format = desc.Format == DXGI_FORMAT_R16G16B16A16_FLOAT ? PixelFormat::RGBA_F16 : PixelFormat::BGRA8;
-                out.width = w;
-                out.height = h;
-                out.stride = w * bpp;
-                out.data.resize(out.stride * h);
+            const PixelFormat srcFmt = PixelFormatFromDXGI(desc.Format);
+            if (!OutputCopyCompatible(srcFmt, fmt)) {
+                Logger::Warn(L"Unexpected duplication format {} for buffer format {}", static_cast<int>(desc.Format), static_cast<int>(fmt));
+                lost = true;
+                continue;
             }
 
-            D3D11_TEXTURE2D_DESC stagingDesc = desc;
-            stagingDesc.Usage = D3D11_USAGE_STAGING;
-            stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
-            stagingDesc.BindFlags = 0;
-            stagingDesc.MiscFlags = 0;
-            ComPtr<ID3D11Texture2D> staging;
-            if (FAILED(m.device->CreateTexture2D(&stagingDesc, nullptr, &staging))) continue;
-            m.context->CopyResource(staging.Get(), texture.Get());
-
-            D3D11_MAPPED_SUBRESOURCE mapped{};
-            if (FAILED(m.context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped))) continue;
-
-            auto unmap = [&](void*) { m.context->Unmap(staging.Get(), 0); };
-            std::unique_ptr<void, decltype(unmap)> mapGuard(reinterpret_cast<void*>(1), unmap);
-
-            int destX = inter.left - x;
-            int destY = inter.top - y;
-            int rw = inter.right - inter.left;
-            int rh = inter.bottom - inter.top;
-
-            int rx0 = inter.left - m.desktopRect.left;
-            int ry0 = inter.top - m.desktopRect.top;
-
-            for (int row = 0; row < rh; ++row) {
-                for (int col = 0; col < rw; ++col) {
-                    int rx = rx0 + col;
-                    int ry = ry0 + row;
-
-                    int u = rx, v = ry;
-                    switch (m.rotation) {
-                    case DXGI_MODE_ROTATION_ROTATE90:
-                        u = ry;
-                        v = static_cast<int>(m.width) - rx - 1;
-                        break;
-                    case DXGI_MODE_ROTATION_ROTATE180:
-                        u = static_cast<int>(m.width) - rx - 1;
-                        v = static_cast<int>(m.height) - ry - 1;
-                        break;
-                    case DXGI_MODE_ROTATION_ROTATE270:
-                        u = static_cast<int>(m.height) - ry - 1;
-                        v = rx;
-                        break;
-                    default:
-                        break;
-                    }
-
-                    const uint8_t* src = static_cast<const uint8_t*>(mapped.pData) + v * mapped.RowPitch + u * bpp;
-                    uint8_t* dst = out.data.data() + ((destY + row) * w + destX + col) * bpp;
-                    memcpy(dst, src, bpp);
-                }
+            // 只复制并映射与请求区域相交的子矩形（按输出旋转换算到纹理坐标）
+            const PixelBox& texBox = part.texture;
+            if (texBox.left < 0 || texBox.top < 0 ||
+                texBox.right > static_cast<int>(desc.Width) || texBox.bottom > static_cast<int>(desc.Height)) {
+                Logger::Warn(L"Duplication texture {}x{} does not cover output {}x{}", desc.Width, desc.Height, part.deskWidth, part.deskHeight);
+                lost = true;
+                continue;
+            }
+
+            StagingSlot* staging = acquireStaging(m, desc.Format, texBox.Width(), texBox.Height());
+            if (!staging) {
+                // 这一输出的部分会留空（全黑），不能当作成功
+                lost = true;
+                continue;
             }
+            D3D11_BOX box{ static_cast<UINT>(texBox.left), static_cast<UINT>(texBox.top), 0,
+                           static_cast<UINT>(texBox.right), static_cast<UINT>(texBox.bottom), 1 };
+            m.context->CopySubresourceRegion(staging->texture.Get(), 0, 0, 0, 0, texture.Get(), 0, &box);
+            staging->box = texBox;
+            staging->valid = true;
+
+            // 在释放帧之前映射，复制命令读取的仍是这一帧
+            if (!readStaging(m, *staging, part, out, hasContent)) stale = true;
         }
 
-        if (!gotFrame || !allSuccess) {
+        if (lost || !anyOutput) {
             return CaptureResult::NeedsReinitialization;
         }
-        
-        if (out.data.empty() || std::all_of(out.data.begin(), out.data.end(), [](uint8_t v) { return v == 0; })) {
+        if (stale) {
+            return CaptureResult::NoNewFrame;
+        }
+        if (out.data.empty() || !hasContent) {
             return CaptureResult::TemporaryFailure;
         }
 
@@ -1,5 +1,8 @@
 #pragma once
 #include "CaptureCommon.hpp"
+#include "OutputCopy.hpp"
+#include "OutputRotation.hpp"
+#include "StagingPool.hpp"
 #include "../image/ImageBuffer.hpp"
 #include "../config/Config.hpp"
 #include "../platform/WinHeaders.hpp"
@@ -11,16 +14,48 @@
 
 namespace screenshot_tool {
 
+    // 桌面复制纹理格式 -> 图像核心使用的像素格式（其余 8bit 格式按 BGRA8 处理）
+    inline PixelFormat PixelFormatFromDXGI(DXGI_FORMAT fmt) {
+        switch (fmt) {
+        case DXGI_FORMAT_R16G16B16A16_FLOAT: return PixelFormat::RGBA_F16;
+        case DXGI_FORMAT_R10G10B10A2_UNORM:  return PixelFormat::RGBA10A2;
+        default:                             return PixelFormat::BGRA8;
+        }
+    }
+
+    // 输出按当前模式选择复制格式：HDR 输出为 FP16 scRGB，SDR 输出为 BGRA8（回读带宽减半）
+    inline DXGI_FORMAT NativeDuplicationFormat(bool hdrEnabled) {
+        return NativeCaptureFormat(hdrEnabled) == PixelFormat::RGBA_F16 ? DXGI_FORMAT_R16G16B16A16_FLOAT : DXGI_FORMAT_B8G8R8A8_UNORM;
+    }
+
+    inline PixelBox ToPixelBox(const RECT& r) {
+        return { static_cast<int>(r.left), static_cast<int>(r.top), static_cast<int>(r.right), static_cast<int>(r.bottom) };
+    }
+
+    inline OutputRotation OutputRotationFromDXGI(DXGI_MODE_ROTATION rot) {
+        switch (rot) {
+        case DXGI_MODE_ROTATION_ROTATE90:  return OutputRotation::Rotate90;
+        case DXGI_MODE_ROTATION_ROTATE180: return OutputRotation::Rotate180;
+        case DXGI_MODE_ROTATION_ROTATE270: return OutputRotation::Rotate270;
+        default:                           return OutputRotation::Identity;
+        }
+    }
+
     struct MonitorInfo {
         Microsoft::WRL::ComPtr<IDXGIAdapter1> adapter;
+        LUID adapterLuid{};
         Microsoft::WRL::ComPtr<IDXGIOutput6> output6;
-        Microsoft::WRL::ComPtr<ID3D11Device> device;
+        Microsoft::WRL::ComPtr<ID3D11Device> device;            // 同一适配器上的输出共享
         Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
         Microsoft::WRL::ComPtr<IDXGIOutputDuplication> dupl;
+        PixelFormat format = PixelFormat::Unknown;              // 复制得到的原生格式
         RECT desktopRect{};
         UINT width = 0;
         UINT height = 0;
-        DXGI_MODE_ROTATION rotation = DXGI_MODE_ROTATION_IDENTITY;
+        OutputRotation rotation = OutputRotation::Identity;
+        DXGI_COLOR_SPACE_TYPE colorSpace = DXGI_COLOR_SPACE_RGB_FULL_G22_NONE_P709;
+        HDRMetadata hdr{};     // 该输出自身的 HDR 状态与亮度范围
+        StagingKey stagingKey; // 该输出在暂存纹理池中的位置
     };
 
     class DXGICapture {
@@ -30,22 +65,48 @@ namespace screenshot_tool {
         bool Reinitialize();
 
         bool IsInitialized() const { return initialized_; }
-        bool IsHDREnabled() const { return hdrEnabled_; }
-        HDRMetadata GetHDRMetadata() const { return hdrMeta_; }
+        bool IsHDREnabled() const { return hdrEnabled_; }     // 任一输出处于 HDR 模式
+        HDRMetadata GetHDRMetadata() const { return hdrMeta_; } // 第一个 HDR 输出（无则为主输出）
         RECT GetVirtualRect() const { return virtualRect_; }
         const std::vector<MonitorInfo>& GetMonitors() const { return monitors_; }
 
         // 底层抓屏获取原始格式 (上层再根据 HDR 判断 & 转换)
-        CaptureResult CaptureRegion(int x, int y, int w, int h, DXGI_FORMAT& fmt, ImageBuffer& out);
+        // compactHDR：FP16 数据在回读时直接打包为 RGB9E5（4 字节/像素），此时 fmt 返回 RGB9E5。
+        // acquireTimeoutMs：等待桌面出新帧的最长时间。超时时复用该输出上一次复制的内容，
+        // 没有覆盖请求区域的副本时返回 NoNewFrame；只有复制接口失效时才返回 NeedsReinitialization。
+        // out 原有的缓冲区容量会被复用
+        CaptureResult CaptureRegion(int x, int y, int w, int h, PixelFormat& fmt, ImageBuffer& out, bool compactHDR = false,
+            UINT acquireTimeoutMs = 100);
+
+        // 空闲时释放各输出的暂存纹理和其中保留的上一次复制（下次抓取按需重建）；StagingBytes 为当前占用的显存估计
+        void ReleaseStaging();
+        size_t StagingBytes() const;
+        size_t StagingAllocations() const { return staging_.Allocations(); }
 
     private:
+        // 每个适配器（按 LUID）只创建一个 D3D11 设备；Initialize 之间保留，Reinitialize 时释放
+        struct AdapterDevice {
+            LUID luid{};
+            Microsoft::WRL::ComPtr<ID3D11Device> device;
+            Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+        };
+
         bool initialized_ = false;
         bool hdrEnabled_ = false;
         HDRMetadata hdrMeta_{};
         RECT virtualRect_{};
         std::vector<MonitorInfo> monitors_;
+        std::vector<AdapterDevice> devices_;
+
+        // 回读用的暂存纹理，每个输出一张，保留最近一次复制的内容：AcquireNextFrame 超时说明画面没有变化，
+        // 请求的子矩形在其中时直接重新映射读取。与设备一样在 Initialize 之间保留，Reinitialize 时释放
+        using StagingSlot = StagingPool<Microsoft::WRL::ComPtr<ID3D11Texture2D>>::Slot;
+        StagingPool<Microsoft::WRL::ComPtr<ID3D11Texture2D>> staging_;
 
         bool initDxgiObjects();
+        bool acquireDevice(MonitorInfo& info);
+        StagingSlot* acquireStaging(const MonitorInfo& info, DXGI_FORMAT format, UINT width, UINT height);
+        bool readStaging(const MonitorInfo& info, StagingSlot& slot, const OutputRegion& part, ImageBuffer& out, bool& hasContent);
         void detectHDR();
         bool InitMonitor(MonitorInfo& info);
     };
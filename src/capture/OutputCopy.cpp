@@ -0,0 +1,104 @@
+#include "OutputCopy.hpp"
+#include "CaptureScope.hpp"
+#include "../image/PixelConvert.hpp"
+#include "../image/SharedExponent.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace screenshot_tool {
+
+    PixelFormat RegionCaptureFormat(const PixelBox& region, const std::vector<CaptureOutput>& outputs) {
+        PixelFormat format = PixelFormat::Unknown;
+        for (const auto& o : outputs) {
+            PixelBox inter;
+            if (IntersectBox(region, o.desktop, inter)) format = CommonCaptureFormat(format, o.format);
+        }
+        return format;
+    }
+
+    void PrepareCaptureBuffer(ImageBuffer& out, PixelFormat format, int width, int height) {
+        out.data.clear();
+        if (format == PixelFormat::Unknown) return;
+        out.format = format;
+        out.width = width;
+        out.height = height;
+        out.stride = width * BytesPerPixel(format);
+        out.data.resize(static_cast<size_t>(out.stride) * height);
+    }
+
+    bool OutputCopyCompatible(PixelFormat source, PixelFormat buffer) {
+        if (source == buffer) return source != PixelFormat::Unknown;
+        if (buffer == PixelFormat::RGBA_F16) return source == PixelFormat::BGRA8;
+        if (buffer == PixelFormat::RGB9E5) return source == PixelFormat::RGBA_F16 || source == PixelFormat::BGRA8;
+        return false;
+    }
+
+    bool IntersectOutput(const PixelBox& region, const PixelBox& outputDesktop, OutputRotation rotation, OutputRegion& out) {
+        PixelBox inter;
+        if (!IntersectBox(region, outputDesktop, inter)) return false;
+        out.deskWidth = outputDesktop.Width();
+        out.deskHeight = outputDesktop.Height();
+        out.rotation = rotation;
+        out.desk = { inter.left - outputDesktop.left, inter.top - outputDesktop.top,
+                     inter.right - outputDesktop.left, inter.bottom - outputDesktop.top };
+        out.texture = DesktopBoxToTexture(out.desk, out.deskWidth, out.deskHeight, rotation);
+        out.destX = inter.left - region.left;
+        out.destY = inter.top - region.top;
+        return true;
+    }
+
+    bool CopyOutputRegion(const MappedTexture& src, const OutputRegion& region, ImageBuffer& out) {
+        const int srcBpp = BytesPerPixel(src.format);
+        const int bpp = BytesPerPixel(out.format);
+        const bool pack = out.format == PixelFormat::RGB9E5;
+        const bool widen = src.format == PixelFormat::BGRA8 && out.format != PixelFormat::BGRA8;
+        const int rw = region.desk.Width();
+        const int rh = region.desk.Height();
+        const std::ptrdiff_t step = DesktopStepInTexture(region.rotation, srcBpp, src.rowPitch);
+
+        std::vector<uint8_t> gathered;      // 旋转的输出先按桌面方向收集成连续的一行
+        std::vector<uint16_t> widened;      // 打包前 BGRA8 先展开为 FP16
+        if (step != srcBpp) gathered.resize(static_cast<size_t>(rw) * srcBpp);
+        if (pack && widen) widened.resize(static_cast<size_t>(rw) * 4);
+
+        bool hasContent = false;
+        for (int row = 0; row < rh; ++row) {
+            // 每行起点换算到纹理坐标，再减去子矩形原点即为暂存纹理内的位置
+            int u = 0, v = 0;
+            DesktopPixelToTexture(region.desk.left, region.desk.top + row, region.deskWidth, region.deskHeight, region.rotation, u, v);
+            const uint8_t* s = src.data + static_cast<std::ptrdiff_t>(v - region.texture.top) * src.rowPitch +
+                static_cast<std::ptrdiff_t>(u - region.texture.left) * srcBpp;
+            uint8_t* dst = out.data.data() + static_cast<size_t>(region.destY + row) * out.stride + static_cast<size_t>(region.destX) * bpp;
+
+            if (step != srcBpp) {
+                uint8_t* g = gathered.data();
+                for (int col = 0; col < rw; ++col, s += step, g += srcBpp) {
+                    std::memcpy(g, s, srcBpp);
+                }
+                s = gathered.data();
+            }
+
+            // 只检查实际复制的源像素，显示器之间的空洞不参与；找到非零值后不再扫描。
+            // 须在展开之前检查：展开会把 alpha 置为 1，全零的 BGRA8 纹理展开后不再是全零
+            if (!hasContent) {
+                hasContent = std::any_of(s, s + static_cast<size_t>(rw) * srcBpp, [](uint8_t b) { return b != 0; });
+            }
+
+            // 整行复制、展开或打包
+            if (pack) {
+                const uint16_t* half = reinterpret_cast<const uint16_t*>(s);
+                if (widen) {
+                    PixelConvert::WidenBGRA8ToF16(s, widened.data(), rw);
+                    half = widened.data();
+                }
+                PackHalfToRGB9E5N(half, reinterpret_cast<uint32_t*>(dst), rw);
+            } else if (widen) {
+                PixelConvert::WidenBGRA8ToF16(s, reinterpret_cast<uint16_t*>(dst), rw);
+            } else {
+                std::memcpy(dst, s, static_cast<size_t>(rw) * bpp);
+            }
+        }
+        return hasContent;
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
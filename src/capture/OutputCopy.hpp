@@ -0,0 +1,67 @@
+#pragma once
+#include "OutputRotation.hpp"
+#include "../image/ImageBuffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 桌面复制的 CPU 侧部分：格式协商、区域缓冲区格式、以及把映射后的暂存纹理按旋转逐行复制到缓冲区。
+// 与 D3D11 / DXGI 无关，DXGICapture 只负责取帧、复制子矩形和映射
+namespace screenshot_tool {
+
+    // 输出按当前模式选择复制格式：HDR 输出为 FP16 scRGB，SDR 输出为 BGRA8（回读带宽减半）
+    inline PixelFormat NativeCaptureFormat(bool hdrEnabled) {
+        return hdrEnabled ? PixelFormat::RGBA_F16 : PixelFormat::BGRA8;
+    }
+
+    // nativeSupported 为 false 表示 DuplicateOutput1 失败、回退到 DuplicateOutput，得到的总是 BGRA8
+    inline PixelFormat NegotiateCaptureFormat(bool hdrEnabled, bool nativeSupported) {
+        return nativeSupported ? NativeCaptureFormat(hdrEnabled) : PixelFormat::BGRA8;
+    }
+
+    struct CaptureOutput {
+        PixelBox desktop;       // 虚拟桌面坐标
+        PixelFormat format;     // 协商得到的复制格式
+    };
+
+    // 与区域相交的各输出格式一致时直接使用，否则（HDR 与 SDR 混合）整块使用 FP16；不与任何输出相交时为 Unknown
+    PixelFormat RegionCaptureFormat(const PixelBox& region, const std::vector<CaptureOutput>& outputs);
+
+    // compact 时 FP16 在复制每一行时打包为 RGB9E5，不产生 8 字节/像素的中间缓冲
+    inline PixelFormat CaptureBufferFormat(PixelFormat regionFormat, bool compact) {
+        return compact && regionFormat == PixelFormat::RGBA_F16 ? PixelFormat::RGB9E5 : regionFormat;
+    }
+
+    // 按格式分配 w x h 的缓冲区（保留原有容量）；Unknown 时清空
+    void PrepareCaptureBuffer(ImageBuffer& out, PixelFormat format, int width, int height);
+
+    // 复制纹理格式能否写入该缓冲区：相同格式直接复制，BGRA8 可展开为 FP16，FP16 / BGRA8 可打包为 RGB9E5
+    bool OutputCopyCompatible(PixelFormat source, PixelFormat buffer);
+
+    // 一个输出与请求区域的相交部分
+    struct OutputRegion {
+        PixelBox desk;          // 输出内、桌面方向的坐标
+        PixelBox texture;       // 复制纹理内恰好覆盖它的矩形（CopySubresourceRegion 的源矩形）
+        int deskWidth = 0;      // 输出在桌面方向的尺寸
+        int deskHeight = 0;
+        OutputRotation rotation = OutputRotation::Identity;
+        int destX = 0;          // 在区域缓冲区内的位置
+        int destY = 0;
+    };
+
+    // 不相交时返回 false
+    bool IntersectOutput(const PixelBox& region, const PixelBox& outputDesktop, OutputRotation rotation, OutputRegion& out);
+
+    // 映射后的暂存纹理：data 指向 OutputRegion::texture 左上角
+    struct MappedTexture {
+        const uint8_t* data = nullptr;
+        std::ptrdiff_t rowPitch = 0;
+        PixelFormat format = PixelFormat::Unknown;
+    };
+
+    // 按旋转逐行收集为桌面方向，再整行复制、展开（BGRA8 -> FP16）或打包（-> RGB9E5）到 out。
+    // 调用前需确认 OutputCopyCompatible(src.format, out.format)。返回复制的源像素中是否有非零值
+    // （尚未出帧时复制纹理为全零）
+    bool CopyOutputRegion(const MappedTexture& src, const OutputRegion& region, ImageBuffer& out);
+
+} // namespace screenshot_tool
\ No newline at end of file
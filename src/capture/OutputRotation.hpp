@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+
+namespace screenshot_tool {
+
+    // 桌面复制得到的纹理按扫描方向存放，输出旋转时与桌面方向不一致
+    enum class OutputRotation {
+        Identity,
+        Rotate90,
+        Rotate180,
+        Rotate270
+    };
+
+    // 半开矩形 [left, right) x [top, bottom)
+    struct PixelBox {
+        int left = 0;
+        int top = 0;
+        int right = 0;
+        int bottom = 0;
+
+        int Width() const { return right - left; }
+        int Height() const { return bottom - top; }
+    };
+
+    // 输出内桌面方向的矩形 -> 复制纹理中恰好覆盖它的矩形
+    // deskW / deskH 为输出在桌面方向的尺寸（旋转 90/270 时纹理宽高与之互换）
+    inline PixelBox DesktopBoxToTexture(const PixelBox& r, int deskW, int deskH, OutputRotation rot) {
+        switch (rot) {
+        case OutputRotation::Rotate90:  return { r.top, deskW - r.right, r.bottom, deskW - r.left };
+        case OutputRotation::Rotate180: return { deskW - r.right, deskH - r.bottom, deskW - r.left, deskH - r.top };
+        case OutputRotation::Rotate270: return { deskH - r.bottom, r.left, deskH - r.top, r.right };
+        default:                        return r;
+        }
+    }
+
+    // 桌面方向像素 (x, y) -> 纹理像素 (u, v)
+    inline void DesktopPixelToTexture(int x, int y, int deskW, int deskH, OutputRotation rot, int& u, int& v) {
+        switch (rot) {
+        case OutputRotation::Rotate90:  u = y;             v = deskW - x - 1; break;
+        case OutputRotation::Rotate180: u = deskW - x - 1; v = deskH - y - 1; break;
+        case OutputRotation::Rotate270: u = deskH - y - 1; v = x;             break;
+        default:                        u = x;             v = y;             break;
+        }
+    }
+
+    // 桌面方向向右移动一个像素时纹理内的字节偏移；未旋转时等于 bpp（整行连续）
+    inline std::ptrdiff_t DesktopStepInTexture(OutputRotation rot, int bpp, std::ptrdiff_t rowPitch) {
+        switch (rot) {
+        case OutputRotation::Rotate90:  return -rowPitch;
+        case OutputRotation::Rotate180: return -bpp;
+        case OutputRotation::Rotate270: return rowPitch;
+        default:                        return bpp;
+        }
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -1,12 +1,27 @@
-#include "SmartCapture.hpp"
+﻿#include "SmartCapture.hpp"
+#include "../image/Dither.hpp"
+#include "../image/FrameFile.hpp"
+#include "../image/HalfFloat.hpp"
+#include "../util/ParallelFor.hpp"
+#include "../util/Trace.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
 #include <thread>
 
 namespace screenshot_tool {
 
+    SmartCapture::~SmartCapture() {
+        waitPersist();
+    }
+
     // ---- 初始化 ---------------------------------------------------------------
     bool SmartCapture::Initialize()
     {
         Logger::Debug(L"SmartCapture::Initialize()");
+        Logger::Debug(L"FP16 decode: {}", HalfToFloatUsesF16C() ? L"F16C" : L"table");
+        // 蓝噪声表首次使用时生成（几十毫秒），放在启动阶段避免拖慢第一次截图
+        Dither::Row(0);
         // DXGI 初始化失败后自动 fallback
         dxgi_.Initialize();
         return true;
@@ -54,26 +69,30 @@ namespace screenshot_tool {
         ImageBuffer& outRGB8,
         bool& usedGDI)
     {
+        TraceScope trace("SmartCapture::captureRegionInternal");
         usedGDI = false;
 
         // 优先尝试 DXGI
         if (dxgi_.IsInitialized()) {
-            DXGI_FORMAT fmt{};
+            PixelFormat fmt = PixelFormat::Unknown;
             CaptureResult result = dxgi_.CaptureRegion(x, y, w, h, fmt, outRGB8);
             
             if (result == CaptureResult::Success) {
-                // HDR 转 SDR，传递 HDR 状态和配置
-                // 只有在实际获取到HDR格式数据时才进行HDR处理
-                bool isHDR = dxgi_.IsHDREnabled() && 
-                            (fmt == DXGI_FORMAT_R16G16B16A16_FLOAT || 
-                             fmt == DXGI_FORMAT_R10G10B10A2_UNORM);
-                PixelConvert::ToSRGB8(fmt, outRGB8, isHDR, cfg_);
+                // HDR 转 SDR，按区域所在显示器分别选择 HDR/SDR 处理和峰值亮度
+                ToneMapRegions regions = buildToneMapRegions(fmt);
+                regions.Build(x, y, w, h);
+                PixelConvert::ApplyAutoExposure(fmt, outRGB8, regions, cfg_);
+                PixelConvert::ToSRGB8(fmt, outRGB8, regions, cfg_);
                 return true;
             }
             else if (result == CaptureResult::NeedsReinitialization) {
                 Logger::Warn(L"DXGI needs reinitialization, fallback to GDI");
                 dxgi_.Reinitialize(); // 尝试重新初始化，下一次可能恢复
             }
+            else if (result == CaptureResult::NoNewFrame) {
+                Logger::Warn(L"DXGI has no frame for this region, fallback to GDI");
+                dxgi_.Reinitialize(); // 重建复制后第一次取帧会立即返回当前画面
+            }
             else {
                 Logger::Warn(L"DXGI Capture failed, fallback to GDI");
             }
@@ -88,6 +107,31 @@ namespace screenshot_tool {
         return false;
     }
 
+    ToneMapRegions SmartCapture::buildToneMapRegions(PixelFormat fmt) const {
+        ToneMapRegions regions;
+        // 只有在实际获取到HDR格式数据时才进行HDR处理
+        if (!IsHDRCapableFormat(fmt)) {
+            return regions;
+        }
+
+        for (const auto& monitor : dxgi_.GetMonitors()) {
+            const RECT& rc = monitor.desktopRect;
+            regions.AddRegion(rc.left, rc.top, rc.right, rc.bottom, toneMapParamsFor(monitor, fmt));
+        }
+        return regions;
+    }
+
+    ToneMapParams SmartCapture::toneMapParamsFor(const MonitorInfo& monitor, PixelFormat fmt) {
+        ToneMapParams params;
+        if (!IsHDRCapableFormat(fmt)) {
+            return params;
+        }
+        params.hdr = monitor.hdr.hdrEnabled;
+        params.maxNits = monitor.hdr.maxLuminance;
+        params.minNits = monitor.hdr.minLuminance;
+        return params;
+    }
+
     RECT SmartCapture::GetVirtualDesktop() const {
         // 优先使用DXGI计算的虚拟桌面，fallback到GetSystemMetrics
         if (dxgi_.IsInitialized()) {
@@ -103,35 +147,58 @@ namespace screenshot_tool {
         };
     }
 
-    bool SmartCapture::CaptureFullscreenToCache() {
-        RECT vr = GetVirtualDesktop();
-        int w = vr.right - vr.left;
-        int h = vr.bottom - vr.top;
-        
-        cachedFullscreen_ = {};
-        cachedFormat_ = DXGI_FORMAT_UNKNOWN;
-        hasCachedData_ = false;
+    bool SmartCapture::CaptureFullscreenToCache(const RECT& scope) {
+        TraceScope trace("SmartCapture::CaptureFullscreenToCache");
+        resetCache();
+
+        // 选择限制在单个显示器时只冻结该显示器，转换、上传和内存都只与它的大小相关
+        PixelBox cacheBox;
+        if (!CacheScope(ToPixelBox(scope), ToPixelBox(GetVirtualDesktop()), cacheBox)) {
+            Logger::Error(L"Cache scope ({},{})-({},{}) is outside the virtual desktop", scope.left, scope.top, scope.right, scope.bottom);
+            return false;
+        }
+        const RECT vr{ cacheBox.left, cacheBox.top, cacheBox.right, cacheBox.bottom };
+        int w = cacheBox.Width();
+        int h = cacheBox.Height();
         
-        // 优先尝试 DXGI 捕获全屏原始数据
+        // 优先尝试 DXGI：每个显示器单独一块，保持原生格式，显示器之间的空洞不分配；
+        // 开启紧凑缓存时 FP16 块在回读时直接打包为 RGB9E5
         if (dxgi_.IsInitialized()) {
-            CaptureResult result = dxgi_.CaptureRegion(vr.left, vr.top, w, h, cachedFormat_, cachedFullscreen_);
+            const bool compact = cfg_ && cfg_->compactCache;
+            const auto& monitors = dxgi_.GetMonitors();
+            std::vector<PixelBox> monitorBoxes;
+            for (const auto& monitor : monitors) monitorBoxes.push_back(ToPixelBox(monitor.desktopRect));
+            CaptureResult result = CaptureResult::Success;
+            for (const CacheTile& tile : CacheTiles(cacheBox, monitorBoxes)) {
+                ImageBuffer image;
+                PixelFormat fmt = PixelFormat::Unknown;
+                result = dxgi_.CaptureRegion(tile.box.left, tile.box.top, tile.box.Width(), tile.box.Height(), fmt, image, compact);
+                if (result != CaptureResult::Success) break;
+                cache_.AddTile(tile.box.left, tile.box.top, std::move(image), toneMapParamsFor(monitors[tile.monitor], fmt));
+            }
             
-            if (result == CaptureResult::Success) {
+            if (result == CaptureResult::Success && !cache_.Empty()) {
+                cache_.ApplyAutoExposure(cfg_);
+                cachedRect_ = vr;
                 hasCachedData_ = true;
-                Logger::Info(L"Cached fullscreen data via DXGI: {}x{}, format: {}", w, h, static_cast<int>(cachedFormat_));
+                Logger::Info(L"Cached fullscreen data via DXGI: {}x{} at ({}, {}), {} tiles, {} KB",
+                    w, h, vr.left, vr.top, cache_.Tiles().size(), cache_.MemoryBytes() / 1024);
                 return true;
             }
-            else if (result == CaptureResult::NeedsReinitialization) {
+            cache_.Clear();
+            if (result == CaptureResult::NeedsReinitialization || result == CaptureResult::NoNewFrame) {
                 Logger::Warn(L"DXGI needs reinitialization for cache");
                 dxgi_.Reinitialize();
             }
         }
         
-        // GDI fallback - 直接获取 RGB8 格式
-        if (gdi_.CaptureRegion(vr.left, vr.top, w, h, cachedFullscreen_)) {
-            cachedFormat_ = DXGI_FORMAT_B8G8R8A8_UNORM; // GDI 输出的是 RGB8
+        // GDI fallback - 直接获取 RGB8 格式，整个范围一块
+        ImageBuffer image;
+        if (gdi_.CaptureRegion(vr.left, vr.top, w, h, image)) {
+            cache_.AddTile(vr.left, vr.top, std::move(image), ToneMapParams{});
+            cachedRect_ = vr;
             hasCachedData_ = true;
-            Logger::Info(L"Cached fullscreen data via GDI: {}x{}", w, h);
+            Logger::Info(L"Cached fullscreen data via GDI: {}x{} at ({}, {})", w, h, vr.left, vr.top);
             return true;
         }
         
@@ -140,56 +207,18 @@ namespace screenshot_tool {
     }
 
     SmartCapture::Result SmartCapture::ExtractRegionFromCache(HWND hwnd, const RECT& r, const wchar_t* savePath) {
+        TraceScope trace("SmartCapture::ExtractRegionFromCache");
         if (!hasCachedData_) {
             Logger::Error(L"No cached data available for region extraction");
             return Result::Failed;
         }
         
-        RECT vr = GetVirtualDesktop();
-        int cacheWidth = vr.right - vr.left;
-        int cacheHeight = vr.bottom - vr.top;
-        
-        // 计算区域在缓存中的位置
-        int regionX = r.left - vr.left;
-        int regionY = r.top - vr.top;
-        int regionW = r.right - r.left;
-        int regionH = r.bottom - r.top;
-        
-        // 边界检查
-        if (regionX < 0 || regionY < 0 || 
-            regionX + regionW > cacheWidth || regionY + regionH > cacheHeight) {
-            Logger::Error(L"Region out of cached bounds");
-            return Result::Failed;
-        }
-        
-        // 从缓存中提取区域数据
         ImageBuffer regionBuffer;
-        regionBuffer.format = cachedFullscreen_.format;
-        regionBuffer.width = regionW;
-        regionBuffer.height = regionH;
-        
-        int pixelSize = (cachedFullscreen_.format == PixelFormat::RGBA_F16) ? 8 : 
-                       (cachedFullscreen_.format == PixelFormat::RGBA10A2) ? 4 : 
-                       (cachedFullscreen_.format == PixelFormat::BGRA8) ? 4 : 3;
-        
-        regionBuffer.stride = regionW * pixelSize;
-        regionBuffer.data.resize(regionBuffer.stride * regionH);
-        
-        // 逐行复制区域数据
-        for (int y = 0; y < regionH; ++y) {
-            const uint8_t* srcRow = cachedFullscreen_.data.data() + 
-                                   (regionY + y) * cachedFullscreen_.stride + 
-                                   regionX * pixelSize;
-            uint8_t* dstRow = regionBuffer.data.data() + y * regionBuffer.stride;
-            memcpy(dstRow, srcRow, regionBuffer.stride);
+        if (!extractRegion(r, regionBuffer)) {
+            return Result::Failed;
         }
-        
-        // 处理 HDR 转换
-        // 注意：如果使用GDI fallback捕获的数据，即使显示器支持HDR，数据也是SDR的
-        bool isHDR = dxgi_.IsHDREnabled() && 
-                    (cachedFormat_ == DXGI_FORMAT_R16G16B16A16_FLOAT || 
-                     cachedFormat_ == DXGI_FORMAT_R10G10B10A2_UNORM);
-        PixelConvert::ToSRGB8(cachedFormat_, regionBuffer, isHDR, cfg_);
+        const int regionW = regionBuffer.width;
+        const int regionH = regionBuffer.height;
         
         // 写入剪贴板
         bool clipboardSuccess = ClipboardWriter::WriteRGB(hwnd, regionBuffer.data.data(), regionW, regionH);
@@ -209,43 +238,360 @@ namespace screenshot_tool {
         return (clipboardSuccess && fileSuccess) ? Result::OK : Result::Failed;
     }
     
-    bool SmartCapture::GetCachedImageAsRGB8(ImageBuffer& outRGB8) const {
-        if (!hasCachedData_) {
-            Logger::Error(L"No cached data available");
-            return false;
+    SmartCapture::Result SmartCapture::ExtractRegionsFromCache(HWND hwnd, const std::vector<RECT>& regions,
+        const std::vector<std::wstring>& savePaths)
+    {
+        TraceScope trace("SmartCapture::ExtractRegionsFromCache");
+        if (!hasCachedData_ || regions.empty()) {
+            Logger::Error(L"No cached data available for region extraction");
+            return Result::Failed;
         }
         
-        // 如果已经是RGB8格式，直接复制
-        if (cachedFullscreen_.format == PixelFormat::RGB8) {
-            outRGB8 = cachedFullscreen_;
-            return true;
+        // 整帧只转换一次（overlay 背景通常已经转换过），各区域随后都是直接裁剪
+        GetCachedImageAsRGB8();
+        
+        const int count = static_cast<int>(regions.size());
+        std::vector<ImageBuffer> crops(count);
+        std::vector<char> ok(count, 0);
+        for (int i = 0; i < count; ++i) {
+            ok[i] = extractRegion(regions[i], crops[i]);
+        }
+        
+        // PNG 编码互不依赖，分配到工作线程并行完成；每个区域一个任务
+        ParallelFor(count, 1, [&](int begin, int end, int) {
+            for (int i = begin; i < end; ++i) {
+                if (!ok[i] || i >= static_cast<int>(savePaths.size()) || savePaths[i].empty()) continue;
+                if (!ImageSaverPNG::SaveRGBToPNG(crops[i].data.data(), crops[i].width, crops[i].height, savePaths[i].c_str())) {
+                    Logger::Warn(L"ImageSaverPNG failed: {}", savePaths[i]);
+                    ok[i] = 0;
+                }
+            }
+        });
+        
+        // 剪贴板只能容纳一张图：放最后一个成功的区域
+        bool clipboardSuccess = false;
+        for (int i = count - 1; i >= 0; --i) {
+            if (!crops[i].data.empty()) {
+                clipboardSuccess = ClipboardWriter::WriteRGB(hwnd, crops[i].data.data(), crops[i].width, crops[i].height);
+                if (!clipboardSuccess) {
+                    Logger::Warn(L"ClipboardWriter failed");
+                }
+                break;
+            }
+        }
+        
+        const int exported = static_cast<int>(std::count(ok.begin(), ok.end(), 1));
+        Logger::Info(L"Exported {}/{} regions from the cached frame", exported, count);
+        return (clipboardSuccess && exported == count) ? Result::OK : Result::Failed;
+    }
+    
+    BurstStats SmartCapture::CaptureBurst(const RECT& scope, const BurstOptions& options,
+        const std::vector<std::wstring>& savePaths)
+    {
+        TraceScope trace("SmartCapture::CaptureBurst");
+        PixelBox burstBox;
+        if (!CacheScope(ToPixelBox(scope), ToPixelBox(GetVirtualDesktop()), burstBox)) {
+            Logger::Error(L"Burst scope ({},{})-({},{}) is outside the virtual desktop", scope.left, scope.top, scope.right, scope.bottom);
+            BurstStats stats;
+            stats.requested = options.frameCount;
+            return stats;
+        }
+        const RECT vr{ burstBox.left, burstBox.top, burstBox.right, burstBox.bottom };
+        const int w = burstBox.Width();
+        const int h = burstBox.Height();
+        const bool compact = cfg_ && cfg_->compactCache;
+        
+        // 画面静止时 DXGI 不出新帧：最多等半个间隔，超时就重新读取该输出暂存纹理中上一次复制的内容，
+        // 一个显示器静止不会让整帧改用 GDI。只有复制接口失效时余下的帧才改用 GDI
+        const UINT acquireTimeout = static_cast<UINT>(std::clamp(options.intervalMs / 2, 0, 100));
+        int gdiFrames = 0;
+        
+        std::vector<CacheTile> tiles;
+        auto layoutTiles = [&] {
+            std::vector<PixelBox> monitorBoxes;
+            for (const auto& monitor : dxgi_.GetMonitors()) monitorBoxes.push_back(ToPixelBox(monitor.desktopRect));
+            tiles = CacheTiles(burstBox, monitorBoxes);
+        };
+        
+        // 开始计时前每块先抓一次，让各输出的暂存纹理保留连拍区域的内容，之后超时都有内容可复用。
+        // 上一帧已被取走而画面静止（NoNewFrame）时重建复制，第一次取帧会立即返回当前画面
+        auto prime = [&] {
+            ImageBuffer scratch;
+            for (const CacheTile& tile : tiles) {
+                PixelFormat fmt = PixelFormat::Unknown;
+                const CaptureResult result = dxgi_.CaptureRegion(tile.box.left, tile.box.top, tile.box.Width(), tile.box.Height(),
+                    fmt, scratch, compact);
+                if (result != CaptureResult::Success) return result;
+            }
+            return CaptureResult::Success;
+        };
+        bool dxgiLost = !dxgi_.IsInitialized();
+        if (!dxgiLost) {
+            layoutTiles();
+            CaptureResult result = prime();
+            if (result != CaptureResult::Success) {
+                dxgi_.Reinitialize();
+                layoutTiles();
+                result = dxgi_.IsInitialized() ? prime() : CaptureResult::NeedsReinitialization;
+            }
+            if (result != CaptureResult::Success) {
+                Logger::Warn(L"Burst: DXGI capture unavailable (result {}), using GDI", static_cast<int>(result));
+                dxgiLost = true;
+            }
         }
         
-        // 需要格式转换
-        outRGB8.format = PixelFormat::RGB8;
-        outRGB8.width = cachedFullscreen_.width;
-        outRGB8.height = cachedFullscreen_.height;
-        outRGB8.stride = outRGB8.width * 3; // RGB8格式每像素3字节
-        outRGB8.data.resize(outRGB8.stride * outRGB8.height);
+        // 每个显示器块按原生格式（紧凑缓存时 FP16 为 RGB9E5）的大小预留
+        auto tileBytes = [&](const CacheTile& tile) {
+            const PixelFormat fmt = CaptureBufferFormat(dxgi_.GetMonitors()[tile.monitor].format, compact);
+            return static_cast<size_t>(tile.box.Width()) * tile.box.Height() * BytesPerPixel(fmt);
+        };
+        
+        auto prepare = [&](BurstFrame& slot) {
+            if (dxgiLost) {
+                ImageBuffer image;
+                image.data.reserve(static_cast<size_t>(w) * h * 3);
+                slot.spare.push_back(std::move(image));
+                return;
+            }
+            for (const CacheTile& tile : tiles) {
+                ImageBuffer image;
+                image.data.reserve(tileBytes(tile));
+                slot.spare.push_back(std::move(image));
+            }
+        };
+        
+        auto capture = [&](BurstFrame& frame) {
+            if (!dxgiLost) {
+                CaptureResult result = CaptureResult::Success;
+                for (const CacheTile& tile : tiles) {
+                    ImageBuffer image = frame.TakeSpare(tileBytes(tile));
+                    PixelFormat fmt = PixelFormat::Unknown;
+                    result = dxgi_.CaptureRegion(tile.box.left, tile.box.top, tile.box.Width(), tile.box.Height(),
+                        fmt, image, compact, acquireTimeout);
+                    if (result != CaptureResult::Success) {
+                        frame.spare.push_back(std::move(image));
+                        break;
+                    }
+                    frame.image.AddTile(tile.box.left, tile.box.top, std::move(image), toneMapParamsFor(dxgi_.GetMonitors()[tile.monitor], fmt));
+                }
+                if (result == CaptureResult::Success && !frame.image.Empty()) return true;
+                frame.image.Recycle(frame.spare);
+                // 复制接口仍然有效时只丢这一帧；失效后连拍期间不重建（会打乱节奏），余下的帧都用 GDI
+                if (result != CaptureResult::NeedsReinitialization) return false;
+                Logger::Warn(L"Burst: DXGI duplication lost at frame {}, continuing with GDI", frame.index);
+                dxgiLost = true;
+            }
+            
+            ImageBuffer image = frame.TakeSpare(static_cast<size_t>(w) * h * 3);
+            if (!gdi_.CaptureRegion(vr.left, vr.top, w, h, image)) {
+                frame.spare.push_back(std::move(image));
+                return false;
+            }
+            frame.image.AddTile(vr.left, vr.top, std::move(image), ToneMapParams{});
+            ++gdiFrames;
+            return true;
+        };
         
-        // 复制原始数据到临时缓冲区进行转换
-        ImageBuffer tempBuffer = cachedFullscreen_;
+        // 编码线程：自动曝光、色调映射和 PNG 编码都在这里完成，抓取线程只做回读
+        auto encode = [&](BurstFrame& frame) {
+            frame.image.ApplyAutoExposure(cfg_);
+            ImageBuffer rgb8;
+            if (!frame.image.ToSRGB8(vr.left, vr.top, w, h, rgb8, cfg_)) return false;
+            if (frame.index >= static_cast<int>(savePaths.size()) || savePaths[frame.index].empty()) return true;
+            if (!ImageSaverPNG::SaveRGBToPNG(rgb8.data.data(), w, h, savePaths[frame.index].c_str())) {
+                Logger::Warn(L"ImageSaverPNG failed: {}", savePaths[frame.index]);
+                return false;
+            }
+            return true;
+        };
         
-        // 使用PixelConvert进行格式转换
-        // 注意：只有在实际获取到HDR格式数据时才进行HDR处理
-        bool isHDR = dxgi_.IsHDREnabled() && 
-                    (cachedFormat_ == DXGI_FORMAT_R16G16B16A16_FLOAT || 
-                     cachedFormat_ == DXGI_FORMAT_R10G10B10A2_UNORM);
+        BurstStats stats = BurstCapture::Run(options, prepare, capture, encode);
+        if (gdiFrames > 0) {
+            Logger::Info(L"Burst: {} frames captured via GDI", gdiFrames);
+        }
+        return stats;
+    }
+    
+    bool SmartCapture::extractRegion(const RECT& r, ImageBuffer& regionBuffer) {
+        int regionW = r.right - r.left;
+        int regionH = r.bottom - r.top;
         
-        // 转换为sRGB8格式
-        PixelConvert::ToSRGB8(cachedFormat_, tempBuffer, isHDR, cfg_);
+        // 边界检查
+        if (!RegionInCache(ToPixelBox(r), ToPixelBox(cachedRect_))) {
+            Logger::Error(L"Region out of cached bounds");
+            return false;
+        }
+        
+        if (convertedValid()) {
+            // overlay 背景已按相同设置转换过整帧：直接裁剪，不再重复色调映射
+            const ImageBuffer& frame = converted_.rgb8;
+            regionBuffer.format = PixelFormat::RGB8;
+            regionBuffer.width = regionW;
+            regionBuffer.height = regionH;
+            regionBuffer.stride = regionW * 3;
+            regionBuffer.data.resize(static_cast<size_t>(regionBuffer.stride) * regionH);
+            for (int y = 0; y < regionH; ++y) {
+                const uint8_t* src = frame.data.data() + static_cast<size_t>(r.top - cachedRect_.top + y) * frame.stride +
+                    static_cast<size_t>(r.left - cachedRect_.left) * 3;
+                memcpy(regionBuffer.data.data() + static_cast<size_t>(y) * regionBuffer.stride, src, regionBuffer.stride);
+            }
+            Logger::Debug(L"Cropped {}x{} region from the converted frame", regionW, regionH);
+        } else {
+            // 由覆盖区域的各块按自身格式和冻结时的参数转换后拼接
+            // 注意：如果使用GDI fallback捕获的数据，即使显示器支持HDR，数据也是SDR的
+            if (!ensureCacheResident()) {
+                Logger::Error(L"No cached data available for region extraction");
+                return false;
+            }
+            if (!cache_.ToSRGB8(r.left, r.top, regionW, regionH, regionBuffer, cfg_)) {
+                Logger::Error(L"Region is not covered by any cached monitor");
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    const ImageBuffer* SmartCapture::GetCachedImageAsRGB8() {
+        TraceScope trace("SmartCapture::GetCachedImageAsRGB8");
+        if (!hasCachedData_) {
+            Logger::Error(L"No cached data available");
+            return nullptr;
+        }
+        if (convertedValid()) {
+            Logger::Debug(L"Reusing converted frame: {}x{}", converted_.rgb8.width, converted_.rgb8.height);
+            return &converted_.rgb8;
+        }
+        waitPersist();
+        if (!ensureCacheResident()) return nullptr;
         
-        // 将转换后的数据复制到输出缓冲区
-        outRGB8 = tempBuffer;
-        outRGB8.format = PixelFormat::RGB8;
+        // 各显示器分别转换（使用各自的色调映射参数），空洞保持黑色
+        ImageBuffer rgb8;
+        if (!cache_.ToSRGB8(cachedRect_.left, cachedRect_.top, cachedRect_.right - cachedRect_.left,
+            cachedRect_.bottom - cachedRect_.top, rgb8, cfg_)) {
+            return nullptr;
+        }
+        converted_.frameId = frameId_;
+        converted_.settings = PixelConvert::SettingsHash(cfg_);
+        converted_.rgb8 = std::move(rgb8);
         
-        Logger::Debug(L"Converted cached image to RGB8 format: {}x{}", outRGB8.width, outRGB8.height);
+        Logger::Debug(L"Converted cached image to RGB8 format: {}x{}", converted_.rgb8.width, converted_.rgb8.height);
+        return &converted_.rgb8;
+    }
+
+    void SmartCapture::TrimIdle(bool compress) {
+        TraceScope trace("SmartCapture::TrimIdle");
+        waitPersist();
+        dxgi_.ReleaseStaging();
+        converted_ = ConvertedFrame{};
+        if (!hasCachedData_) return;
+
+        if (compress) {
+            const size_t before = cache_.MemoryBytes();
+            cache_.Compress();
+            Logger::Info(L"Compressed idle freeze-frame cache: {} KB -> {} KB", before / 1024, cache_.MemoryBytes() / 1024);
+        } else {
+            resetCache();
+            Logger::Info(L"Released idle freeze-frame cache");
+        }
+    }
+
+    bool SmartCapture::PersistCache(const std::filesystem::path& path) {
+        TraceScope trace("SmartCapture::PersistCache");
+        if (!hasCachedData_) return false;
+        if (cachePersisted_) return true;
+        waitPersist();
+        if (!ensureCacheResident()) return false;
+
+        // 整帧写入要 100 ms 以上，放到后台线程，UI 线程只取快照参数。
+        // 线程直接读取缓存与预览：在下一次 waitPersist 之前二者都不会改动
+        const ImageBuffer* preview = convertedValid() ? &converted_.rgb8 : nullptr;
+        const uint64_t settings = converted_.settings;
+        const RECT rect = cachedRect_;
+        const int64_t captureTime = static_cast<int64_t>(std::time(nullptr));
+        cachePersisted_ = true;
+        persistThread_ = std::thread([this, path, preview, settings, rect, captureTime] {
+            TraceScope trace("SmartCapture::PersistCache/write");
+            FrameFile file;
+            if (!file.Save(path, cache_, rect.left, rect.top, rect.right, rect.bottom, captureTime, preview, settings)) {
+                Logger::Warn(L"Failed to persist last frame to {}", path.wstring());
+                return;
+            }
+            Logger::Info(L"Persisted last frame to {}: {} KB{}", path.wstring(), cache_.MemoryBytes() / 1024,
+                preview ? L" + preview" : L"");
+        });
+        return true;
+    }
+
+    void SmartCapture::waitPersist() {
+        if (!persistThread_.joinable()) return;
+        TraceScope trace("SmartCapture::waitPersist");
+        persistThread_.join();
+    }
+
+    bool SmartCapture::RestoreCache(const std::filesystem::path& path) {
+        TraceScope trace("SmartCapture::RestoreCache");
+        resetCache();
+
+        FrameFile file;
+        if (!file.Open(path) || !file.LoadTiles(cache_)) {
+            Logger::Warn(L"No usable last frame at {}", path.wstring());
+            cache_.Clear();
+            return false;
+        }
+
+        cachedRect_ = RECT{ file.Left(), file.Top(), file.Right(), file.Bottom() };
+        hasCachedData_ = true;
+        cachePersisted_ = true;
+
+        // 预览由相同的转换设置生成时直接作为本帧的转换结果，overlay 背景和最终裁剪都不再转换
+        const uint64_t settings = PixelConvert::SettingsHash(cfg_);
+        const bool previewReused = file.HasPreview() && file.PreviewSettings() == settings;
+        if (previewReused) {
+            ImageBuffer& rgb8 = converted_.rgb8;
+            rgb8.format = PixelFormat::RGB8;
+            rgb8.width = file.PreviewWidth();
+            rgb8.height = file.PreviewHeight();
+            rgb8.stride = rgb8.width * 3;
+            rgb8.data.resize(static_cast<size_t>(rgb8.stride) * rgb8.height);
+            for (int y = 0; y < rgb8.height; ++y) {
+                memcpy(rgb8.data.data() + static_cast<size_t>(y) * rgb8.stride,
+                    file.PreviewPixels() + static_cast<size_t>(y) * file.PreviewStride(), rgb8.stride);
+            }
+            converted_.frameId = frameId_;
+            converted_.settings = settings;
+        }
+
+        Logger::Info(L"Restored last frame: {}x{} at ({}, {}), {} tiles, {}",
+            cachedRect_.right - cachedRect_.left, cachedRect_.bottom - cachedRect_.top, cachedRect_.left, cachedRect_.top,
+            cache_.Tiles().size(), previewReused ? L"preview reused" : L"preview needs conversion");
         return true;
     }
 
+    bool SmartCapture::ensureCacheResident() {
+        if (!cache_.Compressed()) return true;
+        if (cache_.Decompress()) {
+            Logger::Debug(L"Restored compressed freeze-frame cache: {} KB", cache_.MemoryBytes() / 1024);
+            return true;
+        }
+
+        Logger::Error(L"Compressed freeze-frame cache is corrupt, discarding it");
+        resetCache();
+        return false;
+    }
+
+    void SmartCapture::resetCache() {
+        waitPersist();
+        cache_.Clear();
+        cachedRect_ = {};
+        hasCachedData_ = false;
+        cachePersisted_ = false;
+        converted_ = ConvertedFrame{};
+        ++frameId_;
+    }
+
+    bool SmartCapture::convertedValid() const {
+        return hasCachedData_ && converted_.frameId == frameId_ && !converted_.rgb8.data.empty() &&
+               converted_.settings == PixelConvert::SettingsHash(cfg_);
+    }
+
 } // namespace screenshot_tool
@@ -1,13 +1,20 @@
 ﻿#pragma once
 
+#include "BurstCapture.hpp"
+#include "CaptureScope.hpp"
 #include "DXGICapture.hpp"
 #include "GDICapture.hpp"
 #include "../config/Config.hpp"
 #include "../image/PixelConvert.hpp"
+#include "../image/TiledImage.hpp"
 #include "../image/ClipboardWriter.hpp"
 #include "../image/ImageSaverPNG.hpp"
 #include "../util/PathUtils.hpp"
 #include "../util/Logger.hpp"
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace screenshot_tool {
 
@@ -20,6 +27,7 @@ namespace screenshot_tool {
         };
 
         explicit SmartCapture(Config* cfg) : cfg_(cfg), dxgi_(), gdi_() {}
+        ~SmartCapture();
 
         // ---- 初始化 -------------------------------------------------------------
         bool Initialize();            // 必须在捕获前调用一次（App 启动时）
@@ -29,32 +37,88 @@ namespace screenshot_tool {
         Result CaptureFullscreen(HWND hwnd, const RECT& virtualRect, const wchar_t* savePath);
         
         // ---- 冻结帧区域截图 -----------------------------------------------------
-        bool CaptureFullscreenToCache();  // 捕获全屏到缓存
+        // 捕获到缓存：只覆盖选择可能到达的范围（与虚拟桌面求交），overlay 背景与缓存范围一致
+        bool CaptureFullscreenToCache(const RECT& scope);
         Result ExtractRegionFromCache(HWND hwnd, const RECT& r, const wchar_t* savePath);  // 从缓存提取区域
+        // 一次提取多个区域：整帧只转换一次，PNG 并行编码；savePaths 与 regions 一一对应（空路径不保存），
+        // 剪贴板放最后一个区域。全部成功才返回 OK
+        Result ExtractRegionsFromCache(HWND hwnd, const std::vector<RECT>& regions, const std::vector<std::wstring>& savePaths);
+        
+        // ---- 连拍 ---------------------------------------------------------------
+        // 按固定间隔把 scope 范围的原始帧抓到预分配的环形缓冲，后台线程转换后保存为 savePaths[i]（空路径只转换不保存）。
+        // 阻塞到全部编码完成，不影响冻结帧缓存；期间其他线程不得使用本对象
+        BurstStats CaptureBurst(const RECT& scope, const BurstOptions& options, const std::vector<std::wstring>& savePaths);
         
         // ---- 工具方法 -----------------------------------------------------------
         RECT GetVirtualDesktop() const;
         
         // ---- 访问缓存数据 -------------------------------------------------------
-        const ImageBuffer* GetCachedImage() const { return hasCachedData_ ? &cachedFullscreen_ : nullptr; }
+        const TiledImage* GetCachedImage() const { return hasCachedData_ ? &cache_ : nullptr; }  // 空闲后可能处于压缩状态
         bool HasCachedData() const { return hasCachedData_; }
+        RECT GetCachedRect() const { return cachedRect_; }   // 缓存在虚拟桌面中的位置
         
-        // 获取缓存图像的RGB8版本（用于overlay背景显示）
-        bool GetCachedImageAsRGB8(ImageBuffer& outRGB8) const;
+        // 获取缓存图像的RGB8版本（用于overlay背景显示）。
+        // 结果按帧与转换设置缓存，同一帧的最终裁剪直接从中复制像素；返回的指针在缓存变化前有效
+        const ImageBuffer* GetCachedImageAsRGB8();
+
+        // ---- 空闲回收 -----------------------------------------------------------
+        // 截图之间空闲时回收：compress 为 true 时压缩保留冻结帧（再次使用时自动解压），否则直接释放；
+        // 两种方式都会释放 DXGI 暂存纹理
+        void TrimIdle(bool compress);
+        size_t CacheResidentBytes() const { return cache_.MemoryBytes(); }
+        size_t CacheRawBytes() const { return cache_.RawBytes(); }
+        size_t StagingBytes() const { return dxgi_.StagingBytes(); }
+        size_t StagingAllocations() const { return dxgi_.StagingAllocations(); }   // 累计分配次数，重复截图同一区域时不应增加
+        size_t ConvertedBytes() const { return converted_.rgb8.data.size(); }
+
+        // ---- 上次冻结帧（重新裁剪） ---------------------------------------------
+        // 在后台线程把当前冻结帧连同已转换的整帧预览写入内存映射文件，立即返回是否已开始写入；
+        // 缓存本身就来自该文件时不重复写入。写入期间缓存保持不变，下一次改动缓存前等待写入结束
+        bool PersistCache(const std::filesystem::path& path);
+        // 从文件恢复冻结帧到缓存，不抓屏；文件里的预览与当前转换设置一致时直接作为转换结果
+        bool RestoreCache(const std::filesystem::path& path);
 
     private:
         // 区域抓屏到 ImageBuffer (8-bit RGB)
         bool captureRegionInternal(int x, int y, int w, int h, ImageBuffer& outRGB8,
             bool& usedGDI);
+        // 按当前各显示器的 HDR 状态生成区域 -> 色调映射参数表（尚未 Build）
+        ToneMapRegions buildToneMapRegions(PixelFormat fmt) const;
+        // 单个显示器的色调映射参数；只有实际取得 HDR 格式数据时才按 HDR 处理
+        static ToneMapParams toneMapParamsFor(const MonitorInfo& monitor, PixelFormat fmt);
+        // 从冻结帧取出一个区域的 sRGB8 像素：有整帧转换结果时直接裁剪，否则按块转换
+        bool extractRegion(const RECT& r, ImageBuffer& out);
+        // 缓存被空闲压缩过时先解压；数据损坏则丢弃缓存并返回 false
+        bool ensureCacheResident();
+        // 冻结帧内容变化（重新抓取 / 从文件恢复 / 丢弃）：换新的帧代号并作废转换结果
+        void resetCache();
+        // 转换结果是否对应当前帧和当前转换设置
+        bool convertedValid() const;
+        // 等待后台写入上次冻结帧结束；改动 cache_ 或 converted_ 前调用
+        void waitPersist();
 
         Config* cfg_ = nullptr;
         DXGICapture  dxgi_;
         GDICapture   gdi_;
         
-        // 冻结帧缓存
-        ImageBuffer cachedFullscreen_;
-        DXGI_FORMAT cachedFormat_ = DXGI_FORMAT_UNKNOWN;
+        // 冻结帧缓存：每个显示器一块，保留各自的原生格式与色调映射参数（冻结时估计一次自动曝光）
+        TiledImage cache_;
+        RECT cachedRect_{};
         bool hasCachedData_ = false;
+
+        uint64_t frameId_ = 0;          // 帧代号，每次 resetCache 递增
+        bool cachePersisted_ = false;   // 当前帧已与上次冻结帧文件内容一致
+
+        // 整帧 sRGB8 转换结果，以帧代号 + 转换设置哈希为键
+        struct ConvertedFrame {
+            uint64_t frameId = 0;
+            uint64_t settings = 0;
+            ImageBuffer rgb8;
+        };
+        ConvertedFrame converted_;
+
+        // 后台写入上次冻结帧，只读 cache_ 与 converted_.rgb8；只在 UI 线程启动和等待
+        std::thread persistThread_;
     };
 
 } // namespace screenshot_tool
\ No newline at end of file
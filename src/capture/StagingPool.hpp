@@ -0,0 +1,97 @@
+#pragma once
+#include "OutputRotation.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 回读暂存纹理池：每个输出一张暂存纹理，只按需要的子矩形大小分配，并保留最近一次复制的内容。
+// 按（适配器 LUID, 输出设备名）索引，与每次截图前重新枚举的输出列表分开保存：
+// 同一输出下次截图直接复用已分配的纹理，只有重新初始化设备或空闲回收时才释放。
+// 纹理类型为模板参数，与 D3D11 无关，以便用假纹理测试
+namespace screenshot_tool {
+
+    struct StagingKey {
+        uint64_t adapter = 0;       // 适配器 LUID
+        std::wstring output;        // 输出设备名（\\.\DISPLAY1 等）
+
+        bool operator==(const StagingKey& o) const { return adapter == o.adapter && output == o.output; }
+    };
+
+    template<class Texture>
+    class StagingPool {
+    public:
+        struct Slot {
+            StagingKey key;
+            Texture texture{};
+            uint32_t format = 0;    // 纹理格式（DXGI_FORMAT）
+            int width = 0;
+            int height = 0;
+            size_t bytes = 0;
+            PixelBox box{};         // texture 左上角对应的复制纹理子矩形
+            bool valid = false;     // box 中是该输出当前复制接口最近一帧的内容
+
+            // 保留的内容覆盖复制纹理中的子矩形 r 时可以直接重新读取
+            bool Holds(const PixelBox& r) const {
+                return texture && valid && r.left >= box.left && r.top >= box.top && r.right <= box.right && r.bottom <= box.bottom;
+            }
+        };
+
+        // 不存在时建立空槽（不分配纹理）
+        Slot& At(const StagingKey& key) {
+            for (auto& s : slots_) {
+                if (s->key == key) return *s;
+            }
+            slots_.push_back(std::make_unique<Slot>());
+            slots_.back()->key = key;
+            return *slots_.back();
+        }
+
+        // 已有纹理格式相同且足够大时直接复用，否则调用 create(format, width, height) 重新分配，
+        // 保留的内容随之作废。create 返回空纹理表示失败，此时返回 nullptr
+        template<class Create>
+        Slot* Acquire(const StagingKey& key, uint32_t format, int width, int height, int bytesPerPixel, Create&& create) {
+            Slot& s = At(key);
+            if (s.texture && s.format == format && s.width >= width && s.height >= height) return &s;
+
+            s.texture = Texture{};
+            s.valid = false;
+            s.bytes = 0;
+            s.texture = create(format, width, height);
+            if (!s.texture) return nullptr;
+            s.format = format;
+            s.width = width;
+            s.height = height;
+            s.bytes = static_cast<size_t>(width) * height * bytesPerPixel;
+            ++allocations_;
+            return &s;
+        }
+
+        // 空闲回收：释放纹理但保留各输出的槽位
+        void Release() {
+            for (auto& s : slots_) {
+                s->texture = Texture{};
+                s->valid = false;
+                s->bytes = 0;
+            }
+        }
+
+        // 设备重建：纹理属于旧设备，连同槽位一起丢弃
+        void Clear() { slots_.clear(); }
+
+        size_t Bytes() const {
+            size_t total = 0;
+            for (const auto& s : slots_) total += s->texture ? s->bytes : 0;
+            return total;
+        }
+
+        // 累计分配次数（用于确认重复截图不会重新分配）
+        size_t Allocations() const { return allocations_; }
+
+    private:
+        std::vector<std::unique_ptr<Slot>> slots_;      // 槽位地址在重新枚举输出之间保持不变
+        size_t allocations_ = 0;
+    };
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -29,11 +29,31 @@ namespace screenshot_tool {
             else if (key == "AutoCreateSaveDir") cfg.autoCreateSaveDir = (val == "true" || val == "1");
             else if (key == "AutoStart") cfg.autoStart = (val == "true" || val == "1");
             else if (key == "DebugMode") cfg.debugMode = (val == "true" || val == "1");
-            else if (key == "UseACESFilmToneMapping") cfg.useACESFilmToneMapping = (val == "true" || val == "1");
+            else if (key == "TraceFile") cfg.traceFile = val;
+            else if (key == "ToneMapper") cfg.toneMapper = val;
+            else if (key == "UseACESFilmToneMapping") { if (val == "true" || val == "1") cfg.toneMapper = "aces"; } // ɰ
+            else if (key == "GamutMapping") cfg.gamutMapping = val;
             else if (key == "SDRBrightness") cfg.sdrBrightness = std::clamp(std::stof(val), 80.0f, 1000.0f);
+            else if (key == "AutoExposure") cfg.autoExposure = (val == "true" || val == "1");
+            else if (key == "AutoExposureKeyPercentile") cfg.autoExposureKeyPercentile = std::clamp(std::stof(val), 0.0f, 100.0f);
+            else if (key == "ColorLUTSize") { int n = std::stoi(val); cfg.colorLutSize = n <= 0 ? 0 : std::clamp(n, 17, 65); }
+            else if (key == "ColorLookFile") cfg.colorLookFile = val;
+            else if (key == "ColorLUTExportFile") cfg.colorLutExportFile = val;
+            else if (key == "Dither") cfg.dither = (val == "true" || val == "1");
+            else if (key == "AutoExposureWhitePercentile") cfg.autoExposureWhitePercentile = std::clamp(std::stof(val), 0.0f, 100.0f);
             else if (key == "FullscreenCurrentMonitor") cfg.fullscreenCurrentMonitor = (val == "true" || val == "1");
             else if (key == "RegionFullscreenMonitor") cfg.regionFullscreenMonitor = (val == "true" || val == "1");
+            else if (key == "SelectionSnap") cfg.selectionSnap = (val == "true" || val == "1");
+            else if (key == "MultiSelect") cfg.multiSelect = (val == "true" || val == "1");
             else if (key == "CaptureRetryCount") cfg.captureRetryCount = std::clamp(std::stoi(val), 1, 10);
+            else if (key == "CompactCache") cfg.compactCache = (val == "true" || val == "1");
+            else if (key == "IdleTrimSeconds") cfg.idleTrimSeconds = std::clamp(std::stoi(val), 0, 86400);
+            else if (key == "IdleTrimMode") cfg.idleTrimMode = val;
+            else if (key == "LastFrameFile") cfg.lastFrameFile = val;
+            else if (key == "BurstHotkey") cfg.burstHotkey = val;
+            else if (key == "BurstCount") cfg.burstCount = std::clamp(std::stoi(val), 1, 999);
+            else if (key == "BurstIntervalMs") cfg.burstIntervalMs = std::clamp(std::stoi(val), 0, 60000);
+            else if (key == "BurstRingSize") cfg.burstRingSize = std::clamp(std::stoi(val), 1, 64);
         }
         return true;
     }
@@ -49,11 +69,30 @@ namespace screenshot_tool {
         f << "AutoCreateSaveDir=" << (cfg.autoCreateSaveDir ? "true" : "false") << '\n';
         f << "AutoStart=" << (cfg.autoStart ? "true" : "false") << '\n';
         f << "DebugMode=" << (cfg.debugMode ? "true" : "false") << '\n';
-        f << "UseACESFilmToneMapping=" << (cfg.useACESFilmToneMapping ? "true" : "false") << '\n';
+        f << "TraceFile=" << cfg.traceFile << '\n';
+        f << "ToneMapper=" << cfg.toneMapper << '\n';
+        f << "GamutMapping=" << cfg.gamutMapping << '\n';
         f << "SDRBrightness=" << cfg.sdrBrightness << '\n';
+        f << "AutoExposure=" << (cfg.autoExposure ? "true" : "false") << '\n';
+        f << "AutoExposureKeyPercentile=" << cfg.autoExposureKeyPercentile << '\n';
+        f << "AutoExposureWhitePercentile=" << cfg.autoExposureWhitePercentile << '\n';
+        f << "ColorLUTSize=" << cfg.colorLutSize << '\n';
+        f << "ColorLookFile=" << cfg.colorLookFile << '\n';
+        f << "ColorLUTExportFile=" << cfg.colorLutExportFile << '\n';
+        f << "Dither=" << (cfg.dither ? "true" : "false") << '\n';
         f << "FullscreenCurrentMonitor=" << (cfg.fullscreenCurrentMonitor ? "true" : "false") << '\n';
         f << "RegionFullscreenMonitor=" << (cfg.regionFullscreenMonitor ? "true" : "false") << '\n';
+        f << "SelectionSnap=" << (cfg.selectionSnap ? "true" : "false") << '\n';
+        f << "MultiSelect=" << (cfg.multiSelect ? "true" : "false") << '\n';
         f << "CaptureRetryCount=" << cfg.captureRetryCount << '\n';
+        f << "CompactCache=" << (cfg.compactCache ? "true" : "false") << '\n';
+        f << "IdleTrimSeconds=" << cfg.idleTrimSeconds << '\n';
+        f << "IdleTrimMode=" << cfg.idleTrimMode << '\n';
+        f << "LastFrameFile=" << cfg.lastFrameFile << '\n';
+        f << "BurstHotkey=" << cfg.burstHotkey << '\n';
+        f << "BurstCount=" << cfg.burstCount << '\n';
+        f << "BurstIntervalMs=" << cfg.burstIntervalMs << '\n';
+        f << "BurstRingSize=" << cfg.burstRingSize << '\n';
         return true;
     }
 
@@ -18,17 +18,44 @@ namespace screenshot_tool {
 
         // 
         bool        debugMode = false;                     // д־
+        std::string traceFile;                             // ǿʱ¼ͼ׶κʱ Chrome trace JSONģʽҲ¼
 
         // HDR
-        bool        useACESFilmToneMapping = false;
+        std::string toneMapper = "reinhard";               // ɫӳӣreinhard / reinhardextended / aces / hable / bt2390 / agx
+        std::string gamutMapping = "preserve";             //  sRGB ɫɫpreserve߽磩/ acesοɫѹ/ clip
         float       sdrBrightness = 250.0f;                // SDR ӳĿֵ (nit)
+        bool        autoExposure = false;                  // ֱͼԶع⣨̶ sdrBrightness 
+        float       autoExposureKeyPercentile = 50.0f;     // ðٷλӳ䵽 18% л
+        float       autoExposureWhitePercentile = 99.5f;   // ðٷλӳΪɫ
+        int         colorLutSize = 33;                     // HDR->SDR 任決Ϊ 3D LUT ı߳0 = ؽ㣩
+        std::string colorLookFile;                         // ӵ LUT.cubeΪ sRGB ʾ룩
+        std::string colorLutExportFile;                    // ǿʱÿκ決 LUT Ϊ .cube
+        bool        dither = true;                         //  8bit ʱɫ
 
         // ʾΪ
         bool        fullscreenCurrentMonitor = false;      // true: ȫͼǰʾfalse: ʾ
         bool        regionFullscreenMonitor = false;       // true: ѡƵǰʾfalse: ʾѡ
 
+        // ѡ
+        bool        selectionSnap = true;                  // ѡڱ߿ͻԵ
+        bool        multiSelect = false;                   // ѡÿɿУEnter һεȫرʱס Ctrl ɿʱѡ
+
         // 
         int         captureRetryCount = 3;                 // DXGI Դ
+        bool        compactCache = false;                  // ֡е FP16 ݴΪ RGB9E54 ֽ/أڴ룬Լ 1/512
+
+        // л
+        int         idleTrimSeconds = 60;                  // ͼжն֡overlay ͽ0 = գ
+        std::string idleTrimMode = "compress";             // compressѹ֡ʹʱѹ/ freeֱͷţ
+
+        // ²ü
+        std::string lastFrameFile;                         // ϴζ֡ԭʼ + Ԥӳļ·λ %LOCALAPPDATA%\HDR Screenshot Tool = 棬Ĭϣ
+
+        // 
+        std::string burstHotkey;                           // ȼ = עᣬԿɴ̲˵
+        int         burstCount = 30;                       // ÿ
+        int         burstIntervalMs = 100;                 // ļ룩
+        int         burstRingSize = 6;                     // ͬʱפԭʼ֡4K FP16 ÿ֡Լ 63 MBջ룩
     };
 
     //  ini ·ãļĬϡ
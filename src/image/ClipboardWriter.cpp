@@ -1,11 +1,13 @@
 #include "ClipboardWriter.hpp"
 #include "../platform/WinHeaders.hpp"
 #include "../util/ScopedWin.hpp"
+#include "../util/Trace.hpp"
 #include <vector>
 #include <memory>
 
 namespace screenshot_tool {
 	bool ClipboardWriter::WriteRGB(HWND hwnd, const uint8_t* rgb, int w, int h) {
+		TraceScope trace("ClipboardWriter::WriteRGB");
 		if (!OpenClipboard(hwnd)) return false;
 
 		auto clipboardGuard = [](void*) { CloseClipboard(); };
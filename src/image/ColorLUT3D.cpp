@@ -0,0 +1,211 @@
+#include "ColorLUT3D.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define COLOR_LUT_SSE2 1
+#endif
+
+namespace screenshot_tool {
+
+    namespace {
+
+        // 四面体插值的顶点选择：按三个小数部分的大小顺序确定穿过立方体的四面体。
+        // 结果 = (1-w1)*c000 + (w1-w2)*A + (w2-w3)*B + w3*c111
+        struct Tetra {
+            size_t a;
+            size_t b;
+            float w1;
+            float w2;
+            float w3;
+        };
+
+        inline Tetra selectTetra(float fr, float fg, float fb, size_t dr, size_t dg, size_t db) {
+            if (fr > fg) {
+                if (fg > fb) return { dr, dr + dg, fr, fg, fb };
+                if (fr > fb) return { dr, dr + db, fr, fb, fg };
+                return { db, dr + db, fb, fr, fg };
+            }
+            if (fb > fg) return { db, dg + db, fb, fg, fr };
+            if (fb > fr) return { dg, dg + db, fg, fb, fr };
+            return { dg, dr + dg, fg, fr, fb };
+        }
+
+        inline void latticeCoord(float c, int size, int& index, float& frac) {
+            float x = std::clamp(c, 0.0f, 1.0f) * static_cast<float>(size - 1);
+            index = std::min(static_cast<int>(x), size - 2);
+            frac = x - static_cast<float>(index);
+        }
+
+        bool parseFloats(const char* s, float* out, int count) {
+            for (int i = 0; i < count; ++i) {
+                char* end = nullptr;
+                out[i] = std::strtof(s, &end);
+                if (end == s) return false;
+                s = end;
+            }
+            return true;
+        }
+
+    } // namespace
+
+    void ColorLUT3D::resize(int size) {
+        size_ = std::clamp(size, MIN_SIZE, MAX_SIZE);
+        data_.assign(static_cast<size_t>(size_) * size_ * size_ * 4, 0.0f);
+        for (int c = 0; c < 3; ++c) {
+            domainMin_[c] = 0.0f;
+            domainMax_[c] = 1.0f;
+        }
+    }
+
+    void ColorLUT3D::Sample(float r, float g, float b, float out[3]) const {
+        const float in[3] = { r, g, b };
+        int idx[3];
+        float frac[3];
+        for (int c = 0; c < 3; ++c) {
+            float range = domainMax_[c] - domainMin_[c];
+            float n = range > 0.0f ? (in[c] - domainMin_[c]) / range : 0.0f;
+            latticeCoord(n, size_, idx[c], frac[c]);
+        }
+
+        const size_t dr = 4, dg = static_cast<size_t>(size_) * 4, db = static_cast<size_t>(size_) * size_ * 4;
+        const float* c000 = data_.data() + idx[0] * dr + idx[1] * dg + idx[2] * db;
+        const Tetra t = selectTetra(frac[0], frac[1], frac[2], dr, dg, db);
+        for (int c = 0; c < 3; ++c) {
+            out[c] = (1.0f - t.w1) * c000[c] + (t.w1 - t.w2) * c000[t.a + c] +
+                     (t.w2 - t.w3) * c000[t.b + c] + t.w3 * c000[dr + dg + db + c];
+        }
+    }
+
+    void ColorLUT3D::ApplyRGB8(const float* coords, uint8_t* dst, int count, const DitherRow& dither) const {
+        const size_t dr = 4, dg = static_cast<size_t>(size_) * 4, db = static_cast<size_t>(size_) * size_ * 4;
+        const size_t d111 = dr + dg + db;
+        const float* base = data_.data();
+
+#ifdef COLOR_LUT_SSE2
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+#endif
+
+        for (int i = 0; i < count; ++i) {
+            int ir, ig, ib;
+            float fr, fg, fb;
+            latticeCoord(coords[i * 3 + 0], size_, ir, fr);
+            latticeCoord(coords[i * 3 + 1], size_, ig, fg);
+            latticeCoord(coords[i * 3 + 2], size_, ib, fb);
+
+            const float* c000 = base + ir * dr + ig * dg + ib * db;
+            const Tetra t = selectTetra(fr, fg, fb, dr, dg, db);
+
+#ifdef COLOR_LUT_SSE2
+            // 每个顶点的 RGB(A) 一次读取，三个通道同时插值
+            __m128 v = _mm_mul_ps(_mm_loadu_ps(c000), _mm_set1_ps(1.0f - t.w1));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(c000 + t.a), _mm_set1_ps(t.w1 - t.w2)));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(c000 + t.b), _mm_set1_ps(t.w2 - t.w3)));
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_loadu_ps(c000 + d111), _mm_set1_ps(t.w3)));
+            v = _mm_min_ps(_mm_max_ps(v, zero), one);
+
+            __m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, scale), _mm_add_ps(half, _mm_set1_ps(dither.At(i)))));
+            q = _mm_packs_epi32(q, q);
+            q = _mm_packus_epi16(q, q);
+            uint32_t packed = static_cast<uint32_t>(_mm_cvtsi128_si32(q));
+            dst[i * 3 + 0] = static_cast<uint8_t>(packed);
+            dst[i * 3 + 1] = static_cast<uint8_t>(packed >> 8);
+            dst[i * 3 + 2] = static_cast<uint8_t>(packed >> 16);
+#else
+            for (int c = 0; c < 3; ++c) {
+                float v = (1.0f - t.w1) * c000[c] + (t.w1 - t.w2) * c000[t.a + c] +
+                          (t.w2 - t.w3) * c000[t.b + c] + t.w3 * c000[d111 + c];
+                dst[i * 3 + c] = QuantizeDithered(std::clamp(v, 0.0f, 1.0f), dither.At(i));
+            }
+#endif
+        }
+    }
+
+    bool ColorLUT3D::LoadCube(const std::filesystem::path& path, std::string* error) {
+        auto fail = [&](const std::string& msg) {
+            if (error) *error = msg;
+            return false;
+        };
+
+        std::ifstream f(path);
+        if (!f.is_open()) return fail("cannot open file");
+
+        int size = 0;
+        float domainMin[3] = { 0.0f, 0.0f, 0.0f };
+        float domainMax[3] = { 1.0f, 1.0f, 1.0f };
+        std::string title;
+        std::vector<float> values;
+
+        std::string line;
+        while (std::getline(f, line)) {
+            size_t start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') continue;
+            const char* s = line.c_str() + start;
+
+            if (std::strncmp(s, "TITLE", 5) == 0) {
+                size_t q0 = line.find('"');
+                size_t q1 = line.rfind('"');
+                if (q0 != std::string::npos && q1 > q0) title = line.substr(q0 + 1, q1 - q0 - 1);
+            } else if (std::strncmp(s, "LUT_3D_SIZE", 11) == 0) {
+                size = std::atoi(s + 11);
+                if (size < MIN_SIZE || size > MAX_SIZE) return fail("unsupported LUT_3D_SIZE");
+                values.reserve(static_cast<size_t>(size) * size * size * 3);
+            } else if (std::strncmp(s, "LUT_1D_SIZE", 11) == 0) {
+                return fail("1D LUTs are not supported");
+            } else if (std::strncmp(s, "DOMAIN_MIN", 10) == 0) {
+                if (!parseFloats(s + 10, domainMin, 3)) return fail("invalid DOMAIN_MIN");
+            } else if (std::strncmp(s, "DOMAIN_MAX", 10) == 0) {
+                if (!parseFloats(s + 10, domainMax, 3)) return fail("invalid DOMAIN_MAX");
+            } else if ((*s >= '0' && *s <= '9') || *s == '-' || *s == '+' || *s == '.') {
+                float rgb[3];
+                if (!parseFloats(s, rgb, 3)) return fail("invalid table entry");
+                values.insert(values.end(), rgb, rgb + 3);
+            }
+            // 其他关键字（LUT_IN_VIDEO_RANGE 等）忽略
+        }
+
+        if (size == 0) return fail("missing LUT_3D_SIZE");
+        if (values.size() != static_cast<size_t>(size) * size * size * 3) return fail("entry count does not match LUT_3D_SIZE");
+
+        resize(size);
+        for (size_t i = 0, n = values.size() / 3; i < n; ++i) {
+            data_[i * 4 + 0] = values[i * 3 + 0];
+            data_[i * 4 + 1] = values[i * 3 + 1];
+            data_[i * 4 + 2] = values[i * 3 + 2];
+        }
+        std::copy(domainMin, domainMin + 3, domainMin_);
+        std::copy(domainMax, domainMax + 3, domainMax_);
+        title_ = title;
+        return true;
+    }
+
+    bool ColorLUT3D::SaveCube(const std::filesystem::path& path, const std::string& title,
+        const std::vector<std::string>& comments) const
+    {
+        if (Empty()) return false;
+
+        std::ofstream f(path);
+        if (!f.is_open()) return false;
+
+        for (const auto& c : comments) f << "# " << c << '\n';
+        f << "TITLE \"" << title << "\"\n";
+        f << "LUT_3D_SIZE " << size_ << '\n';
+        f << "DOMAIN_MIN " << domainMin_[0] << ' ' << domainMin_[1] << ' ' << domainMin_[2] << '\n';
+        f << "DOMAIN_MAX " << domainMax_[0] << ' ' << domainMax_[1] << ' ' << domainMax_[2] << '\n';
+
+        char buf[64];
+        for (size_t i = 0, n = data_.size() / 4; i < n; ++i) {
+            int len = std::snprintf(buf, sizeof(buf), "%.6f %.6f %.6f\n", data_[i * 4 + 0], data_[i * 4 + 1], data_[i * 4 + 2]);
+            f.write(buf, len);
+        }
+        return static_cast<bool>(f);
+    }
+
+} // namespace screenshot_tool
@@ -0,0 +1,65 @@
+#pragma once
+#include "Dither.hpp"
+#include "../util/ParallelFor.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 三维颜色查找表（.cube 约定：R 变化最快），四面体插值。
+    // 格点按 RGBA 四个 float 存放，插值时每个顶点一次 SIMD 读取。
+    class ColorLUT3D {
+    public:
+        static constexpr int MIN_SIZE = 2;
+        static constexpr int MAX_SIZE = 129;
+
+        bool Empty() const { return size_ == 0; }
+        int Size() const { return size_; }
+        const std::string& Title() const { return title_; }
+        size_t MemoryBytes() const { return data_.size() * sizeof(float); }
+
+        // 以 fn(r, g, b, out[3]) 烘焙整张表，输入为 [0, 1] 格点坐标；按 B 切片并行
+        template<class Fn>
+        void Bake(int size, Fn&& fn);
+
+        // 单点采样（输入按 DOMAIN 归一化），用于烘焙时叠加外部 LUT
+        void Sample(float r, float g, float b, float out[3]) const;
+
+        // 批量：coords 为已归一化到 [0, 1] 的坐标（每像素 3 个 float），输出 8bit RGB（按 dither 抖动量化）
+        void ApplyRGB8(const float* coords, uint8_t* dst, int count, const DitherRow& dither) const;
+
+        // .cube 读写（仅支持 LUT_3D_SIZE）
+        bool LoadCube(const std::filesystem::path& path, std::string* error = nullptr);
+        bool SaveCube(const std::filesystem::path& path, const std::string& title,
+            const std::vector<std::string>& comments = {}) const;
+
+    private:
+        void resize(int size);
+
+        int size_ = 0;
+        std::vector<float> data_;          // size^3 * 4
+        float domainMin_[3] = { 0.0f, 0.0f, 0.0f };
+        float domainMax_[3] = { 1.0f, 1.0f, 1.0f };
+        std::string title_;
+    };
+
+    template<class Fn>
+    void ColorLUT3D::Bake(int size, Fn&& fn) {
+        resize(size);
+        const float scale = 1.0f / static_cast<float>(size - 1);
+        ParallelFor(size, 1, [&](int b0, int b1, int) {
+            for (int b = b0; b < b1; ++b) {
+                for (int g = 0; g < size; ++g) {
+                    float* entry = data_.data() + (static_cast<size_t>(b) * size + g) * size * 4;
+                    for (int r = 0; r < size; ++r, entry += 4) {
+                        fn(r * scale, g * scale, b * scale, entry);
+                        entry[3] = 0.0f;
+                    }
+                }
+            }
+        });
+    }
+
+} // namespace screenshot_tool
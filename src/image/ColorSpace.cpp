@@ -0,0 +1,400 @@
+#include "ColorSpace.hpp"
+#include "HalfFloat.hpp"
+#include "SimdMath.hpp"
+#include "ToneMapping.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <vector>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        constexpr float PQ_M1 = 2610.0f / 16384.0f;
+        constexpr float PQ_M2 = 2523.0f / 4096.0f * 128.0f;
+        constexpr float PQ_C1 = 3424.0f / 4096.0f;
+        constexpr float PQ_C2 = 2413.0f / 4096.0f * 32.0f;
+        constexpr float PQ_C3 = 2392.0f / 4096.0f * 32.0f;
+
+        constexpr float HLG_A = 0.17883277f;
+        constexpr float HLG_B = 0.28466892f;
+        constexpr float HLG_C = 0.55991073f;
+
+        constexpr float SCRGB_UNIT_NITS = 80.0f;
+
+        // Rec.709 亮度系数
+        constexpr float LUMA_R = 0.2126f;
+        constexpr float LUMA_G = 0.7152f;
+        constexpr float LUMA_B = 0.0722f;
+
+        // ACES 1.3 参考色域压缩参数：各通道到灰轴距离的压缩起点与上限（上限处压缩到色域边界）
+        constexpr float RGC_THRESHOLD[3] = { 0.815f, 0.803f, 0.880f };
+        constexpr float RGC_LIMIT[3] = { 1.147f, 1.264f, 1.312f };
+        constexpr float RGC_POWER = 1.2f;
+
+        struct RGCScale {
+            float s[3];
+
+            RGCScale() {
+                for (int c = 0; c < 3; ++c) {
+                    const float t = RGC_THRESHOLD[c], l = RGC_LIMIT[c];
+                    s[c] = (l - t) / std::pow(std::pow((1.0f - t) / (l - t), -RGC_POWER) - 1.0f, 1.0f / RGC_POWER);
+                }
+            }
+        };
+
+        const RGCScale& rgcScale() {
+            static const RGCScale scale;
+            return scale;
+        }
+
+        inline float rgcCompress(float dist, int c, float scale) {
+            const float t = RGC_THRESHOLD[c];
+            if (dist < t) return dist;
+            const float d = (dist - t) / scale;
+            return t + scale * d / std::pow(1.0f + std::pow(d, RGC_POWER), 1.0f / RGC_POWER);
+        }
+
+        using Mat3 = std::array<double, 9>;
+
+        Mat3 multiply(const Mat3& a, const Mat3& b) {
+            Mat3 m{};
+            for (int r = 0; r < 3; ++r)
+                for (int c = 0; c < 3; ++c)
+                    m[r * 3 + c] = a[r * 3 + 0] * b[0 * 3 + c] + a[r * 3 + 1] * b[1 * 3 + c] + a[r * 3 + 2] * b[2 * 3 + c];
+            return m;
+        }
+
+        Mat3 invert(const Mat3& m) {
+            const double det = m[0] * (m[4] * m[8] - m[5] * m[7]) - m[1] * (m[3] * m[8] - m[5] * m[6]) + m[2] * (m[3] * m[7] - m[4] * m[6]);
+            const double inv = 1.0 / det;
+            return {
+                (m[4] * m[8] - m[5] * m[7]) * inv, (m[2] * m[7] - m[1] * m[8]) * inv, (m[1] * m[5] - m[2] * m[4]) * inv,
+                (m[5] * m[6] - m[3] * m[8]) * inv, (m[0] * m[8] - m[2] * m[6]) * inv, (m[2] * m[3] - m[0] * m[5]) * inv,
+                (m[3] * m[7] - m[4] * m[6]) * inv, (m[1] * m[6] - m[0] * m[7]) * inv, (m[0] * m[4] - m[1] * m[3]) * inv,
+            };
+        }
+
+        // 由原色与 D65 白点的 xy 坐标求 RGB -> XYZ 矩阵
+        Mat3 rgbToXYZ(ColorGamut gamut) {
+            static const double primaries[3][6] = {
+                { 0.640, 0.330, 0.300, 0.600, 0.150, 0.060 },   // Rec.709
+                { 0.680, 0.320, 0.265, 0.690, 0.150, 0.060 },   // Display P3
+                { 0.708, 0.292, 0.170, 0.797, 0.131, 0.046 },   // Rec.2020
+            };
+            const double* p = primaries[static_cast<int>(gamut)];
+            const double wx = 0.3127, wy = 0.3290;
+
+            Mat3 xyz{};
+            for (int i = 0; i < 3; ++i) {
+                const double x = p[i * 2], y = p[i * 2 + 1];
+                xyz[0 * 3 + i] = x / y;
+                xyz[1 * 3 + i] = 1.0;
+                xyz[2 * 3 + i] = (1.0 - x - y) / y;
+            }
+            const Mat3 inv = invert(xyz);
+            const double w[3] = { wx / wy, 1.0, (1.0 - wx - wy) / wy };
+            for (int i = 0; i < 3; ++i) {
+                const double s = inv[i * 3 + 0] * w[0] + inv[i * 3 + 1] * w[1] + inv[i * 3 + 2] * w[2];
+                for (int r = 0; r < 3; ++r) xyz[r * 3 + i] *= s;
+            }
+            return xyz;
+        }
+
+        struct GamutMatrices {
+            float m[3][3][9];
+
+            GamutMatrices() {
+                for (int from = 0; from < 3; ++from) {
+                    for (int to = 0; to < 3; ++to) {
+                        const Mat3 mat = multiply(invert(rgbToXYZ(static_cast<ColorGamut>(to))), rgbToXYZ(static_cast<ColorGamut>(from)));
+                        for (int i = 0; i < 9; ++i) m[from][to][i] = static_cast<float>(mat[i]);
+                    }
+                }
+            }
+        };
+
+        const GamutMatrices& gamutMatrices() {
+            static const GamutMatrices matrices;
+            return matrices;
+        }
+
+        float hlgToLinear(float e) {
+            e = std::clamp(e, 0.0f, 1.0f);
+            return e <= 0.5f ? e * e / 3.0f : (std::exp((e - HLG_C) / HLG_A) + HLG_B) / 12.0f;
+        }
+
+    } // namespace
+
+    GamutMapping ParseGamutMapping(const std::string& name) {
+        std::string n;
+        for (char ch : name) n.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+        if (n == "aces") return GamutMapping::ACES;
+        if (n == "clip") return GamutMapping::Clip;
+        return GamutMapping::Preserve;
+    }
+
+    void ColorSpace::Rec2020ToSRGB(float& r, float& g, float& b, GamutMapping mapping) {
+        const float* m = GamutMatrix(ColorGamut::Rec2020, ColorGamut::Rec709);
+        float r2 = m[0] * r + m[1] * g + m[2] * b;
+        float g2 = m[3] * r + m[4] * g + m[5] * b;
+        float b2 = m[6] * r + m[7] * g + m[8] * b;
+
+        r = r2;
+        g = g2;
+        b = b2;
+        MapGamut(r, g, b, mapping);
+    }
+
+    void ColorSpace::MapGamut(float& r, float& g, float& b, GamutMapping mapping) {
+        switch (mapping) {
+        case GamutMapping::Preserve: {
+            const float lo = std::min({ r, g, b });
+            if (lo >= 0.0f) return;
+            const float y = LUMA_R * r + LUMA_G * g + LUMA_B * b;
+            if (y <= 0.0f) {
+                r = g = b = 0.0f;
+                return;
+            }
+            // 沿 (y, y, y) -> (r, g, b) 的直线收缩到最小分量恰好为 0，亮度不变
+            const float t = y / (y - lo);
+            r = std::max(y + (r - y) * t, 0.0f);
+            g = std::max(y + (g - y) * t, 0.0f);
+            b = std::max(y + (b - y) * t, 0.0f);
+            return;
+        }
+        case GamutMapping::ACES: {
+            const float ach = std::max({ r, g, b });
+            if (ach <= 0.0f) {
+                r = g = b = 0.0f;
+                return;
+            }
+            const RGCScale& k = rgcScale();
+            float* ch[3] = { &r, &g, &b };
+            for (int c = 0; c < 3; ++c) {
+                const float dist = (ach - *ch[c]) / ach;
+                *ch[c] = std::max(ach - rgcCompress(dist, c, k.s[c]) * ach, 0.0f);
+            }
+            return;
+        }
+        default:
+            r = std::max(r, 0.0f);
+            g = std::max(g, 0.0f);
+            b = std::max(b, 0.0f);
+            return;
+        }
+    }
+
+    void ColorSpace::MapGamutPlanar(float* r, float* g, float* b, int count, GamutMapping mapping) {
+        int i = 0;
+#ifdef SCREENSHOT_SIMD_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        if (mapping == GamutMapping::Preserve) {
+            const __m128 kr = _mm_set1_ps(LUMA_R), kg = _mm_set1_ps(LUMA_G), kb = _mm_set1_ps(LUMA_B);
+            for (; i + 4 <= count; i += 4) {
+                __m128 vr = _mm_loadu_ps(r + i), vg = _mm_loadu_ps(g + i), vb = _mm_loadu_ps(b + i);
+                __m128 lo = _mm_min_ps(vr, _mm_min_ps(vg, vb));
+                __m128 outside = _mm_cmplt_ps(lo, zero);
+                if (_mm_movemask_ps(outside) == 0) continue;    // 常见情况：4 个像素都在色域内
+
+                __m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(kr, vr), _mm_mul_ps(kg, vg)), _mm_mul_ps(kb, vb));
+                // y <= 0 时 t 取 0，结果为 max(y, 0) = 0
+                __m128 t = _mm_and_ps(_mm_div_ps(y, _mm_sub_ps(y, lo)), _mm_cmpgt_ps(y, zero));
+                __m128 mr = _mm_max_ps(_mm_add_ps(y, _mm_mul_ps(_mm_sub_ps(vr, y), t)), zero);
+                __m128 mg = _mm_max_ps(_mm_add_ps(y, _mm_mul_ps(_mm_sub_ps(vg, y), t)), zero);
+                __m128 mb = _mm_max_ps(_mm_add_ps(y, _mm_mul_ps(_mm_sub_ps(vb, y), t)), zero);
+                _mm_storeu_ps(r + i, simd::Select(outside, mr, vr));
+                _mm_storeu_ps(g + i, simd::Select(outside, mg, vg));
+                _mm_storeu_ps(b + i, simd::Select(outside, mb, vb));
+            }
+        } else if (mapping == GamutMapping::ACES) {
+            const RGCScale& k = rgcScale();
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 power = _mm_set1_ps(RGC_POWER);
+            const __m128 invPower = _mm_set1_ps(1.0f / RGC_POWER);
+            float* planes[3] = { r, g, b };
+            for (; i + 4 <= count; i += 4) {
+                __m128 v[3] = { _mm_loadu_ps(r + i), _mm_loadu_ps(g + i), _mm_loadu_ps(b + i) };
+                __m128 ach = _mm_max_ps(v[0], _mm_max_ps(v[1], v[2]));
+                __m128 positive = _mm_cmpgt_ps(ach, zero);
+                __m128 invAch = _mm_and_ps(_mm_div_ps(one, ach), positive);
+                for (int c = 0; c < 3; ++c) {
+                    const __m128 thr = _mm_set1_ps(RGC_THRESHOLD[c]);
+                    const __m128 scale = _mm_set1_ps(k.s[c]);
+                    __m128 dist = _mm_mul_ps(_mm_sub_ps(ach, v[c]), invAch);
+                    if (_mm_movemask_ps(_mm_cmpge_ps(dist, thr)) == 0) {
+                        // 4 个像素都在保护区内，只需处理 ach <= 0 的情况
+                        _mm_storeu_ps(planes[c] + i, _mm_and_ps(_mm_max_ps(v[c], zero), positive));
+                        continue;
+                    }
+                    __m128 d = _mm_div_ps(_mm_max_ps(_mm_sub_ps(dist, thr), zero), scale);
+                    __m128 den = simd::Pow(_mm_add_ps(one, simd::Pow(d, power)), invPower);
+                    __m128 compressed = _mm_add_ps(thr, _mm_div_ps(_mm_mul_ps(scale, d), den));
+                    compressed = simd::Select(_mm_cmplt_ps(dist, thr), dist, compressed);
+                    __m128 out = _mm_max_ps(_mm_sub_ps(ach, _mm_mul_ps(compressed, ach)), zero);
+                    _mm_storeu_ps(planes[c] + i, _mm_and_ps(out, positive));
+                }
+            }
+        } else {
+            for (; i + 4 <= count; i += 4) {
+                _mm_storeu_ps(r + i, _mm_max_ps(_mm_loadu_ps(r + i), zero));
+                _mm_storeu_ps(g + i, _mm_max_ps(_mm_loadu_ps(g + i), zero));
+                _mm_storeu_ps(b + i, _mm_max_ps(_mm_loadu_ps(b + i), zero));
+            }
+        }
+#endif
+        for (; i < count; ++i) MapGamut(r[i], g[i], b[i], mapping);
+    }
+
+    void ColorSpace::PQToLinearN(const float* pq, float* nits, int count) {
+        int i = 0;
+#ifdef SCREENSHOT_SIMD_SSE2
+        const __m128 invM2 = _mm_set1_ps(1.0f / PQ_M2);
+        const __m128 invM1 = _mm_set1_ps(1.0f / PQ_M1);
+        const __m128 c1 = _mm_set1_ps(PQ_C1);
+        const __m128 c2 = _mm_set1_ps(PQ_C2);
+        const __m128 c3 = _mm_set1_ps(PQ_C3);
+        const __m128 peak = _mm_set1_ps(10000.0f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 p = simd::Pow(simd::Clamp01(_mm_loadu_ps(pq + i)), invM2);
+            __m128 num = _mm_max_ps(_mm_sub_ps(p, c1), _mm_setzero_ps());
+            __m128 den = _mm_sub_ps(c2, _mm_mul_ps(c3, p));
+            _mm_storeu_ps(nits + i, _mm_mul_ps(simd::Pow(_mm_div_ps(num, den), invM1), peak));
+        }
+#endif
+        for (; i < count; ++i) nits[i] = PQToLinear(pq[i]);
+    }
+
+    void ColorSpace::LinearToPQN(const float* nits, float* pq, int count) {
+        int i = 0;
+#ifdef SCREENSHOT_SIMD_SSE2
+        const __m128 m1 = _mm_set1_ps(PQ_M1);
+        const __m128 m2 = _mm_set1_ps(PQ_M2);
+        const __m128 c1 = _mm_set1_ps(PQ_C1);
+        const __m128 c2 = _mm_set1_ps(PQ_C2);
+        const __m128 c3 = _mm_set1_ps(PQ_C3);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 invPeak = _mm_set1_ps(1.0f / 10000.0f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 p = simd::Pow(simd::Clamp01(_mm_mul_ps(_mm_loadu_ps(nits + i), invPeak)), m1);
+            __m128 v = _mm_div_ps(_mm_add_ps(c1, _mm_mul_ps(c2, p)), _mm_add_ps(one, _mm_mul_ps(c3, p)));
+            _mm_storeu_ps(pq + i, simd::Pow(v, m2));
+        }
+#endif
+        for (; i < count; ++i) pq[i] = LinearToPQ(nits[i]);
+    }
+
+    void ColorSpace::HLGToLinearN(const float* hlg, float* linear, int count) {
+        int i = 0;
+#ifdef SCREENSHOT_SIMD_SSE2
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 third = _mm_set1_ps(1.0f / 3.0f);
+        const __m128 invA = _mm_set1_ps(1.0f / HLG_A);
+        const __m128 b = _mm_set1_ps(HLG_B);
+        const __m128 c = _mm_set1_ps(HLG_C);
+        const __m128 twelfth = _mm_set1_ps(1.0f / 12.0f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 e = simd::Clamp01(_mm_loadu_ps(hlg + i));
+            __m128 low = _mm_mul_ps(_mm_mul_ps(e, e), third);
+            __m128 high = _mm_mul_ps(_mm_add_ps(simd::Exp(_mm_mul_ps(_mm_sub_ps(e, c), invA)), b), twelfth);
+            _mm_storeu_ps(linear + i, simd::Select(_mm_cmple_ps(e, half), low, high));
+        }
+#endif
+        for (; i < count; ++i) linear[i] = hlgToLinear(hlg[i]);
+    }
+
+    void ColorSpace::ScRGBToNitsN(const uint16_t* half, float* nits, int count) {
+        HalfToFloatN(half, nits, count);
+        for (int i = 0; i < count; ++i) nits[i] *= SCRGB_UNIT_NITS;
+    }
+
+    void ColorSpace::LinearToSRGBN(const float* linear, float* encoded, int count) {
+        int i = 0;
+#ifdef SCREENSHOT_SIMD_SSE2
+        const __m128 threshold = _mm_set1_ps(0.0031308f);
+        const __m128 slope = _mm_set1_ps(12.92f);
+        const __m128 invGamma = _mm_set1_ps(1.0f / 2.4f);
+        const __m128 scale = _mm_set1_ps(1.055f);
+        const __m128 offset = _mm_set1_ps(0.055f);
+        for (; i + 4 <= count; i += 4) {
+            __m128 x = simd::Clamp01(_mm_loadu_ps(linear + i));
+            __m128 low = _mm_mul_ps(x, slope);
+            __m128 high = _mm_sub_ps(_mm_mul_ps(scale, simd::Pow(x, invGamma)), offset);
+            _mm_storeu_ps(encoded + i, simd::Select(_mm_cmple_ps(x, threshold), low, high));
+        }
+#endif
+        for (; i < count; ++i) encoded[i] = LinearToSRGB(std::clamp(linear[i], 0.0f, 1.0f));
+    }
+
+    const float* ColorSpace::GamutMatrix(ColorGamut from, ColorGamut to) {
+        return gamutMatrices().m[static_cast<int>(from)][static_cast<int>(to)];
+    }
+
+    void ColorSpace::ConvertGamutN(ColorGamut from, ColorGamut to, float* rgb, int count) {
+        if (from == to) return;
+        const float* m = GamutMatrix(from, to);
+        for (int i = 0; i < count; ++i) {
+            float r = rgb[i * 3 + 0], g = rgb[i * 3 + 1], b = rgb[i * 3 + 2];
+            rgb[i * 3 + 0] = m[0] * r + m[1] * g + m[2] * b;
+            rgb[i * 3 + 1] = m[3] * r + m[4] * g + m[5] * b;
+            rgb[i * 3 + 2] = m[6] * r + m[7] * g + m[8] * b;
+        }
+    }
+
+    void ColorSpace::ConvertGamutPlanar(ColorGamut from, ColorGamut to, float* r, float* g, float* b, int count) {
+        if (from == to) return;
+        const float* m = GamutMatrix(from, to);
+        int i = 0;
+#ifdef SCREENSHOT_SIMD_SSE2
+        __m128 k[9];
+        for (int j = 0; j < 9; ++j) k[j] = _mm_set1_ps(m[j]);
+        for (; i + 4 <= count; i += 4) {
+            __m128 vr = _mm_loadu_ps(r + i), vg = _mm_loadu_ps(g + i), vb = _mm_loadu_ps(b + i);
+            _mm_storeu_ps(r + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(k[0], vr), _mm_mul_ps(k[1], vg)), _mm_mul_ps(k[2], vb)));
+            _mm_storeu_ps(g + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(k[3], vr), _mm_mul_ps(k[4], vg)), _mm_mul_ps(k[5], vb)));
+            _mm_storeu_ps(b + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(k[6], vr), _mm_mul_ps(k[7], vg)), _mm_mul_ps(k[8], vb)));
+        }
+#endif
+        for (; i < count; ++i) {
+            float vr = r[i], vg = g[i], vb = b[i];
+            r[i] = m[0] * vr + m[1] * vg + m[2] * vb;
+            g[i] = m[3] * vr + m[4] * vg + m[5] * vb;
+            b[i] = m[6] * vr + m[7] * vg + m[8] * vb;
+        }
+    }
+
+    void PQ2020ToLinearSRGB(const uint16_t* input, int width, int height, int stride,
+                           float maxNits, float minNits, float* output) {
+        if (!input || !output || width <= 0 || height <= 0) return;
+
+        std::vector<float> rgba(static_cast<size_t>(width) * 4);
+        std::vector<float> planes(static_cast<size_t>(width) * 3);
+        float* r = planes.data();
+        float* g = r + width;
+        float* b = g + width;
+        const float range = std::max(maxNits - minNits, 1e-3f);
+
+        for (int y = 0; y < height; ++y) {
+            const auto* src = reinterpret_cast<const uint16_t*>(reinterpret_cast<const uint8_t*>(input) + static_cast<size_t>(y) * stride);
+            HalfToFloatN(src, rgba.data(), width * 4);
+            for (int x = 0; x < width; ++x) {
+                r[x] = rgba[x * 4 + 0];
+                g[x] = rgba[x * 4 + 1];
+                b[x] = rgba[x * 4 + 2];
+            }
+
+            ColorSpace::PQToLinearN(planes.data(), planes.data(), width * 3);
+            ColorSpace::ConvertGamutPlanar(ColorGamut::Rec2020, ColorGamut::Rec709, r, g, b, width);
+
+            float* dst = output + static_cast<size_t>(y) * width * 3;
+            for (int x = 0; x < width; ++x) {
+                dst[x * 3 + 0] = (r[x] - minNits) / range;
+                dst[x * 3 + 1] = (g[x] - minNits) / range;
+                dst[x * 3 + 2] = (b[x] - minNits) / range;
+            }
+        }
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -1,16 +1,51 @@
 #pragma once
 #include <cstdint>
+#include <string>
 
 namespace screenshot_tool {
 
+	// 线性 RGB 色域（均为 D65 白点）
+	enum class ColorGamut {
+		Rec709,     // sRGB / scRGB
+		DisplayP3,
+		Rec2020
+	};
+
+	// 转换到 sRGB 原色后超出色域（出现负分量）时的处理方式（Config::gamutMapping 以字符串配置）。
+	// 三种方式都不做上限钳制：高于 1.0 的亮度留给色调映射压缩。
+	enum class GamutMapping {
+		Preserve,   // 沿等亮度线向灰轴收缩到色域边界；色域内颜色保持不变
+		ACES,       // ACES 参考色域压缩：按到灰轴的距离软压缩，接近色域边界的饱和色也会轻微收缩
+		Clip        // 逐通道把负值钳制为 0
+	};
+
+	// 无法识别的名称回退到 Preserve
+	GamutMapping ParseGamutMapping(const std::string& name);
+
 	class ColorSpace {
 	public:
-		// Rec.2020 to sRGB color space conversion
-		static void Rec2020ToSRGB(float& r, float& g, float& b);
+		// Rec.2020 to sRGB color space conversion，随后按 mapping 把超出色域的颜色映射回来
+		static void Rec2020ToSRGB(float& r, float& g, float& b, GamutMapping mapping = GamutMapping::Preserve);
+
+		// 线性 sRGB 的色域映射：单像素与平面批量版本
+		static void MapGamut(float& r, float& g, float& b, GamutMapping mapping);
+		static void MapGamutPlanar(float* r, float* g, float* b, int count, GamutMapping mapping);
+
+		// ---- 批量传递函数：逐个 float 处理，交错或平面数据都可整行传入，in 与 out 可相同 ----
+		static void PQToLinearN(const float* pq, float* nits, int count);            // ST 2084 EOTF，输出 nits
+		static void LinearToPQN(const float* nits, float* pq, int count);            // ST 2084 逆 EOTF
+		static void HLGToLinearN(const float* hlg, float* linear, int count);        // BT.2100 HLG 逆 OETF，输出场景线性 [0, 1]
+		static void ScRGBToNitsN(const uint16_t* half, float* nits, int count);      // scRGB FP16（1.0 = 80 nits）
+		static void LinearToSRGBN(const float* linear, float* encoded, int count);   // 输入先钳制到 [0, 1]
+
+		// ---- 色域转换：矩阵由各色域的原色坐标推导 ----
+		static const float* GamutMatrix(ColorGamut from, ColorGamut to);            // 行主序 3x3
+		static void ConvertGamutN(ColorGamut from, ColorGamut to, float* rgb, int count);                       // 交错 RGB，原地
+		static void ConvertGamutPlanar(ColorGamut from, ColorGamut to, float* r, float* g, float* b, int count); // 平面 RGB，原地
 	};
 
-	// 从 Rec.2020 PQ (HDR10) 格式转换为线性伽马（0-1）空间。
-	// 接口：实现后再调用。
+	// 从 Rec.2020 PQ (HDR10) 格式转换为线性 sRGB（Rec.709 原色）。
+	// 输入为 RGBA16F 中存放的 PQ 码值 [0, 1]，输出每像素 3 个 float，minLumNit..maxLumNit 映射到 0..1。
 	void PQ2020ToLinearSRGB(const uint16_t* srcRGBA16F, int width, int height, int strideBytes, float maxLumNit, float minLumNit, float* outLinearRGB);
 
 } // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "Dither.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        constexpr int N = Dither::TILE;
+        constexpr int CELLS = N * N;
+        constexpr float SIGMA = 1.5f;
+        constexpr float AMPLITUDE = 0.98f;  // 峰峰值（LSB），留出余量给浮点误差
+
+        // void-and-cluster：能量场为所有已放置点的环面高斯和。
+        // 最密集的点 = 已放置点中能量最大者，最大空洞 = 空位中能量最小者。
+        class VoidAndCluster {
+        public:
+            VoidAndCluster() : kernel_(CELLS), energy_(CELLS, 0.0f), set_(CELLS, 0) {
+                for (int dy = 0; dy < N; ++dy) {
+                    for (int dx = 0; dx < N; ++dx) {
+                        int ex = std::min(dx, N - dx), ey = std::min(dy, N - dy);
+                        kernel_[dy * N + dx] = std::exp(-static_cast<float>(ex * ex + ey * ey) / (2.0f * SIGMA * SIGMA));
+                    }
+                }
+            }
+
+            std::vector<int> Ranks() {
+                // 初始图案：约 10% 的确定性伪随机点，再反复把最密集的点移到最大空洞直到稳定
+                uint32_t seed = 0x9E3779B9u;
+                int initial = 0;
+                while (initial < CELLS / 10) {
+                    seed = seed * 1664525u + 1013904223u;
+                    int p = static_cast<int>((seed >> 8) % CELLS);
+                    if (!set_[p]) {
+                        toggle(p);
+                        ++initial;
+                    }
+                }
+                for (int iter = 0; iter < CELLS; ++iter) {
+                    int cluster = tightestCluster();
+                    toggle(cluster);
+                    int hole = largestVoid();
+                    if (hole == cluster) {
+                        toggle(cluster);
+                        break;
+                    }
+                    toggle(hole);
+                }
+
+                std::vector<int> rank(CELLS, 0);
+                std::vector<uint8_t> prototype = set_;
+                std::vector<float> prototypeEnergy = energy_;
+
+                // 阶段 1：依次移除最密集的点，排名从 initial - 1 递减
+                for (int r = initial - 1; r >= 0; --r) {
+                    int p = tightestCluster();
+                    toggle(p);
+                    rank[p] = r;
+                }
+
+                // 阶段 2/3：从原型开始依次填入最大空洞，排名递增直到填满
+                set_ = prototype;
+                energy_ = prototypeEnergy;
+                for (int r = initial; r < CELLS; ++r) {
+                    int p = largestVoid();
+                    toggle(p);
+                    rank[p] = r;
+                }
+                return rank;
+            }
+
+        private:
+            void toggle(int p) {
+                const float sign = set_[p] ? -1.0f : 1.0f;
+                set_[p] ^= 1;
+                const int px = p % N, py = p / N;
+                for (int y = 0; y < N; ++y) {
+                    const float* k = kernel_.data() + ((y - py + N) % N) * N;
+                    float* e = energy_.data() + y * N;
+                    // 环面偏移拆成两段，避免内层取模
+                    for (int x = 0; x < px; ++x) e[x] += sign * k[x - px + N];
+                    for (int x = px; x < N; ++x) e[x] += sign * k[x - px];
+                }
+            }
+
+            int tightestCluster() const {
+                int best = -1;
+                for (int p = 0; p < CELLS; ++p) {
+                    if (set_[p] && (best < 0 || energy_[p] > energy_[best])) best = p;
+                }
+                return best;
+            }
+
+            int largestVoid() const {
+                int best = -1;
+                for (int p = 0; p < CELLS; ++p) {
+                    if (!set_[p] && (best < 0 || energy_[p] < energy_[best])) best = p;
+                }
+                return best;
+            }
+
+            std::vector<float> kernel_;
+            std::vector<float> energy_;
+            std::vector<uint8_t> set_;
+        };
+
+        struct NoiseTile {
+            float noise[CELLS];
+            float zero[N] = {};
+
+            NoiseTile() {
+                std::vector<int> rank = VoidAndCluster().Ranks();
+                for (int p = 0; p < CELLS; ++p) {
+                    noise[p] = ((static_cast<float>(rank[p]) + 0.5f) / CELLS - 0.5f) * AMPLITUDE;
+                }
+            }
+        };
+
+        const NoiseTile& noiseTile() {
+            static const NoiseTile tile;
+            return tile;
+        }
+
+    } // namespace
+
+    const float* Dither::Row(int y, bool enabled) {
+        const NoiseTile& tile = noiseTile();
+        return enabled ? tile.noise + (y & (TILE - 1)) * TILE : tile.zero;
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+namespace screenshot_tool {
+
+	// 量化抖动：64x64 平铺的蓝噪声阈值（void-and-cluster 生成，首次使用时构建一次）。
+	// 阈值范围约 ±0.49 LSB，所以恰好落在 8bit 码值上的颜色（SDR 内容、纯黑纯白）量化结果不变。
+	class Dither {
+	public:
+		static constexpr int TILE = 64;
+
+		// 第 y 行的 TILE 个阈值；enabled 为 false 时返回全 0 行（等同于原来的四舍五入）
+		static const float* Row(int y, bool enabled = true);
+	};
+
+	// 一段像素的抖动游标：段起点横坐标 + 所在行的阈值
+	struct DitherRow {
+		const float* noise;
+		int x;
+
+		float At(int i) const { return noise[(x + i) & (Dither::TILE - 1)]; }
+	};
+
+	// v 为 [0, 1] 内的显示编码值
+	inline uint8_t QuantizeDithered(float v, float noise) {
+		return static_cast<uint8_t>(v * 255.0f + 0.5f + noise);
+	}
+
+} // namespace screenshot_tool
\ No newline at end of file
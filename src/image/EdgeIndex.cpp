@@ -0,0 +1,168 @@
+#include "EdgeIndex.hpp"
+#include "../util/ParallelFor.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        // 每个线程处理一段连续行，结果按行顺序保存，最后按线程顺序拼接
+        struct EdgeBand {
+            std::vector<uint32_t> rowCounts;
+            std::vector<uint16_t> rowXs;
+            std::vector<uint16_t> colXs;   // 水平边缘 (x, y)，按 y 递增
+            std::vector<uint16_t> colYs;
+        };
+
+        void loadLuma(const uint8_t* rgb, int width, int height, int stride, int y, int* dst) {
+            y = std::clamp(y, 0, height - 1);
+            const uint8_t* row = rgb + static_cast<size_t>(y) * stride;
+            for (int x = 0; x < width; ++x) {
+                dst[x] = (row[x * 3 + 0] * 77 + row[x * 3 + 1] * 150 + row[x * 3 + 2] * 29) >> 8;
+            }
+        }
+
+        // 3x3 Sobel，输出梯度绝对值；左右边界列置 0
+        void sobelRow(const int* p, const int* c, const int* n, int width, int* ax, int* ay) {
+            ax[0] = ay[0] = 0;
+            ax[width - 1] = ay[width - 1] = 0;
+            for (int x = 1; x < width - 1; ++x) {
+                int gx = (p[x + 1] + 2 * c[x + 1] + n[x + 1]) - (p[x - 1] + 2 * c[x - 1] + n[x - 1]);
+                int gy = (n[x - 1] + 2 * n[x] + n[x + 1]) - (p[x - 1] + 2 * p[x] + p[x + 1]);
+                ax[x] = std::abs(gx);
+                ay[x] = std::abs(gy);
+            }
+        }
+
+    } // namespace
+
+    void EdgeIndex::Clear() {
+        width_ = height_ = 0;
+        rowOffsets_.clear();
+        rowEdges_.clear();
+        colOffsets_.clear();
+        colEdges_.clear();
+    }
+
+    void EdgeIndex::Build(const uint8_t* rgb, int width, int height, int stride, int threshold) {
+        Clear();
+        if (!rgb || width < 3 || height < 3 || width > 65535 || height > 65535) return;
+
+        std::vector<EdgeBand> bands(ParallelWorkerCount());
+
+        ParallelFor(height, 64, [&](int y0, int y1, int worker) {
+            EdgeBand& band = bands[worker];
+            band.rowCounts.assign(y1 - y0, 0);
+
+            // 亮度行 y-1..y+2 与梯度行 y-1..y+1 滚动复用（水平边缘需要沿 y 做非极大值抑制）
+            std::vector<int> luma(4 * static_cast<size_t>(width));
+            std::vector<int> grad(6 * static_cast<size_t>(width));
+            int* L[4] = { &luma[0], &luma[width], &luma[2 * width], &luma[3 * width] };
+            int* AX[3] = { &grad[0], &grad[width], &grad[2 * width] };
+            int* AY[3] = { &grad[3 * width], &grad[4 * width], &grad[5 * width] };
+
+            for (int i = 0; i < 4; ++i) loadLuma(rgb, width, height, stride, y0 - 2 + i, L[i]);
+            sobelRow(L[0], L[1], L[2], width, AX[0], AY[0]);   // y0 - 1
+            sobelRow(L[1], L[2], L[3], width, AX[1], AY[1]);   // y0
+
+            for (int y = y0; y < y1; ++y) {
+                // 亮度行滚动为 y-1..y+2，计算 y+1 的梯度
+                std::rotate(L, L + 1, L + 4);
+                loadLuma(rgb, width, height, stride, y + 2, L[3]);
+                sobelRow(L[1], L[2], L[3], width, AX[2], AY[2]);
+
+                const int* ax = AX[1];
+                const int* ayPrev = AY[0];
+                const int* ay = AY[1];
+                const int* ayNext = AY[2];
+
+                uint32_t count = 0;
+                for (int x = 1; x < width - 1; ++x) {
+                    const int gx = ax[x];
+                    const int gy = ay[x];
+                    if (gx >= threshold && gx >= gy && gx >= ax[x - 1] && gx > ax[x + 1]) {
+                        band.rowXs.push_back(static_cast<uint16_t>(x));
+                        ++count;
+                    }
+                    if (gy >= threshold && gy > gx && gy >= ayPrev[x] && gy > ayNext[x]) {
+                        band.colXs.push_back(static_cast<uint16_t>(x));
+                        band.colYs.push_back(static_cast<uint16_t>(y));
+                    }
+                }
+                band.rowCounts[y - y0] = count;
+
+                std::rotate(AX, AX + 1, AX + 3);
+                std::rotate(AY, AY + 1, AY + 3);
+            }
+        });
+
+        width_ = width;
+        height_ = height;
+
+        // 行索引：各线程结果按行顺序直接拼接
+        rowOffsets_.resize(static_cast<size_t>(height) + 1);
+        size_t totalRow = 0;
+        for (const auto& band : bands) totalRow += band.rowXs.size();
+        rowEdges_.reserve(totalRow);
+        uint32_t offset = 0;
+        int y = 0;
+        for (const auto& band : bands) {
+            for (uint32_t c : band.rowCounts) {
+                rowOffsets_[y++] = offset;
+                offset += c;
+            }
+            rowEdges_.insert(rowEdges_.end(), band.rowXs.begin(), band.rowXs.end());
+        }
+        rowOffsets_[height] = offset;
+
+        // 列索引：按列计数排序，线程顺序即 y 顺序，保证每列内 y 递增
+        colOffsets_.assign(static_cast<size_t>(width) + 1, 0);
+        for (const auto& band : bands) {
+            for (uint16_t x : band.colXs) ++colOffsets_[x + 1];
+        }
+        for (int x = 0; x < width; ++x) colOffsets_[x + 1] += colOffsets_[x];
+        colEdges_.resize(colOffsets_[width]);
+        std::vector<uint32_t> cursor(colOffsets_.begin(), colOffsets_.end() - 1);
+        for (const auto& band : bands) {
+            for (size_t i = 0; i < band.colXs.size(); ++i) {
+                colEdges_[cursor[band.colXs[i]]++] = band.colYs[i];
+            }
+        }
+    }
+
+    size_t EdgeIndex::MemoryBytes() const {
+        return rowOffsets_.size() * sizeof(uint32_t) + rowEdges_.size() * sizeof(uint16_t) +
+               colOffsets_.size() * sizeof(uint32_t) + colEdges_.size() * sizeof(uint16_t);
+    }
+
+    static bool nearestInSorted(const uint16_t* begin, const uint16_t* end, int value, int radius, int& out) {
+        if (begin == end) return false;
+        const uint16_t* it = std::lower_bound(begin, end, static_cast<uint16_t>(std::clamp(value, 0, 65535)));
+        int best = -1;
+        int bestDist = radius + 1;
+        if (it != end && *it - value < bestDist) {
+            best = *it;
+            bestDist = *it - value;
+        }
+        if (it != begin && value - *(it - 1) < bestDist) {
+            best = *(it - 1);
+        }
+        if (best < 0) return false;
+        out = best;
+        return true;
+    }
+
+    bool EdgeIndex::NearestVertical(int x, int y, int radius, int& outX) const {
+        if (y < 0 || y >= height_) return false;
+        const uint16_t* base = rowEdges_.data();
+        return nearestInSorted(base + rowOffsets_[y], base + rowOffsets_[y + 1], x, radius, outX);
+    }
+
+    bool EdgeIndex::NearestHorizontal(int x, int y, int radius, int& outY) const {
+        if (x < 0 || x >= width_) return false;
+        const uint16_t* base = colEdges_.data();
+        return nearestInSorted(base + colOffsets_[x], base + colOffsets_[x + 1], y, radius, outY);
+    }
+
+} // namespace screenshot_tool
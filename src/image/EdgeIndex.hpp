@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 冻结帧的强边缘索引：并行 Sobel 检测后按行/列压缩存储（CSR），供选区吸附查询。
+    // 每行保存竖直边缘的 x 坐标，每列保存水平边缘的 y 坐标，均已排序，查询为 O(log n)。
+    class EdgeIndex {
+    public:
+        static constexpr int DEFAULT_THRESHOLD = 128;   // Sobel 亮度梯度阈值（最大约 1020）
+
+        // 从 RGB8 图像构建索引；尺寸超过 65535 时不建立索引
+        void Build(const uint8_t* rgb, int width, int height, int stride, int threshold = DEFAULT_THRESHOLD);
+        void Clear();
+
+        bool Empty() const { return width_ == 0; }
+        int Width() const { return width_; }
+        int Height() const { return height_; }
+        size_t EdgeCount() const { return rowEdges_.size() + colEdges_.size(); }
+        size_t MemoryBytes() const;
+
+        // 在第 y 行中查找距 x 最近的竖直边缘，radius 内没有则返回 false
+        bool NearestVertical(int x, int y, int radius, int& outX) const;
+        // 在第 x 列中查找距 y 最近的水平边缘，radius 内没有则返回 false
+        bool NearestHorizontal(int x, int y, int radius, int& outY) const;
+
+    private:
+        int width_ = 0;
+        int height_ = 0;
+        std::vector<uint32_t> rowOffsets_;   // height + 1
+        std::vector<uint16_t> rowEdges_;     // 每行竖直边缘 x
+        std::vector<uint32_t> colOffsets_;   // width + 1
+        std::vector<uint16_t> colEdges_;     // 每列水平边缘 y
+    };
+
+} // namespace screenshot_tool
@@ -0,0 +1,222 @@
+#include "FrameFile.hpp"
+#include "../util/Trace.hpp"
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        constexpr uint32_t FRAME_MAGIC = 0x46545348;   // "HSTF"
+        constexpr uint32_t FRAME_VERSION = 2;
+        constexpr uint32_t MAX_TILES = 64;
+        constexpr size_t DATA_ALIGN = 64;              // 各块像素按缓存行对齐存放
+
+        struct FileHeader {
+            uint32_t magic;
+            uint32_t version;
+            int32_t  left;
+            int32_t  top;
+            int32_t  right;
+            int32_t  bottom;
+            int64_t  captureTime;
+            uint32_t tileCount;
+            int32_t  previewStride;
+            uint64_t previewOffset;        // 0 = 无预览
+            uint64_t previewSettings;      // 生成预览时的转换设置哈希
+            uint64_t fileBytes;
+        };
+
+        struct TileRecord {
+            int32_t  left;
+            int32_t  top;
+            int32_t  width;
+            int32_t  height;
+            int32_t  stride;
+            uint32_t format;               // PixelFormat
+            uint32_t hdr;
+            float    maxNits;
+            float    minNits;
+            float    exposure;
+            float    whiteNits;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t bytes;
+        };
+
+        static_assert(std::is_trivially_copyable_v<FileHeader> && std::is_trivially_copyable_v<TileRecord>);
+
+        inline size_t alignUp(size_t v) {
+            return (v + DATA_ALIGN - 1) & ~(DATA_ALIGN - 1);
+        }
+
+        inline bool validFormat(uint32_t format) {
+            return format > static_cast<uint32_t>(PixelFormat::Unknown) &&
+                   format <= static_cast<uint32_t>(PixelFormat::RGB9E5);
+        }
+
+        // [offset, offset + bytes) 是否完全落在文件内（防止溢出）
+        inline bool inFile(uint64_t offset, uint64_t bytes, size_t fileBytes) {
+            return offset <= fileBytes && bytes <= fileBytes - offset;
+        }
+
+    } // namespace
+
+    bool FrameFile::Save(const std::filesystem::path& path, const TiledImage& frame,
+        int left, int top, int right, int bottom, int64_t captureTime,
+        const ImageBuffer* preview, uint64_t previewSettings)
+    {
+        TraceScope trace("FrameFile::Save");
+        Close();
+        if (frame.Empty() || frame.Compressed() || frame.Tiles().size() > MAX_TILES) return false;
+
+        const auto& tiles = frame.Tiles();
+        const bool withPreview = preview && preview->format == PixelFormat::RGB8 &&
+            preview->width == right - left && preview->height == bottom - top &&
+            preview->data.size() >= static_cast<size_t>(preview->stride) * preview->height;
+
+        // 布局：文件头 | 块记录 | 各块像素 | 预览（像素段均对齐）
+        std::vector<TileRecord> records(tiles.size());
+        size_t offset = alignUp(sizeof(FileHeader) + records.size() * sizeof(TileRecord));
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            const ImageTile& tile = tiles[i];
+            TileRecord& rec = records[i];
+            rec = TileRecord{};
+            rec.left = tile.left;
+            rec.top = tile.top;
+            rec.width = tile.image.width;
+            rec.height = tile.image.height;
+            rec.stride = tile.image.stride;
+            rec.format = static_cast<uint32_t>(tile.image.format);
+            rec.hdr = tile.params.hdr ? 1 : 0;
+            rec.maxNits = tile.params.maxNits;
+            rec.minNits = tile.params.minNits;
+            rec.exposure = tile.params.exposure;
+            rec.whiteNits = tile.params.whiteNits;
+            rec.offset = offset;
+            rec.bytes = tile.image.data.size();
+            offset = alignUp(offset + tile.image.data.size());
+        }
+        const size_t previewOffset = withPreview ? offset : 0;
+        const size_t previewBytes = withPreview ? static_cast<size_t>(preview->stride) * preview->height : 0;
+        const size_t fileBytes = offset + previewBytes;
+
+        MappedFile out;
+        if (!out.Create(path, fileBytes)) return false;
+
+        uint8_t* base = out.Data();
+        std::memcpy(base + sizeof(FileHeader), records.data(), records.size() * sizeof(TileRecord));
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            std::memcpy(base + records[i].offset, tiles[i].image.data.data(), tiles[i].image.data.size());
+        }
+        if (withPreview) std::memcpy(base + previewOffset, preview->data.data(), previewBytes);
+
+        // 文件头最后写入：中途失败留下的文件没有有效标识，不会被 Open 接受
+        FileHeader header{};
+        header.magic = FRAME_MAGIC;
+        header.version = FRAME_VERSION;
+        header.left = left;
+        header.top = top;
+        header.right = right;
+        header.bottom = bottom;
+        header.captureTime = captureTime;
+        header.tileCount = static_cast<uint32_t>(tiles.size());
+        header.previewStride = withPreview ? preview->stride : 0;
+        header.previewOffset = previewOffset;
+        header.previewSettings = withPreview ? previewSettings : 0;
+        header.fileBytes = fileBytes;
+        std::memcpy(base, &header, sizeof(header));
+        return true;
+    }
+
+    bool FrameFile::Open(const std::filesystem::path& path) {
+        TraceScope trace("FrameFile::Open");
+        Close();
+        if (!file_.OpenRead(path)) return false;
+
+        auto fail = [this]() {
+            Close();
+            return false;
+        };
+
+        const size_t fileBytes = file_.Size();
+        if (fileBytes < sizeof(FileHeader)) return fail();
+        FileHeader header;
+        std::memcpy(&header, file_.Data(), sizeof(header));
+        if (header.magic != FRAME_MAGIC || header.version != FRAME_VERSION || header.fileBytes != fileBytes) return fail();
+        if (header.tileCount == 0 || header.tileCount > MAX_TILES) return fail();
+        if (header.right <= header.left || header.bottom <= header.top) return fail();
+        if (!inFile(sizeof(FileHeader), static_cast<uint64_t>(header.tileCount) * sizeof(TileRecord), fileBytes)) return fail();
+
+        for (uint32_t i = 0; i < header.tileCount; ++i) {
+            TileRecord rec;
+            std::memcpy(&rec, file_.Data() + sizeof(FileHeader) + i * sizeof(TileRecord), sizeof(rec));
+            if (!validFormat(rec.format) || rec.width <= 0 || rec.height <= 0) return fail();
+            // 块是显示器与冻结范围的交集，必须位于范围内（同时保证 Right() / Bottom() 不溢出）
+            if (rec.left < header.left || rec.top < header.top ||
+                static_cast<int64_t>(rec.left) + rec.width > header.right ||
+                static_cast<int64_t>(rec.top) + rec.height > header.bottom) return fail();
+            const int bpp = BytesPerPixel(static_cast<PixelFormat>(rec.format));
+            if (rec.stride < static_cast<int64_t>(rec.width) * bpp) return fail();
+            if (rec.bytes != static_cast<uint64_t>(rec.stride) * rec.height || !inFile(rec.offset, rec.bytes, fileBytes)) return fail();
+        }
+
+        if (header.previewOffset) {
+            const int64_t w = static_cast<int64_t>(header.right) - header.left;
+            const int64_t h = static_cast<int64_t>(header.bottom) - header.top;
+            if (header.previewStride < w * 3) return fail();
+            if (!inFile(header.previewOffset, static_cast<uint64_t>(header.previewStride) * h, fileBytes)) return fail();
+        }
+
+        left_ = header.left;
+        top_ = header.top;
+        right_ = header.right;
+        bottom_ = header.bottom;
+        captureTime_ = header.captureTime;
+        tileCount_ = header.tileCount;
+        previewStride_ = header.previewStride;
+        previewOffset_ = static_cast<size_t>(header.previewOffset);
+        previewSettings_ = header.previewSettings;
+        return true;
+    }
+
+    void FrameFile::Close() {
+        file_.Close();
+        left_ = top_ = right_ = bottom_ = 0;
+        captureTime_ = 0;
+        tileCount_ = 0;
+        previewStride_ = 0;
+        previewOffset_ = 0;
+        previewSettings_ = 0;
+    }
+
+    bool FrameFile::LoadTiles(TiledImage& out) const {
+        TraceScope trace("FrameFile::LoadTiles");
+        out.Clear();
+        if (!IsOpen()) return false;
+
+        for (uint32_t i = 0; i < tileCount_; ++i) {
+            TileRecord rec;
+            std::memcpy(&rec, file_.Data() + sizeof(FileHeader) + i * sizeof(TileRecord), sizeof(rec));
+
+            ImageBuffer image;
+            image.format = static_cast<PixelFormat>(rec.format);
+            image.width = rec.width;
+            image.height = rec.height;
+            image.stride = rec.stride;
+            const uint8_t* pixels = file_.Data() + rec.offset;
+            image.data.assign(pixels, pixels + rec.bytes);
+
+            ToneMapParams params;
+            params.hdr = rec.hdr != 0;
+            params.maxNits = rec.maxNits;
+            params.minNits = rec.minNits;
+            params.exposure = rec.exposure;
+            params.whiteNits = rec.whiteNits;
+            out.AddTile(rec.left, rec.top, std::move(image), params);
+        }
+        return !out.Empty();
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
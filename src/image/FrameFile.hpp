@@ -0,0 +1,57 @@
+#pragma once
+#include "ImageBuffer.hpp"
+#include "TiledImage.hpp"
+#include "../util/MappedFile.hpp"
+#include <cstdint>
+#include <filesystem>
+
+namespace screenshot_tool {
+
+    // 上一次冻结帧的持久化容器：各块原始像素（原生格式，HDR 数据不经转换）、块位置与色调映射参数、
+    // 冻结范围和抓取时间，以及可选的 sRGB8 预览（overlay 背景）。
+    // 保存在内存映射文件中，重新裁剪时直接从映射读取，不需要重新抓屏；带预览时也不需要重新转换。
+    class FrameFile {
+    public:
+        // 写入冻结帧；preview 尺寸与冻结范围一致时连同生成它的转换设置（PixelConvert::SettingsHash）一并保存。
+        // 会先关闭本对象当前打开的映射
+        bool Save(const std::filesystem::path& path, const TiledImage& frame,
+            int left, int top, int right, int bottom, int64_t captureTime,
+            const ImageBuffer* preview, uint64_t previewSettings);
+
+        // 以只读方式映射并校验文件；失败时保持关闭状态
+        bool Open(const std::filesystem::path& path);
+        void Close();
+        bool IsOpen() const { return file_.IsOpen(); }
+
+        // 冻结范围（虚拟桌面坐标）与抓取时间（Unix 秒）
+        int Left() const { return left_; }
+        int Top() const { return top_; }
+        int Right() const { return right_; }
+        int Bottom() const { return bottom_; }
+        int64_t CaptureTime() const { return captureTime_; }
+
+        // 把各块复制到 out（替换原有内容）
+        bool LoadTiles(TiledImage& out) const;
+
+        // 预览像素直接指向映射，在 Close / 下一次 Save / Open 前有效
+        bool HasPreview() const { return previewOffset_ != 0; }
+        const uint8_t* PreviewPixels() const { return HasPreview() ? file_.Data() + previewOffset_ : nullptr; }
+        int PreviewWidth() const { return HasPreview() ? right_ - left_ : 0; }
+        int PreviewHeight() const { return HasPreview() ? bottom_ - top_ : 0; }
+        int PreviewStride() const { return previewStride_; }
+        uint64_t PreviewSettings() const { return previewSettings_; }
+
+    private:
+        MappedFile file_;
+        int left_ = 0;
+        int top_ = 0;
+        int right_ = 0;
+        int bottom_ = 0;
+        int64_t captureTime_ = 0;
+        uint32_t tileCount_ = 0;
+        int previewStride_ = 0;
+        size_t previewOffset_ = 0;
+        uint64_t previewSettings_ = 0;
+    };
+
+} // namespace screenshot_tool
\ No newline at end of file
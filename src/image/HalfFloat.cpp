@@ -0,0 +1,175 @@
+#include "HalfFloat.hpp"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#define HALF_FLOAT_X86 1
+#endif
+
+#if defined(HALF_FLOAT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HALF_FLOAT_F16C_TARGET __attribute__((target("f16c")))
+#else
+#define HALF_FLOAT_F16C_TARGET
+#endif
+
+namespace screenshot_tool {
+
+    namespace {
+
+        // 查表解码：bits = mantissa[offset[e] + m] + exponent[e]，e 为符号 + 指数共 6 位
+        struct HalfTables {
+            uint32_t mantissa[2048];
+            uint32_t exponent[64];
+            uint16_t offset[64];
+
+            HalfTables() {
+                mantissa[0] = 0;
+                for (uint32_t i = 1; i < 1024; ++i) {
+                    // 非规格化数：规格化尾数并相应调整指数
+                    uint32_t m = i << 13;
+                    uint32_t e = 0;
+                    while ((m & 0x00800000) == 0) {
+                        e -= 0x00800000;
+                        m <<= 1;
+                    }
+                    mantissa[i] = (m & ~0x00800000u) | (e + 0x38800000);
+                }
+                for (uint32_t i = 1024; i < 2048; ++i) {
+                    mantissa[i] = 0x38000000 + ((i - 1024) << 13);
+                }
+
+                exponent[0] = 0;
+                exponent[32] = 0x80000000;
+                for (uint32_t i = 1; i < 31; ++i) {
+                    exponent[i] = i << 23;
+                    exponent[i + 32] = 0x80000000 | (i << 23);
+                }
+                exponent[31] = 0x47800000;              // Inf / NaN：0x38000000 + 0x47800000 = 0x7F800000
+                exponent[63] = 0xC7800000;
+
+                for (int i = 0; i < 64; ++i) offset[i] = 1024;
+                offset[0] = 0;
+                offset[32] = 0;
+            }
+        };
+
+        const HalfTables& halfTables() {
+            static const HalfTables tables;
+            return tables;
+        }
+
+        void halfToFloatTable(const uint16_t* src, float* dst, int count) {
+            const HalfTables& t = halfTables();
+            for (int i = 0; i < count; ++i) {
+                const uint32_t h = src[i];
+                const uint32_t e = h >> 10;
+                const uint32_t bits = t.mantissa[t.offset[e] + (h & 0x3FF)] + t.exponent[e];
+                std::memcpy(dst + i, &bits, sizeof(bits));
+            }
+        }
+
+#ifdef HALF_FLOAT_X86
+        bool cpuHasF16C() {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            const bool f16c = (info[2] & (1 << 29)) != 0;
+            // VEX 指令还要求操作系统保存 YMM 状态
+            return osxsave && avx && f16c && (_xgetbv(0) & 0x6) == 0x6;
+#else
+            return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#endif
+        }
+
+        // vcvtph2ps 会把 signaling NaN 转成 quiet NaN，而 HalfToFloat 保留原载荷；
+        // 这类输入极少出现，检测到时整组改走查表
+        HALF_FLOAT_F16C_TARGET
+        void halfToFloatF16C(const uint16_t* src, float* dst, int count) {
+            const __m128i expMask = _mm_set1_epi16(0x7E00);
+            const __m128i snanExp = _mm_set1_epi16(0x7C00);
+            const __m128i payloadMask = _mm_set1_epi16(0x01FF);
+            const __m128i zero = _mm_setzero_si128();
+
+            int i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                const __m128i snan = _mm_andnot_si128(
+                    _mm_cmpeq_epi16(_mm_and_si128(h, payloadMask), zero),
+                    _mm_cmpeq_epi16(_mm_and_si128(h, expMask), snanExp));
+                if (_mm_movemask_epi8(snan) != 0) {
+                    halfToFloatTable(src + i, dst + i, 8);
+                    continue;
+                }
+                _mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+                _mm_storeu_ps(dst + i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(h, h)));
+            }
+            halfToFloatTable(src + i, dst + i, count - i);
+        }
+#endif
+
+        using HalfKernel = void (*)(const uint16_t*, float*, int);
+
+        HalfKernel selectKernel() {
+#ifdef HALF_FLOAT_X86
+            if (cpuHasF16C()) return &halfToFloatF16C;
+#endif
+            return &halfToFloatTable;
+        }
+
+        HalfKernel halfKernel() {
+            static const HalfKernel kernel = selectKernel();
+            return kernel;
+        }
+
+    } // namespace
+
+    void HalfToFloatN(const uint16_t* src, float* dst, int count) {
+        if (count > 0) halfKernel()(src, dst, count);
+    }
+
+    uint16_t FloatToHalf(float f) {
+        uint32_t x;
+        std::memcpy(&x, &f, sizeof(x));
+        const uint32_t sign = (x >> 16) & 0x8000;
+        const uint32_t a = x & 0x7FFFFFFF;
+
+        if (a >= 0x7F800000) {
+            // Inf / NaN（NaN 保证尾数非零）
+            return static_cast<uint16_t>(sign | 0x7C00 | (a > 0x7F800000 ? 0x200 | ((a >> 13) & 0x3FF) : 0));
+        }
+        if (a >= 0x477FF000) {
+            return static_cast<uint16_t>(sign | 0x7C00);    // >= 65520 舍入后溢出
+        }
+        if (a < 0x38800000) {
+            // 结果为非规格化数或零：以 2^-24 为单位右移尾数
+            if (a < 0x33000000) return static_cast<uint16_t>(sign);
+            const uint32_t m = (a & 0x7FFFFF) | 0x800000;
+            const uint32_t shift = 126 - (a >> 23);
+            uint32_t h = m >> shift;
+            const uint32_t rem = m & ((1u << shift) - 1);
+            const uint32_t half = 1u << (shift - 1);
+            if (rem > half || (rem == half && (h & 1))) ++h;
+            return static_cast<uint16_t>(sign | h);
+        }
+
+        // 规格化数：指数偏置 127 -> 15，尾数截去 13 位后舍入（进位自然进入指数）
+        uint32_t h = (a - 0x38000000) >> 13;
+        const uint32_t rem = a & 0x1FFF;
+        if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) ++h;
+        return static_cast<uint16_t>(sign | h);
+    }
+
+    bool HalfToFloatUsesF16C() {
+#ifdef HALF_FLOAT_X86
+        return halfKernel() != &halfToFloatTable;
+#else
+        return false;
+#endif
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
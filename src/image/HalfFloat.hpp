@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+namespace screenshot_tool {
+
+	// 批量 FP16 -> FP32 解码，结果与 HalfToFloat 逐位一致（含非规格化数、Inf 与 NaN 载荷）。
+	// CPU 支持 F16C 时使用 vcvtph2ps，否则使用查表（尾数表 + 指数表，约 8.5 KB）。
+	void HalfToFloatN(const uint16_t* src, float* dst, int count);
+
+	// 是否正在使用 F16C 路径（用于日志）
+	bool HalfToFloatUsesF16C();
+
+	// FP32 -> FP16，就近舍入到偶数；溢出为 Inf，NaN 保留高位载荷。逐个转换，用于建表等非热点路径
+	uint16_t FloatToHalf(float f);
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -9,9 +9,33 @@ namespace screenshot_tool {
         RGBA_F16,    // R16G16B16A16_FLOAT
         RGBA10A2,    // R10G10B10A2_UNORM
         BGRA8,       // BGRA8_UNORM
-        RGB8         // planar / packed output (no alpha)
+        RGB8,        // planar / packed output (no alpha)
+        RGB9E5       // 共享指数紧凑缓存：scRGB 刻度、Rec.2020 原色（见 SharedExponent.hpp）
     };
 
+    inline int BytesPerPixel(PixelFormat format) {
+        switch (format) {
+        case PixelFormat::RGBA_F16: return 8;
+        case PixelFormat::RGBA10A2:
+        case PixelFormat::BGRA8:
+        case PixelFormat::RGB9E5:   return 4;
+        case PixelFormat::RGB8:     return 3;
+        default:                    return 0;
+        }
+    }
+
+    // 可能携带 HDR 数据的格式；其余格式一律按 SDR 处理
+    inline bool IsHDRCapableFormat(PixelFormat format) {
+        return format == PixelFormat::RGBA_F16 || format == PixelFormat::RGBA10A2 || format == PixelFormat::RGB9E5;
+    }
+
+    // 一次抓取覆盖多个输出时的缓冲区格式：各输出格式一致时直接使用，
+    // 否则统一为 FP16（SDR 输出的 BGRA8 在复制时展开为 scRGB）
+    inline PixelFormat CommonCaptureFormat(PixelFormat current, PixelFormat output) {
+        if (current == PixelFormat::Unknown || current == output) return output;
+        return PixelFormat::RGBA_F16;
+    }
+
     struct ImageBuffer {
         PixelFormat format = PixelFormat::Unknown;
         int width = 0;
@@ -1,11 +1,40 @@
 #include "ImageSaverPNG.hpp"
 #include "../platform/WinHeaders.hpp"
+#include "../util/Trace.hpp"
+#include <memory>
 #include <mutex>
 
 namespace screenshot_tool {
 
+    namespace {
+
+        bool getEncoderClsid(const WCHAR* format, CLSID* pClsid) {
+            using namespace Gdiplus;
+        
+            UINT num = 0, size = 0;
+            GetImageEncodersSize(&num, &size);
+            if (size == 0) return false;
+
+            auto pImageCodecInfo = std::make_unique<uint8_t[]>(size);
+            auto* codecInfo = reinterpret_cast<ImageCodecInfo*>(pImageCodecInfo.get());
+
+            GetImageEncoders(num, size, codecInfo);
+
+            for (UINT j = 0; j < num; ++j) {
+                if (wcscmp(codecInfo[j].MimeType, format) == 0) {
+                    *pClsid = codecInfo[j].Clsid;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+    } // namespace
+
     bool ImageSaverPNG::SaveRGBToPNG(const uint8_t* rgb, int w, int h, const wchar_t* savePath) {
         using namespace Gdiplus;
+        TraceScope trace("ImageSaverPNG::SaveRGBToPNG");
         
         Bitmap bitmap(w, h, PixelFormat24bppRGB);
         BitmapData bitmapData;
@@ -26,33 +55,11 @@ namespace screenshot_tool {
 
             // 获取PNG编码器
             CLSID pngClsid;
-            if (GetEncoderClsid(L"image/png", &pngClsid)) {
+            if (getEncoderClsid(L"image/png", &pngClsid)) {
                 return bitmap.Save(savePath, &pngClsid, nullptr) == Ok;
             }
         }
         return false;
     }
-    
-    bool ImageSaverPNG::GetEncoderClsid(const WCHAR* format, CLSID* pClsid) {
-        using namespace Gdiplus;
-        
-        UINT num = 0, size = 0;
-        GetImageEncodersSize(&num, &size);
-        if (size == 0) return false;
-
-        auto pImageCodecInfo = std::make_unique<uint8_t[]>(size);
-        auto* codecInfo = reinterpret_cast<ImageCodecInfo*>(pImageCodecInfo.get());
-
-        GetImageEncoders(num, size, codecInfo);
-
-        for (UINT j = 0; j < num; ++j) {
-            if (wcscmp(codecInfo[j].MimeType, format) == 0) {
-                *pClsid = codecInfo[j].Clsid;
-                return true;
-            }
-        }
-
-        return false;
-    }
 
 } // namespace screenshot_tool
\ No newline at end of file
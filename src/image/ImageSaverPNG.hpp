@@ -1,17 +1,13 @@
 #pragma once
 #include <cstdint>
 #include <string>
-#include <Windows.h>
 
 namespace screenshot_tool {
 
 	class ImageSaverPNG {
 	public:
-		// 保存 RGB8 数据为 PNG，使用 GDI+
+		// 保存 RGB8 数据为 PNG，使用 GDI+（接口不依赖 Windows 头文件，实现仅在 Windows 上编译）
 		static bool SaveRGBToPNG(const uint8_t* rgb, int w, int h, const wchar_t* savePath);
-		
-	private:
-		static bool GetEncoderClsid(const WCHAR* format, CLSID* pClsid);
 	};
 
 } // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "LuminanceHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        constexpr float BINS_PER_STOP = LuminanceHistogram::BIN_COUNT /
+            (LuminanceHistogram::MAX_LOG2_NITS - LuminanceHistogram::MIN_LOG2_NITS);
+
+        constexpr float KEY_VALUE = 0.18f;      // 中灰
+        constexpr float MIN_KEY_NITS = 0.05f;
+        constexpr float MAX_WHITE = 64.0f;      // 色调映射输入中白点的上限
+
+        // 指数位 + 二次多项式近似尾数，误差远小于一个桶宽
+        inline float fastLog2(float v) {
+            uint32_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            const float e = static_cast<float>(static_cast<int>((bits >> 23) & 0xFF) - 127);
+            const float m = static_cast<float>(bits & 0x7FFFFF) * (1.0f / 8388608.0f);
+            return e + m * (1.0f + 0.346607f * (1.0f - m));
+        }
+
+    } // namespace
+
+    void LuminanceHistogram::Clear() {
+        bins_.fill(0);
+        count_ = 0;
+    }
+
+    void LuminanceHistogram::Add(float nits) {
+        int bin = 0;
+        if (nits > 0.0f) {
+            float pos = (fastLog2(nits) - MIN_LOG2_NITS) * BINS_PER_STOP;
+            bin = std::clamp(static_cast<int>(pos), 0, BIN_COUNT - 1);
+        }
+        ++bins_[bin];
+        ++count_;
+    }
+
+    void LuminanceHistogram::Merge(const LuminanceHistogram& other) {
+        for (int i = 0; i < BIN_COUNT; ++i) bins_[i] += other.bins_[i];
+        count_ += other.count_;
+    }
+
+    float LuminanceHistogram::Percentile(float percent) const {
+        if (count_ == 0) return 0.0f;
+
+        const double target = std::clamp(percent, 0.0f, 100.0f) / 100.0 * static_cast<double>(count_);
+        double cumulative = 0.0;
+        int bin = 0;
+        for (; bin < BIN_COUNT - 1; ++bin) {
+            // 跳过空桶：0 百分位落在最低的非空桶，而不是直方图下限
+            if (bins_[bin] > 0 && cumulative + bins_[bin] >= target) break;
+            cumulative += bins_[bin];
+        }
+
+        const double inBin = bins_[bin] > 0 ? (target - cumulative) / bins_[bin] : 0.0;
+        const double log2Nits = MIN_LOG2_NITS + (bin + std::clamp(inBin, 0.0, 1.0)) / BINS_PER_STOP;
+        return static_cast<float>(std::exp2(log2Nits));
+    }
+
+    bool LuminanceHistogram::DeriveExposure(float keyPercentile, float whitePercentile,
+        float& exposurePerNit, float& whiteNits) const
+    {
+        if (count_ == 0) return false;
+
+        const float keyNits = std::max(Percentile(keyPercentile), MIN_KEY_NITS);
+        whiteNits = std::max(Percentile(std::max(whitePercentile, keyPercentile)), keyNits);
+
+        exposurePerNit = KEY_VALUE / keyNits;
+        if (whiteNits * exposurePerNit < 1.0f) {
+            exposurePerNit = 1.0f / whiteNits;
+        }
+        whiteNits = std::min(whiteNits, MAX_WHITE / exposurePerNit);
+        return true;
+    }
+
+} // namespace screenshot_tool
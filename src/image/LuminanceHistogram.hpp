@@ -0,0 +1,32 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+namespace screenshot_tool {
+
+    // 对数亮度直方图（单位 nits），用于自动曝光。
+    // 每个线程各自累加一份，最后 Merge 合并，累加过程无需同步。
+    class LuminanceHistogram {
+    public:
+        static constexpr int   BIN_COUNT = 128;
+        static constexpr float MIN_LOG2_NITS = -6.0f;   // ~0.016 nits
+        static constexpr float MAX_LOG2_NITS = 14.0f;   // ~16384 nits
+
+        void Clear();
+        void Add(float nits);
+        void Merge(const LuminanceHistogram& other);
+
+        uint64_t Count() const { return count_; }
+        // 百分位对应的亮度（nits），桶内按对数线性插值
+        float Percentile(float percent) const;
+
+        // 由百分位推导曝光：keyPercentile 处的亮度映射到 18% 中灰，whitePercentile 处的亮度作为白点。
+        // 曝光至少保证白点映射到 1.0，避免以浅色界面为主的桌面被整体压暗。
+        bool DeriveExposure(float keyPercentile, float whitePercentile, float& exposurePerNit, float& whiteNits) const;
+
+    private:
+        std::array<uint32_t, BIN_COUNT> bins_{};
+        uint64_t count_ = 0;
+    };
+
+} // namespace screenshot_tool
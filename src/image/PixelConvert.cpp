@@ -1,18 +1,550 @@
 #include "PixelConvert.hpp"
 #include "ToneMapping.hpp"
 #include "ColorSpace.hpp"
+#include "HalfFloat.hpp"
+#include "LuminanceHistogram.hpp"
+#include "SharedExponent.hpp"
 #include "../util/Logger.hpp"
+#include "../util/ParallelFor.hpp"
+#include "../util/Trace.hpp"
+#include "ColorLUT3D.hpp"
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <ranges>
 
 namespace screenshot_tool {
 
+    namespace {
+
+        constexpr float SCRGB_UNIT_NITS = 80.0f;    // scRGB 1.0 = 80 nits
+        constexpr int AUTO_EXPOSURE_ROW_STEP = 4;   // 直方图抽样：每 4 行取 1 行
+        constexpr int AUTO_EXPOSURE_COL_STEP = 2;   // 行内每 2 个像素取 1 个
+        constexpr float AUTO_EXPOSURE_STEPS_PER_EV = 64.0f;    // 曝光与白点按 1/64 EV 量化
+
+        constexpr int DECODE_CHUNK = 256;           // 半精度批量解码的段长（像素）
+
+        // 正值取最近的 2^(k/64)
+        inline float quantizeEV(float v) {
+            return std::exp2(std::round(std::log2(v) * AUTO_EXPOSURE_STEPS_PER_EV) / AUTO_EXPOSURE_STEPS_PER_EV);
+        }
+
+        void accumulate16F(const uint16_t* src, int count, LuminanceHistogram& hist) {
+            float rgba[DECODE_CHUNK * 4];
+            for (int x0 = 0; x0 < count; x0 += DECODE_CHUNK) {
+                const int n = std::min(DECODE_CHUNK, count - x0);
+                HalfToFloatN(src + x0 * 4, rgba, n * 4);
+                for (int x = 0; x < n; x += AUTO_EXPOSURE_COL_STEP) {
+                    const float* p = rgba + x * 4;
+                    hist.Add((0.2126f * p[0] + 0.7152f * p[1] + 0.0722f * p[2]) * SCRGB_UNIT_NITS);
+                }
+            }
+        }
+
+        void accumulateE5(const uint32_t* src, int count, LuminanceHistogram& hist) {
+            float planes[DECODE_CHUNK * 3];
+            for (int x0 = 0; x0 < count; x0 += DECODE_CHUNK) {
+                const int n = std::min(DECODE_CHUNK, count - x0);
+                UnpackRGB9E5Planar(src + x0, n, planes);
+                for (int x = 0; x < n; x += AUTO_EXPOSURE_COL_STEP) {
+                    hist.Add((0.2126f * planes[x] + 0.7152f * planes[n + x] + 0.0722f * planes[2 * n + x]) * SCRGB_UNIT_NITS);
+                }
+            }
+        }
+
+        void accumulateHDR10(const uint32_t* src, int count, LuminanceHistogram& hist) {
+            for (int x = 0; x < count; x += AUTO_EXPOSURE_COL_STEP) {
+                uint32_t pixel = src[x];
+                float r = PQToLinear(static_cast<float>((pixel >> 20) & 0x3FF) / 1023.0f);
+                float g = PQToLinear(static_cast<float>((pixel >> 10) & 0x3FF) / 1023.0f);
+                float b = PQToLinear(static_cast<float>(pixel & 0x3FF) / 1023.0f);
+                hist.Add(0.2627f * r + 0.6780f * g + 0.0593f * b);
+            }
+        }
+
+        // HDR16F 单像素：scRGB 线性值 -> sRGB 编码（未钳制）
+        template<class ToneMap>
+        inline void displayHDR16(float& r, float& g, float& b, const ToneCurve& curve) {
+            r *= curve.exposure;
+            g *= curve.exposure;
+            b *= curve.exposure;
+
+            // scRGB 中 sRGB 色域外的颜色表现为负分量
+            ColorSpace::MapGamut(r, g, b, curve.gamut);
+            
+            // Tone mapping
+            ToneMap::Apply(r, g, b, curve);
+            
+            // sRGB gamma correction
+            r = LinearToSRGB(r);
+            g = LinearToSRGB(g);
+            b = LinearToSRGB(b);
+        }
+
+        // HDR10 单像素：Rec.2020 线性 nits -> sRGB 编码 [0, 1]
+        template<class ToneMap>
+        inline void displayHDR10(float& r, float& g, float& b, const ToneCurve& curve) {
+            r *= curve.exposure;
+            g *= curve.exposure;
+            b *= curve.exposure;
+            
+            // Rec.2020 到 sRGB 色域转换，色域外颜色映射回边界，高光保留给色调映射
+            ColorSpace::Rec2020ToSRGB(r, g, b, curve.gamut);
+            
+            // 非线性色调映射
+            ToneMap::Apply(r, g, b, curve);
+            
+            // sRGB伽马校正
+            r = LinearToSRGB(std::clamp(r, 0.0f, 1.0f));
+            g = LinearToSRGB(std::clamp(g, 0.0f, 1.0f));
+            b = LinearToSRGB(std::clamp(b, 0.0f, 1.0f));
+        }
+
+        // ---- 解析路径：按段转成平面 float，再调用 ColorSpace 的批量传递函数 ----
+        // 每段的 R/G/B 平面连续存放（r = buf, g = buf + n, b = buf + 2n），sRGB 编码可一次处理 3n 个值
+
+        constexpr int CONVERT_CHUNK = DECODE_CHUNK;
+
+        void decodeHalfPlanar(const uint16_t* src, int n, float* planes) {
+            float rgba[CONVERT_CHUNK * 4];
+            HalfToFloatN(src, rgba, n * 4);
+            for (int i = 0; i < n; ++i) {
+                planes[i] = rgba[i * 4 + 0];
+                planes[n + i] = rgba[i * 4 + 1];
+                planes[2 * n + i] = rgba[i * 4 + 2];
+            }
+        }
+
+        void decodePQ10Planar(const uint32_t* src, int n, float* planes) {
+            constexpr float inv = 1.0f / 1023.0f;
+            for (int i = 0; i < n; ++i) {
+                uint32_t pixel = src[i];
+                planes[i] = static_cast<float>((pixel >> 20) & 0x3FF) * inv;
+                planes[n + i] = static_cast<float>((pixel >> 10) & 0x3FF) * inv;
+                planes[2 * n + i] = static_cast<float>(pixel & 0x3FF) * inv;
+            }
+        }
+
+        // 线性 [0, 1] -> sRGB 8bit（超出范围的值先钳制），量化时叠加蓝噪声阈值
+        void encodeSRGB8Planar(float* planes, int n, uint8_t* dst, const DitherRow& dither) {
+            ColorSpace::LinearToSRGBN(planes, planes, n * 3);
+            for (int i = 0; i < n; ++i) {
+                const float noise = dither.At(i);
+                dst[i * 3 + 0] = QuantizeDithered(planes[i], noise);
+                dst[i * 3 + 1] = QuantizeDithered(planes[n + i], noise);
+                dst[i * 3 + 2] = QuantizeDithered(planes[2 * n + i], noise);
+            }
+        }
+
+        // 一段平面 scRGB：色域映射、曝光与色调映射后编码为 sRGB 8bit（FP16 与 RGB9E5 共用）
+        template<class ToneMap>
+        void toneMapScRGBPlanar(float* planes, int n, uint8_t* dst, const ToneCurve& curve, const DitherRow& dither) {
+            ColorSpace::MapGamutPlanar(planes, planes + n, planes + 2 * n, n, curve.gamut);
+
+            for (int i = 0; i < n; ++i) {
+                float r = planes[i] * curve.exposure;
+                float g = planes[n + i] * curve.exposure;
+                float b = planes[2 * n + i] * curve.exposure;
+
+                // Tone mapping
+                ToneMap::Apply(r, g, b, curve);
+
+                planes[i] = r;
+                planes[n + i] = g;
+                planes[2 * n + i] = b;
+            }
+
+            encodeSRGB8Planar(planes, n, dst, dither);
+        }
+
+        // ---- 3D LUT ----------------------------------------------------------
+        // LUT 输入统一为 Rec.2020 原色的 PQ 编码：HDR10 的码值本身就是；scRGB（FP16 / RGB9E5）先换到
+        // Rec.2020 原色，再按半精度位模式查表得到 PQ。2020 -> 709、色域映射与色调映射都烘焙在格点里，
+        // 三种格式共用同一个 "PQ Rec.2020 -> sRGB 显示" 变换，可直接导出给调色使用。
+        // 色域边界与高光钳制处变换不光滑，跨越这些位置的格子插值误差大，烘焙时标记出来，
+        // 落在其中的像素改走解析内核（见 lutSegment）。
+
+        constexpr int HALF_TO_PQ_SHIFT = 3;     // 按半精度高 12 位查表（相对误差 < 0.4%）
+        constexpr float LUT_CELL_TOLERANCE = 2.0f / 255.0f;    // 格内检查点的插值误差超过该值即回退解析路径
+
+        const float* halfToPQTable() {
+            static const std::vector<float> table = [] {
+                std::vector<float> t((0x7FFF >> HALF_TO_PQ_SHIFT) + 1);
+                for (size_t i = 0; i < t.size(); ++i) {
+                    // 取桶中点，Inf/NaN 按 10000 nits 处理
+                    uint16_t h = static_cast<uint16_t>((i << HALF_TO_PQ_SHIFT) | (1u << (HALF_TO_PQ_SHIFT - 1)));
+                    float v = HalfToFloat(h);
+                    t[i] = std::isfinite(v) ? LinearToPQ(v * SCRGB_UNIT_NITS) : 1.0f;
+                }
+                return t;
+            }();
+            return table.data();
+        }
+
+        // scRGB 线性值按半精度位模式的高位查 halfToPQTable（截断而非舍入）
+        inline float scRGBToPQCoord(float v, const float* shaper) {
+            if (!(v > 0.0f)) return 0.0f;
+            uint16_t h;
+            if (v >= 65504.0f) {
+                h = 0x7BFF;
+            } else if (v < 6.103515625e-05f) {
+                h = static_cast<uint16_t>(v * 16777216.0f);     // 非规格化：尾数 = v / 2^-24
+            } else {
+                uint32_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                h = static_cast<uint16_t>((bits >> 13) - (112u << 10));
+            }
+            return shaper[h >> HALF_TO_PQ_SHIFT];
+        }
+
+        // 烘焙结果：LUT 本体 + 需回退解析路径的格子
+        struct BakedLUT {
+            ColorLUT3D lut;
+            int cells = 0;                          // 每维格子数 = size - 1
+            std::vector<uint8_t> analyticCells;     // cells^3，空表示不回退（叠加外部 look 时解析路径无法复现）
+            size_t analyticCount = 0;
+
+            // 与 ColorLUT3D 插值时的格子选择一致
+            size_t CellIndex(const float* c) const {
+                size_t index = 0;
+                for (int k = 2; k >= 0; --k) {
+                    const int i = std::min(static_cast<int>(std::clamp(c[k], 0.0f, 1.0f) * static_cast<float>(cells)), cells - 1);
+                    index = index * cells + i;
+                }
+                return index;
+            }
+        };
+
+        template<class Pixel>
+        using AnalyticKernel = void (*)(const Pixel* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither);
+
+        constexpr int LUT_CHUNK = 256;          // 每次先生成一段坐标再批量插值
+
+        // 一段像素先整体查 LUT，再把需回退的像素（fallback 预先标记的，或落在 analyticCells 里的）
+        // 按连续区间交给解析内核覆盖，这些像素与解析路径逐字节一致。返回回退的像素数
+        template<class Pixel>
+        int lutSegment(const BakedLUT& baked, const float* coords, uint8_t* fallback, int n, const Pixel* src, int channels,
+            uint8_t* dst, AnalyticKernel<Pixel> analytic, const ToneCurve& curve, const DitherRow& dither)
+        {
+            baked.lut.ApplyRGB8(coords, dst, n, dither);
+            if (!baked.analyticCells.empty()) {
+                for (int i = 0; i < n; ++i) {
+                    fallback[i] |= baked.analyticCells[baked.CellIndex(coords + i * 3)];
+                }
+            }
+            int total = 0;
+            for (int i = 0; i < n;) {
+                if (!fallback[i]) {
+                    ++i;
+                    continue;
+                }
+                int j = i + 1;
+                while (j < n && fallback[j]) ++j;
+                analytic(src + i * channels, dst + i * 3, j - i, curve, DitherRow{ dither.noise, dither.x + i });
+                total += j - i;
+                i = j;
+            }
+            return total;
+        }
+
+        // 平面 Rec.2020 scRGB -> PQ 坐标；Rec.2020 色域之外的颜色（出现负分量，极少见）标记为回退
+        void scRGB2020ToCoords(const float* planes, int n, float* coords, uint8_t* fallback, const float* shaper) {
+            for (int i = 0; i < n; ++i) {
+                const float r = planes[i];
+                const float g = planes[n + i];
+                const float b = planes[2 * n + i];
+                fallback[i] = (r < 0.0f || g < 0.0f || b < 0.0f) ? 1 : 0;
+                coords[i * 3 + 0] = scRGBToPQCoord(r, shaper);
+                coords[i * 3 + 1] = scRGBToPQCoord(g, shaper);
+                coords[i * 3 + 2] = scRGBToPQCoord(b, shaper);
+            }
+        }
+
+        int lutHDR16(const uint16_t* src, uint8_t* dst, int count, const BakedLUT& baked,
+            AnalyticKernel<uint16_t> analytic, const ToneCurve& curve, const DitherRow& dither)
+        {
+            int fallbacks = 0;
+            const float* shaper = halfToPQTable();
+            float planes[LUT_CHUNK * 3];
+            float coords[LUT_CHUNK * 3];
+            uint8_t fallback[LUT_CHUNK];
+            for (int x0 = 0; x0 < count; x0 += LUT_CHUNK) {
+                const int n = std::min(LUT_CHUNK, count - x0);
+                decodeHalfPlanar(src + x0 * 4, n, planes);
+                ColorSpace::ConvertGamutPlanar(ColorGamut::Rec709, ColorGamut::Rec2020, planes, planes + n, planes + 2 * n, n);
+                scRGB2020ToCoords(planes, n, coords, fallback, shaper);
+                fallbacks += lutSegment(baked, coords, fallback, n, src + x0 * 4, 4, dst + x0 * 3, analytic, curve,
+                    DitherRow{ dither.noise, dither.x + x0 });
+            }
+            return fallbacks;
+        }
+
+        int lutE5(const uint32_t* src, uint8_t* dst, int count, const BakedLUT& baked,
+            AnalyticKernel<uint32_t> analytic, const ToneCurve& curve, const DitherRow& dither)
+        {
+            int fallbacks = 0;
+            const float* shaper = halfToPQTable();
+            float planes[LUT_CHUNK * 3];
+            float coords[LUT_CHUNK * 3];
+            uint8_t fallback[LUT_CHUNK];
+            for (int x0 = 0; x0 < count; x0 += LUT_CHUNK) {
+                const int n = std::min(LUT_CHUNK, count - x0);
+                // 缓存本身就是 Rec.2020 原色，直接解包，不经 709
+                UnpackRGB9E5Rec2020Planar(src + x0, n, planes);
+                scRGB2020ToCoords(planes, n, coords, fallback, shaper);
+                fallbacks += lutSegment(baked, coords, fallback, n, src + x0, 1, dst + x0 * 3, analytic, curve,
+                    DitherRow{ dither.noise, dither.x + x0 });
+            }
+            return fallbacks;
+        }
+
+        int lutHDR10(const uint32_t* src, uint8_t* dst, int count, const BakedLUT& baked,
+            AnalyticKernel<uint32_t> analytic, const ToneCurve& curve, const DitherRow& dither)
+        {
+            int fallbacks = 0;
+            constexpr float inv = 1.0f / 1023.0f;
+            float coords[LUT_CHUNK * 3];
+            uint8_t fallback[LUT_CHUNK];
+            for (int x0 = 0; x0 < count; x0 += LUT_CHUNK) {
+                const int n = std::min(LUT_CHUNK, count - x0);
+                for (int i = 0; i < n; ++i) {
+                    uint32_t pixel = src[x0 + i];
+                    coords[i * 3 + 0] = static_cast<float>((pixel >> 20) & 0x3FF) * inv;
+                    coords[i * 3 + 1] = static_cast<float>((pixel >> 10) & 0x3FF) * inv;
+                    coords[i * 3 + 2] = static_cast<float>(pixel & 0x3FF) * inv;
+                    fallback[i] = 0;
+                }
+                fallbacks += lutSegment(baked, coords, fallback, n, src + x0, 1, dst + x0 * 3, analytic, curve,
+                    DitherRow{ dither.noise, dither.x + x0 });
+            }
+            return fallbacks;
+        }
+
+        // 格点输入：Rec.2020 PQ；HDR10 曲线以 nits 为单位，scRGB 曲线以 80 nits 为单位
+        template<class ToneMap>
+        void bakeTransform(float pr, float pg, float pb, float unitNits, const ToneCurve& curve, float* out) {
+            out[0] = PQToLinear(pr) / unitNits;
+            out[1] = PQToLinear(pg) / unitNits;
+            out[2] = PQToLinear(pb) / unitNits;
+            displayHDR10<ToneMap>(out[0], out[1], out[2], curve);
+        }
+
+        template<class ToneMap>
+        void bakeLUT(BakedLUT& baked, int size, bool hdr10, const ToneCurve& curve, const ColorLUT3D* look) {
+            const float unitNits = hdr10 ? 1.0f : SCRGB_UNIT_NITS;
+            baked.lut.Bake(size, [&](float pr, float pg, float pb, float* out) {
+                bakeTransform<ToneMap>(pr, pg, pb, unitNits, curve, out);
+                if (look) {
+                    look->Sample(out[0], out[1], out[2], out);
+                }
+            });
+
+            size = baked.lut.Size();
+            baked.cells = size - 1;
+            baked.analyticCells.clear();
+            baked.analyticCount = 0;
+            if (look) return;
+
+            // 各格点转到 709 后哪些分量为负、哪些分量被色域映射改变（ACES 压缩在色域内就开始介入）、
+            // 哪些分量被映射到 0
+            const float* m = ColorSpace::GamutMatrix(ColorGamut::Rec2020, ColorGamut::Rec709);
+            const float step = 1.0f / static_cast<float>(size - 1);
+            std::vector<uint16_t> mapped(static_cast<size_t>(size) * size * size);
+            ParallelFor(size, 1, [&](int b0, int b1, int) {
+                for (int b = b0; b < b1; ++b) {
+                    for (int g = 0; g < size; ++g) {
+                        for (int r = 0; r < size; ++r) {
+                            const float in[3] = { PQToLinear(r * step), PQToLinear(g * step), PQToLinear(b * step) };
+                            float rgb[3];
+                            for (int c = 0; c < 3; ++c) {
+                                rgb[c] = m[c * 3] * in[0] + m[c * 3 + 1] * in[1] + m[c * 3 + 2] * in[2];
+                            }
+                            float out[3] = { rgb[0], rgb[1], rgb[2] };
+                            ColorSpace::MapGamut(out[0], out[1], out[2], curve.gamut);
+                            uint16_t bits = 0;
+                            for (int c = 0; c < 3; ++c) {
+                                if (rgb[c] < 0.0f) bits |= 1u << c;
+                                if (out[c] != rgb[c]) bits |= 8u << c;
+                                if (out[c] <= 0.0f) bits |= 64u << c;
+                            }
+                            mapped[(static_cast<size_t>(b) * size + g) * size + r] = bits;
+                        }
+                    }
+                }
+            });
+
+            // 回退条件：8 个顶点的上述标记不一致（格子跨越色域边界或色域映射的起点），
+            // 或在中心、6 个面心与 12 个棱中点处插值与精确值之差超限。
+            // 这些点即步长减半的细格点，按 B 方向滚动保留 3 个平面，相邻格子共用
+            const int cells = baked.cells;
+            const int fine = 2 * cells + 1;
+            const float halfStep = 0.5f * step;
+            baked.analyticCells.assign(static_cast<size_t>(cells) * cells * cells, 0);
+            ParallelFor(cells, 1, [&](int b0, int b1, int) {
+                std::vector<float> planes[3];
+                auto fill = [&](std::vector<float>& plane, int fb) {
+                    plane.resize(static_cast<size_t>(fine) * fine * 3);
+                    for (int fg = 0; fg < fine; ++fg) {
+                        for (int fr = 0; fr < fine; ++fr) {
+                            bakeTransform<ToneMap>(fr * halfStep, fg * halfStep, fb * halfStep, unitNits, curve,
+                                plane.data() + (static_cast<size_t>(fg) * fine + fr) * 3);
+                        }
+                    }
+                };
+                fill(planes[0], 2 * b0);
+                for (int b = b0; b < b1; ++b) {
+                    fill(planes[1], 2 * b + 1);
+                    fill(planes[2], 2 * b + 2);
+                    for (int g = 0; g < cells; ++g) {
+                        for (int r = 0; r < cells; ++r) {
+                            uint16_t any = 0;
+                            uint16_t all = 0x1FF;
+                            for (int v = 0; v < 8; ++v) {
+                                const uint16_t bits = mapped[(static_cast<size_t>(b + (v >> 2)) * size + g + ((v >> 1) & 1)) * size + r + (v & 1)];
+                                any |= bits;
+                                all &= bits;
+                            }
+                            bool fallback = any != all;
+                            for (int k = 0; k < 27 && !fallback; ++k) {
+                                const int dr = k % 3, dg = (k / 3) % 3, db = k / 9;
+                                if ((dr != 1) + (dg != 1) + (db != 1) == 3) continue;     // 顶点
+                                const int fr = 2 * r + dr, fg = 2 * g + dg;
+                                const float* exact = planes[db].data() + (static_cast<size_t>(fg) * fine + fr) * 3;
+                                float sampled[3];
+                                baked.lut.Sample(fr * halfStep, fg * halfStep, (2 * b + db) * halfStep, sampled);
+                                for (int c = 0; c < 3; ++c) {
+                                    fallback |= std::fabs(exact[c] - sampled[c]) > LUT_CELL_TOLERANCE;
+                                }
+                            }
+                            baked.analyticCells[(static_cast<size_t>(b) * cells + g) * cells + r] = fallback ? 1 : 0;
+                        }
+                    }
+                    std::swap(planes[0], planes[2]);
+                }
+            });
+            baked.analyticCount = static_cast<size_t>(std::ranges::count(baked.analyticCells, uint8_t{ 1 }));
+        }
+
+        // 已烘焙 LUT 的缓存：键为格式 + 算子 + 曲线参数 + LUT 配置，
+        // 只有 Config 或显示器 HDR 元数据（及自动曝光结果）变化时才重新烘焙
+        struct LUTKey {
+            bool hdr10;
+            ToneMapOperator op;
+            GamutMapping gamut;
+            int size;
+            float exposure;
+            float white;
+            float targetNits;
+            std::string look;
+
+            bool operator==(const LUTKey&) const = default;
+        };
+
+        class LUTCache {
+        public:
+            std::shared_ptr<const BakedLUT> Acquire(const LUTKey& key, const ToneCurve& curve, const Config& config) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (const auto& entry : entries_) {
+                    if (entry.first == key) return entry.second;
+                }
+
+                const ColorLUT3D* look = loadLook(key.look);
+                auto lut = std::make_shared<BakedLUT>();
+                auto start = std::chrono::steady_clock::now();
+                WithToneMapPolicy(key.op, [&]<class ToneMap>() {
+                    bakeLUT<ToneMap>(*lut, key.size, key.hdr10, curve, look);
+                });
+                auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                Logger::Info(L"Baked {}^3 color LUT ({}, {}, exposure {:.5f}, {} of {} cells analytic) in {:.1f} ms",
+                    lut->lut.Size(), key.hdr10 ? L"HDR10" : L"scRGB", ToneMapOperatorName(key.op), key.exposure,
+                    lut->analyticCount, lut->analyticCells.size(), ms);
+
+                if (!config.colorLutExportFile.empty()) {
+                    std::vector<std::string> comments{
+                        "HDR Screenshot Tool baked transform, input: PQ (ST 2084) Rec.2020 primaries, output: sRGB display",
+                    };
+                    if (!lut->lut.SaveCube(utf8Path(config.colorLutExportFile), "HDR Screenshot Tool", comments)) {
+                        Logger::Warn(L"Failed to export color LUT");
+                    }
+                }
+
+                if (entries_.size() >= MAX_ENTRIES) entries_.erase(entries_.begin());
+                entries_.emplace_back(key, lut);
+                return lut;
+            }
+
+        private:
+            static constexpr size_t MAX_ENTRIES = 8;
+
+            static std::filesystem::path utf8Path(const std::string& s) {
+                return std::filesystem::path(reinterpret_cast<const char8_t*>(s.c_str()));
+            }
+
+            const ColorLUT3D* loadLook(const std::string& path) {
+                if (path.empty()) return nullptr;
+                if (path != lookPath_) {
+                    lookPath_ = path;
+                    look_ = ColorLUT3D{};
+                    std::string error;
+                    if (look_.LoadCube(utf8Path(path), &error)) {
+                        Logger::Info(L"Loaded look LUT: {}^3", look_.Size());
+                    } else {
+                        Logger::Warn(L"Failed to load look LUT: {}", std::wstring(error.begin(), error.end()));
+                    }
+                }
+                return look_.Empty() ? nullptr : &look_;
+            }
+
+            std::mutex mutex_;
+            std::vector<std::pair<LUTKey, std::shared_ptr<const BakedLUT>>> entries_;
+            std::string lookPath_;
+            ColorLUT3D look_;
+        };
+
+        LUTCache& lutCache() {
+            static LUTCache cache;
+            return cache;
+        }
+
+        // ---- 吞吐量统计 --------------------------------------------------------
+        // 每次转换在 Debug 日志中记录耗时、MP/s 与 ns/像素，以及各路径处理的像素数，
+        // 用于在真实截图上比较算子 / LUT / 抖动等配置的开销
+
+        struct PathCounts {
+            uint64_t lut = 0;
+            uint64_t analytic = 0;
+            uint64_t sdr = 0;
+        };
+
+        void logThroughput(const wchar_t* what, int format, int width, int height,
+            std::chrono::steady_clock::time_point start, const PathCounts* counts)
+        {
+            const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const double pixels = static_cast<double>(width) * height;
+            const double mpps = ms > 0.0 ? pixels / (ms * 1000.0) : 0.0;
+            const double nsPerPixel = pixels > 0.0 ? ms * 1e6 / pixels : 0.0;
+            if (counts) {
+                Logger::Debug(L"{} format {} {}x{}: {:.2f} ms, {:.1f} MP/s, {:.2f} ns/px (lut {}, analytic {}, sdr {})",
+                    what, format, width, height, ms, mpps, nsPerPixel, counts->lut, counts->analytic, counts->sdr);
+            } else {
+                Logger::Debug(L"{} format {} {}x{}: {:.2f} ms, {:.1f} MP/s, {:.2f} ns/px",
+                    what, format, width, height, ms, mpps, nsPerPixel);
+            }
+        }
+
+    } // namespace
+
     bool PixelConvert::ConvertToRGB8(const ImageBuffer& in, ImageBuffer& out) {
         if (in.format == PixelFormat::RGB8) { 
             out = in; 
             return true; 
         }
         
+        const auto start = std::chrono::steady_clock::now();
         out.format = PixelFormat::RGB8; 
         out.width = in.width; 
         out.height = in.height; 
@@ -29,36 +561,304 @@ namespace screenshot_tool {
         case PixelFormat::RGBA10A2:
             convertRGBA10A2ToRGB8(in, out);
             break;
+        case PixelFormat::RGB9E5:
+            convertRGB9E5ToRGB8(in, out);
+            break;
         default:
             Logger::Error(L"Unsupported input format for conversion");
             return false;
         }
         
+        logThroughput(L"ConvertToRGB8", static_cast<int>(in.format), in.width, in.height, start, nullptr);
         return true;
     }
 
-    bool PixelConvert::ToSRGB8(DXGI_FORMAT fmt, ImageBuffer& buffer, bool isHDR, const Config* config) {
-        switch (fmt) {
-        case DXGI_FORMAT_R16G16B16A16_FLOAT:
-            if (isHDR) {
-                processHDR16Float(buffer, config);
-            } else {
-                processSDR16Float(buffer);
+    void PixelConvert::WidenBGRA8ToF16(const uint8_t* src, uint16_t* dst, int count) {
+        // sRGB 8bit 码值 -> 线性 FP16
+        static const std::array<uint16_t, 256> table = [] {
+            std::array<uint16_t, 256> t{};
+            for (int i = 0; i < 256; ++i) {
+                float c = static_cast<float>(i) / 255.0f;
+                float linear = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+                t[i] = FloatToHalf(linear);
             }
-            break;
-        case DXGI_FORMAT_R10G10B10A2_UNORM:
-            if (isHDR) {
-                processHDR10(buffer, config);
-            } else {
-                processSDR10(buffer);
+            return t;
+        }();
+        const uint16_t one = FloatToHalf(1.0f);
+
+        for (int i = 0; i < count; ++i) {
+            dst[i * 4 + 0] = table[src[i * 4 + 2]];
+            dst[i * 4 + 1] = table[src[i * 4 + 1]];
+            dst[i * 4 + 2] = table[src[i * 4 + 0]];
+            dst[i * 4 + 3] = one;
+        }
+    }
+
+    void PixelConvert::convertRect(PixelFormat fmt, const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride,
+        int width, int height, const ToneMapRegions& regions, int ditherX, int ditherY, const Config* config)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // 算子只在这里选择一次；每组显示器参数的曲线预先算好
+        const ToneMapOperator op = ParseToneMapOperator(config ? config->toneMapper : std::string());
+        HDR16Kernel hdr16 = nullptr;
+        HDR10Kernel hdr10 = nullptr;
+        HDRE5Kernel hdrE5 = nullptr;
+        selectKernels(op, hdr16, hdr10, hdrE5);
+
+        const bool isHDR10 = (fmt == PixelFormat::RGBA10A2);
+        const bool ditherEnabled = !config || config->dither;
+        std::vector<ToneCurve> curves(regions.ParamCount());
+        std::vector<std::shared_ptr<const BakedLUT>> luts(regions.ParamCount());
+        for (uint32_t i = 0; i < regions.ParamCount(); ++i) {
+            curves[i] = curveFor(op, regions.Params(i), config, isHDR10 ? 1.0f : SCRGB_UNIT_NITS);
+            if (config && config->colorLutSize > 0 && regions.Params(i).hdr && IsHDRCapableFormat(fmt)) {
+                LUTKey key{ isHDR10, op, curves[i].gamut, config->colorLutSize, curves[i].exposure, curves[i].white,
+                    curves[i].targetNits, config->colorLookFile };
+                luts[i] = lutCache().Acquire(key, curves[i], *config);
+            }
+        }
+
+        // 单遍转换：逐行推进带指针，按区间选择该显示器的参数
+        const auto& bands = regions.Bands();
+        PathCounts counts;
+        size_t band = 0;
+        for (int y = 0; y < height; ++y) {
+            while (y >= bands[band].y1) ++band;
+            const uint8_t* srcRow = src + static_cast<size_t>(y) * srcStride;
+            uint8_t* dstRow = dst + static_cast<size_t>(y) * dstStride;
+
+            const float* noise = Dither::Row(ditherY + y, ditherEnabled);
+
+            const ToneMapRegions::Span* spans = regions.Spans(bands[band]);
+            for (uint32_t i = 0; i < bands[band].spanCount; ++i) {
+                const auto& span = spans[i];
+                const ToneMapParams& params = regions.Params(span.param);
+                const int count = span.x1 - span.x0;
+                uint8_t* out = dstRow + span.x0 * 3;
+                const DitherRow dither{ noise, ditherX + span.x0 };
+
+                switch (fmt) {
+                case PixelFormat::RGBA_F16: {
+                    const auto* in = reinterpret_cast<const uint16_t*>(srcRow) + span.x0 * 4;
+                    if (luts[span.param]) {
+                        const int fallbacks = lutHDR16(in, out, count, *luts[span.param], hdr16, curves[span.param], dither);
+                        counts.lut += count - fallbacks;
+                        counts.analytic += fallbacks;
+                    } else if (params.hdr) {
+                        hdr16(in, out, count, curves[span.param], dither);
+                        counts.analytic += count;
+                    } else {
+                        processSDR16Float(in, out, count, dither);
+                        counts.sdr += count;
+                    }
+                    break;
+                }
+                case PixelFormat::RGBA10A2: {
+                    const auto* in = reinterpret_cast<const uint32_t*>(srcRow) + span.x0;
+                    if (luts[span.param]) {
+                        const int fallbacks = lutHDR10(in, out, count, *luts[span.param], hdr10, curves[span.param], dither);
+                        counts.lut += count - fallbacks;
+                        counts.analytic += fallbacks;
+                    } else if (params.hdr) {
+                        hdr10(in, out, count, curves[span.param], dither);
+                        counts.analytic += count;
+                    } else {
+                        processSDR10(in, out, count, dither);
+                        counts.sdr += count;
+                    }
+                    break;
+                }
+                case PixelFormat::RGB9E5: {
+                    const auto* in = reinterpret_cast<const uint32_t*>(srcRow) + span.x0;
+                    if (luts[span.param]) {
+                        const int fallbacks = lutE5(in, out, count, *luts[span.param], hdrE5, curves[span.param], dither);
+                        counts.lut += count - fallbacks;
+                        counts.analytic += fallbacks;
+                    } else if (params.hdr) {
+                        hdrE5(in, out, count, curves[span.param], dither);
+                        counts.analytic += count;
+                    } else {
+                        processSDRE5(in, out, count, dither);
+                        counts.sdr += count;
+                    }
+                    break;
+                }
+                default:
+                    processSDR(srcRow + span.x0 * 4, out, count);
+                    counts.sdr += count;
+                    break;
+                }
             }
-            break;
-        default:
-            processSDR(buffer);
-            break;
         }
+
+        logThroughput(L"ToSRGB8", static_cast<int>(fmt), width, height, start, &counts);
+    }
+
+    bool PixelConvert::ToSRGB8(PixelFormat fmt, ImageBuffer& buffer, bool isHDR, const Config* config) {
+        ToneMapParams params;
+        params.hdr = isHDR;
+        return ToSRGB8(fmt, buffer, ToneMapRegions::Uniform(params, buffer.width, buffer.height), config);
+    }
+
+    bool PixelConvert::ToSRGB8(PixelFormat fmt, ImageBuffer& buffer, const ToneMapRegions& regions, const Config* config) {
+        TraceScope trace("PixelConvert::ToSRGB8");
+        if (buffer.format == PixelFormat::RGB8) {
+            return true; // GDI 回退路径的缓存已是 RGB8
+        }
+        if (buffer.width <= 0 || buffer.height <= 0) {
+            return false;
+        }
+        if (!regions.Matches(buffer.width, buffer.height)) {
+            Logger::Warn(L"Tone map regions do not match buffer {}x{}, using uniform SDR", buffer.width, buffer.height);
+            return ToSRGB8(fmt, buffer, false, config);
+        }
+
+        const int dstStride = buffer.width * 3;
+        std::vector<uint8_t> rgbBuffer(static_cast<size_t>(dstStride) * buffer.height);
+        convertRect(fmt, buffer.data.data(), buffer.stride, rgbBuffer.data(), dstStride, buffer.width, buffer.height,
+            regions, 0, 0, config);
+
+        buffer.format = PixelFormat::RGB8;
+        buffer.stride = dstStride;
+        buffer.data = std::move(rgbBuffer);
         return true;
     }
+
+    bool PixelConvert::ToSRGB8(PixelFormat fmt, const ImageBuffer& src, int srcX, int srcY, int width, int height,
+        const ToneMapRegions& regions, ImageBuffer& out, int dstX, int dstY, int ditherX, int ditherY, const Config* config)
+    {
+        TraceScope trace("PixelConvert::ToSRGB8");
+        if (width <= 0 || height <= 0 || srcX < 0 || srcY < 0 || srcX + width > src.width || srcY + height > src.height ||
+            out.format != PixelFormat::RGB8 || dstX < 0 || dstY < 0 || dstX + width > out.width || dstY + height > out.height) {
+            return false;
+        }
+        const int bpp = BytesPerPixel(src.format);
+        const uint8_t* from = src.data.data() + static_cast<size_t>(srcY) * src.stride + static_cast<size_t>(srcX) * bpp;
+        uint8_t* to = out.data.data() + static_cast<size_t>(dstY) * out.stride + static_cast<size_t>(dstX) * 3;
+        if (src.format == PixelFormat::RGB8) {
+            for (int y = 0; y < height; ++y) {
+                memcpy(to + static_cast<size_t>(y) * out.stride, from + static_cast<size_t>(y) * src.stride, static_cast<size_t>(width) * 3);
+            }
+            return true; // GDI 回退路径的块已是 RGB8
+        }
+        if (!regions.Matches(width, height)) {
+            Logger::Warn(L"Tone map regions do not match rectangle {}x{}", width, height);
+            return false;
+        }
+        convertRect(fmt, from, src.stride, to, out.stride, width, height, regions, ditherX, ditherY, config);
+        return true;
+    }
+
+    void PixelConvert::ApplyAutoExposure(PixelFormat fmt, const ImageBuffer& buffer, ToneMapRegions& regions, const Config* config) {
+        TraceScope trace("PixelConvert::ApplyAutoExposure");
+        if (!config || !config->autoExposure) return;
+        if (!IsHDRCapableFormat(fmt)) return;
+        if (buffer.format == PixelFormat::RGB8 || !regions.Matches(buffer.width, buffer.height) || !regions.AnyHDR()) return;
+
+        const uint32_t paramCount = regions.ParamCount();
+        const int sampledRows = (buffer.height + AUTO_EXPOSURE_ROW_STEP - 1) / AUTO_EXPOSURE_ROW_STEP;
+        std::vector<LuminanceHistogram> histograms(static_cast<size_t>(ParallelWorkerCount()) * paramCount);
+
+        // 抽样行只读取约 1/4 的缓存行，解码与累加在同一循环内完成；每个 worker 写自己的直方图
+        ParallelFor(sampledRows, 16, [&](int r0, int r1, int worker) {
+            LuminanceHistogram* local = &histograms[static_cast<size_t>(worker) * paramCount];
+            for (int r = r0; r < r1; ++r) {
+                const int y = r * AUTO_EXPOSURE_ROW_STEP;
+                const auto& band = regions.BandAt(y);
+                const uint8_t* srcRow = buffer.data.data() + static_cast<size_t>(y) * buffer.stride;
+                const ToneMapRegions::Span* spans = regions.Spans(band);
+
+                for (uint32_t i = 0; i < band.spanCount; ++i) {
+                    const auto& span = spans[i];
+                    if (!regions.Params(span.param).hdr) continue;
+                    if (fmt == PixelFormat::RGBA_F16) {
+                        accumulate16F(reinterpret_cast<const uint16_t*>(srcRow) + span.x0 * 4, span.x1 - span.x0, local[span.param]);
+                    } else if (fmt == PixelFormat::RGB9E5) {
+                        accumulateE5(reinterpret_cast<const uint32_t*>(srcRow) + span.x0, span.x1 - span.x0, local[span.param]);
+                    } else {
+                        accumulateHDR10(reinterpret_cast<const uint32_t*>(srcRow) + span.x0, span.x1 - span.x0, local[span.param]);
+                    }
+                }
+            }
+        });
+
+        for (uint32_t p = 0; p < paramCount; ++p) {
+            ToneMapParams params = regions.Params(p);
+            if (!params.hdr) continue;
+
+            LuminanceHistogram merged;
+            for (int w = 0; w < ParallelWorkerCount(); ++w) {
+                merged.Merge(histograms[static_cast<size_t>(w) * paramCount + p]);
+            }
+            if (!merged.DeriveExposure(config->autoExposureKeyPercentile, config->autoExposureWhitePercentile,
+                params.exposure, params.whiteNits)) {
+                continue;
+            }
+            // 直方图随画面细微变化，不量化则每帧得到新的曲线参数，LUT 缓存键永远不命中、每次重新烘焙；
+            // 1/64 EV 远低于可察觉的亮度差
+            params.exposure = quantizeEV(params.exposure);
+            params.whiteNits = quantizeEV(params.whiteNits);
+            regions.SetParams(p, params);
+            Logger::Debug(L"Auto exposure [{}]: {} samples, exposure {:.5f}/nit, white {:.1f} nits",
+                p, merged.Count(), params.exposure, params.whiteNits);
+        }
+    }
+
+    uint64_t PixelConvert::SettingsHash(const Config* config) {
+        // FNV-1a；字符串连同结尾的 0 一起计入，避免相邻字段拼接产生歧义
+        uint64_t h = 14695981039346656037ull;
+        auto mix = [&h](const void* data, size_t bytes) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < bytes; ++i) {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+        };
+        auto mixString = [&mix](const std::string& s) { mix(s.c_str(), s.size() + 1); };
+
+        const Config defaults;
+        const Config& c = config ? *config : defaults;
+        const uint8_t hasConfig = config ? 1 : 0;
+        const uint8_t dither = c.dither ? 1 : 0;
+        mix(&hasConfig, sizeof(hasConfig));
+        mixString(c.toneMapper);
+        mixString(c.gamutMapping);
+        mix(&c.sdrBrightness, sizeof(c.sdrBrightness));
+        mix(&c.colorLutSize, sizeof(c.colorLutSize));
+        mixString(c.colorLookFile);
+        mix(&dither, sizeof(dither));
+        return h;
+    }
+
+    void PixelConvert::selectKernels(ToneMapOperator op, HDR16Kernel& hdr16, HDR10Kernel& hdr10, HDRE5Kernel& hdrE5) {
+        WithToneMapPolicy(op, [&]<class ToneMap>() {
+            hdr16 = &processHDR16Float<ToneMap>;
+            hdr10 = &processHDR10<ToneMap>;
+            hdrE5 = &processHDRE5<ToneMap>;
+        });
+    }
+
+    ToneCurve PixelConvert::curveFor(ToneMapOperator op, const ToneMapParams& params, const Config* config, float unitNits) {
+        ToneCurve curve;
+        curve.targetNits = config ? config->sdrBrightness : 250.0f;
+        curve.gamut = ParseGamutMapping(config ? config->gamutMapping : std::string());
+
+        if (params.exposure > 0.0f) {
+            curve.exposure = params.exposure * unitNits;
+            curve.white = params.whiteNits * params.exposure;
+            PrepareToneCurve(op, curve, true);
+            return curve;
+        }
+
+        // 显示器未报告有效峰值亮度时按 1000 nits 处理
+        float maxNits = params.maxNits > 0.0f ? params.maxNits : 1000.0f;
+        // 色调映射输入统一按 scRGB 刻度（1.0 = 80 nits），PQ 解码得到的 nits 需再除以 80
+        curve.exposure = curve.targetNits / maxNits * unitNits / SCRGB_UNIT_NITS;
+        curve.white = maxNits / unitNits * curve.exposure;   // 显示器峰值在色调映射输入中的位置
+        PrepareToneCurve(op, curve, false);
+        return curve;
+    }
     
     void PixelConvert::convertBGRA8ToRGB8(const ImageBuffer& in, ImageBuffer& out) {
         for (int y = 0; y < in.height; ++y) {
@@ -76,238 +876,121 @@ namespace screenshot_tool {
     void PixelConvert::convertRGBA16FToRGB8(const ImageBuffer& in, ImageBuffer& out) {
         for (int y = 0; y < in.height; ++y) {
             const auto* srcRow = reinterpret_cast<const uint16_t*>(in.data.data() + y * in.stride);
-            auto* dstRow = out.data.data() + y * out.stride;
-            
-            for (int x = 0; x < in.width; ++x) {
-                float r = HalfToFloat(srcRow[x * 4 + 0]);
-                float g = HalfToFloat(srcRow[x * 4 + 1]);
-                float b = HalfToFloat(srcRow[x * 4 + 2]);
-                
-                // Clamp to 0-1 range for SDR
-                r = std::clamp(r, 0.0f, 1.0f);
-                g = std::clamp(g, 0.0f, 1.0f);
-                b = std::clamp(b, 0.0f, 1.0f);
-                
-                // Apply gamma correction
-                r = LinearToSRGB(r);
-                g = LinearToSRGB(g);
-                b = LinearToSRGB(b);
-                
-                dstRow[x * 3 + 0] = static_cast<uint8_t>(r * 255.0f + 0.5f);
-                dstRow[x * 3 + 1] = static_cast<uint8_t>(g * 255.0f + 0.5f);
-                dstRow[x * 3 + 2] = static_cast<uint8_t>(b * 255.0f + 0.5f);
-            }
+            processSDR16Float(srcRow, out.data.data() + y * out.stride, in.width, DitherRow{ Dither::Row(y), 0 });
         }
     }
     
     void PixelConvert::convertRGBA10A2ToRGB8(const ImageBuffer& in, ImageBuffer& out) {
         for (int y = 0; y < in.height; ++y) {
             const auto* srcRow = reinterpret_cast<const uint32_t*>(in.data.data() + y * in.stride);
-            auto* dstRow = out.data.data() + y * out.stride;
-            
-            for (int x = 0; x < in.width; ++x) {
-                uint32_t pixel = srcRow[x];
-                uint32_t r10 = (pixel >> 20) & 0x3FF;
-                uint32_t g10 = (pixel >> 10) & 0x3FF;
-                uint32_t b10 = pixel & 0x3FF;
-                
-                // SDR模式下简单缩放
-                float r = static_cast<float>(r10) / 1023.0f;
-                float g = static_cast<float>(g10) / 1023.0f;
-                float b = static_cast<float>(b10) / 1023.0f;
-                
-                dstRow[x * 3 + 0] = static_cast<uint8_t>(r * 255.0f + 0.5f);
-                dstRow[x * 3 + 1] = static_cast<uint8_t>(g * 255.0f + 0.5f);
-                dstRow[x * 3 + 2] = static_cast<uint8_t>(b * 255.0f + 0.5f);
-            }
+            processSDR10(srcRow, out.data.data() + y * out.stride, in.width, DitherRow{ Dither::Row(y), 0 });
         }
     }
     
-    void PixelConvert::processHDR16Float(ImageBuffer& buffer, const Config* config) {
-        // Convert in-place from RGBA16F to RGB8
-        const int pixelCount = buffer.width * buffer.height;
-        std::vector<uint8_t> rgbBuffer(pixelCount * 3);
-        
-        float targetNits = config ? config->sdrBrightness : 250.0f;
-        float maxNits = 1000.0f; // Default HDR max
-        float exposure = targetNits / maxNits;
-        
-        for (int y = 0; y < buffer.height; ++y) {
-            const auto* srcRow = reinterpret_cast<const uint16_t*>(buffer.data.data() + y * buffer.stride);
-            auto* dstRow = rgbBuffer.data() + y * buffer.width * 3;
-            
-            for (int x = 0; x < buffer.width; ++x) {
-                float r = HalfToFloat(srcRow[x * 4 + 0]) * exposure;
-                float g = HalfToFloat(srcRow[x * 4 + 1]) * exposure;
-                float b = HalfToFloat(srcRow[x * 4 + 2]) * exposure;
-                
-                // Tone mapping
-                if (config && config->useACESFilmToneMapping) {
-                    float rgb[3] = {r, g, b};
-                    ToneMap_ACES(rgb, rgb, 1);
-                    r = rgb[0]; g = rgb[1]; b = rgb[2];
-                } else {
-                    r = r / (1.0f + r);
-                    g = g / (1.0f + g);
-                    b = b / (1.0f + b);
-                }
-                
-                // sRGB gamma correction
-                r = LinearToSRGB(r);
-                g = LinearToSRGB(g);
-                b = LinearToSRGB(b);
-                
-                dstRow[x * 3 + 0] = static_cast<uint8_t>(std::clamp(r * 255.0f + 0.5f, 0.0f, 255.0f));
-                dstRow[x * 3 + 1] = static_cast<uint8_t>(std::clamp(g * 255.0f + 0.5f, 0.0f, 255.0f));
-                dstRow[x * 3 + 2] = static_cast<uint8_t>(std::clamp(b * 255.0f + 0.5f, 0.0f, 255.0f));
-            }
+    void PixelConvert::convertRGB9E5ToRGB8(const ImageBuffer& in, ImageBuffer& out) {
+        for (int y = 0; y < in.height; ++y) {
+            const auto* srcRow = reinterpret_cast<const uint32_t*>(in.data.data() + y * in.stride);
+            processSDRE5(srcRow, out.data.data() + y * out.stride, in.width, DitherRow{ Dither::Row(y), 0 });
         }
-        
-        // Update buffer
-        buffer.format = PixelFormat::RGB8;
-        buffer.stride = buffer.width * 3;
-        buffer.data = std::move(rgbBuffer);
     }
     
-    void PixelConvert::processSDR16Float(ImageBuffer& buffer) {
-        const int pixelCount = buffer.width * buffer.height;
-        std::vector<uint8_t> rgbBuffer(pixelCount * 3);
-        
-        for (int y = 0; y < buffer.height; ++y) {
-            const auto* srcRow = reinterpret_cast<const uint16_t*>(buffer.data.data() + y * buffer.stride);
-            auto* dstRow = rgbBuffer.data() + y * buffer.width * 3;
-            
-            for (int x = 0; x < buffer.width; ++x) {
-                float r = HalfToFloat(srcRow[x * 4 + 0]);
-                float g = HalfToFloat(srcRow[x * 4 + 1]);
-                float b = HalfToFloat(srcRow[x * 4 + 2]);
-                
-                // SDR模式下直接钳制到0-1
-                r = std::clamp(r, 0.0f, 1.0f);
-                g = std::clamp(g, 0.0f, 1.0f);
-                b = std::clamp(b, 0.0f, 1.0f);
-                
-                // 应用伽马校正
-                r = LinearToSRGB(r);
-                g = LinearToSRGB(g);
-                b = LinearToSRGB(b);
-                
-                dstRow[x * 3 + 0] = static_cast<uint8_t>(r * 255.0f + 0.5f);
-                dstRow[x * 3 + 1] = static_cast<uint8_t>(g * 255.0f + 0.5f);
-                dstRow[x * 3 + 2] = static_cast<uint8_t>(b * 255.0f + 0.5f);
-            }
+    template<class ToneMap>
+    void PixelConvert::processHDR16Float(const uint16_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither) {
+        float planes[CONVERT_CHUNK * 3];
+        for (int x0 = 0; x0 < count; x0 += CONVERT_CHUNK) {
+            const int n = std::min(CONVERT_CHUNK, count - x0);
+            decodeHalfPlanar(src + x0 * 4, n, planes);
+            toneMapScRGBPlanar<ToneMap>(planes, n, dst + x0 * 3, curve, DitherRow{ dither.noise, dither.x + x0 });
         }
-        
-        // Update buffer
-        buffer.format = PixelFormat::RGB8;
-        buffer.stride = buffer.width * 3;
-        buffer.data = std::move(rgbBuffer);
     }
     
-    void PixelConvert::processHDR10(ImageBuffer& buffer, const Config* config) {
-        const int pixelCount = buffer.width * buffer.height;
-        std::vector<uint8_t> rgbBuffer(pixelCount * 3);
-        
-        float targetNits = config ? config->sdrBrightness : 250.0f;
-        float maxNits = 1000.0f; // Default HDR content light level
-        float exposure = targetNits / maxNits;
-        
-        for (int y = 0; y < buffer.height; ++y) {
-            const auto* srcRow = reinterpret_cast<const uint32_t*>(buffer.data.data() + y * buffer.stride);
-            auto* dstRow = rgbBuffer.data() + y * buffer.width * 3;
-            
-            for (int x = 0; x < buffer.width; ++x) {
-                uint32_t pixel = srcRow[x];
-                uint32_t r10 = (pixel >> 20) & 0x3FF;
-                uint32_t g10 = (pixel >> 10) & 0x3FF;
-                uint32_t b10 = pixel & 0x3FF;
-                
-                // PQ解码到线性光域（nits）
-                float r = PQToLinear(static_cast<float>(r10) / 1023.0f) * exposure;
-                float g = PQToLinear(static_cast<float>(g10) / 1023.0f) * exposure;
-                float b = PQToLinear(static_cast<float>(b10) / 1023.0f) * exposure;
-                
-                // Rec.2020 到 sRGB 色域转换
-                ColorSpace::Rec2020ToSRGB(r, g, b);
-                
+    void PixelConvert::processSDR16Float(const uint16_t* src, uint8_t* dst, int count, const DitherRow& dither) {
+        float planes[CONVERT_CHUNK * 3];
+        for (int x0 = 0; x0 < count; x0 += CONVERT_CHUNK) {
+            const int n = std::min(CONVERT_CHUNK, count - x0);
+            decodeHalfPlanar(src + x0 * 4, n, planes);
+
+            // SDR模式下直接钳制到0-1并做伽马校正
+            encodeSRGB8Planar(planes, n, dst + x0 * 3, DitherRow{ dither.noise, dither.x + x0 });
+        }
+    }
+    
+    template<class ToneMap>
+    void PixelConvert::processHDR10(const uint32_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither) {
+        float planes[CONVERT_CHUNK * 3];
+        for (int x0 = 0; x0 < count; x0 += CONVERT_CHUNK) {
+            const int n = std::min(CONVERT_CHUNK, count - x0);
+            float* r = planes;
+            float* g = planes + n;
+            float* b = planes + 2 * n;
+
+            // PQ解码到线性光域（nits），再从 Rec.2020 转到 sRGB 原色
+            decodePQ10Planar(src + x0, n, planes);
+            ColorSpace::PQToLinearN(planes, planes, n * 3);
+            ColorSpace::ConvertGamutPlanar(ColorGamut::Rec2020, ColorGamut::Rec709, r, g, b, n);
+            ColorSpace::MapGamutPlanar(r, g, b, n, curve.gamut);
+
+            for (int i = 0; i < n; ++i) {
+                float vr = r[i] * curve.exposure;
+                float vg = g[i] * curve.exposure;
+                float vb = b[i] * curve.exposure;
+
                 // 非线性色调映射
-                if (config && config->useACESFilmToneMapping) {
-                    float rgb[3] = {r, g, b};
-                    ToneMap_ACES(rgb, rgb, 1);
-                    r = rgb[0]; g = rgb[1]; b = rgb[2];
-                } else {
-                    r = r / (1.0f + r);
-                    g = g / (1.0f + g);
-                    b = b / (1.0f + b);
-                }
-                
-                // sRGB伽马校正
-                r = LinearToSRGB(std::clamp(r, 0.0f, 1.0f));
-                g = LinearToSRGB(std::clamp(g, 0.0f, 1.0f));
-                b = LinearToSRGB(std::clamp(b, 0.0f, 1.0f));
-                
-                dstRow[x * 3 + 0] = static_cast<uint8_t>(r * 255.0f + 0.5f);
-                dstRow[x * 3 + 1] = static_cast<uint8_t>(g * 255.0f + 0.5f);
-                dstRow[x * 3 + 2] = static_cast<uint8_t>(b * 255.0f + 0.5f);
+                ToneMap::Apply(vr, vg, vb, curve);
+
+                r[i] = vr;
+                g[i] = vg;
+                b[i] = vb;
             }
+
+            encodeSRGB8Planar(planes, n, dst + x0 * 3, DitherRow{ dither.noise, dither.x + x0 });
         }
-        
-        // Update buffer
-        buffer.format = PixelFormat::RGB8;
-        buffer.stride = buffer.width * 3;
-        buffer.data = std::move(rgbBuffer);
     }
     
-    void PixelConvert::processSDR10(ImageBuffer& buffer) {
-        const int pixelCount = buffer.width * buffer.height;
-        std::vector<uint8_t> rgbBuffer(pixelCount * 3);
-        
-        for (int y = 0; y < buffer.height; ++y) {
-            const auto* srcRow = reinterpret_cast<const uint32_t*>(buffer.data.data() + y * buffer.stride);
-            auto* dstRow = rgbBuffer.data() + y * buffer.width * 3;
+    void PixelConvert::processSDR10(const uint32_t* src, uint8_t* dst, int count, const DitherRow& dither) {
+        for (int x = 0; x < count; ++x) {
+            uint32_t pixel = src[x];
+            uint32_t r10 = (pixel >> 20) & 0x3FF;
+            uint32_t g10 = (pixel >> 10) & 0x3FF;
+            uint32_t b10 = pixel & 0x3FF;
             
-            for (int x = 0; x < buffer.width; ++x) {
-                uint32_t pixel = srcRow[x];
-                uint32_t r10 = (pixel >> 20) & 0x3FF;
-                uint32_t g10 = (pixel >> 10) & 0x3FF;
-                uint32_t b10 = pixel & 0x3FF;
-                
-                // SDR模式下简单缩放
-                float r = static_cast<float>(r10) / 1023.0f;
-                float g = static_cast<float>(g10) / 1023.0f;
-                float b = static_cast<float>(b10) / 1023.0f;
-                
-                dstRow[x * 3 + 0] = static_cast<uint8_t>(r * 255.0f + 0.5f);
-                dstRow[x * 3 + 1] = static_cast<uint8_t>(g * 255.0f + 0.5f);
-                dstRow[x * 3 + 2] = static_cast<uint8_t>(b * 255.0f + 0.5f);
-            }
+            // SDR模式下简单缩放
+            float r = static_cast<float>(r10) / 1023.0f;
+            float g = static_cast<float>(g10) / 1023.0f;
+            float b = static_cast<float>(b10) / 1023.0f;
+            
+            const float noise = dither.At(x);
+            dst[x * 3 + 0] = QuantizeDithered(r, noise);
+            dst[x * 3 + 1] = QuantizeDithered(g, noise);
+            dst[x * 3 + 2] = QuantizeDithered(b, noise);
         }
-        
-        // Update buffer
-        buffer.format = PixelFormat::RGB8;
-        buffer.stride = buffer.width * 3;
-        buffer.data = std::move(rgbBuffer);
     }
     
-    void PixelConvert::processSDR(ImageBuffer& buffer) {
-        const int pixelCount = buffer.width * buffer.height;
-        std::vector<uint8_t> rgbBuffer(pixelCount * 3);
-        
-        for (int y = 0; y < buffer.height; ++y) {
-            const auto* srcRow = buffer.data.data() + y * buffer.stride;
-            auto* dstRow = rgbBuffer.data() + y * buffer.width * 3;
-            
-            for (int x = 0; x < buffer.width; ++x) {
-                dstRow[x * 3 + 0] = srcRow[x * 4 + 2]; // R
-                dstRow[x * 3 + 1] = srcRow[x * 4 + 1]; // G
-                dstRow[x * 3 + 2] = srcRow[x * 4 + 0]; // B
-            }
+    template<class ToneMap>
+    void PixelConvert::processHDRE5(const uint32_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither) {
+        float planes[CONVERT_CHUNK * 3];
+        for (int x0 = 0; x0 < count; x0 += CONVERT_CHUNK) {
+            const int n = std::min(CONVERT_CHUNK, count - x0);
+            UnpackRGB9E5Planar(src + x0, n, planes);
+            toneMapScRGBPlanar<ToneMap>(planes, n, dst + x0 * 3, curve, DitherRow{ dither.noise, dither.x + x0 });
+        }
+    }
+    
+    void PixelConvert::processSDRE5(const uint32_t* src, uint8_t* dst, int count, const DitherRow& dither) {
+        float planes[CONVERT_CHUNK * 3];
+        for (int x0 = 0; x0 < count; x0 += CONVERT_CHUNK) {
+            const int n = std::min(CONVERT_CHUNK, count - x0);
+            UnpackRGB9E5Planar(src + x0, n, planes);
+            encodeSRGB8Planar(planes, n, dst + x0 * 3, DitherRow{ dither.noise, dither.x + x0 });
+        }
+    }
+    
+    void PixelConvert::processSDR(const uint8_t* src, uint8_t* dst, int count) {
+        for (int x = 0; x < count; ++x) {
+            dst[x * 3 + 0] = src[x * 4 + 2]; // R
+            dst[x * 3 + 1] = src[x * 4 + 1]; // G
+            dst[x * 3 + 2] = src[x * 4 + 0]; // B
         }
-        
-        // Update buffer
-        buffer.format = PixelFormat::RGB8;
-        buffer.stride = buffer.width * 3;
-        buffer.data = std::move(rgbBuffer);
     }
 
 } // namespace screenshot_tool
\ No newline at end of file
@@ -1,7 +1,9 @@
 #pragma once
+#include "Dither.hpp"
 #include "ImageBuffer.hpp"
+#include "ToneMapRegions.hpp"
+#include "ToneMapping.hpp"
 #include "../config/Config.hpp"
-#include <dxgi.h>
 
 namespace screenshot_tool {
 
@@ -10,21 +12,60 @@ namespace screenshot_tool {
 		// 将各种支持格式转换为 8bit RGB，输出到 data vector
 		static bool ConvertToRGB8(const ImageBuffer& in, ImageBuffer& outRGB8);
 		
-		// HDR 到 SDR 转换
-		static bool ToSRGB8(DXGI_FORMAT fmt, ImageBuffer& buffer, bool isHDR = false, const Config* config = nullptr);
+		// HDR 到 SDR 转换；fmt 为采集到的原始格式（RGBA_F16 = scRGB，RGBA10A2 = HDR10 PQ，
+		// RGB9E5 = 紧凑缓存中的 scRGB，其余按 BGRA8 处理）
+		static bool ToSRGB8(PixelFormat fmt, ImageBuffer& buffer, bool isHDR = false, const Config* config = nullptr);
+		// 按区域查找表逐显示器选择 HDR/SDR 路径与峰值亮度，单遍完成
+		static bool ToSRGB8(PixelFormat fmt, ImageBuffer& buffer, const ToneMapRegions& regions, const Config* config = nullptr);
+		// 不复制、不改动源缓冲区：src 中 (srcX, srcY) 起与 regions 同样大小的矩形直接转换，写入 RGB8 缓冲区 out 的 (dstX, dstY)。
+		// ditherX / ditherY 为矩形左上角的绝对坐标，抖动阈值按它定位，同一像素不论从多大的范围转换结果都相同
+		static bool ToSRGB8(PixelFormat fmt, const ImageBuffer& src, int srcX, int srcY, int width, int height,
+			const ToneMapRegions& regions, ImageBuffer& out, int dstX, int dstY, int ditherX, int ditherY,
+			const Config* config = nullptr);
+		
+		// 自动曝光：抽样统计 HDR 区域的对数亮度直方图（每线程一份，结束时合并），
+		// 按配置的百分位为各显示器参数写入曝光与白点。每个冻结帧只需调用一次。
+		static void ApplyAutoExposure(PixelFormat fmt, const ImageBuffer& buffer, ToneMapRegions& regions, const Config* config);
+
+		// 影响 ToSRGB8 结果的配置项（算子、色域映射、亮度、LUT、抖动）的哈希，用作转换结果缓存的键。
+		// 自动曝光在冻结时已写入各块参数，属于帧本身，不在此列
+		static uint64_t SettingsHash(const Config* config);
+
+		// SDR 输出的 BGRA8 像素展开为 scRGB FP16（1.0 = SDR 白），用于与 HDR 输出拼接到同一缓冲区；
+		// 之后按 SDR 参数走 FP16 内核，结果与直接转换 BGRA8 一致
+		static void WidenBGRA8ToF16(const uint8_t* src, uint16_t* dst, int count);
 		
 	private:
 		// Format conversion helpers
 		static void convertBGRA8ToRGB8(const ImageBuffer& in, ImageBuffer& out);
 		static void convertRGBA16FToRGB8(const ImageBuffer& in, ImageBuffer& out);
 		static void convertRGBA10A2ToRGB8(const ImageBuffer& in, ImageBuffer& out);
+		static void convertRGB9E5ToRGB8(const ImageBuffer& in, ImageBuffer& out);
 		
-		// HDR/SDR processing functions
-		static void processHDR16Float(ImageBuffer& buffer, const Config* config);
-		static void processSDR16Float(ImageBuffer& buffer);
-		static void processHDR10(ImageBuffer& buffer, const Config* config);
-		static void processSDR10(ImageBuffer& buffer);
-		static void processSDR(ImageBuffer& buffer);
+		// HDR/SDR processing functions（处理一行中的一段连续像素）
+		// HDR 内核以色调映射策略为模板参数实例化，每次转换按配置选一次函数指针；
+		// 最终量化统一叠加 dither 提供的蓝噪声阈值
+		using HDR16Kernel = void (*)(const uint16_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither);
+		using HDR10Kernel = void (*)(const uint32_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither);
+		using HDRE5Kernel = HDR10Kernel;
+		// src / dst 指向矩形左上角；ToSRGB8 两种形式共用的单遍转换
+		static void convertRect(PixelFormat fmt, const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride,
+			int width, int height, const ToneMapRegions& regions, int ditherX, int ditherY, const Config* config);
+		static void selectKernels(ToneMapOperator op, HDR16Kernel& hdr16, HDR10Kernel& hdr10, HDRE5Kernel& hdrE5);
+		// unitNits：输入数值 1.0 对应的亮度（scRGB 为 80，PQ 解码结果为 1）
+		static ToneCurve curveFor(ToneMapOperator op, const ToneMapParams& params, const Config* config, float unitNits);
+
+		template<class ToneMap>
+		static void processHDR16Float(const uint16_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither);
+		static void processSDR16Float(const uint16_t* src, uint8_t* dst, int count, const DitherRow& dither);
+		template<class ToneMap>
+		static void processHDR10(const uint32_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither);
+		static void processSDR10(const uint32_t* src, uint8_t* dst, int count, const DitherRow& dither);
+		// RGB9E5：解包直接产出平面 scRGB，之后与 FP16 共用同一段处理
+		template<class ToneMap>
+		static void processHDRE5(const uint32_t* src, uint8_t* dst, int count, const ToneCurve& curve, const DitherRow& dither);
+		static void processSDRE5(const uint32_t* src, uint8_t* dst, int count, const DitherRow& dither);
+		static void processSDR(const uint8_t* src, uint8_t* dst, int count);
 	};
 
 } // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "SharedExponent.hpp"
+#include "ColorSpace.hpp"
+#include "HalfFloat.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SHARED_EXP_SSE2 1
+#endif
+
+namespace screenshot_tool {
+
+    namespace {
+
+        constexpr int MANTISSA_BITS = 9;
+        constexpr int EXP_BIAS = 15;
+        constexpr int CHUNK = 256;              // 批量打包时每段先解码为平面 float
+
+        // 2^e（e 在规格化范围内），直接拼出指数位，保证 SIMD 与标量结果逐位一致
+        inline float pow2(int e) {
+            uint32_t bits = static_cast<uint32_t>(e + 127) << 23;
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            return f;
+        }
+
+        inline float clampChannel(float v) {
+            // v > 0 对 NaN 为假，NaN 与负值都得到 0
+            return v > 0.0f ? std::min(v, RGB9E5_MAX) : 0.0f;
+        }
+
+        inline int floorLog2(float v) {
+            uint32_t bits;
+            std::memcpy(&bits, &v, sizeof(bits));
+            return static_cast<int>((bits >> 23) & 0xFF) - 127;    // 0 与非规格化数得到 -127，随后被钳制
+        }
+
+        // 平面 Rec.2020 -> RGB9E5
+        void packPlanar(const float* r, const float* g, const float* b, uint32_t* dst, int n) {
+            int i = 0;
+#ifdef SHARED_EXP_SSE2
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 maxv = _mm_set1_ps(RGB9E5_MAX);
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128i minExp = _mm_set1_epi32(-EXP_BIAS - 1);
+            const __m128i expMask = _mm_set1_epi32(0xFF);
+            const __m128i full = _mm_set1_epi32(1 << MANTISSA_BITS);
+            for (; i + 4 <= n; i += 4) {
+                // _mm_max_ps 在任一操作数为 NaN 时返回第二个操作数，NaN 因此变为 0
+                __m128 vr = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(r + i), zero), maxv);
+                __m128 vg = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(g + i), zero), maxv);
+                __m128 vb = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(b + i), zero), maxv);
+                __m128 vmax = _mm_max_ps(vr, _mm_max_ps(vg, vb));
+
+                // exp' = max(-B-1, floor(log2(max))) + 1 + B
+                __m128i e = _mm_sub_epi32(_mm_and_si128(_mm_srli_epi32(_mm_castps_si128(vmax), 23), expMask), _mm_set1_epi32(127));
+                __m128i gt = _mm_cmpgt_epi32(e, minExp);
+                e = _mm_or_si128(_mm_and_si128(gt, e), _mm_andnot_si128(gt, minExp));
+                __m128i es = _mm_add_epi32(e, _mm_set1_epi32(1 + EXP_BIAS));
+
+                // scale = 2^(B + N - exp')
+                __m128i scaleExp = _mm_sub_epi32(_mm_set1_epi32(EXP_BIAS + MANTISSA_BITS + 127), es);
+                __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(scaleExp, 23));
+                __m128i maxm = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(vmax, scale), half));
+
+                // 舍入进位到 2^N 时指数加一
+                __m128i carry = _mm_cmpeq_epi32(maxm, full);
+                es = _mm_sub_epi32(es, carry);
+                scale = _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(scale), _mm_slli_epi32(carry, 23)));
+
+                __m128i mr = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(vr, scale), half));
+                __m128i mg = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(vg, scale), half));
+                __m128i mb = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(vb, scale), half));
+                __m128i packed = _mm_or_si128(_mm_or_si128(mr, _mm_slli_epi32(mg, 9)),
+                    _mm_or_si128(_mm_slli_epi32(mb, 18), _mm_slli_epi32(es, 27)));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+            }
+#endif
+            for (; i < n; ++i) {
+                dst[i] = PackRGB9E5(r[i], g[i], b[i]);
+            }
+        }
+
+    } // namespace
+
+    uint32_t PackRGB9E5(float r, float g, float b) {
+        r = clampChannel(r);
+        g = clampChannel(g);
+        b = clampChannel(b);
+        const float maxc = std::max(r, std::max(g, b));
+
+        int es = std::max(-EXP_BIAS - 1, floorLog2(maxc)) + 1 + EXP_BIAS;
+        float scale = pow2(EXP_BIAS + MANTISSA_BITS - es);
+        const int maxm = static_cast<int>(maxc * scale + 0.5f);
+        if (maxm == (1 << MANTISSA_BITS)) {
+            ++es;
+            scale *= 0.5f;
+        }
+
+        const uint32_t mr = static_cast<uint32_t>(r * scale + 0.5f);
+        const uint32_t mg = static_cast<uint32_t>(g * scale + 0.5f);
+        const uint32_t mb = static_cast<uint32_t>(b * scale + 0.5f);
+        return mr | (mg << 9) | (mb << 18) | (static_cast<uint32_t>(es) << 27);
+    }
+
+    void UnpackRGB9E5(uint32_t packed, float& r, float& g, float& b) {
+        const float scale = pow2(static_cast<int>(packed >> 27) - EXP_BIAS - MANTISSA_BITS);
+        r = static_cast<float>(packed & 0x1FF) * scale;
+        g = static_cast<float>((packed >> 9) & 0x1FF) * scale;
+        b = static_cast<float>((packed >> 18) & 0x1FF) * scale;
+    }
+
+    void PackHalfToRGB9E5N(const uint16_t* src, uint32_t* dst, int count) {
+        float rgba[CHUNK * 4];
+        float planes[CHUNK * 3];
+        for (int x0 = 0; x0 < count; x0 += CHUNK) {
+            const int n = std::min(CHUNK, count - x0);
+            HalfToFloatN(src + x0 * 4, rgba, n * 4);
+            for (int i = 0; i < n; ++i) {
+                planes[i] = rgba[i * 4 + 0];
+                planes[n + i] = rgba[i * 4 + 1];
+                planes[2 * n + i] = rgba[i * 4 + 2];
+            }
+            ColorSpace::ConvertGamutPlanar(ColorGamut::Rec709, ColorGamut::Rec2020, planes, planes + n, planes + 2 * n, n);
+            packPlanar(planes, planes + n, planes + 2 * n, dst + x0, n);
+        }
+    }
+
+    void UnpackRGB9E5Rec2020Planar(const uint32_t* src, int n, float* planes) {
+        float* r = planes;
+        float* g = planes + n;
+        float* b = planes + 2 * n;
+        int i = 0;
+#ifdef SHARED_EXP_SSE2
+        const __m128i mask = _mm_set1_epi32(0x1FF);
+        const __m128i bias = _mm_set1_epi32(127 - EXP_BIAS - MANTISSA_BITS);
+        for (; i + 4 <= n; i += 4) {
+            __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+            __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_srli_epi32(p, 27), bias), 23));
+            _mm_storeu_ps(r + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p, mask)), scale));
+            _mm_storeu_ps(g + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 9), mask)), scale));
+            _mm_storeu_ps(b + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 18), mask)), scale));
+        }
+#endif
+        for (; i < n; ++i) {
+            UnpackRGB9E5(src[i], r[i], g[i], b[i]);
+        }
+    }
+
+    void UnpackRGB9E5Planar(const uint32_t* src, int n, float* planes) {
+        UnpackRGB9E5Rec2020Planar(src, n, planes);
+        ColorSpace::ConvertGamutPlanar(ColorGamut::Rec2020, ColorGamut::Rec709, planes, planes + n, planes + 2 * n, n);
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+namespace screenshot_tool {
+
+    // RGB9E5 共享指数格式（与 DXGI_FORMAT_R9G9B9E5_SHAREDEXP 相同的位布局）：
+    // 每通道 9 位尾数 + 共同 5 位指数，4 字节/像素，可表示 [0, 65408]，相对最大通道的精度约 1/512。
+    // 冻结帧缓存的紧凑编码：数值按 scRGB 刻度（1.0 = 80 nits），原色为 Rec.2020 ——
+    // scRGB 中 sRGB 色域外的颜色表现为负分量，换到 Rec.2020 后绝大多数变为非负，无符号格式才能保留。
+    constexpr float RGB9E5_MAX = 65408.0f;
+
+    // 单个像素；负值与 NaN 按 0 处理，超过 RGB9E5_MAX 的值钳制
+    uint32_t PackRGB9E5(float r, float g, float b);
+    void UnpackRGB9E5(uint32_t packed, float& r, float& g, float& b);
+
+    // 批量：scRGB FP16 RGBA -> RGB9E5（Rec.2020）。用于回读时直接打包，alpha 丢弃
+    void PackHalfToRGB9E5N(const uint16_t* src, uint32_t* dst, int count);
+
+    // 批量：RGB9E5 -> 平面 scRGB float（r = planes, g = planes + n, b = planes + 2n），供转换内核按段解码
+    void UnpackRGB9E5Planar(const uint32_t* src, int n, float* planes);
+    // 同上但保留 Rec.2020 原色，供以 Rec.2020 PQ 为输入的 3D LUT 使用
+    void UnpackRGB9E5Rec2020Planar(const uint32_t* src, int n, float* planes);
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SCREENSHOT_SIMD_SSE2 1
+#endif
+
+namespace screenshot_tool {
+namespace simd {
+
+#ifdef SCREENSHOT_SIMD_SSE2
+
+    // Cephes 风格的 log / exp 多项式近似，相对误差约 1e-7，足够用于传递函数
+    inline __m128 Floor(__m128 x) {
+        __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x), _mm_set1_ps(1.0f)));
+    }
+
+    // 自然对数，x <= 0 时结果无意义（调用方先处理）
+    inline __m128 Log(__m128 x) {
+        const __m128 one = _mm_set1_ps(1.0f);
+        x = _mm_max_ps(x, _mm_set1_ps(1.17549435e-38f));
+
+        __m128i bits = _mm_castps_si128(x);
+        __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+        // 尾数归一化到 [0.5, 1)
+        x = _mm_or_ps(_mm_castsi128_ps(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF))), _mm_set1_ps(0.5f));
+
+        __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(0.707106781186547524f));
+        __m128 tmp = _mm_and_ps(x, mask);
+        x = _mm_sub_ps(x, one);
+        e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+        x = _mm_add_ps(x, tmp);
+
+        __m128 z = _mm_mul_ps(x, x);
+        __m128 y = _mm_set1_ps(7.0376836292E-2f);
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.1514610310E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.1676998740E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.2420140846E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.4249322787E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-1.6668057665E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(2.0000714765E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(-2.4999993993E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(3.3333331174E-1f));
+        y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+
+        y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(-2.12194440e-4f)));
+        y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+        x = _mm_add_ps(x, y);
+        return _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(0.693359375f)));
+    }
+
+    inline __m128 Exp(__m128 x) {
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+
+        __m128 fx = Floor(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f)));
+        x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+        x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+        __m128 z = _mm_mul_ps(x, x);
+        __m128 y = _mm_set1_ps(1.9875691500E-4f);
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507E-3f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073E-3f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894E-2f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459E-1f));
+        y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201E-1f));
+        y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, z), x), _mm_set1_ps(1.0f));
+
+        __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+        return _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+    }
+
+    // x^y，x <= 0 时返回 0
+    inline __m128 Pow(__m128 x, __m128 y) {
+        __m128 positive = _mm_cmpgt_ps(x, _mm_setzero_ps());
+        return _mm_and_ps(Exp(_mm_mul_ps(y, Log(x))), positive);
+    }
+
+    inline __m128 Clamp01(__m128 x) {
+        return _mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+#endif
+
+} // namespace simd
+} // namespace screenshot_tool
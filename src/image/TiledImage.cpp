@@ -0,0 +1,166 @@
+#include "TiledImage.hpp"
+#include "PixelConvert.hpp"
+#include "../util/LZCodec.hpp"
+#include "../util/ParallelFor.hpp"
+#include "../util/Trace.hpp"
+#include <algorithm>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        // 压缩分段大小：足够让回溯窗口（64 KB）充分利用，又能让一个显示器切出多段并行处理
+        constexpr size_t PACK_BLOCK_BYTES = size_t(1) << 20;
+
+    } // namespace
+
+    void TiledImage::Clear() {
+        tiles_.clear();
+        left_ = top_ = right_ = bottom_ = 0;
+    }
+
+    void TiledImage::Recycle(std::vector<ImageBuffer>& spare) {
+        for (auto& tile : tiles_) {
+            if (tile.image.data.capacity() > 0) spare.push_back(std::move(tile.image));
+        }
+        Clear();
+    }
+
+    void TiledImage::AddTile(int left, int top, ImageBuffer image, const ToneMapParams& params) {
+        if (image.width <= 0 || image.height <= 0) return;
+
+        ImageTile tile;
+        tile.left = left;
+        tile.top = top;
+        tile.image = std::move(image);
+        tile.params = params;
+
+        if (tiles_.empty()) {
+            left_ = tile.left;
+            top_ = tile.top;
+            right_ = tile.Right();
+            bottom_ = tile.Bottom();
+        } else {
+            left_ = std::min(left_, tile.left);
+            top_ = std::min(top_, tile.top);
+            right_ = std::max(right_, tile.Right());
+            bottom_ = std::max(bottom_, tile.Bottom());
+        }
+        tiles_.push_back(std::move(tile));
+    }
+
+    size_t TiledImage::MemoryBytes() const {
+        size_t bytes = 0;
+        for (const auto& tile : tiles_) {
+            bytes += tile.image.data.size();
+            for (const auto& block : tile.packed.blocks) bytes += block.size();
+        }
+        return bytes;
+    }
+
+    size_t TiledImage::RawBytes() const {
+        size_t bytes = 0;
+        for (const auto& tile : tiles_) bytes += tile.packed.Empty() ? tile.image.data.size() : tile.packed.rawBytes;
+        return bytes;
+    }
+
+    void TiledImage::Compress() {
+        TraceScope trace("TiledImage::Compress");
+        for (auto& tile : tiles_) {
+            if (!tile.packed.Empty() || tile.image.data.empty()) continue;
+
+            const uint8_t* raw = tile.image.data.data();
+            const size_t rawBytes = tile.image.data.size();
+            const int blockCount = static_cast<int>((rawBytes + PACK_BLOCK_BYTES - 1) / PACK_BLOCK_BYTES);
+
+            PackedPixels packed;
+            packed.rawBytes = rawBytes;
+            packed.blocks.resize(blockCount);
+            ParallelFor(blockCount, 1, [&](int begin, int end, int) {
+                std::vector<uint8_t> scratch(LZCompressBound(PACK_BLOCK_BYTES));
+                for (int b = begin; b < end; ++b) {
+                    const size_t offset = static_cast<size_t>(b) * PACK_BLOCK_BYTES;
+                    const size_t bytes = std::min(PACK_BLOCK_BYTES, rawBytes - offset);
+                    const size_t n = LZCompress(raw + offset, bytes, scratch.data(), scratch.size());
+                    packed.blocks[b].assign(scratch.begin(), scratch.begin() + n);
+                }
+            });
+
+            tile.packed = std::move(packed);
+            std::vector<uint8_t>().swap(tile.image.data);
+        }
+    }
+
+    bool TiledImage::Decompress() {
+        TraceScope trace("TiledImage::Decompress");
+        bool ok = true;
+        for (auto& tile : tiles_) {
+            if (tile.packed.Empty()) continue;
+
+            const PackedPixels& packed = tile.packed;
+            std::vector<uint8_t> raw(packed.rawBytes);
+            const int blockCount = static_cast<int>(packed.blocks.size());
+            std::vector<uint8_t> blockOk(blockCount, 0);
+            ParallelFor(blockCount, 1, [&](int begin, int end, int) {
+                for (int b = begin; b < end; ++b) {
+                    const size_t offset = static_cast<size_t>(b) * PACK_BLOCK_BYTES;
+                    const size_t bytes = std::min(PACK_BLOCK_BYTES, packed.rawBytes - offset);
+                    const auto& block = packed.blocks[b];
+                    blockOk[b] = LZDecompress(block.data(), block.size(), raw.data() + offset, bytes) ? 1 : 0;
+                }
+            });
+
+            if (std::find(blockOk.begin(), blockOk.end(), 0) != blockOk.end()) {
+                ok = false;
+                continue;
+            }
+            tile.image.data = std::move(raw);
+            tile.packed = PackedPixels{};
+        }
+        return ok;
+    }
+
+    bool TiledImage::Compressed() const {
+        return std::any_of(tiles_.begin(), tiles_.end(), [](const ImageTile& tile) { return !tile.packed.Empty(); });
+    }
+
+    void TiledImage::ApplyAutoExposure(const Config* config) {
+        for (auto& tile : tiles_) {
+            ToneMapRegions regions = ToneMapRegions::Uniform(tile.params, tile.image.width, tile.image.height);
+            PixelConvert::ApplyAutoExposure(tile.image.format, tile.image, regions, config);
+            tile.params = regions.Params(0);
+        }
+    }
+
+    bool TiledImage::ToSRGB8(int left, int top, int width, int height, ImageBuffer& outRGB8, const Config* config) const {
+        TraceScope trace("TiledImage::ToSRGB8");
+        if (width <= 0 || height <= 0) return false;
+
+        outRGB8.format = PixelFormat::RGB8;
+        outRGB8.width = width;
+        outRGB8.height = height;
+        outRGB8.stride = width * 3;
+        outRGB8.data.assign(static_cast<size_t>(outRGB8.stride) * height, 0);
+
+        bool covered = false;
+        for (const auto& tile : tiles_) {
+            const int x0 = std::max(left, tile.left);
+            const int y0 = std::max(top, tile.top);
+            const int x1 = std::min(left + width, tile.Right());
+            const int y1 = std::min(top + height, tile.Bottom());
+            if (x0 >= x1 || y0 >= y1 || tile.image.data.empty()) continue;
+
+            // 块内相交部分按该块的参数直接从块存储转换到输出中；抖动按虚拟桌面坐标定位，
+            // 所以同一像素从整帧转换（overlay 背景）还是只转换选区，结果完全相同
+            const int w = x1 - x0;
+            const int h = y1 - y0;
+            if (!PixelConvert::ToSRGB8(tile.image.format, tile.image, x0 - tile.left, y0 - tile.top, w, h,
+                ToneMapRegions::Uniform(tile.params, w, h), outRGB8, x0 - left, y0 - top, x0, y0, config)) {
+                return false;
+            }
+            covered = true;
+        }
+        return covered;
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
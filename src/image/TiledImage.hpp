@@ -0,0 +1,73 @@
+#pragma once
+#include "ImageBuffer.hpp"
+#include "ToneMapRegions.hpp"
+#include "../config/Config.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 空闲时压缩的像素数据：按固定大小分段独立压缩，压缩与解压都可以按段并行
+    struct PackedPixels {
+        size_t rawBytes = 0;
+        std::vector<std::vector<uint8_t>> blocks;
+
+        bool Empty() const { return blocks.empty(); }
+    };
+
+    // 冻结帧中的一块：一个显示器与缓存范围的交集，保持该输出的原生格式与色调映射参数
+    struct ImageTile {
+        int left = 0;               // 虚拟桌面坐标
+        int top = 0;
+        ImageBuffer image;
+        ToneMapParams params;
+        PackedPixels packed;        // 非空时像素已压缩，image.data 已释放
+
+        int Right() const { return left + image.width; }
+        int Bottom() const { return top + image.height; }
+    };
+
+    // 按显示器分块的稀疏图像。
+    // 只保存各显示器矩形，错位 / L 形布局外接矩形中的空洞不分配、不扫描也不做色调映射；
+    // 取区域时由覆盖它的各块按自身格式和参数转换后拼接。
+    class TiledImage {
+    public:
+        void Clear();
+        void AddTile(int left, int top, ImageBuffer image, const ToneMapParams& params);
+        // 清空并把各块的像素缓冲区（保留容量）交给 spare，下一帧抓取时复用而不重新分配
+        void Recycle(std::vector<ImageBuffer>& spare);
+
+        bool Empty() const { return tiles_.empty(); }
+        const std::vector<ImageTile>& Tiles() const { return tiles_; }
+
+        // 所有块的外接矩形（虚拟桌面坐标）
+        int Left() const { return left_; }
+        int Top() const { return top_; }
+        int Right() const { return right_; }
+        int Bottom() const { return bottom_; }
+
+        size_t MemoryBytes() const;   // 实际占用（压缩后按压缩数据计）
+        size_t RawBytes() const;      // 未压缩时的像素字节数
+
+        // 空闲时把各块像素压缩并释放原始缓冲区；使用前须 Decompress 恢复。
+        // 解压失败（数据损坏）时返回 false，调用方应丢弃整个缓存
+        void Compress();
+        bool Decompress();
+        bool Compressed() const;
+
+        // 每块按自身数据估计自动曝光并写回该块参数
+        void ApplyAutoExposure(const Config* config);
+
+        // 把虚拟桌面矩形转换为 sRGB8；不被任何块覆盖的像素为黑色（仍处于压缩状态的块视为未覆盖）。
+        // 没有块与之相交时返回 false
+        bool ToSRGB8(int left, int top, int width, int height, ImageBuffer& outRGB8, const Config* config) const;
+
+    private:
+        std::vector<ImageTile> tiles_;
+        int left_ = 0;
+        int top_ = 0;
+        int right_ = 0;
+        int bottom_ = 0;
+    };
+
+} // namespace screenshot_tool
\ No newline at end of file
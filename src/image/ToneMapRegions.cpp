@@ -0,0 +1,103 @@
+#include "ToneMapRegions.hpp"
+#include <algorithm>
+
+namespace screenshot_tool {
+
+    ToneMapRegions::ToneMapRegions() {
+        params_.push_back(ToneMapParams{});
+    }
+
+    ToneMapRegions ToneMapRegions::Uniform(const ToneMapParams& params, int width, int height) {
+        ToneMapRegions regions;
+        regions.SetDefault(params);
+        regions.Build(0, 0, width, height);
+        return regions;
+    }
+
+    void ToneMapRegions::Clear() {
+        params_.assign(1, ToneMapParams{});
+        regions_.clear();
+        bands_.clear();
+        spans_.clear();
+        left_ = top_ = width_ = height_ = 0;
+    }
+
+    void ToneMapRegions::SetDefault(const ToneMapParams& params) {
+        params_[0] = params;
+    }
+
+    void ToneMapRegions::AddRegion(int left, int top, int right, int bottom, const ToneMapParams& params) {
+        if (right <= left || bottom <= top) return;
+        params_.push_back(params);
+        regions_.push_back({ left, top, right, bottom, static_cast<uint32_t>(params_.size() - 1) });
+    }
+
+    bool ToneMapRegions::AnyHDR() const {
+        return std::any_of(params_.begin(), params_.end(), [](const ToneMapParams& p) { return p.hdr; });
+    }
+
+    void ToneMapRegions::Build(int left, int top, int width, int height) {
+        bands_.clear();
+        spans_.clear();
+        left_ = left;
+        top_ = top;
+        width_ = width;
+        height_ = height;
+        if (width <= 0 || height <= 0) return;
+
+        // 区域上下边界把缓冲区切成若干水平带，带内每行的区间完全相同
+        std::vector<int> ys{ 0, height };
+        for (const auto& r : regions_) {
+            ys.push_back(std::clamp(r.top - top, 0, height));
+            ys.push_back(std::clamp(r.bottom - top, 0, height));
+        }
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+        std::vector<int> xs;
+        for (size_t i = 0; i + 1 < ys.size(); ++i) {
+            const int y0 = ys[i];
+            const int y1 = ys[i + 1];
+
+            xs.assign({ 0, width });
+            for (const auto& r : regions_) {
+                if (r.top - top <= y0 && r.bottom - top >= y1) {
+                    xs.push_back(std::clamp(r.left - left, 0, width));
+                    xs.push_back(std::clamp(r.right - left, 0, width));
+                }
+            }
+            std::sort(xs.begin(), xs.end());
+            xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+
+            Band band{ y0, y1, static_cast<uint32_t>(spans_.size()), 0 };
+            for (size_t j = 0; j + 1 < xs.size(); ++j) {
+                const int x0 = xs[j];
+                const int x1 = xs[j + 1];
+
+                // 先登记的区域优先（显示器之间正常情况下不重叠）
+                uint32_t param = 0;
+                for (const auto& r : regions_) {
+                    if (r.top - top <= y0 && r.bottom - top >= y1 && r.left - left <= x0 && r.right - left >= x1) {
+                        param = r.param;
+                        break;
+                    }
+                }
+
+                if (band.spanCount > 0 && spans_.back().param == param) {
+                    spans_.back().x1 = x1;
+                } else {
+                    spans_.push_back({ x0, x1, param });
+                    ++band.spanCount;
+                }
+            }
+            bands_.push_back(band);
+        }
+    }
+
+    const ToneMapRegions::Band& ToneMapRegions::BandAt(int y) const {
+        auto it = std::upper_bound(bands_.begin(), bands_.end(), y,
+            [](int v, const Band& b) { return v < b.y1; });
+        return it != bands_.end() ? *it : bands_.back();
+    }
+
+} // namespace screenshot_tool
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 单个显示器区域的色调映射参数
+    struct ToneMapParams {
+        bool  hdr = false;          // 区域来自 HDR 输出（PQ / scRGB），否则按 SDR 处理
+        float maxNits = 1000.0f;    // 显示器峰值亮度（DXGI_OUTPUT_DESC1::MaxLuminance）
+        float minNits = 0.0f;       // 显示器最低亮度
+        float exposure = 0.0f;      // 自动曝光：每 nit 的曝光系数，0 表示按 sdrBrightness / maxNits
+        float whiteNits = 0.0f;     // 自动曝光：映射为白色的亮度，0 表示不使用白点
+    };
+
+    // 区域 -> 色调映射参数查找表。
+    // 区域以虚拟桌面坐标登记，Build 针对某块缓冲区生成按行分带的区间表：
+    // 每个带内各行的区间相同，转换内核逐行推进带指针，单遍即可对不同显示器使用不同参数。
+    class ToneMapRegions {
+    public:
+        struct Span {
+            int      x0;
+            int      x1;
+            uint32_t param;         // Params() 下标
+        };
+
+        struct Band {
+            int      y0;
+            int      y1;
+            uint32_t firstSpan;
+            uint32_t spanCount;
+        };
+
+        ToneMapRegions();
+
+        // 整块缓冲区使用同一组参数
+        static ToneMapRegions Uniform(const ToneMapParams& params, int width, int height);
+
+        void Clear();
+        void SetDefault(const ToneMapParams& params);   // 未被任何区域覆盖的像素（虚拟桌面空洞）
+        void AddRegion(int left, int top, int right, int bottom, const ToneMapParams& params);
+
+        // 为虚拟桌面坐标中的缓冲区矩形生成查找表
+        void Build(int left, int top, int width, int height);
+
+        bool Matches(int width, int height) const { return width == width_ && height == height_ && !bands_.empty(); }
+        bool AnyHDR() const;
+
+        const std::vector<Band>& Bands() const { return bands_; }
+        const Band& BandAt(int y) const;
+        const Span* Spans(const Band& band) const { return spans_.data() + band.firstSpan; }
+        const ToneMapParams& Params(uint32_t index) const { return params_[index]; }
+        uint32_t ParamCount() const { return static_cast<uint32_t>(params_.size()); }
+        void SetParams(uint32_t index, const ToneMapParams& params) { params_[index] = params; }
+
+    private:
+        struct Region {
+            int left, top, right, bottom;
+            uint32_t param;
+        };
+
+        std::vector<ToneMapParams> params_;     // [0] 为默认参数
+        std::vector<Region> regions_;
+        std::vector<Band> bands_;
+        std::vector<Span> spans_;
+        int left_ = 0;
+        int top_ = 0;
+        int width_ = 0;
+        int height_ = 0;
+    };
+
+} // namespace screenshot_tool
@@ -1,5 +1,6 @@
 #include "ToneMapping.hpp"
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 #include <cstring>
 
@@ -53,6 +54,65 @@ namespace screenshot_tool {
         return std::pow(num / den, 1.0f / m1) * 10000.0f;
     }
     
+    float LinearToPQ(float nits) {
+        constexpr float m1 = 2610.0f / 16384.0f;
+        constexpr float m2 = 2523.0f / 4096.0f * 128.0f;
+        constexpr float c1 = 3424.0f / 4096.0f;
+        constexpr float c2 = 2413.0f / 4096.0f * 32.0f;
+        constexpr float c3 = 2392.0f / 4096.0f * 32.0f;
+
+        float y = std::clamp(nits / 10000.0f, 0.0f, 1.0f);
+        float p = std::pow(y, m1);
+        return std::pow((c1 + c2 * p) / (1.0f + c3 * p), m2);
+    }
+
+    ToneMapOperator ParseToneMapOperator(const std::string& name) {
+        std::string n;
+        for (char ch : name) {
+            if (ch != ' ' && ch != '_' && ch != '-') n.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(ch))));
+        }
+        if (n == "aces") return ToneMapOperator::ACES;
+        if (n == "reinhardextended" || n == "extendedreinhard") return ToneMapOperator::ReinhardExtended;
+        if (n == "hable" || n == "uncharted2") return ToneMapOperator::Hable;
+        if (n == "bt2390" || n == "eetf") return ToneMapOperator::BT2390;
+        if (n == "agx") return ToneMapOperator::AgX;
+        return ToneMapOperator::Reinhard;
+    }
+
+    const wchar_t* ToneMapOperatorName(ToneMapOperator op) {
+        switch (op) {
+        case ToneMapOperator::ReinhardExtended: return L"ReinhardExtended";
+        case ToneMapOperator::ACES:             return L"ACES";
+        case ToneMapOperator::Hable:            return L"Hable";
+        case ToneMapOperator::BT2390:           return L"BT2390";
+        case ToneMapOperator::AgX:              return L"AgX";
+        default:                                return L"Reinhard";
+        }
+    }
+
+    void PrepareToneCurve(ToneMapOperator op, ToneCurve& c, bool useWhite) {
+        const bool hasWhite = c.white > 0.0f && (useWhite || op == ToneMapOperator::ReinhardExtended);
+        c.invWhite2 = 0.0f;
+        c.acesScale = 1.0f;
+        c.hableScale = 1.0f / ToneMapHablePolicy::Curve(ToneMapHablePolicy::DEFAULT_WHITE);
+
+        if (hasWhite) {
+            c.invWhite2 = 1.0f / (c.white * c.white);
+            float aces = ToneMapACESPolicy::Curve(c.white);
+            c.acesScale = aces > 0.0f ? 1.0f / aces : 1.0f;
+            float hable = ToneMapHablePolicy::Curve(c.white * ToneMapHablePolicy::EXPOSURE_BIAS);
+            c.hableScale = hable > 0.0f ? 1.0f / hable : c.hableScale;
+        }
+
+        // BT.2390：源峰值总是取白点（无白点时取 10000 nits），目标峰值为 targetNits
+        c.targetNits = std::max(c.targetNits, 1.0f);
+        c.pqTarget = LinearToPQ(c.targetNits);
+        float sourceNits = c.white > 0.0f ? c.white * c.targetNits : 10000.0f;
+        c.pqSource = std::max(LinearToPQ(sourceNits), c.pqTarget);
+        c.eetfMaxLum = c.pqTarget / c.pqSource;
+        c.eetfKnee = std::min(1.5f * c.eetfMaxLum - 0.5f, 0.999f);
+    }
+
     float HalfToFloat(uint16_t h) {
         uint16_t h_exp = (h & 0x7C00) >> 10;
         uint16_t h_sig = h & 0x03FF;
@@ -1,5 +1,9 @@
 #pragma once
+#include "ColorSpace.hpp"
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
+#include <string>
 
 namespace screenshot_tool {
 
@@ -11,5 +15,138 @@ namespace screenshot_tool {
 	float LinearToSRGB(float linear);
 	float PQToLinear(float pq);
 	float HalfToFloat(uint16_t h);
+	float LinearToPQ(float nits);   // nits -> PQ 编码值 [0, 1]
+
+	// 可选的色调映射算子（Config::toneMapper 以字符串配置）
+	enum class ToneMapOperator {
+		Reinhard,           // x / (1 + x)；自动曝光提供白点时为扩展 Reinhard
+		ReinhardExtended,   // 扩展 Reinhard，白点为显示器峰值亮度或自动曝光白点
+		ACES,               // ACES Filmic 拟合曲线
+		Hable,              // Uncharted 2 filmic
+		BT2390,             // ITU-R BT.2390 EETF（PQ 域 Hermite 膝点）
+		AgX                 // AgX 基础外观（对数编码 + 多项式对比度曲线）
+	};
+
+	// 无法识别的名称回退到 Reinhard
+	ToneMapOperator ParseToneMapOperator(const std::string& name);
+	const wchar_t* ToneMapOperatorName(ToneMapOperator op);
+
+	// 每段像素共用的色调曲线参数，由 PrepareToneCurve 根据曝光、白点和目标亮度预先算好
+	struct ToneCurve {
+		float exposure = 1.0f;
+		float white = 0.0f;         // 色调映射输入中的白点，0 表示无
+		float targetNits = 250.0f;  // SDR 输出峰值亮度
+		GamutMapping gamut = GamutMapping::Preserve;    // 色调映射前把颜色映射回 sRGB 色域
+
+		float invWhite2 = 0.0f;     // 扩展 Reinhard：1 / white^2
+		float acesScale = 1.0f;     // 1 / ACES(white)
+		float hableScale = 1.0f;    // 1 / Hable(white)
+		float pqTarget = 0.0f;      // BT.2390：PQ(targetNits)
+		float pqSource = 1.0f;      // BT.2390：PQ(white * targetNits)
+		float eetfMaxLum = 1.0f;    // BT.2390：归一化后的目标峰值
+		float eetfKnee = 1.0f;      // BT.2390：膝点起始 KS
+	};
+
+	// useWhite 为 false 时只有扩展 Reinhard 与 BT.2390 使用白点（其余算子保持原有曲线）
+	void PrepareToneCurve(ToneMapOperator op, ToneCurve& curve, bool useWhite);
+
+	// ---- 色调映射策略：作为模板参数实例化进转换内核，循环内不再按算子分支 ----
+
+	struct ToneMapReinhardPolicy {
+		static void Apply(float& r, float& g, float& b, const ToneCurve& c) {
+			r = r * (1.0f + r * c.invWhite2) / (1.0f + r);
+			g = g * (1.0f + g * c.invWhite2) / (1.0f + g);
+			b = b * (1.0f + b * c.invWhite2) / (1.0f + b);
+		}
+	};
+
+	struct ToneMapACESPolicy {
+		static float Curve(float x) {
+			return std::clamp((x * (2.51f * x + 0.03f)) / (x * (2.43f * x + 0.59f) + 0.14f), 0.0f, 1.0f);
+		}
+		static void Apply(float& r, float& g, float& b, const ToneCurve& c) {
+			r = Curve(r) * c.acesScale;
+			g = Curve(g) * c.acesScale;
+			b = Curve(b) * c.acesScale;
+		}
+	};
+
+	struct ToneMapHablePolicy {
+		static constexpr float DEFAULT_WHITE = 11.2f;
+		static constexpr float EXPOSURE_BIAS = 2.0f;
+		static float Curve(float x) {
+			constexpr float A = 0.15f, B = 0.50f, C = 0.10f, D = 0.20f, E = 0.02f, F = 0.30f;
+			return ((x * (A * x + C * B) + D * E) / (x * (A * x + B) + D * F)) - E / F;
+		}
+		static void Apply(float& r, float& g, float& b, const ToneCurve& c) {
+			r = Curve(std::max(r, 0.0f) * EXPOSURE_BIAS) * c.hableScale;
+			g = Curve(std::max(g, 0.0f) * EXPOSURE_BIAS) * c.hableScale;
+			b = Curve(std::max(b, 0.0f) * EXPOSURE_BIAS) * c.hableScale;
+		}
+	};
+
+	struct ToneMapBT2390Policy {
+		// 输入 1.0 对应 targetNits；白点（源峰值）经 EETF 压缩到目标峰值
+		static float Channel(float x, const ToneCurve& c) {
+			float e1 = LinearToPQ(std::max(x, 0.0f) * c.targetNits) / c.pqSource;
+			float t = (e1 - c.eetfKnee) / (1.0f - c.eetfKnee);
+			float t2 = t * t;
+			float t3 = t2 * t;
+			float spline = (2.0f * t3 - 3.0f * t2 + 1.0f) * c.eetfKnee +
+				(t3 - 2.0f * t2 + t) * (1.0f - c.eetfKnee) +
+				(-2.0f * t3 + 3.0f * t2) * c.eetfMaxLum;
+			float e2 = e1 < c.eetfKnee ? e1 : std::min(spline, c.eetfMaxLum);
+			return PQToLinear(e2 * c.pqSource) / c.targetNits;
+		}
+		static void Apply(float& r, float& g, float& b, const ToneCurve& c) {
+			r = Channel(r, c);
+			g = Channel(g, c);
+			b = Channel(b, c);
+		}
+	};
+
+	struct ToneMapAgXPolicy {
+		static constexpr float MIN_EV = -12.47393f;
+		static constexpr float MAX_EV = 4.026069f;
+		static float Contrast(float x) {
+			float x2 = x * x;
+			float x4 = x2 * x2;
+			return 15.5f * x4 * x2 - 40.14f * x4 * x + 31.96f * x4 - 6.868f * x2 * x + 0.4298f * x2 + 0.1191f * x - 0.00232f;
+		}
+		static float Encode(float v) {
+			v = std::clamp(std::log2(std::max(v, 1e-10f)), MIN_EV, MAX_EV);
+			return Contrast((v - MIN_EV) / (MAX_EV - MIN_EV));
+		}
+		static void Apply(float& r, float& g, float& b, const ToneCurve&) {
+			// 进入 AgX 基色
+			float ar = 0.842479062f * r + 0.0784336f * g + 0.0792237451f * b;
+			float ag = 0.0423282423f * r + 0.878468636f * g + 0.0791661275f * b;
+			float ab = 0.0423756549f * r + 0.0784336f * g + 0.879142974f * b;
+			ar = Encode(ar);
+			ag = Encode(ag);
+			ab = Encode(ab);
+			// 回到线性 sRGB
+			float lr = 1.19687901f * ar - 0.0980208811f * ag - 0.099029744f * ab;
+			float lg = -0.0528968518f * ar + 1.15190313f * ag - 0.0989611768f * ab;
+			float lb = -0.0529716355f * ar - 0.0980434501f * ag + 1.15107367f * ab;
+			r = std::pow(std::max(lr, 0.0f), 2.2f);
+			g = std::pow(std::max(lg, 0.0f), 2.2f);
+			b = std::pow(std::max(lb, 0.0f), 2.2f);
+		}
+	};
+
+	// 把算子对应的策略类型交给 fn.template operator()<Policy>()，算子到策略的映射只写在这一处
+	template<class Fn>
+	decltype(auto) WithToneMapPolicy(ToneMapOperator op, Fn&& fn) {
+		switch (op) {
+		case ToneMapOperator::ACES:   return fn.template operator()<ToneMapACESPolicy>();
+		case ToneMapOperator::Hable:  return fn.template operator()<ToneMapHablePolicy>();
+		case ToneMapOperator::BT2390: return fn.template operator()<ToneMapBT2390Policy>();
+		case ToneMapOperator::AgX:    return fn.template operator()<ToneMapAgXPolicy>();
+		default:
+			// Reinhard 与扩展 Reinhard 共用策略，差别只在曲线的白点
+			return fn.template operator()<ToneMapReinhardPolicy>();
+		}
+	}
 
 } // namespace screenshot_tool
\ No newline at end of file
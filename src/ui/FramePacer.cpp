@@ -0,0 +1,83 @@
+#include "FramePacer.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace screenshot_tool {
+
+    void InputCoalescer::Push(int x, int y) {
+        x_ = x;
+        y_ = y;
+        ++pending_;
+    }
+
+    bool InputCoalescer::Take(int& x, int& y, int& merged) {
+        merged = 0;
+        if (pending_ == 0) return false;
+        x = x_;
+        y = y_;
+        merged = pending_ - 1;
+        pending_ = 0;
+        return true;
+    }
+
+    void FadeAnimation::Start(int64_t nowUs, uint8_t from, uint8_t to) {
+        from_ = from;
+        to_ = to;
+        startUs_ = nowUs;
+        float distance = std::fabs(static_cast<float>(to) - static_cast<float>(from));
+        durationUs_ = static_cast<int64_t>(distance / ALPHA_PER_SECOND * 1e6f);
+        active_ = durationUs_ > 0;
+    }
+
+    uint8_t FadeAnimation::Sample(int64_t nowUs) {
+        if (!active_) return to_;
+        int64_t elapsed = nowUs - startUs_;
+        if (elapsed >= durationUs_) {
+            active_ = false;
+            return to_;
+        }
+        float t = static_cast<float>(std::max<int64_t>(elapsed, 0)) / static_cast<float>(durationUs_);
+        float v = from_ + (static_cast<float>(to_) - from_) * t;
+        return static_cast<uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+    }
+
+    void FramePacer::Reset() {
+        lastFrameUs_ = -1;
+        intervalsUs_.clear();
+        coalescedInputs_ = 0;
+    }
+
+    void FramePacer::OnFrame(int64_t nowUs) {
+        if (lastFrameUs_ >= 0 && nowUs > lastFrameUs_) {
+            intervalsUs_.push_back(nowUs - lastFrameUs_);
+        }
+        lastFrameUs_ = nowUs;
+    }
+
+    FrameStats FramePacer::Stats() const {
+        FrameStats s;
+        s.coalescedInputs = coalescedInputs_;
+        s.frames = static_cast<int>(intervalsUs_.size());
+        if (intervalsUs_.empty()) return s;
+
+        std::vector<int64_t> sorted = intervalsUs_;
+        auto mid = sorted.begin() + sorted.size() / 2;
+        std::nth_element(sorted.begin(), mid, sorted.end());
+        const int64_t median = *mid;
+
+        int64_t sum = 0;
+        int64_t maxInterval = 0;
+        for (int64_t v : intervalsUs_) {
+            sum += v;
+            maxInterval = std::max(maxInterval, v);
+            if (v * 2 > median * 3) ++s.lateFrames;
+        }
+
+        s.avgIntervalMs = static_cast<double>(sum) / intervalsUs_.size() / 1000.0;
+        s.medianIntervalMs = median / 1000.0;
+        s.maxIntervalMs = maxInterval / 1000.0;
+        s.refreshHz = median > 0 ? 1e6 / static_cast<double>(median) : 0.0;
+        return s;
+    }
+
+} // namespace screenshot_tool
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 帧节奏与输入合并逻辑（与平台无关，时间统一使用微秒）
+    // SelectionOverlay 由垂直同步驱动：每帧只取最新一次鼠标位置、按真实时间推进动画，并统计帧间隔。
+
+    // 鼠标输入合并：两帧之间的多次移动只保留最后一次位置
+    class InputCoalescer {
+    public:
+        void Push(int x, int y);
+        // 取出最新位置，返回 false 表示本帧没有新输入；merged 为本帧合并的事件数
+        bool Take(int& x, int& y, int& merged);
+        bool HasPending() const { return pending_ > 0; }
+        void Clear() { pending_ = 0; }
+
+    private:
+        int x_ = 0;
+        int y_ = 0;
+        int pending_ = 0;
+    };
+
+    // 基于时间的透明度渐变（替代固定步长的定时器动画）
+    class FadeAnimation {
+    public:
+        // 与原实现速度一致：每 15ms 变化 16 个 alpha 单位
+        static constexpr float ALPHA_PER_SECOND = 16.0f * 1000.0f / 15.0f;
+
+        void Start(int64_t nowUs, uint8_t from, uint8_t to);
+        uint8_t Sample(int64_t nowUs);
+        void Stop() { active_ = false; }
+        bool Active() const { return active_; }
+        uint8_t Target() const { return to_; }
+
+    private:
+        int64_t startUs_ = 0;
+        int64_t durationUs_ = 0;
+        uint8_t from_ = 0;
+        uint8_t to_ = 0;
+        bool active_ = false;
+    };
+
+    struct FrameStats {
+        int     frames = 0;             // 统计到的帧间隔数量
+        double  avgIntervalMs = 0.0;
+        double  medianIntervalMs = 0.0;
+        double  maxIntervalMs = 0.0;
+        double  refreshHz = 0.0;        // 由中位帧间隔估算的实际刷新率
+        int     lateFrames = 0;         // 间隔超过 1.5 倍中位数的帧（掉帧）
+        int     coalescedInputs = 0;    // 被合并掉的鼠标事件数量
+    };
+
+    // 记录每帧时间戳并汇总帧间隔
+    class FramePacer {
+    public:
+        void Reset();
+        void OnFrame(int64_t nowUs);
+        // 帧循环空闲后调用，下一帧不与之前的帧计算间隔
+        void Suspend() { lastFrameUs_ = -1; }
+        void AddCoalescedInputs(int count) { coalescedInputs_ += count; }
+        FrameStats Stats() const;
+
+    private:
+        int64_t lastFrameUs_ = -1;
+        std::vector<int64_t> intervalsUs_;
+        int coalescedInputs_ = 0;
+    };
+
+} // namespace screenshot_tool
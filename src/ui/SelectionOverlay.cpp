@@ -3,6 +3,8 @@
 #include <vector>
 #include <cmath>
 #include "../util/Logger.hpp"
+#include "../image/EdgeIndex.hpp"
+#include <chrono>
 
 // D3D11 和 D2D/DirectWrite 头文件
 #include <d3d11_1.h>
@@ -11,11 +13,10 @@
 #include <wrl/client.h>
 
 // 链接必要的库
-#pragma comment(lib, "winmm.lib")
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "d2d1.lib")
 #pragma comment(lib, "dwrite.lib")
-#include <mmsystem.h>
+#pragma comment(lib, "dwmapi.lib")
 
 using Microsoft::WRL::ComPtr;
 
@@ -23,6 +24,64 @@ namespace screenshot_tool {
 
     static const wchar_t* kOverlayClass = L"ScreenShotOverlayWindow";
     
+    // 帧循环线程在垂直同步后投递的消息
+    static constexpr UINT WM_OVERLAY_FRAME = WM_APP + 1;
+    
+    // 单调时钟（微秒）
+    static int64_t nowMicroseconds() {
+        static const int64_t freq = [] {
+            LARGE_INTEGER f;
+            QueryPerformanceFrequency(&f);
+            return static_cast<int64_t>(f.QuadPart);
+        }();
+        LARGE_INTEGER c;
+        QueryPerformanceCounter(&c);
+        return static_cast<int64_t>(c.QuadPart / freq * 1000000 + (c.QuadPart % freq) * 1000000 / freq);
+    }
+    
+    // 冻结时枚举可吸附的顶层窗口（EnumWindows 按 Z 序从上到下返回）
+    struct SnapWindowEnumData {
+        HWND overlay = nullptr;
+        HWND parent = nullptr;
+        RECT clip{};
+        std::vector<SnapRect> rects;
+    };
+
+    static BOOL CALLBACK SnapWindowEnumProc(HWND hwnd, LPARAM lParam) {
+        auto* data = reinterpret_cast<SnapWindowEnumData*>(lParam);
+        if (hwnd == data->overlay || hwnd == data->parent) return TRUE;
+        if (!IsWindowVisible(hwnd) || IsIconic(hwnd)) return TRUE;
+
+        // 跳过被 DWM 隐藏的窗口（其他虚拟桌面、挂起的 UWP 应用等）
+        BOOL cloaked = FALSE;
+        if (SUCCEEDED(DwmGetWindowAttribute(hwnd, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked) {
+            return TRUE;
+        }
+
+        // 优先使用不含阴影的可见边框
+        RECT r{};
+        if (FAILED(DwmGetWindowAttribute(hwnd, DWMWA_EXTENDED_FRAME_BOUNDS, &r, sizeof(r)))) {
+            GetWindowRect(hwnd, &r);
+        }
+
+        RECT clipped{};
+        if (!IntersectRect(&clipped, &r, &data->clip)) return TRUE;
+        if (clipped.right - clipped.left < 16 || clipped.bottom - clipped.top < 16) return TRUE;
+
+        data->rects.push_back({
+            clipped.left - data->clip.left,
+            clipped.top - data->clip.top,
+            clipped.right - data->clip.left,
+            clipped.bottom - data->clip.top
+        });
+        return TRUE;
+    }
+    
+    static D2D1_RECT_F toRectF(const RECT& r) {
+        return D2D1::RectF(static_cast<float>(r.left), static_cast<float>(r.top),
+                           static_cast<float>(r.right), static_cast<float>(r.bottom));
+    }
+    
     // 颜色常量定义
     namespace OverlayColors {
         static constexpr COLORREF TRANSPARENT_KEY = RGB(255, 0, 255);
@@ -60,6 +119,7 @@ namespace screenshot_tool {
             }
             
             initializeSimpleAnimation();
+            startFrameLoop();
             
             // *** 修复：尝试加载背景图像，避免首次黑屏 ***
             if (backgroundCheckCallback_) {
@@ -74,12 +134,10 @@ namespace screenshot_tool {
     }
 
     SelectionOverlay::~SelectionOverlay() {
-        // 清理定时器
-        if (timerId_ && hwnd_) {
-            KillTimer(hwnd_, timerId_);
-            timerId_ = 0;
-        }
+        // 先停止帧循环线程，之后才能释放交换链和窗口
+        stopFrameLoop();
         
+        // 清理定时器
         if (backgroundCheckTimerId_ && hwnd_) {
             KillTimer(hwnd_, backgroundCheckTimerId_);
             backgroundCheckTimerId_ = 0;
@@ -124,6 +182,7 @@ namespace screenshot_tool {
         swapChainDesc.SampleDesc.Quality = 0;
         swapChainDesc.Windowed = TRUE;
         swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
+        swapChainDesc.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
 
         D3D_FEATURE_LEVEL featureLevels[] = {
             D3D_FEATURE_LEVEL_11_1,
@@ -147,11 +206,30 @@ namespace screenshot_tool {
             &d3dContext_
         );
 
+        if (FAILED(hr)) {
+            // 旧系统不支持帧延迟等待对象，去掉该标志重试（帧循环回退到 DwmFlush）
+            swapChainDesc.Flags = 0;
+            hr = D3D11CreateDeviceAndSwapChain(
+                nullptr, D3D_DRIVER_TYPE_HARDWARE, nullptr, D3D11_CREATE_DEVICE_BGRA_SUPPORT,
+                featureLevels, ARRAYSIZE(featureLevels), D3D11_SDK_VERSION,
+                &swapChainDesc, &dxgiSwapChain_, &d3dDevice_, &d3dFeatureLevel_, &d3dContext_);
+        }
+
         if (FAILED(hr)) {
             Logger::Error(L"Failed to create D3D11 device and swap chain: {:#x}", static_cast<uint32_t>(hr));
             return false;
         }
 
+        swapChainFlags_ = swapChainDesc.Flags;
+        if (swapChainFlags_ & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT) {
+            ComPtr<IDXGISwapChain2> swapChain2;
+            if (SUCCEEDED(dxgiSwapChain_.As(&swapChain2))) {
+                swapChain2->SetMaximumFrameLatency(1);
+                frameLatencyWaitable_ = swapChain2->GetFrameLatencyWaitableObject();
+            }
+        }
+        Logger::Debug(L"Overlay frame pacing: {}", frameLatencyWaitable_ ? L"frame latency waitable" : L"DwmFlush");
+
         // 创建渲染目标视图
         ComPtr<ID3D11Texture2D> backBuffer;
         hr = dxgiSwapChain_->GetBuffer(0, IID_PPV_ARGS(&backBuffer));
@@ -239,6 +317,10 @@ namespace screenshot_tool {
     }
 
     void SelectionOverlay::cleanupD3DRenderer() {
+        if (frameLatencyWaitable_) {
+            CloseHandle(frameLatencyWaitable_);
+            frameLatencyWaitable_ = nullptr;
+        }
         dwriteTextFormat_.Reset();
         d2dDarkBrush_.Reset();
         d2dWhiteBrush_.Reset();
@@ -260,7 +342,7 @@ namespace screenshot_tool {
         d3dContext_->Flush();
 
         // 调整交换链大小
-        HRESULT hr = dxgiSwapChain_->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, 0);
+        HRESULT hr = dxgiSwapChain_->ResizeBuffers(0, width, height, DXGI_FORMAT_UNKNOWN, swapChainFlags_);
         if (FAILED(hr)) {
             Logger::Error(L"Failed to resize swap chain buffers: {:#x}", static_cast<uint32_t>(hr));
             return;
@@ -313,14 +395,210 @@ namespace screenshot_tool {
         }
     }
 
+    bool SelectionOverlay::IsActive() const {
+        return hwnd_ && (IsWindowVisible(hwnd_) || fadingOut_);
+    }
+
+    bool SelectionOverlay::TrimIdle() {
+        if (!hwnd_ || IsActive()) return false;
+        destroyBackgroundBitmap();
+        resizeD3DRenderer(1, 1);
+        return true;
+    }
+
+    size_t SelectionOverlay::BackgroundBytes() const {
+        return backgroundBitmap_ ? static_cast<size_t>(backgroundWidth_) * backgroundHeight_ * 4 : 0;
+    }
+
+    size_t SelectionOverlay::SwapChainBytes() const {
+        if (!dxgiSwapChain_) return 0;
+        DXGI_SWAP_CHAIN_DESC desc{};
+        if (FAILED(dxgiSwapChain_->GetDesc(&desc))) return 0;
+        return static_cast<size_t>(desc.BufferDesc.Width) * desc.BufferDesc.Height * 4 * desc.BufferCount;
+    }
+
     void SelectionOverlay::initializeSimpleAnimation() {
-        fadeInterval_ = 15;
         alpha_ = 0;
         fadingIn_ = false;
         fadingOut_ = false;
-        lastUpdateTime_ = GetTickCount();
+        fade_.Stop();
+        inputCoalescer_.Clear();
+        framePacer_.Reset();
+        
+        Logger::Debug(L"Animation system initialized (vsync-driven)");
+    }
+
+    // ---- 垂直同步帧循环 ----
+    void SelectionOverlay::startFrameLoop() {
+        if (frameThread_.joinable()) return;
+        
+        frameLoopActive_ = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (!frameLoopActive_) {
+            Logger::Error(L"Failed to create frame loop event");
+            return;
+        }
+        
+        frameThreadRunning_ = true;
+        frameThread_ = std::thread([this] { frameLoopThread(); });
+    }
+
+    void SelectionOverlay::stopFrameLoop() {
+        if (!frameThread_.joinable()) return;
+        
+        frameThreadRunning_ = false;
+        SetEvent(frameLoopActive_);
+        frameThread_.join();
+        
+        CloseHandle(frameLoopActive_);
+        frameLoopActive_ = nullptr;
+        framePending_ = false;
+    }
+
+    void SelectionOverlay::setFrameLoopActive(bool active) {
+        if (!frameLoopActive_) return;
+        
+        if (active) {
+            SetEvent(frameLoopActive_);
+        } else {
+            ResetEvent(frameLoopActive_);
+            framePacer_.Suspend();
+        }
+    }
+
+    void SelectionOverlay::frameLoopThread() {
+        while (frameThreadRunning_) {
+            // 没有动画和输入时在此休眠，不占用 CPU
+            WaitForSingleObject(frameLoopActive_, INFINITE);
+            if (!frameThreadRunning_) break;
+            
+            waitForVBlank();
+            
+            // UI 线程尚未处理上一帧时不再投递，输入会在下一帧一起合并
+            if (!framePending_.exchange(true)) {
+                if (!PostMessage(hwnd_, WM_OVERLAY_FRAME, 0, 0)) {
+                    framePending_ = false;
+                }
+            }
+        }
+    }
+
+    void SelectionOverlay::waitForVBlank() {
+        // 上一帧有 Present 时等待交换链可接受新帧；否则等待对象保持有信号，改用 DWM 合成节拍
+        if (frameLatencyWaitable_ && lastFramePresented_) {
+            if (WaitForSingleObjectEx(frameLatencyWaitable_, 100, FALSE) == WAIT_OBJECT_0) {
+                return;
+            }
+        }
+        
+        if (FAILED(DwmFlush())) {
+            Sleep(8); // DWM 合成不可用
+        }
+    }
+
+    void SelectionOverlay::applyPendingInput() {
+        int x = 0, y = 0, merged = 0;
+        if (!inputCoalescer_.Take(x, y, merged)) return;
+        
+        framePacer_.AddCoalescedInputs(merged);
+        
+        if (!selecting_) {
+            updateHover(x, y);
+            return;
+        }
+        
+        if (snapActive()) {
+            snapIndex_.SnapPoint(x, y, SNAP_RADIUS);
+        }
+        if (cur_.x != x || cur_.y != y) {
+            cur_.x = x;
+            cur_.y = y;
+            frameDirty_ = true;
+        }
+    }
+
+    void SelectionOverlay::onFrame() {
+        framePending_ = false;
+        
+        const int64_t now = nowMicroseconds();
+        framePacer_.OnFrame(now);
+        
+        applyPendingInput();
+        
+        if (fade_.Active()) {
+            alpha_ = fade_.Sample(now);
+            SetLayeredWindowAttributes(hwnd_, OverlayColors::TRANSPARENT_KEY, alpha_, LWA_COLORKEY | LWA_ALPHA);
+            if (!fade_.Active()) {
+                onFadeFinished();
+            }
+        }
         
-        Logger::Debug(L"Animation system initialized with 15ms interval");
+        bool presented = false;
+        if (frameDirty_ && IsWindowVisible(hwnd_)) {
+            renderWithD3D();
+            ValidateRect(hwnd_, nullptr);
+            presented = true;
+        }
+        frameDirty_ = false;
+        lastFramePresented_ = presented;
+        
+        if (!fade_.Active() && !inputCoalescer_.HasPending()) {
+            setFrameLoopActive(false);
+        }
+    }
+
+    // ---- 选区吸附 ----
+    void SelectionOverlay::collectSnapWindows(const RECT& displayRect) {
+        SnapWindowEnumData data;
+        data.overlay = hwnd_;
+        data.parent = parent_;
+        data.clip = displayRect;
+        EnumWindows(SnapWindowEnumProc, reinterpret_cast<LPARAM>(&data));
+        
+        Logger::Debug(L"Snap windows collected: {}", data.rects.size());
+        snapIndex_.SetWindows(std::move(data.rects));
+    }
+
+    bool SelectionOverlay::snapActive() const {
+        // 按住 Alt 时临时关闭吸附，便于精细选择
+        return snapEnabled_ && GetKeyState(VK_MENU) >= 0;
+    }
+
+    void SelectionOverlay::updateHover(int x, int y) {
+        SnapRect window{};
+        bool valid = snapActive() && backgroundBitmap_ && snapIndex_.WindowAt(x, y, window);
+        RECT rect{ window.left, window.top, window.right, window.bottom };
+        
+        if (valid != hoverValid_ || (valid && !EqualRect(&rect, &hoverRect_))) {
+            hoverValid_ = valid;
+            hoverRect_ = valid ? rect : RECT{};
+            frameDirty_ = true;
+        }
+    }
+
+    bool SelectionOverlay::getHighlightRect(RECT& out) const {
+        if (selecting_) {
+            out = RECT{
+                std::min(start_.x, cur_.x),
+                std::min(start_.y, cur_.y),
+                std::max(start_.x, cur_.x),
+                std::max(start_.y, cur_.y)
+            };
+            return true;
+        }
+        if (hoverValid_) {
+            out = hoverRect_;
+            return true;
+        }
+        return false;
+    }
+
+    void SelectionOverlay::logFrameStats() {
+        FrameStats stats = framePacer_.Stats();
+        if (stats.frames == 0) return;
+        
+        Logger::Debug(L"Overlay frames: {}, avg {:.2f} ms, median {:.2f} ms (~{:.0f} Hz), max {:.2f} ms, late {}, coalesced inputs {}",
+            stats.frames, stats.avgIntervalMs, stats.medianIntervalMs, stats.refreshHz,
+            stats.maxIntervalMs, stats.lateFrames, stats.coalescedInputs);
     }
 
     void SelectionOverlay::Hide() {
@@ -332,17 +610,18 @@ namespace screenshot_tool {
         }
         
         if (selecting_) {
-            if (timerId_) {
-                KillTimer(hwnd_, timerId_);
-                timerId_ = 0;
-            }
+            fade_.Stop();
             fadingIn_ = false;
             fadingOut_ = false;
+            inputCoalescer_.Clear();
+            setFrameLoopActive(false);
             ShowWindow(hwnd_, SW_HIDE);
         } else {
             startFadeOut();
         }
 
+        queued_.clear();
+        
         // *** 清理背景图像缓存 ***
         destroyBackgroundBitmap();
     }
@@ -356,6 +635,7 @@ namespace screenshot_tool {
         cur_.x = cur_.y = 0;
         memset(&selectedRect_, 0, sizeof(selectedRect_));
         notifyOnHide_ = false;
+        queued_.clear();
         
         // *** 先清理旧的背景图像，然后等待新的冻结画面加载完成 ***
         destroyBackgroundBitmap(); // 确保清理掉上次的残留画面
@@ -365,23 +645,27 @@ namespace screenshot_tool {
         }
         
         // 重置动画状态
-        if (timerId_) {
-            KillTimer(hwnd_, timerId_);
-            timerId_ = 0;
-        }
         if (backgroundCheckTimerId_) {
             KillTimer(hwnd_, backgroundCheckTimerId_);
             backgroundCheckTimerId_ = 0;
         }
+        fade_.Stop();
         fadingIn_ = false;
         fadingOut_ = false;
         alpha_ = 0;
+        inputCoalescer_.Clear();
+        framePacer_.Reset();
+        hoverValid_ = false;
         
         ShowWindow(hwnd_, SW_HIDE);
         
-        // 存储虚拟桌面偏移信息
-        virtualDesktopLeft_ = GetSystemMetrics(SM_XVIRTUALSCREEN);
-        virtualDesktopTop_ = GetSystemMetrics(SM_YVIRTUALSCREEN);
+        // 冻结时枚举一次窗口矩形；背景图像与窗口覆盖同一范围，边缘索引坐标无需偏移
+        if (snapEnabled_) {
+            collectSnapWindows(displayRect);
+        } else {
+            snapIndex_.SetWindows({});
+        }
+        snapIndex_.SetEdgeOffset(0, 0);
         
         // 设置窗口位置和大小
         SetWindowPos(hwnd_, HWND_TOPMOST, 
@@ -416,11 +700,6 @@ namespace screenshot_tool {
     }
 
     void SelectionOverlay::startFadeIn() {
-        if (timerId_) {
-            KillTimer(hwnd_, timerId_);
-            timerId_ = 0;
-        }
-        
         alpha_ = 0;
         fadingIn_ = true;
         fadingOut_ = false;
@@ -428,67 +707,48 @@ namespace screenshot_tool {
         ShowWindow(hwnd_, SW_SHOWNOACTIVATE);
         SetLayeredWindowAttributes(hwnd_, OverlayColors::TRANSPARENT_KEY, alpha_, LWA_COLORKEY | LWA_ALPHA);
         
-        timerId_ = SetTimer(hwnd_, FADE_TIMER_ID, fadeInterval_, nullptr);
-        InvalidateRect(hwnd_, nullptr, FALSE);
+        // 根据是否有背景图像决定目标透明度
+        BYTE targetAlpha = backgroundBitmap_ ? 255 : TARGET_ALPHA;
+        fade_.Start(nowMicroseconds(), alpha_, targetAlpha);
+        
+        frameDirty_ = true;
+        setFrameLoopActive(true);
     }
-
+    
     void SelectionOverlay::startFadeOut() {
-        if (timerId_) {
-            KillTimer(hwnd_, timerId_);
-            timerId_ = 0;
-        }
-        
         fadingIn_ = false;
         fadingOut_ = true;
         
         // 如果当前alpha为0，直接隐藏
         if (alpha_ <= 0) {
             alpha_ = 0;
+            fade_.Stop();
             fadingOut_ = false;
             ShowWindow(hwnd_, SW_HIDE);
             return;
         }
         
-        timerId_ = SetTimer(hwnd_, FADE_TIMER_ID, fadeInterval_, nullptr);
+        fade_.Start(nowMicroseconds(), alpha_, 0);
+        setFrameLoopActive(true);
     }
-
-    void SelectionOverlay::updateFade() {
+    
+    void SelectionOverlay::onFadeFinished() {
         if (fadingIn_) {
-            // 根据是否有背景图像决定目标透明度
-            BYTE targetAlpha = backgroundBitmap_ ? 255 : TARGET_ALPHA;
+            fadingIn_ = false;
+        } else if (fadingOut_) {
+            fadingOut_ = false;
+            ShowWindow(hwnd_, SW_HIDE);
             
-            alpha_ = static_cast<BYTE>(std::min<int>(alpha_ + 16, targetAlpha));
-            SetLayeredWindowAttributes(hwnd_, OverlayColors::TRANSPARENT_KEY, alpha_, LWA_COLORKEY | LWA_ALPHA);
+            auto style = GetWindowLong(hwnd_, GWL_EXSTYLE);
+            SetWindowLong(hwnd_, GWL_EXSTYLE, style | WS_EX_TRANSPARENT);
+            selecting_ = false;
             
-            if (alpha_ >= targetAlpha) {
-                fadingIn_ = false;
-                KillTimer(hwnd_, timerId_);
-                timerId_ = 0;
-            }
-        } else if (fadingOut_) {
-            if (alpha_ <= 16) {
-                alpha_ = 0;
-                SetLayeredWindowAttributes(hwnd_, OverlayColors::TRANSPARENT_KEY, alpha_, LWA_COLORKEY | LWA_ALPHA);
-                fadingOut_ = false;
-                KillTimer(hwnd_, timerId_);
-                timerId_ = 0;
-                ShowWindow(hwnd_, SW_HIDE);
-                
-                auto style = GetWindowLong(hwnd_, GWL_EXSTYLE);
-                SetWindowLong(hwnd_, GWL_EXSTYLE, style | WS_EX_TRANSPARENT);
-                selecting_ = false;
-                
-                if (notifyOnHide_ && parent_) {
-                    PostMessage(parent_, WM_USER + 100, 0, 0);
-                }
-                notifyOnHide_ = false;
-            } else {
-                alpha_ = static_cast<BYTE>(alpha_ - 16);
-                SetLayeredWindowAttributes(hwnd_, OverlayColors::TRANSPARENT_KEY, alpha_, LWA_COLORKEY | LWA_ALPHA);
+            logFrameStats();
+            
+            if (notifyOnHide_ && parent_) {
+                PostMessage(parent_, WM_USER + 100, 0, 0);
             }
-        } else {
-            KillTimer(hwnd_, timerId_);
-            timerId_ = 0;
+            notifyOnHide_ = false;
         }
     }
 
@@ -507,11 +767,13 @@ namespace screenshot_tool {
             renderBackgroundWithD3D();
         }
 
-        // 绘制暗化遮罩层（除了选择区域）
+        // 绘制暗化遮罩层（除了选择区域和已排队的区域）
         renderDarkenMaskWithD3D();
+        renderQueuedRegionsWithD3D();
 
-        // 如果正在选择，绘制选择框和尺寸信息
-        if (selecting_) {
+        // 绘制选择框（或吸附的窗口）和尺寸信息
+        RECT highlight{};
+        if (getHighlightRect(highlight)) {
             renderSelectionBoxWithD3D();
             renderSizeTextWithD3D();
         }
@@ -572,60 +834,72 @@ namespace screenshot_tool {
             static_cast<float>(clientRect.bottom)
         );
 
-        if (selecting_) {
-            // 绘制除选择区域外的暗化遮罩
-            D2D1_RECT_F selectionRect = D2D1::RectF(
-                static_cast<float>(std::min(start_.x, cur_.x)),
-                static_cast<float>(std::min(start_.y, cur_.y)),
-                static_cast<float>(std::max(start_.x, cur_.x)),
-                static_cast<float>(std::max(start_.y, cur_.y))
-            );
+        // 镂空区域：已排队的选区 + 当前选择框（或吸附的窗口）
+        std::vector<RECT> holes = queued_;
+        RECT highlight{};
+        if (getHighlightRect(highlight)) {
+            holes.push_back(highlight);
+        }
 
-            // 使用几何形状创建镂空效果
-            ComPtr<ID2D1PathGeometry> pathGeometry;
-            hr = d2dFactory_->CreatePathGeometry(&pathGeometry);
-            if (FAILED(hr)) return;
+        if (holes.empty()) {
+            // 没有选择时，全屏暗化
+            d2dRenderTarget_->FillRectangle(fullRect, darkenBrush.Get());
+            return;
+        }
+
+        // 从整个窗口依次减去各镂空区域，多个选区重叠时也不会重新变暗
+        ComPtr<ID2D1RectangleGeometry> fullGeometry;
+        hr = d2dFactory_->CreateRectangleGeometry(fullRect, &fullGeometry);
+        if (FAILED(hr)) return;
 
+        ComPtr<ID2D1Geometry> mask = fullGeometry;
+        for (const RECT& hole : holes) {
+            ComPtr<ID2D1RectangleGeometry> holeGeometry;
+            ComPtr<ID2D1PathGeometry> remaining;
             ComPtr<ID2D1GeometrySink> geometrySink;
-            hr = pathGeometry->Open(&geometrySink);
-            if (FAILED(hr)) return;
+            if (FAILED(d2dFactory_->CreateRectangleGeometry(toRectF(hole), &holeGeometry)) ||
+                FAILED(d2dFactory_->CreatePathGeometry(&remaining)) ||
+                FAILED(remaining->Open(&geometrySink))) {
+                return;
+            }
+            hr = mask->CombineWithGeometry(holeGeometry.Get(), D2D1_COMBINE_MODE_EXCLUDE, nullptr, geometrySink.Get());
+            if (FAILED(hr) || FAILED(geometrySink->Close())) return;
+            mask = remaining;
+        }
 
-            // 创建外部矩形，内部镂空选择区域
-            geometrySink->SetFillMode(D2D1_FILL_MODE_WINDING);
-            
-            // 外部矩形
-            geometrySink->BeginFigure(D2D1::Point2F(fullRect.left, fullRect.top), D2D1_FIGURE_BEGIN_FILLED);
-            geometrySink->AddLine(D2D1::Point2F(fullRect.right, fullRect.top));
-            geometrySink->AddLine(D2D1::Point2F(fullRect.right, fullRect.bottom));
-            geometrySink->AddLine(D2D1::Point2F(fullRect.left, fullRect.bottom));
-            geometrySink->EndFigure(D2D1_FIGURE_END_CLOSED);
-
-            // 内部镂空矩形（选择区域）
-            geometrySink->BeginFigure(D2D1::Point2F(selectionRect.left, selectionRect.top), D2D1_FIGURE_BEGIN_FILLED);
-            geometrySink->AddLine(D2D1::Point2F(selectionRect.left, selectionRect.bottom));
-            geometrySink->AddLine(D2D1::Point2F(selectionRect.right, selectionRect.bottom));
-            geometrySink->AddLine(D2D1::Point2F(selectionRect.right, selectionRect.top));
-            geometrySink->EndFigure(D2D1_FIGURE_END_CLOSED);
-
-            hr = geometrySink->Close();
-            if (FAILED(hr)) return;
-
-            // 填充镂空的暗化区域
-            d2dRenderTarget_->FillGeometry(pathGeometry.Get(), darkenBrush.Get());
-        } else {
-            // 没有选择时，全屏暗化
-            d2dRenderTarget_->FillRectangle(fullRect, darkenBrush.Get());
+        // 填充镂空的暗化区域
+        d2dRenderTarget_->FillGeometry(mask.Get(), darkenBrush.Get());
+    }
+
+    void SelectionOverlay::renderQueuedRegionsWithD3D() {
+        if (!d2dRenderTarget_ || !d2dWhiteBrush_ || queued_.empty()) return;
+
+        // 已排队的区域：细边框 + 左上角序号（即导出顺序）
+        for (size_t i = 0; i < queued_.size(); ++i) {
+            const D2D1_RECT_F rect = toRectF(queued_[i]);
+            d2dRenderTarget_->DrawRectangle(rect, d2dWhiteBrush_.Get(), 1.0f);
+
+            if (!dwriteTextFormat_) continue;
+            wchar_t label[16];
+            swprintf_s(label, L"%zu", i + 1);
+            const D2D1_RECT_F badge = D2D1::RectF(rect.left + 4.0f, rect.top + 4.0f, rect.left + 36.0f, rect.top + 28.0f);
+            if (d2dDarkBrush_) {
+                d2dRenderTarget_->FillRectangle(badge, d2dDarkBrush_.Get());
+            }
+            d2dRenderTarget_->DrawText(label, static_cast<UINT32>(wcslen(label)), dwriteTextFormat_.Get(),
+                D2D1::RectF(badge.left + 6.0f, badge.top + 2.0f, badge.right, badge.bottom), d2dWhiteBrush_.Get());
         }
     }
 
     void SelectionOverlay::renderSelectionBoxWithD3D() {
-        if (!d2dRenderTarget_ || !selecting_) return;
+        RECT highlight{};
+        if (!d2dRenderTarget_ || !getHighlightRect(highlight)) return;
 
         D2D1_RECT_F selectionRect = D2D1::RectF(
-            static_cast<float>(std::min(start_.x, cur_.x)),
-            static_cast<float>(std::min(start_.y, cur_.y)),
-            static_cast<float>(std::max(start_.x, cur_.x)),
-            static_cast<float>(std::max(start_.y, cur_.y))
+            static_cast<float>(highlight.left),
+            static_cast<float>(highlight.top),
+            static_cast<float>(highlight.right),
+            static_cast<float>(highlight.bottom)
         );
 
         // 使用预创建的白色画刷绘制选择框边框
@@ -635,10 +909,11 @@ namespace screenshot_tool {
     }
 
     void SelectionOverlay::renderSizeTextWithD3D() {
-        if (!d2dRenderTarget_ || !dwriteTextFormat_ || !selecting_) return;
+        RECT highlight{};
+        if (!d2dRenderTarget_ || !dwriteTextFormat_ || !getHighlightRect(highlight)) return;
 
-        int width = abs(cur_.x - start_.x);
-        int height = abs(cur_.y - start_.y);
+        int width = highlight.right - highlight.left;
+        int height = highlight.bottom - highlight.top;
 
         // 格式化尺寸文本
         wchar_t sizeText[64];
@@ -663,12 +938,12 @@ namespace screenshot_tool {
         if (FAILED(hr)) return;
 
         // 计算文本位置
-        float textX = static_cast<float>(std::min(start_.x, cur_.x));
-        float textY = static_cast<float>(std::min(start_.y, cur_.y)) - textMetrics.height - 8.0f;
+        float textX = static_cast<float>(highlight.left);
+        float textY = static_cast<float>(highlight.top) - textMetrics.height - 8.0f;
 
         // 如果文本会显示在顶部之外，则显示在选择框内部
         if (textY < 5.0f) {
-            textY = static_cast<float>(std::min(start_.y, cur_.y)) + 8.0f;
+            textY = static_cast<float>(highlight.top) + 8.0f;
         }
 
         // 确保文本不会超出左边界
@@ -761,7 +1036,7 @@ namespace screenshot_tool {
             return 0;
             
         case WM_MOUSEMOVE:   
-            if (selecting_) updateSelect(GET_X_LPARAM(l), GET_Y_LPARAM(l)); 
+            if (selecting_ || snapEnabled_) updateSelect(GET_X_LPARAM(l), GET_Y_LPARAM(l)); 
             return 0;
             
         case WM_LBUTTONUP:   
@@ -770,19 +1045,30 @@ namespace screenshot_tool {
             
         case WM_RBUTTONDOWN:
         case WM_RBUTTONUP:
-            cancelSelection();
+            // 多选队列非空时右键撤销最后一个区域，否则取消
+            if (queued_.empty()) {
+                cancelSelection();
+            } else if (m == WM_RBUTTONUP) {
+                undoQueued();
+            }
             return 0;
             
         case WM_KEYDOWN:
             if (w == VK_ESCAPE) {
                 cancelSelection();
+            } else if ((w == VK_RETURN || w == VK_SPACE) && !queued_.empty()) {
+                commitBatch();
+            } else if (w == VK_BACK || (w == 'Z' && GetKeyState(VK_CONTROL) < 0)) {
+                undoQueued();
             }
             return 0;
             
+        case WM_OVERLAY_FRAME:
+            onFrame();
+            return 0;
+            
         case WM_TIMER:
-            if (w == FADE_TIMER_ID) {
-                updateFade();
-            } else if (w == BACKGROUND_CHECK_TIMER_ID) {
+            if (w == BACKGROUND_CHECK_TIMER_ID) {
                 if (backgroundCheckCallback_) {
                     backgroundCheckCallback_();
                 } else {
@@ -859,6 +1145,9 @@ namespace screenshot_tool {
     }
 
     void SelectionOverlay::startSelect(int x, int y) { 
+        if (snapActive()) {
+            snapIndex_.SnapPoint(x, y, SNAP_RADIUS);
+        }
         selecting_ = true; 
         start_.x = x; 
         start_.y = y; 
@@ -866,66 +1155,30 @@ namespace screenshot_tool {
         
         SetCapture(hwnd_);
         
-        if (timerId_) {
-            KillTimer(hwnd_, timerId_);
-            timerId_ = 0;
-        }
+        fade_.Stop();
         fadingIn_ = false;
         fadingOut_ = false;
         alpha_ = 255;  // 选择时完全不透明
+        inputCoalescer_.Clear();
         
         SetLayeredWindowAttributes(hwnd_, OverlayColors::TRANSPARENT_KEY, alpha_, LWA_COLORKEY | LWA_ALPHA);
         
-        InvalidateRect(hwnd_, nullptr, FALSE); 
+        frameDirty_ = true;
+        setFrameLoopActive(true);
     }
     
     void SelectionOverlay::updateSelect(int x, int y) { 
-        // 性能优化：限制鼠标移动更新频率
-        DWORD currentTime = GetTickCount();
-        if (currentTime - lastUpdateTime_ < MIN_UPDATE_INTERVAL) {
-            return;
-        }
-        lastUpdateTime_ = currentTime;
-        
-        // 只在坐标真正变化时才重绘
-        if (cur_.x != x || cur_.y != y) {
-            // 计算旧的选择区域
-            RECT oldRect = {
-                std::min(start_.x, cur_.x),
-                std::min(start_.y, cur_.y),
-                std::max(start_.x, cur_.x),
-                std::max(start_.y, cur_.y)
-            };
-            
-            // 更新坐标
-            cur_.x = x; 
-            cur_.y = y; 
-            
-            // 计算新的选择区域
-            RECT newRect = {
-                std::min(start_.x, cur_.x),
-                std::min(start_.y, cur_.y),
-                std::max(start_.x, cur_.x),
-                std::max(start_.y, cur_.y)
-            };
-            
-            // 计算需要重绘的总区域
-            RECT unionRect;
-            UnionRect(&unionRect, &oldRect, &newRect);
-            InflateRect(&unionRect, 20, 20);
-            
-            // 确保重绘区域在窗口范围内
-            RECT clientRect;
-            GetClientRect(hwnd_, &clientRect);
-            IntersectRect(&unionRect, &unionRect, &clientRect);
-            
-            // 重绘计算出的区域
-            InvalidateRect(hwnd_, &unionRect, FALSE);
-        }
+        // 不丢弃鼠标事件：先记录最新位置，由下一次垂直同步统一合并并重绘
+        inputCoalescer_.Push(x, y);
+        setFrameLoopActive(true);
     }
 
     void SelectionOverlay::finishSelect() { 
         if (!selecting_) return; 
+        
+        // 使用尚未渲染的最新鼠标位置，避免最终选区落后一帧
+        applyPendingInput();
+        frameDirty_ = false;
         selecting_ = false; 
         
         ReleaseCapture();
@@ -937,14 +1190,30 @@ namespace screenshot_tool {
             std::max(start_.y, cur_.y) 
         }; 
         
-        // 将窗口坐标转换为屏幕坐标
-        RECT windowRect;
-        GetWindowRect(hwnd_, &windowRect);
+        // 单击未拖动时选择光标下的窗口
+        if (hoverValid_ && selectedRect.right - selectedRect.left <= 2 && selectedRect.bottom - selectedRect.top <= 2) {
+            selectedRect = hoverRect_;
+        }
+        hoverValid_ = false;
+        
+        // 多选：区域加入队列，overlay 保持显示；队列非空时普通松开连同当前区域一起导出
+        const bool queueing = batchCb_ && (multiSelect_ || queueModifierActive());
+        if (queueing || !queued_.empty()) {
+            if (selectedRect.right - selectedRect.left > 2 && selectedRect.bottom - selectedRect.top > 2) {
+                queued_.push_back(selectedRect);
+            }
+            if (queueing) {
+                Logger::Debug(L"Region queued: {} pending", queued_.size());
+                frameDirty_ = true;
+                setFrameLoopActive(true);
+            } else {
+                commitBatch();
+            }
+            return;
+        }
         
-        selectedRect.left += windowRect.left;
-        selectedRect.top += windowRect.top;
-        selectedRect.right += windowRect.left;
-        selectedRect.bottom += windowRect.top;
+        // 将窗口坐标转换为屏幕坐标
+        selectedRect = toScreen(selectedRect);
         
         // 存储选择结果
         selectedRect_ = selectedRect;
@@ -971,10 +1240,64 @@ namespace screenshot_tool {
         cur_.x = cur_.y = 0;
         memset(&selectedRect_, 0, sizeof(selectedRect_));
         notifyOnHide_ = false;
+        inputCoalescer_.Clear();
+        hoverValid_ = false;
+        queued_.clear();
         
         startFadeOut();
     }
 
+    bool SelectionOverlay::queueModifierActive() const {
+        // 按住 Ctrl 松开鼠标时临时进入多选
+        return GetKeyState(VK_CONTROL) < 0;
+    }
+
+    RECT SelectionOverlay::toScreen(const RECT& client) const {
+        RECT windowRect{};
+        GetWindowRect(hwnd_, &windowRect);
+        return RECT{
+            client.left + windowRect.left,
+            client.top + windowRect.top,
+            client.right + windowRect.left,
+            client.bottom + windowRect.top
+        };
+    }
+
+    void SelectionOverlay::commitBatch() {
+        if (selecting_) {
+            ReleaseCapture();
+            selecting_ = false;
+        }
+        if (queued_.empty()) {
+            cancelSelection();
+            return;
+        }
+        
+        std::vector<RECT> rects;
+        rects.reserve(queued_.size());
+        for (const RECT& r : queued_) {
+            rects.push_back(toScreen(r));
+        }
+        queued_.clear();
+        
+        selectedRect_ = rects.back();
+        notifyOnHide_ = true;
+        
+        Logger::Info(L"Multi-select finished: {} regions", rects.size());
+        if (batchCb_) {
+            batchCb_(rects);
+        }
+        
+        startFadeOut();
+    }
+
+    void SelectionOverlay::undoQueued() {
+        if (queued_.empty()) return;
+        queued_.pop_back();
+        frameDirty_ = true;
+        setFrameLoopActive(true);
+    }
+
     bool SelectionOverlay::IsValid() const {
         return hwnd_ != nullptr;
     }
@@ -990,6 +1313,16 @@ namespace screenshot_tool {
             if (imageData && width > 0 && height > 0) {
                 createBackgroundBitmap(imageData, width, height, stride);
                 
+                // 在冻结帧上建立边缘索引，拖动时的吸附查询只做二分查找
+                if (snapEnabled_) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    EdgeIndex edges;
+                    edges.Build(imageData, width, height, stride);
+                    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    Logger::Debug(L"Edge index built: {} edges, {} KB, {:.1f} ms", edges.EdgeCount(), edges.MemoryBytes() / 1024, ms);
+                    snapIndex_.SetEdges(std::move(edges));
+                }
+                
                 // 背景图像加载完成后，立即显示窗口并启动淡入动画
                 if (backgroundBitmap_ && !IsWindowVisible(hwnd_)) {
                     auto style = GetWindowLong(hwnd_, GWL_EXSTYLE);
@@ -1083,6 +1416,7 @@ namespace screenshot_tool {
     }
 
     void SelectionOverlay::destroyBackgroundBitmap() {
+        snapIndex_.SetEdges(EdgeIndex{});
         if (backgroundBitmap_) {
             DeleteObject(backgroundBitmap_);
             backgroundBitmap_ = nullptr;
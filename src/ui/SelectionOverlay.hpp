@@ -1,6 +1,11 @@
 #pragma once
 #include "../platform/WinHeaders.hpp"
+#include "FramePacer.hpp"
+#include "SnapIndex.hpp"
 #include <functional>
+#include <thread>
+#include <atomic>
+#include <vector>
 
 // D3D11  D2D/DirectWrite ͷļ
 #include <wrl/client.h>
@@ -13,11 +18,14 @@ namespace screenshot_tool {
     class SelectionOverlay {
     public:
         using Callback = std::function<void(const RECT&)>;
+        using BatchCallback = std::function<void(const std::vector<RECT>&)>;  // ѡʱѡ˳ȫĻ꣩
 
         bool Create(HINSTANCE hInst, HWND parent, Callback cb);
         ~SelectionOverlay();
         void Hide();
         bool IsValid() const;
+        // ʾлڵѡδ֡ʹ
+        bool IsActive() const;
         void BeginSelect();
         void BeginSelectOnMonitor(const RECT& monitorRect);
         
@@ -26,6 +34,20 @@ namespace screenshot_tool {
         
         // ʼȴͼ׼
         void StartWaitingForBackground(std::function<void()> backgroundCheckCallback);
+        
+        // ѡڱ߿ͻԵס Alt ʱرգ
+        void SetSnapEnabled(bool enabled) { snapEnabled_ = enabled; }
+
+        // ѡɿСoverlay ʾEnter/ոһεȫBackspace/Ҽһ
+        // δʱס Ctrl ɿҲУзǿʱͨɿͬǰһ
+        void SetMultiSelect(bool enabled) { multiSelect_ = enabled; }
+        void SetBatchCallback(BatchCallback cb) { batchCb_ = std::move(cb); }
+
+        // лգ״̬ͷűλͼѽС´ʾʱؽ
+        // ʾУʱ false
+        bool TrimIdle();
+        size_t BackgroundBytes() const;   // λͼ 32 λƣ
+        size_t SwapChainBytes() const;    // л
 
     private:
         static LRESULT CALLBACK WndProc(HWND, UINT, WPARAM, LPARAM);
@@ -34,14 +56,34 @@ namespace screenshot_tool {
         void updateSelect(int x, int y); 
         void finishSelect();
         void cancelSelection();
+        bool queueModifierActive() const;
+        RECT toScreen(const RECT& client) const;
+        void commitBatch();
+        void undoQueued();
         void ShowWithRect(const RECT& displayRect);
         
         // 
         void startFadeIn();
         void startFadeOut();
-        void updateFade();
+        void onFadeFinished();
         void initializeSimpleAnimation();
         
+        // ֱͬ֡ѭ
+        void startFrameLoop();
+        void stopFrameLoop();
+        void setFrameLoopActive(bool active);
+        void frameLoopThread();
+        void waitForVBlank();
+        void onFrame();
+        void applyPendingInput();
+        void logFrameStats();
+        
+        // ѡ
+        void collectSnapWindows(const RECT& displayRect);
+        bool snapActive() const;
+        void updateHover(int x, int y);
+        bool getHighlightRect(RECT& out) const;
+        
         // D3DȾط
         bool initializeD3DRenderer();
         void cleanupD3DRenderer();
@@ -51,6 +93,7 @@ namespace screenshot_tool {
         void renderDarkenMaskWithD3D();
         void renderSelectionBoxWithD3D();
         void renderSizeTextWithD3D();
+        void renderQueuedRegionsWithD3D();
         void createD2DBitmapFromGDI(HBITMAP gdiBitmap, ID2D1Bitmap** d2dBitmap);
         
         // ͼ
@@ -60,6 +103,7 @@ namespace screenshot_tool {
         HWND hwnd_ = nullptr; 
         HWND parent_ = nullptr; 
         Callback cb_;
+        BatchCallback batchCb_;
         bool selecting_ = false; 
         POINT start_{}; 
         POINT cur_{}; 
@@ -68,10 +112,26 @@ namespace screenshot_tool {
         BYTE alpha_ = 0; 
         bool fadingIn_ = false; 
         bool fadingOut_ = false;
-        UINT_PTR timerId_ = 0;
-        static constexpr UINT_PTR FADE_TIMER_ID = 1;
         static constexpr BYTE TARGET_ALPHA = 128;
-        UINT fadeInterval_ = 15;
+        FadeAnimation fade_;
+        
+        // ֡ѭ̵̨߳ȴֱͬͶ WM_OVERLAY_FRAMEUI ̺߳ϲ벢Ⱦ
+        std::thread frameThread_;
+        std::atomic<bool> frameThreadRunning_{ false };
+        std::atomic<bool> framePending_{ false };
+        std::atomic<bool> lastFramePresented_{ false };
+        HANDLE frameLoopActive_ = nullptr;          // ֶ¼λʱ֡ѭ
+        HANDLE frameLatencyWaitable_ = nullptr;     // ֡ӳٵȴ󣨲ʱ DwmFlush
+        InputCoalescer inputCoalescer_;
+        FramePacer framePacer_;
+        bool frameDirty_ = false;
+        
+        // ״̬ھڶʱö٣Եڱͼʱ
+        SnapIndex snapIndex_;
+        bool snapEnabled_ = true;
+        bool hoverValid_ = false;
+        RECT hoverRect_{};
+        static constexpr int SNAP_RADIUS = 8;
         
         // ⶨʱ
         UINT_PTR backgroundCheckTimerId_ = 0;
@@ -91,6 +151,7 @@ namespace screenshot_tool {
         Microsoft::WRL::ComPtr<IDWriteFactory> dwriteFactory_;
         Microsoft::WRL::ComPtr<IDWriteTextFormat> dwriteTextFormat_;
         D3D_FEATURE_LEVEL d3dFeatureLevel_;
+        UINT swapChainFlags_ = 0;
         
         // ͼ񣨶Ļݣ
         HBITMAP backgroundBitmap_ = nullptr;
@@ -102,14 +163,10 @@ namespace screenshot_tool {
         RECT selectedRect_{};
         RECT monitorConstraint_{}; 
         bool useMonitorConstraint_ = false;
-        
-        // ƫϢڶĻ֧֣
-        int virtualDesktopLeft_ = 0;
-        int virtualDesktopTop_ = 0;
-        
-        // Ż
-        DWORD lastUpdateTime_ = 0;
-        static constexpr DWORD MIN_UPDATE_INTERVAL = 8; // С¼룩
+
+        // ѡУͻ꣬ѡ˳
+        bool multiSelect_ = false;
+        std::vector<RECT> queued_;
     };
 
 } // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "SnapIndex.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace screenshot_tool {
+
+    void SnapIndex::Clear() {
+        windows_.clear();
+        verticalLines_.clear();
+        horizontalLines_.clear();
+        edges_.Clear();
+        edgeOffsetX_ = edgeOffsetY_ = 0;
+    }
+
+    void SnapIndex::SetWindows(std::vector<SnapRect> windows) {
+        windows_ = std::move(windows);
+        verticalLines_.clear();
+        horizontalLines_.clear();
+        verticalLines_.reserve(windows_.size() * 2);
+        horizontalLines_.reserve(windows_.size() * 2);
+
+        for (const auto& r : windows_) {
+            verticalLines_.push_back({ r.left, r.top, r.bottom });
+            verticalLines_.push_back({ r.right, r.top, r.bottom });
+            horizontalLines_.push_back({ r.top, r.left, r.right });
+            horizontalLines_.push_back({ r.bottom, r.left, r.right });
+        }
+
+        auto byPos = [](const Line& a, const Line& b) { return a.pos < b.pos; };
+        std::sort(verticalLines_.begin(), verticalLines_.end(), byPos);
+        std::sort(horizontalLines_.begin(), horizontalLines_.end(), byPos);
+    }
+
+    void SnapIndex::SetEdges(EdgeIndex edges) {
+        edges_ = std::move(edges);
+    }
+
+    void SnapIndex::SetEdgeOffset(int offsetX, int offsetY) {
+        edgeOffsetX_ = offsetX;
+        edgeOffsetY_ = offsetY;
+    }
+
+    bool SnapIndex::WindowAt(int x, int y, SnapRect& out) const {
+        for (const auto& r : windows_) {
+            if (x >= r.left && x < r.right && y >= r.top && y < r.bottom) {
+                out = r;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool SnapIndex::nearestLine(const std::vector<Line>& lines, int pos, int along, int radius, int& out) {
+        auto it = std::lower_bound(lines.begin(), lines.end(), pos - radius,
+            [](const Line& l, int v) { return l.pos < v; });
+
+        int bestDist = radius + 1;
+        for (; it != lines.end() && it->pos <= pos + radius; ++it) {
+            if (along < it->from || along > it->to) continue;
+            int dist = std::abs(it->pos - pos);
+            if (dist < bestDist) {
+                bestDist = dist;
+                out = it->pos;
+            }
+        }
+        return bestDist <= radius;
+    }
+
+    void SnapIndex::SnapPoint(int& x, int& y, int radius) const {
+        const int qx = x;
+        const int qy = y;
+
+        int snapped = 0;
+        if (nearestLine(verticalLines_, qx, qy, radius, snapped)) {
+            x = snapped;
+        } else if (!edges_.Empty() && edges_.NearestVertical(qx + edgeOffsetX_, qy + edgeOffsetY_, radius, snapped)) {
+            x = snapped - edgeOffsetX_;
+        }
+
+        if (nearestLine(horizontalLines_, qy, qx, radius, snapped)) {
+            y = snapped;
+        } else if (!edges_.Empty() && edges_.NearestHorizontal(qx + edgeOffsetX_, qy + edgeOffsetY_, radius, snapped)) {
+            y = snapped - edgeOffsetY_;
+        }
+    }
+
+} // namespace screenshot_tool
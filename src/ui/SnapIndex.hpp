@@ -0,0 +1,53 @@
+#pragma once
+#include "../image/EdgeIndex.hpp"
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 与平台无关的矩形（left/top 包含，right/bottom 不包含）
+    struct SnapRect {
+        int left = 0;
+        int top = 0;
+        int right = 0;
+        int bottom = 0;
+    };
+
+    // 选区吸附索引：冻结时枚举的窗口矩形 + 冻结帧的边缘索引。
+    // 所有查询坐标均为 Overlay 客户区坐标；窗口边按坐标排序，单次查询 O(log n)。
+    class SnapIndex {
+    public:
+        void Clear();
+
+        // 窗口矩形按 Z 序传入（最上层在前），坐标已转换到客户区
+        void SetWindows(std::vector<SnapRect> windows);
+        // 冻结帧的边缘索引（图像坐标）
+        void SetEdges(EdgeIndex edges);
+        // 客户区坐标 + offset = 图像坐标（Overlay 位置变化时更新）
+        void SetEdgeOffset(int offsetX, int offsetY);
+
+        // 光标下最上层的窗口
+        bool WindowAt(int x, int y, SnapRect& out) const;
+        // 将点吸附到 radius 内最近的窗口边（优先）或图像边缘，x / y 分别独立吸附
+        void SnapPoint(int& x, int& y, int radius) const;
+
+        const EdgeIndex& Edges() const { return edges_; }
+
+    private:
+        // 一条轴对齐的窗口边：pos 为所在坐标，[from, to) 为沿边方向的覆盖范围
+        struct Line {
+            int pos;
+            int from;
+            int to;
+        };
+
+        static bool nearestLine(const std::vector<Line>& lines, int pos, int along, int radius, int& out);
+
+        std::vector<SnapRect> windows_;
+        std::vector<Line> verticalLines_;     // 按 x 排序
+        std::vector<Line> horizontalLines_;   // 按 y 排序
+        EdgeIndex edges_;
+        int edgeOffsetX_ = 0;
+        int edgeOffsetY_ = 0;
+    };
+
+} // namespace screenshot_tool
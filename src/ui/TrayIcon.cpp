@@ -25,6 +25,8 @@ namespace screenshot_tool {
         HMENU menu = CreatePopupMenu();
         AppendMenu(menu, MF_STRING, IDM_TRAY_CAPTURE_REGION, L"区域截图(&R)");
         AppendMenu(menu, MF_STRING, IDM_TRAY_CAPTURE_FULLSCREEN, L"全屏截图(&F)");
+        AppendMenu(menu, MF_STRING, IDM_TRAY_CAPTURE_BURST, L"连拍全屏(&B)");
+        AppendMenu(menu, MF_STRING, IDM_TRAY_RECROP_LAST, L"重新裁剪上一张(&L)");
         AppendMenu(menu, MF_SEPARATOR, 0, nullptr);
         AppendMenu(menu, MF_STRING | (autoStart ? MF_CHECKED : 0), IDM_TRAY_TOGGLE_AUTOSTART, L"开机启动(&S)");
         AppendMenu(menu, MF_STRING | (saveToFile ? MF_CHECKED : 0), IDM_TRAY_TOGGLE_SAVEFILE, L"保存到文件(&V)");
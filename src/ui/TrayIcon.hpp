@@ -10,6 +10,8 @@ namespace screenshot_tool {
     enum TrayMenuId : UINT {
         IDM_TRAY_CAPTURE_REGION = 1000,
         IDM_TRAY_CAPTURE_FULLSCREEN,
+        IDM_TRAY_CAPTURE_BURST,
+        IDM_TRAY_RECROP_LAST,
         IDM_TRAY_OPEN_FOLDER,
         IDM_TRAY_TOGGLE_AUTOSTART,
         IDM_TRAY_TOGGLE_SAVEFILE,
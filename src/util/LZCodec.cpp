@@ -0,0 +1,181 @@
+#include "LZCodec.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        constexpr int HASH_BITS = 16;
+        constexpr size_t MIN_MATCH = 4;
+        constexpr size_t MAX_OFFSET = 0xFFFF;
+        constexpr size_t LAST_LITERALS = 5;   // 末尾至少保留的字面量，匹配不延伸到这里
+        constexpr size_t MATCH_SAFE = 12;     // 距末尾不足此长度时不再开始新的匹配
+
+        inline uint32_t load32(const uint8_t* p) {
+            uint32_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint64_t load64(const uint8_t* p) {
+            uint64_t v;
+            std::memcpy(&v, p, sizeof(v));
+            return v;
+        }
+
+        inline uint32_t hash32(uint32_t v) {
+            return (v * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        // 超出 4 位的长度：每字节 255 累加，最后一个字节小于 255
+        inline uint8_t* writeLength(uint8_t* op, size_t len) {
+            for (; len >= 255; len -= 255) *op++ = 255;
+            *op++ = static_cast<uint8_t>(len);
+            return op;
+        }
+
+        inline bool readLength(const uint8_t*& ip, const uint8_t* iend, size_t& len) {
+            uint8_t b;
+            do {
+                if (ip >= iend) return false;
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+            return true;
+        }
+
+        // 输出一个序列：token、字面量，offset 非 0 时再跟偏移与匹配长度。空间不足返回 nullptr
+        uint8_t* emitSequence(uint8_t* op, uint8_t* oend, const uint8_t* literals, size_t litLen,
+            size_t offset, size_t matchLen)
+        {
+            const size_t ml = offset ? matchLen - MIN_MATCH : 0;
+            auto extBytes = [](size_t len) { return len >= 15 ? (len - 15) / 255 + 1 : 0; };
+            const size_t need = 1 + extBytes(litLen) + litLen + (offset ? 2 + extBytes(ml) : 0);
+            if (static_cast<size_t>(oend - op) < need) return nullptr;
+
+            uint8_t* token = op++;
+            *token = static_cast<uint8_t>((std::min<size_t>(litLen, 15) << 4) | std::min<size_t>(ml, 15));
+            if (litLen >= 15) op = writeLength(op, litLen - 15);
+            if (litLen) std::memcpy(op, literals, litLen);
+            op += litLen;
+
+            if (offset) {
+                *op++ = static_cast<uint8_t>(offset);
+                *op++ = static_cast<uint8_t>(offset >> 8);
+                if (ml >= 15) op = writeLength(op, ml - 15);
+            }
+            return op;
+        }
+
+        // 回溯复制允许与输出重叠（offset < len 时为周期性重复）。
+        // offset 不足 8 时先逐字节写出一个不短于 8 字节的完整周期，之后按该周期 8 字节一组复制
+        inline void copyMatch(uint8_t* op, size_t offset, size_t len) {
+            const uint8_t* match = op - offset;
+            if (offset >= len) {
+                std::memcpy(op, match, len);
+                return;
+            }
+
+            size_t i = 0;
+            if (offset < 8) {
+                const size_t period = offset * ((8 + offset - 1) / offset);
+                for (; i < len && i < period; ++i) op[i] = match[i];
+                match = op - period;
+            }
+            for (; i + 8 <= len; i += 8) std::memcpy(op + i, match + i, 8);
+            for (; i < len; ++i) op[i] = match[i];
+        }
+
+    } // namespace
+
+    size_t LZCompressBound(size_t size) {
+        return size + size / 255 + 16;
+    }
+
+    size_t LZCompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+        uint8_t* op = dst;
+        uint8_t* const oend = dst + capacity;
+        const uint8_t* anchor = src;
+
+        if (size > MATCH_SAFE) {
+            std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+            const uint8_t* const matchLimit = src + size - LAST_LITERALS;
+            const uint8_t* const ilimit = src + size - MATCH_SAFE;
+            const uint8_t* ip = src;
+
+            while (ip < ilimit) {
+                const uint32_t seq = load32(ip);
+                const uint32_t h = hash32(seq);
+                const uint8_t* match = src + table[h];
+                table[h] = static_cast<uint32_t>(ip - src);
+
+                if (match >= ip || static_cast<size_t>(ip - match) > MAX_OFFSET || load32(match) != seq) {
+                    // 连续未命中时步长逐渐加大，快速跳过噪声等不可压缩区域
+                    ip += 1 + (static_cast<size_t>(ip - anchor) >> 6);
+                    continue;
+                }
+
+                while (ip > anchor && match > src && ip[-1] == match[-1]) {
+                    --ip;
+                    --match;
+                }
+                const uint8_t* p = ip + MIN_MATCH;
+                const uint8_t* m = match + MIN_MATCH;
+                while (p + 8 <= matchLimit && load64(p) == load64(m)) {
+                    p += 8;
+                    m += 8;
+                }
+                while (p < matchLimit && *p == *m) {
+                    ++p;
+                    ++m;
+                }
+
+                op = emitSequence(op, oend, anchor, static_cast<size_t>(ip - anchor),
+                    static_cast<size_t>(ip - match), static_cast<size_t>(p - ip));
+                if (!op) return 0;
+                ip = anchor = p;
+
+                // 登记匹配末尾附近的位置，纯色区域和重复行可以紧接着继续匹配
+                table[hash32(load32(ip - 2))] = static_cast<uint32_t>(ip - 2 - src);
+            }
+        }
+
+        op = emitSequence(op, oend, anchor, static_cast<size_t>(src + size - anchor), 0, 0);
+        return op ? static_cast<size_t>(op - dst) : 0;
+    }
+
+    bool LZDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize) {
+        const uint8_t* ip = src;
+        const uint8_t* const iend = src + size;
+        uint8_t* op = dst;
+        uint8_t* const oend = dst + rawSize;
+
+        while (ip < iend) {
+            const unsigned token = *ip++;
+
+            size_t litLen = token >> 4;
+            if (litLen == 15 && !readLength(ip, iend, litLen)) return false;
+            if (static_cast<size_t>(iend - ip) < litLen || static_cast<size_t>(oend - op) < litLen) return false;
+            if (litLen) std::memcpy(op, ip, litLen);
+            op += litLen;
+            ip += litLen;
+            if (ip == iend) break;   // 最后一个序列只有字面量
+
+            if (iend - ip < 2) return false;
+            const size_t offset = static_cast<size_t>(ip[0]) | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+            if (offset == 0 || offset > static_cast<size_t>(op - dst)) return false;
+
+            size_t matchLen = token & 15;
+            if (matchLen == 15 && !readLength(ip, iend, matchLen)) return false;
+            matchLen += MIN_MATCH;
+            if (static_cast<size_t>(oend - op) < matchLen) return false;
+            copyMatch(op, offset, matchLen);
+            op += matchLen;
+        }
+        return op == oend;
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
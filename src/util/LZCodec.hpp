@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace screenshot_tool {
+
+    // 快速 LZ77 块压缩（LZ4 风格的 token 序列：字面量长度 / 匹配长度各 4 位，16 位回溯偏移）。
+    // 面向空闲时压缩冻结帧：桌面画面大面积纯色、重复行，压缩率高且解压远快于重新抓屏。
+    // 每块独立编码，不保存原始长度，解压时由调用方提供。
+
+    // 最坏情况（不可压缩数据）下的压缩输出上限
+    size_t LZCompressBound(size_t size);
+
+    // 压缩 src[0, size) 到 dst，返回写入的字节数；capacity 不足时返回 0
+    size_t LZCompress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+    // 解压出恰好 rawSize 字节；数据损坏或长度不符时返回 false
+    bool LZDecompress(const uint8_t* src, size_t size, uint8_t* dst, size_t rawSize);
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -1,24 +1,464 @@
 #include "Logger.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
 #include "../platform/WinHeaders.hpp"
-#include <fstream>
+#else
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace screenshot_tool {
 
+    namespace {
+
+        const wchar_t* levelTag(LogLevel level) {
+            switch (level) {
+            case LogLevel::Debug: return L"DBG";
+            case LogLevel::Info:  return L"INFO";
+            case LogLevel::Warn:  return L"WARN";
+            default:              return L"ERR";
+            }
+        }
+
+        // wchar_t is UTF-16 on Windows and UTF-32 elsewhere
+        void appendUtf8(std::string& out, std::wstring_view s) {
+            for (size_t i = 0; i < s.size(); ++i) {
+                uint32_t c = static_cast<uint32_t>(s[i]);
+                if (sizeof(wchar_t) == 2 && c >= 0xD800 && c < 0xDC00 && i + 1 < s.size()) {
+                    uint32_t lo = static_cast<uint32_t>(s[i + 1]);
+                    if (lo >= 0xDC00 && lo < 0xE000) {
+                        c = 0x10000 + ((c - 0xD800) << 10) + (lo - 0xDC00);
+                        ++i;
+                    }
+                }
+                if (c < 0x80) {
+                    out += static_cast<char>(c);
+                } else if (c < 0x800) {
+                    out += static_cast<char>(0xC0 | (c >> 6));
+                    out += static_cast<char>(0x80 | (c & 0x3F));
+                } else if (c < 0x10000) {
+                    out += static_cast<char>(0xE0 | (c >> 12));
+                    out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (c & 0x3F));
+                } else {
+                    out += static_cast<char>(0xF0 | (c >> 18));
+                    out += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (c & 0x3F));
+                }
+            }
+        }
+
+        template<class T>
+        void appendChars(std::wstring& out, T value, std::wstring_view spec) {
+            char buf[64];
+            std::to_chars_result r{};
+            if constexpr (std::is_floating_point_v<T>) {
+                size_t dot = spec.find(L'.');
+                if (dot != std::wstring_view::npos) {
+                    int precision = 0;
+                    for (size_t i = dot + 1; i < spec.size() && spec[i] >= L'0' && spec[i] <= L'9'; ++i) {
+                        precision = precision * 10 + (spec[i] - L'0');
+                    }
+                    r = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+                } else {
+                    r = std::to_chars(buf, buf + sizeof(buf), value);
+                }
+            } else {
+                bool hex = spec.find(L'x') != std::wstring_view::npos;
+                if (hex && spec.find(L'#') != std::wstring_view::npos) {
+                    // Sign goes before the prefix: -0x1
+                    auto magnitude = static_cast<std::make_unsigned_t<T>>(value);
+                    if (value < 0) {
+                        out += L'-';
+                        magnitude = 0 - magnitude;
+                    }
+                    out += L"0x";
+                    r = std::to_chars(buf, buf + sizeof(buf), magnitude, 16);
+                } else {
+                    r = std::to_chars(buf, buf + sizeof(buf), value, hex ? 16 : 10);
+                }
+            }
+            out.append(buf, r.ptr);
+        }
+
+        // The log file is a raw OS handle rather than a stream: WriteFile / write() are also what the
+        // crash handler may call, and neither allocates nor takes user-space locks.
+        // INVALID_HANDLE_VALUE and a closed POSIX descriptor are both -1.
+        constexpr intptr_t NO_FILE = -1;
+
+        intptr_t openLogFile(const std::wstring& path) {
+#ifdef _WIN32
+            HANDLE h = CreateFileW(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            return reinterpret_cast<intptr_t>(h);
+#else
+            return ::open(std::filesystem::path(path).c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+#endif
+        }
+
+        void closeLogFile(intptr_t file) {
+            if (file == NO_FILE) return;
+#ifdef _WIN32
+            CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+            ::close(static_cast<int>(file));
+#endif
+        }
+
+        // Async-signal-safe
+        void writeLogFile(intptr_t file, const char* data, size_t size) {
+            if (file == NO_FILE) return;
+            while (size > 0) {
+#ifdef _WIN32
+                DWORD written = 0;
+                if (!WriteFile(reinterpret_cast<HANDLE>(file), data, static_cast<DWORD>(std::min<size_t>(size, 1u << 30)), &written, nullptr) || written == 0) return;
+#else
+                const ssize_t written = ::write(static_cast<int>(file), data, size);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) return;
+#endif
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+
+        // Async-signal-safe clock for the crash handler
+        uint64_t monotonicMs() {
+#ifdef _WIN32
+            return GetTickCount64();
+#else
+            timespec ts{};
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+            return static_cast<uint64_t>(ts.tv_sec) * 1000 + static_cast<uint64_t>(ts.tv_nsec) / 1000000;
+#endif
+        }
+
+        void appendArg(std::wstring& out, const log_detail::Args& args, int index, std::wstring_view spec) {
+            if (index >= args.count) return;
+            using Type = log_detail::Args::Arg::Type;
+            const auto& a = args.items[index];
+            switch (a.type) {
+            case Type::Int:     appendChars(out, a.i, spec); break;
+            case Type::UInt:    appendChars(out, a.u, spec); break;
+            case Type::Float:   appendChars(out, a.f, spec); break;
+            case Type::Double:  appendChars(out, a.d, spec); break;
+            case Type::Bool:    out += a.b ? L"true" : L"false"; break;
+            case Type::Text:    out.append(args.text, a.text.offset, a.text.length); break;
+            case Type::Pointer: appendChars(out, a.u, L"#x"); break;
+            }
+        }
+
+    } // namespace
+
+    void log_detail::FormatTo(std::wstring& out, std::wstring_view fmt, const Args& args) {
+        int next = 0;
+        for (size_t i = 0; i < fmt.size(); ++i) {
+            const wchar_t c = fmt[i];
+            if ((c == L'{' || c == L'}') && i + 1 < fmt.size() && fmt[i + 1] == c) {
+                out += c;
+                ++i;
+            } else if (c == L'{') {
+                size_t end = fmt.find(L'}', i);
+                if (end == std::wstring_view::npos) break;
+                std::wstring_view field = fmt.substr(i + 1, end - i - 1);
+                size_t colon = field.find(L':');
+                appendArg(out, args, next++, colon == std::wstring_view::npos ? std::wstring_view{} : field.substr(colon + 1));
+                i = end;
+            } else {
+                out += c;
+            }
+        }
+    }
+
+    // Bounded MPSC queue (Vyukov-style sequence numbers): producers claim a slot with one CAS
+    // and publish it by bumping the slot's sequence; only the holder of drainMtx consumes.
+    struct Logger::Queue {
+        static constexpr size_t CAPACITY = 1024;
+        static constexpr auto IDLE_WAIT = std::chrono::milliseconds(200);
+
+        struct Record : log_detail::Args {
+            std::atomic<uint64_t> seq{ 0 };
+            uint64_t pos = 0;              // Queue position while claimed
+            LogLevel level = LogLevel::Info;
+            std::wstring_view fmt;
+        };
+
+        std::unique_ptr<Record[]> slots{ new Record[CAPACITY] };
+        alignas(64) std::atomic<uint64_t> enqueuePos{ 0 };
+        alignas(64) std::atomic<uint64_t> dequeuePos{ 0 };
+
+        std::mutex drainMtx;           // Single consumer: writer thread, Flush, full-queue fallback
+        std::atomic<intptr_t> file{ NO_FILE };     // Changed under drainMtx; read lock-free by the crash handler
+        std::atomic<uint64_t> writtenPos{ 0 };     // Records before this position have been written out
+        std::wstring batch;            // Guarded by drainMtx
+        std::string utf8;              // Guarded by drainMtx
+
+        std::mutex wakeMtx;
+        std::condition_variable wakeCv;
+        std::atomic<bool> writerIdle{ false };
+        std::atomic<bool> running{ false };
+        std::thread writer;
+
+        Queue() {
+            for (size_t i = 0; i < CAPACITY; ++i) slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+
+        // The claimed slot stays invisible to the writer until publish()
+        Record* tryClaim() {
+            uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                Record& r = slots[pos % CAPACITY];
+                uint64_t seq = r.seq.load(std::memory_order_acquire);
+                int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+                if (diff == 0) {
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        r.pos = pos;
+                        return &r;
+                    }
+                } else if (diff < 0) {
+                    return nullptr;   // Full
+                } else {
+                    pos = enqueuePos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void publish(Record& r) {
+            r.seq.store(r.pos + 1, std::memory_order_release);
+        }
+
+        bool hasPending() const {
+            uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+            return slots[pos % CAPACITY].seq.load(std::memory_order_acquire) == pos + 1;
+        }
+
+        void appendLine(const Record& r) {
+            batch += levelTag(r.level);
+            batch += L": ";
+            log_detail::FormatTo(batch, r.fmt, r);
+            batch += L'\n';
+        }
+
+        // Caller holds drainMtx. Formats every published record into one batch and writes it out;
+        // extra (a record that did not fit in the queue) goes last.
+        bool drainLocked(const Record* extra = nullptr) {
+            batch.clear();
+            uint64_t pos = dequeuePos.load(std::memory_order_relaxed);
+            for (;;) {
+                Record& r = slots[pos % CAPACITY];
+                if (r.seq.load(std::memory_order_acquire) != pos + 1) break;
+                appendLine(r);
+                r.seq.store(pos + CAPACITY, std::memory_order_release);
+                ++pos;
+            }
+            dequeuePos.store(pos, std::memory_order_relaxed);
+            if (extra) appendLine(*extra);
+            if (batch.empty()) return false;
+
+#ifdef _WIN32
+            OutputDebugStringW(batch.c_str());
+#else
+            std::fputws(batch.c_str(), stderr);
+#endif
+            const intptr_t out = file.load(std::memory_order_relaxed);
+            if (out != NO_FILE) {
+                utf8.clear();
+                appendUtf8(utf8, batch);
+                writeLogFile(out, utf8.data(), utf8.size());
+            }
+            writtenPos.store(pos, std::memory_order_release);
+            return true;
+        }
+
+        void writerLoop() {
+            while (running.load()) {
+                bool wrote;
+                {
+                    std::lock_guard<std::mutex> lock(drainMtx);
+                    wrote = drainLocked();
+                }
+                if (wrote) continue;
+
+                // Producers only notify while the writer is idle. Each side stores its own flag, then a
+                // seq_cst fence, then loads the other side's flag (Dekker): at least one of them sees the
+                // other's store, so either the writer finds the record or the producer notifies
+                std::unique_lock<std::mutex> lock(wakeMtx);
+                writerIdle.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                wakeCv.wait_for(lock, IDLE_WAIT, [this] { return !running.load() || hasPending(); });
+                writerIdle.store(false, std::memory_order_relaxed);
+            }
+        }
+
+        // Called after publish(), which is the producer-side store of the handshake above
+        void wakeWriter() {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (writerIdle.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> lock(wakeMtx);
+                wakeCv.notify_one();
+            }
+        }
+    };
+
+    Logger::Logger() : queue_(std::make_unique<Queue>()) {
+        queue_->running.store(true);
+        queue_->writer = std::thread([q = queue_.get()] { q->writerLoop(); });
+    }
+
+    Logger::~Logger() {
+        Shutdown();
+    }
+
     Logger& Logger::Get() {
         static Logger g; return g;
     }
 
     void Logger::EnableFileLogging(const std::wstring& path) {
-        std::scoped_lock lk(Get().mtx_);
-        Get().filePath_ = path;
+        Queue& q = *Get().queue_;
+        std::lock_guard<std::mutex> lock(q.drainMtx);
+        q.drainLocked();
+        closeLogFile(q.file.exchange(NO_FILE));
+        if (!path.empty()) {
+            q.file.store(openLogFile(path));
+        }
+    }
+
+    void Logger::SetLevel(LogLevel level) {
+        Get().level_.store(level, std::memory_order_relaxed);
+    }
+
+    void Logger::Flush() {
+        Queue& q = *Get().queue_;
+        std::lock_guard<std::mutex> lock(q.drainMtx);
+        q.drainLocked();
+    }
+
+    void Logger::Shutdown() {
+        Queue& q = *Get().queue_;
+        if (q.running.exchange(false)) {
+            {
+                std::lock_guard<std::mutex> lock(q.wakeMtx);
+                q.wakeCv.notify_one();
+            }
+            if (q.writer.joinable()) q.writer.join();
+        }
+        Flush();
+    }
+
+    log_detail::Args* Logger::beginRecord(LogLevel level, std::wstring_view fmt) {
+        Queue& q = *queue_;
+        Queue::Record* r = q.running.load(std::memory_order_relaxed) ? q.tryClaim() : nullptr;
+        if (!r) {
+            thread_local Queue::Record overflow;
+            r = &overflow;
+        }
+        r->Reset();
+        r->level = level;
+        r->fmt = fmt;
+        return r;
+    }
+
+    void Logger::commitRecord(log_detail::Args* record) {
+        Queue& q = *queue_;
+        Queue::Record* r = static_cast<Queue::Record*>(record);
+        if (r < q.slots.get() || r >= q.slots.get() + Queue::CAPACITY) {
+            // Queue full or writer stopped: drain on this thread first so ordering is preserved
+            std::lock_guard<std::mutex> lock(q.drainMtx);
+            q.drainLocked(r);
+            return;
+        }
+        q.publish(*r);
+        q.wakeWriter();
+    }
+
+    void Logger::crashFlush() {
+        // std::terminate runs in ordinary thread context, so formatting is allowed here.
+        // Best effort: the writer thread may be mid-batch, or may be the thread that crashed
+        Queue& q = *Get().queue_;
+        std::unique_lock<std::mutex> lock(q.drainMtx, std::defer_lock);
+        for (int i = 0; i < 100 && !lock.try_lock(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (lock.owns_lock()) q.drainLocked();
+    }
+
+    void Logger::signalFlush(const char* what, uint64_t code, int base) {
+        // Runs inside a signal handler / unhandled-exception filter: the crashed thread may hold any
+        // lock or be halfway through malloc, so nothing here formats, allocates or locks.
+        // The writer thread is still running (unless it is the one that crashed) and polls at least
+        // every IDLE_WAIT, so wait a bounded time for it to write out what was queued before the crash
+        Queue& q = *Get().queue_;
+        const uint64_t target = q.enqueuePos.load(std::memory_order_acquire);
+        const uint64_t deadline = monotonicMs() + CRASH_DRAIN_WAIT_MS;
+        while (q.running.load() && q.writtenPos.load(std::memory_order_acquire) < target && monotonicMs() < deadline) {
+#ifdef _WIN32
+            Sleep(1);
+#else
+            const timespec ms{ 0, 1000000 };
+            nanosleep(&ms, nullptr);
+#endif
+        }
+
+        // Then append one line formatted by hand into a stack buffer
+        char line[96];
+        size_t n = 0;
+        for (const char* p = "ERR: "; *p; ++p) line[n++] = *p;
+        for (const char* p = what; *p && n < 64; ++p) line[n++] = *p;
+        if (base == 16) {
+            line[n++] = '0';
+            line[n++] = 'x';
+        }
+        char digits[20];
+        int d = 0;
+        do {
+            digits[d++] = "0123456789abcdef"[code % base];
+            code /= base;
+        } while (code && d < 20);
+        while (d) line[n++] = digits[--d];
+        line[n++] = '\n';
+        line[n] = '\0';
+#ifdef _WIN32
+        OutputDebugStringA(line);
+#else
+        writeLogFile(STDERR_FILENO, line, n);
+#endif
+        writeLogFile(q.file.load(), line, n);
     }
 
-    void Logger::writeLine(const std::wstring& line) {
-        OutputDebugStringW((line + L"\n").c_str());
-        if (!filePath_.empty()) {
-            std::wofstream f(filePath_, std::ios::app);
-            if (f.is_open()) f << line << L"\n";
+    void Logger::InstallCrashHandler() {
+        Get();
+#ifdef _WIN32
+        SetUnhandledExceptionFilter([](EXCEPTION_POINTERS* info) -> LONG {
+            signalFlush("Unhandled exception ", info->ExceptionRecord->ExceptionCode, 16);
+            return EXCEPTION_CONTINUE_SEARCH;
+        });
+#else
+        for (int sig : { SIGSEGV, SIGABRT, SIGFPE, SIGILL }) {
+            std::signal(sig, [](int s) {
+                signalFlush("Fatal signal ", static_cast<uint64_t>(s), 10);
+                std::signal(s, SIG_DFL);
+                std::raise(s);
+            });
         }
+#endif
+        std::set_terminate([] {
+            Error(L"std::terminate called");
+            crashFlush();
+            std::abort();
+        });
     }
 
 } // namespace screenshot_tool
\ No newline at end of file
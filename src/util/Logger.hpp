@@ -1,40 +1,178 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <string_view>
-#include <format>
-#include <mutex>
+#include <type_traits>
+
+// Lowest level compiled into the binary: 0 = Debug, 1 = Info, 2 = Warn, 3 = Error.
+// Release builds drop Logger::Debug calls entirely unless this is overridden.
+#ifndef SCREENSHOT_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SCREENSHOT_LOG_MIN_LEVEL 1
+#else
+#define SCREENSHOT_LOG_MIN_LEVEL 0
+#endif
+#endif
 
 namespace screenshot_tool {
 
-    // Debug logging class, outputs to debugger + optional file writing (enabled by config.debugMode)
+    enum class LogLevel { Debug, Info, Warn, Error };
+
+    namespace log_detail {
+
+        template<class>
+        inline constexpr bool unsupportedArg = false;
+
+        // Arguments captured by value on the calling thread and formatted later by the writer thread.
+        // Strings are copied into one buffer per record, so a record owns everything it refers to
+        // except the format string, which FormatString restricts to literals.
+        struct Args {
+            static constexpr int MAX = 12;
+
+            struct Arg {
+                enum class Type : uint8_t { Int, UInt, Float, Double, Bool, Text, Pointer };
+                Type type;
+                union {
+                    int64_t i;
+                    uint64_t u;
+                    float f;
+                    double d;
+                    bool b;
+                    struct { uint32_t offset, length; } text;
+                };
+            };
+
+            Arg items[MAX];
+            int count = 0;
+            std::wstring text;
+
+            void Reset() {
+                count = 0;
+                text.clear();
+            }
+
+            void AddText(std::wstring_view s) {
+                Arg& a = items[count++];
+                a.type = Arg::Type::Text;
+                a.text = { static_cast<uint32_t>(text.size()), static_cast<uint32_t>(s.size()) };
+                text.append(s);
+            }
+
+            template<class T>
+            void Add(const T& v) {
+                if constexpr (std::is_same_v<T, bool>) {
+                    Arg& a = items[count++];
+                    a.type = Arg::Type::Bool;
+                    a.b = v;
+                } else if constexpr (std::is_same_v<T, wchar_t>) {
+                    AddText(std::wstring_view(&v, 1));
+                } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                    Arg& a = items[count++];
+                    a.type = Arg::Type::Int;
+                    a.i = v;
+                } else if constexpr (std::is_integral_v<T>) {
+                    Arg& a = items[count++];
+                    a.type = Arg::Type::UInt;
+                    a.u = v;
+                } else if constexpr (std::is_same_v<T, float>) {
+                    Arg& a = items[count++];
+                    a.type = Arg::Type::Float;
+                    a.f = v;
+                } else if constexpr (std::is_floating_point_v<T>) {
+                    Arg& a = items[count++];
+                    a.type = Arg::Type::Double;
+                    a.d = static_cast<double>(v);
+                } else if constexpr (std::is_same_v<T, const wchar_t*> || std::is_same_v<T, wchar_t*>) {
+                    AddText(v ? std::wstring_view(v) : std::wstring_view(L"(null)"));
+                } else if constexpr (std::is_convertible_v<const T&, std::wstring_view>) {
+                    AddText(std::wstring_view(v));
+                } else if constexpr (std::is_pointer_v<T>) {
+                    static_assert(!std::is_same_v<std::remove_cv_t<std::remove_pointer_t<T>>, char>, "narrow strings must be widened before logging");
+                    Arg& a = items[count++];
+                    a.type = Arg::Type::Pointer;
+                    a.u = reinterpret_cast<uintptr_t>(v);
+                } else {
+                    static_assert(unsupportedArg<T>, "unsupported log argument type");
+                }
+            }
+        };
+
+        // A log format string. The record keeps only a view of it and the writer thread formats it later,
+        // so it must outlive every record: the consteval constructor accepts string literals and other
+        // constant arrays with static storage, and a runtime buffer or std::wstring fails to compile
+        struct FormatString {
+            template<size_t N>
+            consteval FormatString(const wchar_t (&s)[N]) : text(s, N - 1) {}
+
+            std::wstring_view text;
+        };
+
+        // std::format-style expansion of the subset used in this code base:
+        // "{}", "{{", "}}" and the specs ".Nf", "x" and "#x"
+        void FormatTo(std::wstring& out, std::wstring_view fmt, const Args& args);
+
+    } // namespace log_detail
+
+    // Debug logging class, outputs to debugger + optional file writing (enabled by config.debugMode).
+    // Callers only capture the arguments into a lock-free queue; a background thread formats and
+    // writes the queued records in batches, so logging never waits on the debugger or the disk.
     class Logger {
     public:
+        static constexpr LogLevel COMPILED_MIN_LEVEL = static_cast<LogLevel>(SCREENSHOT_LOG_MIN_LEVEL);
+
         static Logger& Get();
-        static void EnableFileLogging(const std::wstring& path); // Enable file output
+        static void EnableFileLogging(const std::wstring& path); // Enable file output (kept open, UTF-8)
+        static void SetLevel(LogLevel level);                   // Messages below the level are dropped before capture
+        static bool IsEnabled(LogLevel level) {
+            return level >= COMPILED_MIN_LEVEL && level >= Get().level_.load(std::memory_order_relaxed);
+        }
+        static void Flush();                 // Write out everything queued so far
+        static void Shutdown();              // Flush and stop the writer thread; later messages are written synchronously
+        static void InstallCrashHandler();   // Write out queued messages on unhandled exceptions / fatal signals / std::terminate
 
         template<class...Args>
-        static void Info(std::wstring_view fmt, Args&&...args) { Get().logImpl(L"INFO", fmt, std::forward<Args>(args)...); }
+        static void Info(log_detail::FormatString fmt, const Args&...args) { log<LogLevel::Info>(fmt.text, args...); }
         template<class...Args>
-        static void Warn(std::wstring_view fmt, Args&&...args) { Get().logImpl(L"WARN", fmt, std::forward<Args>(args)...); }
+        static void Warn(log_detail::FormatString fmt, const Args&...args) { log<LogLevel::Warn>(fmt.text, args...); }
         template<class...Args>
-        static void Error(std::wstring_view fmt, Args&&...args) { Get().logImpl(L"ERR", fmt, std::forward<Args>(args)...); }
+        static void Error(log_detail::FormatString fmt, const Args&...args) { log<LogLevel::Error>(fmt.text, args...); }
         template<class...Args>
-        static void Debug(std::wstring_view fmt, Args&&...args) { Get().logImpl(L"DBG", fmt, std::forward<Args>(args)...); }
+        static void Debug(log_detail::FormatString fmt, const Args&...args) { log<LogLevel::Debug>(fmt.text, args...); }
 
     private:
-        Logger() = default;
+        struct Queue;
+
+        Logger();
+        ~Logger();
         Logger(const Logger&) = delete;
         Logger& operator=(const Logger&) = delete;
-        void writeLine(const std::wstring& line);
 
-        template<class...Args>
-        void logImpl(std::wstring_view lvl, std::wstring_view fmt, Args&&...args) {
-            std::wstring msg = std::vformat(fmt, std::make_wformat_args(args...));
-            writeLine(std::wstring(lvl) + L": " + msg);
+        // beginRecord claims a queue slot (or a thread-local record when the queue is full);
+        // commitRecord publishes it to the writer
+        log_detail::Args* beginRecord(LogLevel level, std::wstring_view fmt);
+        void commitRecord(log_detail::Args* record);
+        static void crashFlush();            // std::terminate: drains and formats on the calling thread
+        // Fatal signal / SEH filter: waits for the writer, then writes one pre-formatted line with write/WriteFile
+        static void signalFlush(const char* what, uint64_t code, int base);
+
+        static constexpr int CRASH_DRAIN_WAIT_MS = 300;
+
+        template<LogLevel Level, class...Args>
+        static void log(std::wstring_view fmt, const Args&...args) {
+            static_assert(sizeof...(Args) <= log_detail::Args::MAX, "too many log arguments");
+            if constexpr (Level >= COMPILED_MIN_LEVEL) {
+                Logger& logger = Get();
+                if (Level < logger.level_.load(std::memory_order_relaxed)) return;
+                log_detail::Args* record = logger.beginRecord(Level, fmt);
+                (record->Add(args), ...);
+                logger.commitRecord(record);
+            }
         }
 
-        std::mutex      mtx_;
-        std::wstring    filePath_;
+        std::atomic<LogLevel>   level_{ LogLevel::Debug };
+        std::unique_ptr<Queue>  queue_;
     };
 
 } // namespace screenshot_tool
\ No newline at end of file
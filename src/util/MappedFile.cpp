@@ -0,0 +1,126 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#include "../platform/WinHeaders.hpp"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace screenshot_tool {
+
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+#ifdef _WIN32
+
+    bool MappedFile::Create(const std::filesystem::path& path, size_t size) {
+        Close();
+        if (size == 0) return false;
+
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+            CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        file_ = file;
+        size_ = size;
+        return map(true);
+    }
+
+    bool MappedFile::OpenRead(const std::filesystem::path& path) {
+        Close();
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        file_ = file;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0) {
+            Close();
+            return false;
+        }
+        size_ = static_cast<size_t>(fileSize.QuadPart);
+        return map(false);
+    }
+
+    bool MappedFile::map(bool writable) {
+        const unsigned long long size = size_;
+        HANDLE mapping = CreateFileMappingW(static_cast<HANDLE>(file_), nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+            static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFFull), nullptr);
+        if (!mapping) {
+            Close();
+            return false;
+        }
+        mapping_ = mapping;
+
+        data_ = static_cast<uint8_t*>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size_));
+        if (!data_) {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(static_cast<HANDLE>(mapping_));
+        if (file_) CloseHandle(static_cast<HANDLE>(file_));
+        data_ = nullptr;
+        mapping_ = nullptr;
+        file_ = nullptr;
+        size_ = 0;
+    }
+
+#else
+
+    bool MappedFile::Create(const std::filesystem::path& path, size_t size) {
+        Close();
+        if (size == 0) return false;
+
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) return false;
+        if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+            Close();
+            return false;
+        }
+        size_ = size;
+        return map(true);
+    }
+
+    bool MappedFile::OpenRead(const std::filesystem::path& path) {
+        Close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return false;
+
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0 || st.st_size <= 0) {
+            Close();
+            return false;
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        return map(false);
+    }
+
+    bool MappedFile::map(bool writable) {
+        void* p = ::mmap(nullptr, size_, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            Close();
+            return false;
+        }
+        data_ = static_cast<uint8_t*>(p);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data_) ::munmap(data_, size_);
+        if (fd_ >= 0) ::close(fd_);
+        data_ = nullptr;
+        fd_ = -1;
+        size_ = 0;
+    }
+
+#endif
+
+} // namespace screenshot_tool
\ No newline at end of file
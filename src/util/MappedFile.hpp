@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace screenshot_tool {
+
+    // 整个文件的内存映射（Windows: CreateFileMapping / MapViewOfFile，其他平台: mmap）。
+    // 写入的数据由系统页缓存延迟落盘，关闭映射后文件内容保持。
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // 新建（或截断）为 size 字节并以读写方式映射
+        bool Create(const std::filesystem::path& path, size_t size);
+        // 以只读方式映射已有文件
+        bool OpenRead(const std::filesystem::path& path);
+        void Close();
+
+        bool IsOpen() const { return data_ != nullptr; }
+        uint8_t* Data() { return data_; }
+        const uint8_t* Data() const { return data_; }
+        size_t Size() const { return size_; }
+
+    private:
+        bool map(bool writable);
+
+        uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        void* file_ = nullptr;       // HANDLE
+        void* mapping_ = nullptr;    // HANDLE
+#else
+        int fd_ = -1;
+#endif
+    };
+
+} // namespace screenshot_tool
\ No newline at end of file
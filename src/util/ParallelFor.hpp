@@ -0,0 +1,38 @@
+#pragma once
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 可用的并行工作线程数（调用方按此数量准备每线程状态）
+    inline int ParallelWorkerCount() {
+        unsigned n = std::thread::hardware_concurrency();
+        return static_cast<int>(std::clamp(n, 1u, 16u));
+    }
+
+    // 把 [0, count) 切成按顺序排列的连续区间并行处理，调用 fn(begin, end, worker)。
+    // worker 越小区间越靠前，便于调用方按 worker 顺序拼接结果；minChunk 控制每个线程的最小工作量。
+    template<class Fn>
+    void ParallelFor(int count, int minChunk, Fn&& fn) {
+        if (count <= 0) return;
+
+        int workers = std::min(ParallelWorkerCount(), std::max(1, count / std::max(1, minChunk)));
+        if (workers <= 1) {
+            fn(0, count, 0);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int i = 1; i < workers; ++i) {
+            int begin = static_cast<int>(static_cast<long long>(count) * i / workers);
+            int end = static_cast<int>(static_cast<long long>(count) * (i + 1) / workers);
+            threads.emplace_back([&fn, begin, end, i] { fn(begin, end, i); });
+        }
+        fn(0, static_cast<int>(static_cast<long long>(count) / workers), 0);
+
+        for (auto& t : threads) t.join();
+    }
+
+} // namespace screenshot_tool
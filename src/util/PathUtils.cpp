@@ -40,6 +40,15 @@ namespace screenshot_tool {
         return name;
     }
 
+    std::wstring PathUtils::MakeTimestampedStemMsW()
+    {
+        SYSTEMTIME st{}; GetLocalTime(&st);
+        wchar_t name[64];
+        swprintf_s(name, L"%04u%02u%02u_%02u%02u%02u_%03u", st.wYear, st.wMonth, st.wDay,
+            st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+        return name;
+    }
+
     bool PathUtils::IsAbsolute(const std::wstring& path)
     {
         return fs::path(path).is_absolute();
@@ -22,6 +22,10 @@ namespace screenshot_tool {
         // 生成 yyyyMMdd_HHmmss.png 的文件名（宽字符串）
         static std::wstring MakeTimestampedPngNameW();
 
+        // 生成 yyyyMMdd_HHmmss_fff（精确到毫秒）的文件名主干，连拍等批量截图再追加定宽序号，
+        // 保证不重名且按名称排序即时间顺序
+        static std::wstring MakeTimestampedStemMsW();
+
         // 检查路径是否为绝对路径
         static bool IsAbsolute(const std::wstring& path);
 
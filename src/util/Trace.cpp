@@ -0,0 +1,216 @@
+#include "Trace.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace screenshot_tool {
+
+    namespace {
+
+        // 单生产者环形缓冲区：只有所属线程写入，head 以 release 发布；读取方复制后
+        // 再读一次 head，丢弃复制期间可能被覆盖的槽位（包括正在写入、尚未发布的那一个）
+        struct ThreadRing {
+            std::array<Trace::Event, Trace::RING_CAPACITY> events;
+            std::atomic<uint64_t> head{ 0 };    // 累计写入数
+            uint32_t threadId = 0;
+            bool inUse = false;                 // 受 Registry::mutex 保护
+        };
+
+        // 线程退出后环形缓冲区归还复用（ParallelFor 每次都会新建线程），其中的事件仍可导出
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::unique_ptr<ThreadRing>> rings;
+            uint32_t nextThreadId = 1;
+        };
+
+        Registry& registry() {
+            static Registry r;
+            return r;
+        }
+
+        std::atomic<bool> g_enabled{ false };
+        std::atomic<uint32_t> g_captureId{ 0 };
+        std::atomic<uint64_t> g_captureStartNs{ 0 };
+
+        std::mutex g_outputMutex;
+        std::filesystem::path g_outputFile;
+
+        struct RingLease {
+            ThreadRing* ring = nullptr;
+            ~RingLease() {
+                if (!ring) return;
+                std::lock_guard<std::mutex> lock(registry().mutex);
+                ring->inUse = false;
+            }
+        };
+
+        ThreadRing* currentRing() {
+            thread_local RingLease lease;
+            if (!lease.ring) {
+                Registry& reg = registry();
+                std::lock_guard<std::mutex> lock(reg.mutex);
+                auto it = std::find_if(reg.rings.begin(), reg.rings.end(), [](const auto& r) { return !r->inUse; });
+                if (it == reg.rings.end()) {
+                    reg.rings.push_back(std::make_unique<ThreadRing>());
+                    it = reg.rings.end() - 1;
+                }
+                (*it)->inUse = true;
+                (*it)->threadId = reg.nextThreadId++;
+                lease.ring = it->get();
+            }
+            return lease.ring;
+        }
+
+        double toMs(uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+        // 最近秩法百分位，values 已排序
+        uint64_t percentile(const std::vector<uint64_t>& values, double p) {
+            size_t idx = static_cast<size_t>(p * static_cast<double>(values.size()));
+            return values[std::min(idx, values.size() - 1)];
+        }
+
+        std::wstring widen(std::string_view s) {
+            return std::wstring(s.begin(), s.end());
+        }
+
+    } // namespace
+
+    void Trace::SetEnabled(bool enabled) {
+        g_enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool Trace::Enabled() {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    void Trace::SetOutputFile(const std::filesystem::path& path) {
+        std::lock_guard<std::mutex> lock(g_outputMutex);
+        g_outputFile = path;
+    }
+
+    uint64_t Trace::NowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void Trace::Record(const char* name, uint64_t startNs, uint64_t durationNs) {
+        ThreadRing* ring = currentRing();
+        uint64_t h = ring->head.load(std::memory_order_relaxed);
+        // 上一次发布的 head 先于本次覆盖槽位可见，与 Snapshot 中的 acquire 栅栏配对
+        std::atomic_thread_fence(std::memory_order_release);
+        Event& e = ring->events[h % RING_CAPACITY];
+        e.name = name;
+        e.startNs = startNs;
+        e.durationNs = durationNs;
+        e.threadId = ring->threadId;
+        e.captureId = g_captureId.load(std::memory_order_relaxed);
+        ring->head.store(h + 1, std::memory_order_release);
+    }
+
+    void Trace::BeginCapture() {
+        if (!Enabled()) return;
+        g_captureStartNs.store(NowNs(), std::memory_order_relaxed);
+        g_captureId.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Trace::EndCapture(const wchar_t* what) {
+        if (!Enabled()) return;
+        const uint32_t id = g_captureId.load(std::memory_order_relaxed);
+        const uint64_t totalNs = NowNs() - g_captureStartNs.load(std::memory_order_relaxed);
+        const std::vector<Event> events = Snapshot();
+
+        // 按阶段分组：本次截图的耗时合计，以及全部保留事件的单次耗时分布
+        struct Stage {
+            std::string_view name;
+            uint64_t captureNs = 0;
+            int captureCount = 0;
+            std::vector<uint64_t> history;
+        };
+        std::vector<Stage> stages;
+        for (const Event& e : events) {
+            auto it = std::find_if(stages.begin(), stages.end(), [&](const Stage& s) { return s.name == e.name; });
+            if (it == stages.end()) {
+                it = stages.insert(stages.end(), Stage{});
+                it->name = e.name;
+            }
+            it->history.push_back(e.durationNs);
+            if (e.captureId == id) {
+                it->captureNs += e.durationNs;
+                ++it->captureCount;
+            }
+        }
+
+        Logger::Info(L"Trace #{} {}: {:.2f} ms from hotkey to done", id, what, toMs(totalNs));
+        for (auto& s : stages) {
+            if (s.captureCount == 0) continue;
+            std::sort(s.history.begin(), s.history.end());
+            Logger::Info(L"  {}: {:.2f} ms x{} (p50 {:.2f} ms, p99 {:.2f} ms over {} calls)",
+                widen(s.name), toMs(s.captureNs), s.captureCount,
+                toMs(percentile(s.history, 0.50)), toMs(percentile(s.history, 0.99)), s.history.size());
+        }
+
+        std::filesystem::path output;
+        {
+            std::lock_guard<std::mutex> lock(g_outputMutex);
+            output = g_outputFile;
+        }
+        if (!output.empty() && !ExportChromeTrace(output)) {
+            Logger::Warn(L"Failed to write trace file {}", output.wstring());
+        }
+    }
+
+    std::vector<Trace::Event> Trace::Snapshot() {
+        std::vector<Event> out;
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        for (const auto& ring : reg.rings) {
+            uint64_t end = ring->head.load(std::memory_order_acquire);
+            uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+            size_t first = out.size();
+            for (uint64_t i = begin; i < end; ++i) {
+                out.push_back(ring->events[i % RING_CAPACITY]);
+            }
+
+            // 复制期间所属线程可能继续写入并覆盖最旧的槽位；序号 after 的写入可能已经开始，
+            // 它覆盖的 after - RING_CAPACITY 也不可信
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = ring->head.load(std::memory_order_relaxed);
+            uint64_t valid = after + 1 > RING_CAPACITY ? after + 1 - RING_CAPACITY : 0;
+            if (valid > begin) {
+                size_t drop = static_cast<size_t>(std::min(valid, end) - begin);
+                out.erase(out.begin() + first, out.begin() + first + drop);
+            }
+        }
+        std::sort(out.begin(), out.end(), [](const Event& a, const Event& b) { return a.startNs < b.startNs; });
+        return out;
+    }
+
+    bool Trace::ExportChromeTrace(const std::filesystem::path& path) {
+        const std::vector<Event> events = Snapshot();
+        std::ofstream f(path, std::ios::binary | std::ios::trunc);
+        if (!f.is_open()) return false;
+
+        // 时间戳以微秒为单位，相对最早的事件
+        const uint64_t origin = events.empty() ? 0 : events.front().startNs;
+        f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        char buf[256];
+        for (size_t i = 0; i < events.size(); ++i) {
+            const Event& e = events[i];
+            int len = std::snprintf(buf, sizeof(buf),
+                "%s\n{\"name\":\"%s\",\"cat\":\"capture\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"capture\":%u}}",
+                i ? "," : "", e.name, static_cast<double>(e.startNs - origin) / 1e3,
+                static_cast<double>(e.durationNs) / 1e3, e.threadId, e.captureId);
+            f.write(buf, std::min<int>(len, sizeof(buf) - 1));
+        }
+        f << "\n]}\n";
+        return static_cast<bool>(f);
+    }
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace screenshot_tool {
+
+    // 截图流程的分阶段耗时追踪。每个线程写自己的无锁环形缓冲区（只保留最近的事件），
+    // 每次截图结束时汇总本次各阶段耗时与历史 p50/p99，并可导出 Chrome trace-event JSON
+    // （chrome://tracing 或 Perfetto 打开）。
+    class Trace {
+    public:
+        struct Event {
+            const char* name = nullptr;   // 阶段名，必须是字符串字面量
+            uint64_t startNs = 0;         // 单调时钟
+            uint64_t durationNs = 0;
+            uint32_t threadId = 0;        // 追踪内部分配的线程序号
+            uint32_t captureId = 0;       // 所属截图序号，0 表示不在截图流程内
+        };
+
+        // 每个线程的槽位数。回绕后最旧的槽位随时可能正被覆盖，快照保留最近的 RING_CAPACITY - 1 个
+        static constexpr size_t RING_CAPACITY = 4096;
+
+        static void SetEnabled(bool enabled);
+        static bool Enabled();
+        // 非空时每次截图结束后把保留的全部事件写成 Chrome trace JSON
+        static void SetOutputFile(const std::filesystem::path& path);
+
+        static uint64_t NowNs();
+        static void Record(const char* name, uint64_t startNs, uint64_t durationNs);
+
+        // 一次截图（热键 -> 剪贴板/文件落盘）的起止；EndCapture 输出本次各阶段耗时
+        static void BeginCapture();
+        static void EndCapture(const wchar_t* what);
+
+        // 所有线程保留事件的快照，按开始时间排序
+        static std::vector<Event> Snapshot();
+        static bool ExportChromeTrace(const std::filesystem::path& path);
+    };
+
+    // RAII 计时：析构时把 [构造, 析构) 写入当前线程的环形缓冲区。未启用时只有一次原子读
+    class TraceScope {
+    public:
+        explicit TraceScope(const char* name)
+            : name_(Trace::Enabled() ? name : nullptr), start_(name_ ? Trace::NowNs() : 0) {}
+        ~TraceScope() {
+            if (name_) Trace::Record(name_, start_, Trace::NowNs() - start_);
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* name_;
+        uint64_t start_;
+    };
+
+} // namespace screenshot_tool
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "TestUtil.hpp"
+#include "capture/BurstCapture.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// 连拍：用合成的抓取源和编码器驱动，检查环形缓冲的槽位复用、帧的完整性与顺序、失败计数、
+// 编码慢于抓取时的等待，以及节奏统计。不依赖 DXGI / GDI
+using namespace screenshot_tool;
+
+namespace {
+
+    constexpr int kTileW = 64;
+    constexpr int kTileH = 32;
+
+    // 合成的双显示器桌面：每个输出一块 RGB8，像素写入 (输出, 内容版本)。
+    // 输出 1 每 staticEvery 帧才出一次新画面，其余帧沿用它上一次复制的内容（与 DXGI 超时时复用暂存纹理相同）
+    struct SyntheticDesktop {
+        int staticEvery = 1;
+        int lastVersion[2] = { -1, -1 };
+
+        static size_t TileBytes() { return static_cast<size_t>(kTileW) * kTileH * 3; }
+
+        void Prepare(BurstFrame& slot) const {
+            for (int i = 0; i < 2; ++i) {
+                ImageBuffer b;
+                b.data.reserve(TileBytes());
+                slot.spare.push_back(std::move(b));
+            }
+        }
+
+        bool Capture(BurstFrame& frame) {
+            for (int output = 0; output < 2; ++output) {
+                const bool newFrame = output == 0 || frame.index % staticEvery == 0 || lastVersion[output] < 0;
+                if (newFrame) lastVersion[output] = frame.index;
+
+                ImageBuffer b = frame.TakeSpare(TileBytes());
+                b.format = PixelFormat::RGB8;
+                b.width = kTileW;
+                b.height = kTileH;
+                b.stride = kTileW * 3;
+                b.data.resize(TileBytes());
+                for (size_t i = 0; i < b.data.size(); i += 3) {
+                    b.data[i] = static_cast<uint8_t>(output);
+                    b.data[i + 1] = static_cast<uint8_t>(lastVersion[output] & 0xFF);
+                    b.data[i + 2] = static_cast<uint8_t>(lastVersion[output] >> 8);
+                }
+                frame.image.AddTile(output * kTileW, 0, std::move(b), ToneMapParams{});
+            }
+            return true;
+        }
+    };
+
+    // 块中每个像素都是同一 (输出, 版本)
+    bool tileStamp(const ImageTile& tile, int& output, int& version) {
+        const auto& d = tile.image.data;
+        if (d.size() != SyntheticDesktop::TileBytes()) return false;
+        for (size_t i = 3; i < d.size(); i += 3) {
+            if (memcmp(&d[i], &d[0], 3) != 0) return false;
+        }
+        output = d[0];
+        version = d[1] | (d[2] << 8);
+        return true;
+    }
+
+    std::set<const uint8_t*> spareAddresses(const std::vector<BurstFrame*>& slots) {
+        std::set<const uint8_t*> r;
+        for (const BurstFrame* s : slots) {
+            for (const auto& b : s->spare) r.insert(b.data.data());
+        }
+        return r;
+    }
+
+} // namespace
+
+TEST_CASE(TakeSparePrefersSmallestSufficientBuffer) {
+    BurstFrame frame;
+    CHECK(frame.TakeSpare(100).data.capacity() == 0);
+
+    for (size_t cap : { 50u, 400u, 200u, 120u }) {
+        ImageBuffer b;
+        b.data.reserve(cap);
+        frame.spare.push_back(std::move(b));
+    }
+    CHECK(frame.TakeSpare(150).data.capacity() >= 200);
+    CHECK(frame.TakeSpare(150).data.capacity() >= 400);
+    // 都不够时取最大的一块
+    CHECK(frame.TakeSpare(1000).data.capacity() >= 120);
+    CHECK_EQ(frame.spare.size(), 1u);
+    CHECK(frame.TakeSpare(10).data.capacity() >= 50);
+    CHECK(frame.spare.empty());
+}
+
+TEST_CASE(ZeroFramesDoesNothing) {
+    BurstOptions options;
+    options.frameCount = 0;
+    int calls = 0;
+    auto count = [&](BurstFrame&) { ++calls; return true; };
+    const BurstStats s = BurstCapture::Run(options, [&](BurstFrame&) { ++calls; }, count, count);
+    CHECK_EQ(calls, 0);
+    CHECK_EQ(s.requested, 0);
+    CHECK_EQ(s.captured, 0);
+    CHECK_EQ(s.ringBytes, 0u);
+}
+
+TEST_CASE(EveryFrameEncodedOnceWithItsOwnPixels) {
+    BurstOptions options;
+    options.frameCount = 40;
+    options.intervalMs = 2;
+    options.ringSize = 4;
+    options.encodeThreads = 3;
+
+    SyntheticDesktop desktop;
+    desktop.staticEvery = 3;
+    std::mutex mutex;
+    std::vector<int> encodedIndices;
+    std::vector<int64_t> captureTimes;
+    std::atomic<int> badFrames{ 0 };
+
+    const BurstStats s = BurstCapture::Run(options,
+        [&](BurstFrame& slot) { desktop.Prepare(slot); },
+        [&](BurstFrame& frame) {
+            captureTimes.push_back(frame.captureUs);
+            return desktop.Capture(frame);
+        },
+        [&](BurstFrame& frame) {
+            // 编码线程上读取的必须是这一帧的内容：输出 0 为本帧，静止的输出 1 为它最近一次出新画面的帧
+            const auto& tiles = frame.image.Tiles();
+            bool ok = tiles.size() == 2;
+            for (size_t i = 0; ok && i < tiles.size(); ++i) {
+                int output = -1, version = -1;
+                ok = tileStamp(tiles[i], output, version) && output == static_cast<int>(i) &&
+                    version == (output == 0 ? frame.index : frame.index - frame.index % desktop.staticEvery);
+            }
+            if (!ok) ++badFrames;
+            std::lock_guard<std::mutex> lock(mutex);
+            encodedIndices.push_back(frame.index);
+            return true;
+        });
+
+    CHECK_EQ(s.requested, 40);
+    CHECK_EQ(s.captured, 40);
+    CHECK_EQ(s.captureFailures, 0);
+    CHECK_EQ(s.encoded, 40);
+    CHECK_EQ(s.encodeFailures, 0);
+    CHECK_EQ(badFrames.load(), 0);
+    CHECK_EQ(s.ringBytes, 4 * 2 * SyntheticDesktop::TileBytes());
+
+    std::sort(encodedIndices.begin(), encodedIndices.end());
+    CHECK_EQ(encodedIndices.size(), 40u);
+    for (int i = 0; i < static_cast<int>(encodedIndices.size()); ++i) CHECK_EQ(encodedIndices[i], i);
+
+    // 抓取时刻单调递增，且不早于计划时刻
+    for (size_t i = 1; i < captureTimes.size(); ++i) CHECK(captureTimes[i] > captureTimes[i - 1]);
+    for (size_t i = 0; i < captureTimes.size(); ++i) {
+        CHECK(captureTimes[i] >= static_cast<int64_t>(i) * options.intervalMs * 1000);
+    }
+}
+
+TEST_CASE(RingBuffersAreReusedNotReallocated) {
+    BurstOptions options;
+    options.frameCount = 24;
+    options.intervalMs = 0;
+    options.ringSize = 3;
+    options.encodeThreads = 2;
+
+    SyntheticDesktop desktop;
+    std::vector<BurstFrame*> slots;
+    std::set<const uint8_t*> prepared;
+    std::mutex mutex;
+    std::atomic<int> foreign{ 0 };
+
+    const BurstStats s = BurstCapture::Run(options,
+        [&](BurstFrame& slot) {
+            desktop.Prepare(slot);
+            slots.push_back(&slot);
+        },
+        [&](BurstFrame& frame) {
+            if (prepared.empty()) prepared = spareAddresses(slots);
+            const bool ok = desktop.Capture(frame);
+            // 抓取写入的缓冲区都是开始前预分配的那几块
+            for (const auto& tile : frame.image.Tiles()) {
+                if (!prepared.count(tile.image.data.data())) ++foreign;
+            }
+            return ok;
+        },
+        [&](BurstFrame&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            return true;
+        });
+
+    CHECK_EQ(slots.size(), 3u);
+    CHECK_EQ(prepared.size(), 6u);
+    CHECK_EQ(foreign.load(), 0);
+    CHECK_EQ(s.encoded, 24);
+}
+
+TEST_CASE(FailuresAreCountedAndSlotsReturned) {
+    BurstOptions options;
+    options.frameCount = 30;
+    options.intervalMs = 0;
+    options.ringSize = 2;
+    options.encodeThreads = 1;
+
+    SyntheticDesktop desktop;
+    std::atomic<int> encodeCalls{ 0 };
+    int dirtySlots = 0;
+
+    const BurstStats s = BurstCapture::Run(options,
+        [&](BurstFrame& slot) { desktop.Prepare(slot); },
+        [&](BurstFrame& frame) {
+            // 交给抓取的槽位已清空，上一轮的缓冲区（包括失败帧写了一半的）一块不少地回到了 spare
+            if (!frame.image.Empty() || frame.spare.size() != 2) ++dirtySlots;
+            if (frame.index % 3 == 1) {
+                // 写了一半后失败：已加入的块也要回收到槽位
+                ImageBuffer b = frame.TakeSpare(SyntheticDesktop::TileBytes());
+                b.format = PixelFormat::RGB8;
+                b.width = kTileW;
+                b.height = kTileH;
+                b.stride = kTileW * 3;
+                b.data.resize(SyntheticDesktop::TileBytes());
+                frame.image.AddTile(0, 0, std::move(b), ToneMapParams{});
+                return false;
+            }
+            return desktop.Capture(frame);
+        },
+        [&](BurstFrame& frame) {
+            ++encodeCalls;
+            return frame.index % 3 != 2;
+        });
+
+    CHECK_EQ(s.captured, 20);
+    CHECK_EQ(s.captureFailures, 10);
+    CHECK_EQ(encodeCalls.load(), 20);
+    CHECK_EQ(s.encoded, 10);
+    CHECK_EQ(s.encodeFailures, 10);
+    CHECK_EQ(dirtySlots, 0);
+}
+
+TEST_CASE(SlowEncodingStallsCaptureOnFullRing) {
+    BurstOptions options;
+    options.frameCount = 8;
+    options.intervalMs = 0;
+    options.ringSize = 2;
+    options.encodeThreads = 1;
+
+    SyntheticDesktop desktop;
+    const BurstStats s = BurstCapture::Run(options,
+        [&](BurstFrame& slot) { desktop.Prepare(slot); },
+        [&](BurstFrame& frame) { return desktop.Capture(frame); },
+        [&](BurstFrame&) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            return true;
+        });
+
+    // 抓取最多领先编码两帧，其余每帧都要等编码腾出槽位
+    CHECK_EQ(s.encoded, 8);
+    CHECK(s.ringStalls >= 5);
+    CHECK(s.stallMs >= 20.0);
+    CHECK(s.maxLatenessMs >= 4.0);
+    CHECK(s.totalMs >= 40.0);
+}
+
+TEST_CASE(CadenceFollowsTheSchedule) {
+    BurstOptions options;
+    options.frameCount = 15;
+    options.intervalMs = 10;
+    options.ringSize = 4;
+
+    SyntheticDesktop desktop;
+    const BurstStats s = BurstCapture::Run(options,
+        [&](BurstFrame& slot) { desktop.Prepare(slot); },
+        [&](BurstFrame& frame) { return desktop.Capture(frame); },
+        [&](BurstFrame&) { return true; });
+
+    if (test::Verbose()) {
+        printf("  cadence: avg %.2f ms, median %.2f, min %.2f, max %.2f, jitter %.2f, lateness %.2f / %.2f, span %.1f ms\n",
+            s.avgIntervalMs, s.medianIntervalMs, s.minIntervalMs, s.maxIntervalMs, s.jitterMs,
+            s.avgLatenessMs, s.maxLatenessMs, s.captureSpanMs);
+    }
+    CHECK_EQ(s.captured, 15);
+    CHECK_NEAR(s.targetIntervalMs, 10.0, 1e-9);
+    CHECK(s.minIntervalMs <= s.medianIntervalMs && s.medianIntervalMs <= s.maxIntervalMs);
+    CHECK(s.minIntervalMs <= s.avgIntervalMs && s.avgIntervalMs <= s.maxIntervalMs);
+    CHECK(s.jitterMs >= 0.0);
+    // 按绝对时间表抓取：某一帧晚了不会推迟后面的计划，跨度不小于 14 个间隔，平均间隔接近目标
+    CHECK(s.captureSpanMs >= 140.0);
+    CHECK_NEAR(s.avgIntervalMs, s.captureSpanMs / 14.0, 1e-6);
+    CHECK_NEAR(s.avgIntervalMs, 10.0, 5.0);
+    CHECK(s.totalMs >= s.captureSpanMs);
+    CHECK_EQ(s.ringStalls, 0);
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "TestUtil.hpp"
+#include "capture/CaptureScope.hpp"
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+// 冻结帧缓存范围：合成的多显示器布局下，选择限制在单个显示器时缓存只含该显示器（内存与它的面积成正比），
+// 跨显示器选择时每个显示器一块且不为空洞分配；区域只能从覆盖它的缓存范围内提取
+using namespace screenshot_tool;
+
+namespace {
+
+    struct Layout {
+        const char* name;
+        std::vector<PixelBox> monitors;
+    };
+
+    // 主显示器左上角为原点，其余显示器可位于负坐标；尺寸与对齐方式各不相同
+    std::vector<Layout> layouts() {
+        return {
+            { "single", { { 0, 0, 1920, 1080 } } },
+            { "side by side, bottom aligned", { { 0, 0, 2560, 1440 }, { 2560, 360, 4480, 1440 } } },
+            { "stacked above", { { 0, 0, 1920, 1080 }, { -320, -1440, 2240, 0 } } },
+            { "portrait left", { { 0, 0, 3840, 2160 }, { -1080, -600, 0, 1320 } } },
+            { "L-shaped", { { 0, 0, 2560, 1440 }, { 2560, 0, 4480, 1080 }, { 0, 1440, 1920, 2520 } } },
+            { "diagonal, touching corner", { { 0, 0, 1920, 1080 }, { 1920, 1080, 3840, 2160 } } },
+            { "three in a row with gap", { { -1920, 0, 0, 1080 }, { 0, 0, 1920, 1080 }, { 2000, 100, 3280, 1124 } } },
+        };
+    }
+
+    PixelBox boundingBox(const std::vector<PixelBox>& boxes) {
+        PixelBox r{ INT_MAX, INT_MAX, INT_MIN, INT_MIN };
+        for (const auto& b : boxes) {
+            r.left = std::min(r.left, b.left);
+            r.top = std::min(r.top, b.top);
+            r.right = std::max(r.right, b.right);
+            r.bottom = std::max(r.bottom, b.bottom);
+        }
+        return r;
+    }
+
+    long long area(const PixelBox& b) {
+        return static_cast<long long>(b.Width()) * b.Height();
+    }
+
+    bool sameBox(const PixelBox& a, const PixelBox& b) {
+        return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+    }
+
+    // 各块互不重叠且都在缓存范围内
+    bool tilesDisjointInside(const std::vector<CacheTile>& tiles, const PixelBox& cache) {
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            if (!RegionInCache(tiles[i].box, cache)) return false;
+            for (size_t j = i + 1; j < tiles.size(); ++j) {
+                PixelBox overlap;
+                if (IntersectBox(tiles[i].box, tiles[j].box, overlap)) return false;
+            }
+        }
+        return true;
+    }
+
+} // namespace
+
+TEST_CASE(IntersectBoxHalfOpen) {
+    PixelBox r;
+    CHECK(IntersectBox({ 0, 0, 10, 10 }, { 5, -5, 20, 5 }, r));
+    CHECK(sameBox(r, { 5, 0, 10, 5 }));
+    // 只有边或角相接不算相交，out 不被改写
+    r = { 1, 2, 3, 4 };
+    CHECK(!IntersectBox({ 0, 0, 10, 10 }, { 10, 0, 20, 10 }, r));
+    CHECK(!IntersectBox({ 0, 0, 10, 10 }, { 10, 10, 20, 20 }, r));
+    CHECK(!IntersectBox({ 0, 0, 10, 10 }, { 3, 3, 3, 8 }, r));
+    CHECK(sameBox(r, { 1, 2, 3, 4 }));
+}
+
+TEST_CASE(MonitorScopeCachesOneDisplay) {
+    for (const Layout& layout : layouts()) {
+        const PixelBox desktop = boundingBox(layout.monitors);
+        for (size_t m = 0; m < layout.monitors.size(); ++m) {
+            // regionFullscreenMonitor：选择范围为光标所在显示器
+            const PixelBox& monitor = layout.monitors[m];
+            PixelBox cache;
+            CHECK(CacheScope(monitor, desktop, cache));
+            CHECK(sameBox(cache, monitor));
+            const auto tiles = CacheTiles(cache, layout.monitors);
+            CHECK_EQ(tiles.size(), size_t(1));
+            if (tiles.size() != 1) {
+                std::printf("  %s, monitor %zu: %zu tiles\n", layout.name, m, tiles.size());
+                continue;
+            }
+            CHECK_EQ(tiles[0].monitor, m);
+            CHECK(sameBox(tiles[0].box, monitor));
+            CHECK_EQ(area(tiles[0].box), area(monitor));   // 缓存大小与该显示器成正比，与其余显示器无关
+        }
+    }
+}
+
+TEST_CASE(DesktopScopeCachesEveryDisplayWithoutGaps) {
+    for (const Layout& layout : layouts()) {
+        const PixelBox desktop = boundingBox(layout.monitors);
+        PixelBox cache;
+        CHECK(CacheScope(desktop, desktop, cache));
+        CHECK(sameBox(cache, desktop));
+        const auto tiles = CacheTiles(cache, layout.monitors);
+        CHECK_EQ(tiles.size(), layout.monitors.size());
+        CHECK(tilesDisjointInside(tiles, cache));
+        long long tileArea = 0, monitorArea = 0;
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            CHECK_EQ(tiles[i].monitor, i);
+            CHECK(sameBox(tiles[i].box, layout.monitors[i]));
+            tileArea += area(tiles[i].box);
+        }
+        for (const auto& m : layout.monitors) monitorArea += area(m);
+        // 空洞不分配：块面积之和等于显示器面积之和，不超过包围盒
+        CHECK_EQ(tileArea, monitorArea);
+        CHECK(tileArea <= area(desktop));
+        if (test::Verbose()) {
+            std::printf("  %s: %lld of %lld pixels cached\n", layout.name, tileArea, area(desktop));
+        }
+    }
+}
+
+TEST_CASE(ScopeClippedToDesktop) {
+    const std::vector<PixelBox> monitors = { { 0, 0, 2560, 1440 }, { 2560, 360, 4480, 1440 } };
+    const PixelBox desktop = boundingBox(monitors);
+    PixelBox cache;
+    // 超出虚拟桌面的部分被裁掉；空洞上方的部分保留在范围内但不产生块
+    CHECK(CacheScope({ 2000, -100, 5000, 800 }, desktop, cache));
+    CHECK(sameBox(cache, { 2000, 0, 4480, 800 }));
+    const auto tiles = CacheTiles(cache, monitors);
+    CHECK_EQ(tiles.size(), size_t(2));
+    CHECK(sameBox(tiles[0].box, { 2000, 0, 2560, 800 }));
+    CHECK(sameBox(tiles[1].box, { 2560, 360, 4480, 800 }));
+    // 完全在桌面之外或为空
+    CHECK(!CacheScope({ 5000, 0, 6000, 100 }, desktop, cache));
+    CHECK(!CacheScope({ 100, 100, 100, 200 }, desktop, cache));
+    // 只位于空洞内：范围有效但没有块，上层回退到 GDI
+    CHECK(CacheScope({ 3000, 0, 3500, 300 }, desktop, cache));
+    CHECK(CacheTiles(cache, monitors).empty());
+}
+
+TEST_CASE(RegionsScopedToCachedMonitor) {
+    const Layout layout = layouts()[4];     // L 形
+    const PixelBox desktop = boundingBox(layout.monitors);
+    const PixelBox& primary = layout.monitors[0];
+    PixelBox cache;
+    CHECK(CacheScope(primary, desktop, cache));
+
+    CHECK(RegionInCache(primary, cache));
+    CHECK(RegionInCache({ 100, 100, 200, 150 }, cache));
+    CHECK(RegionInCache({ 2559, 1439, 2560, 1440 }, cache));
+    // 越过到相邻显示器的区域不在缓存中
+    CHECK(!RegionInCache({ 2500, 100, 2600, 200 }, cache));
+    CHECK(!RegionInCache({ 100, 1400, 200, 1500 }, cache));
+    CHECK(!RegionInCache({ -1, 0, 10, 10 }, cache));
+    // 空区域
+    CHECK(!RegionInCache({ 10, 10, 10, 20 }, cache));
+    CHECK(!RegionInCache({ 10, 20, 30, 10 }, cache));
+
+    // 整个桌面为范围时跨显示器的区域可以提取
+    CHECK(CacheScope(desktop, desktop, cache));
+    CHECK(RegionInCache({ 2500, 100, 2600, 200 }, cache));
+    CHECK(RegionInCache({ 100, 1400, 200, 1500 }, cache));
+}
+
+TEST_CASE(EveryMonitorCoveredByItsTile) {
+    // 任一显示器范围内的每个采样点恰好落在一个块中，且是该显示器的块
+    for (const Layout& layout : layouts()) {
+        const PixelBox desktop = boundingBox(layout.monitors);
+        const auto tiles = CacheTiles(desktop, layout.monitors);
+        int misses = 0;
+        for (size_t m = 0; m < layout.monitors.size(); ++m) {
+            const PixelBox& mon = layout.monitors[m];
+            for (int y = mon.top; y < mon.bottom; y += 97) {
+                for (int x = mon.left; x < mon.right; x += 89) {
+                    int hits = 0;
+                    for (const auto& t : tiles) {
+                        if (RegionInCache({ x, y, x + 1, y + 1 }, t.box)) {
+                            ++hits;
+                            if (t.monitor != m) ++misses;
+                        }
+                    }
+                    if (hits != 1) ++misses;
+                }
+            }
+        }
+        CHECK_EQ(misses, 0);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/PixelConvert.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+// 3D LUT 路径与解析内核的一致性：关闭抖动后逐像素比较 8 位输出。
+// LUT 的输入为 Rec.2020 PQ，2020 -> 709、色域映射与色调映射都烘焙在格点里，
+// 插值误差超限的格子回退解析内核，因此误差有明确上界
+using namespace screenshot_tool;
+
+namespace {
+
+    const char* const OPERATORS[] = { "reinhard", "reinhardextended", "aces", "hable", "bt2390", "agx" };
+    const char* const GAMUTS[] = { "preserve", "aces", "clip" };
+
+    struct Format {
+        const char* name;
+        PixelFormat format;
+    };
+    const Format FORMATS[] = {
+        { "scRGB FP16", PixelFormat::RGBA_F16 },
+        { "HDR10", PixelFormat::RGBA10A2 },
+        { "RGB9E5", PixelFormat::RGB9E5 },
+    };
+
+    // 误差上限（8 位码值）
+    constexpr int MAX_ERROR = 4;
+    constexpr double MAX_SHARE_ABOVE_2 = 0.005;     // 误差 > 2 的通道占比
+    constexpr double MAX_RMS = 1.0;                 // 大片平坦区域（界面底色）的 ±1 舍入差会整体计入
+
+    struct ErrorStats {
+        int max = 0;
+        double shareAbove2 = 0.0;
+        double rms = 0.0;
+    };
+
+    ErrorStats compare(const ImageBuffer& analytic, const ImageBuffer& lut) {
+        ErrorStats stats;
+        size_t above2 = 0;
+        double squared = 0.0;
+        for (size_t i = 0; i < analytic.data.size(); ++i) {
+            const int d = std::abs(analytic.data[i] - lut.data[i]);
+            stats.max = std::max(stats.max, d);
+            above2 += d > 2;
+            squared += static_cast<double>(d) * d;
+        }
+        stats.shareAbove2 = static_cast<double>(above2) / analytic.data.size();
+        stats.rms = std::sqrt(squared / analytic.data.size());
+        return stats;
+    }
+
+    // 随机像素：HDR10 为均匀分布的码值；scRGB 为 0.001..100 倍 80 nits 的随机颜色，含负分量（色域外）
+    ImageBuffer randomPixels(PixelFormat fmt, int width, int height) {
+        ImageBuffer buf;
+        buf.format = fmt;
+        buf.width = width;
+        buf.height = height;
+        buf.stride = width * BytesPerPixel(fmt);
+        buf.data.resize(static_cast<size_t>(buf.stride) * height);
+        const int pixels = width * height;
+        std::mt19937 rng(20240601u);
+        if (fmt == PixelFormat::RGBA10A2) {
+            auto* dst = reinterpret_cast<uint32_t*>(buf.data.data());
+            for (int i = 0; i < pixels; ++i) {
+                const uint32_t r = rng() % 1024u, g = rng() % 1024u, b = rng() % 1024u;
+                dst[i] = (3u << 30) | (r << 20) | (g << 10) | b;
+            }
+            return buf;
+        }
+        std::uniform_real_distribution<float> exponent(-3.0f, 2.0f);
+        std::uniform_real_distribution<float> component(-0.5f, 1.0f);
+        std::vector<uint16_t> half(static_cast<size_t>(pixels) * 4);
+        for (int i = 0; i < pixels; ++i) {
+            const float scale = std::pow(10.0f, exponent(rng));
+            for (int c = 0; c < 3; ++c) half[i * 4 + c] = FloatToHalf(component(rng) * scale);
+            half[i * 4 + 3] = FloatToHalf(1.0f);
+        }
+        if (fmt == PixelFormat::RGBA_F16) {
+            std::memcpy(buf.data.data(), half.data(), buf.data.size());
+        } else {
+            PackHalfToRGB9E5N(half.data(), reinterpret_cast<uint32_t*>(buf.data.data()), pixels);
+        }
+        return buf;
+    }
+
+    ToneMapParams hdrParams() {
+        ToneMapParams params;
+        params.hdr = true;
+        params.maxNits = 1000.0f;
+        return params;
+    }
+
+    // 对每种格式的源图跑全部 算子 × 色域映射 × LUT 尺寸，逐项检查误差上限
+    template<class MakeSource>
+    void checkAccuracy(const char* label, MakeSource&& makeSource) {
+        std::vector<int> sizes = { 33 };
+        if (!test::QuickMode()) sizes = { 17, 33, 65 };
+        for (const auto& f : FORMATS) {
+            const ImageBuffer source = makeSource(f.format);
+            const auto regions = ToneMapRegions::Uniform(hdrParams(), source.width, source.height);
+            for (const char* op : OPERATORS) {
+                for (const char* gamut : GAMUTS) {
+                    Config config;
+                    config.toneMapper = op;
+                    config.gamutMapping = gamut;
+                    config.dither = false;
+                    config.colorLutSize = 0;
+                    ImageBuffer analytic = source;
+                    CHECK(PixelConvert::ToSRGB8(f.format, analytic, regions, &config));
+                    for (int size : sizes) {
+                        config.colorLutSize = size;
+                        ImageBuffer lut = source;
+                        CHECK(PixelConvert::ToSRGB8(f.format, lut, regions, &config));
+                        const ErrorStats e = compare(analytic, lut);
+                        const bool ok = e.max <= MAX_ERROR && e.shareAbove2 <= MAX_SHARE_ABOVE_2 && e.rms <= MAX_RMS;
+                        if (!ok || test::Verbose()) {
+                            std::printf("  %s %-10s %-16s %-8s %2d^3: max %d, >2 %.3f%%, rms %.3f\n", label, f.name, op, gamut,
+                                size, e.max, 100.0 * e.shareAbove2, e.rms);
+                        }
+                        CHECK(e.max <= MAX_ERROR);
+                        CHECK(e.shareAbove2 <= MAX_SHARE_ABOVE_2);
+                        CHECK(e.rms <= MAX_RMS);
+                    }
+                }
+            }
+        }
+    }
+
+} // namespace
+
+TEST_CASE(RandomPixelsMatchAnalytic) {
+    checkAccuracy("random", [](PixelFormat fmt) { return randomPixels(fmt, 256, 256); });
+}
+
+TEST_CASE(SyntheticSceneMatchesAnalytic) {
+    const test::SceneNits scene = test::QuickMode() ? test::MakeScene(480, 270) : test::MakeScene(1920, 1080);
+    checkAccuracy("scene", [&](PixelFormat fmt) { return test::EncodeScene(scene, fmt); });
+}
+
+TEST_CASE(AutoExposureQuantizedForLUTCache) {
+    // 自动曝光的结果按 1/64 EV 量化：亮度略有变化的画面得到相同或相邻一档的参数，LUT 缓存键才能命中
+    test::SceneNits scene = test::MakeScene(480, 270);
+    Config config;
+    config.autoExposure = true;
+    ToneMapParams exposures[2];
+    for (ToneMapParams& params : exposures) {
+        const ImageBuffer source = test::EncodeScene(scene, PixelFormat::RGBA_F16);
+        auto regions = ToneMapRegions::Uniform(hdrParams(), source.width, source.height);
+        PixelConvert::ApplyAutoExposure(source.format, source, regions, &config);
+        params = regions.Params(0);
+        CHECK(params.exposure > 0.0f && params.whiteNits > 0.0f);
+        for (float v : { params.exposure, params.whiteNits }) {
+            const float steps = std::log2(v) * 64.0f;
+            CHECK_NEAR(steps, std::round(steps), 1e-3f);
+        }
+        for (float& v : scene.rgb) v *= 1.002f;
+    }
+    CHECK(std::abs(std::log2(exposures[1].exposure / exposures[0].exposure)) <= 1.0f / 64.0f + 1e-4f);
+    if (test::Verbose()) {
+        std::printf("  exposure %.6f -> %.6f /nit, white %.1f -> %.1f nits\n", exposures[0].exposure,
+            exposures[1].exposure, exposures[0].whiteNits, exposures[1].whiteNits);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "TestUtil.hpp"
+#include "image/ColorSpace.hpp"
+#include "image/HalfFloat.hpp"
+#include "image/ToneMapping.hpp"
+#include <vector>
+
+// ColorSpace 批量接口的参考值：ST 2084 / BT.2100 HLG / sRGB 传递函数与双精度公式比较，
+// 色域矩阵与 ITU-R BT.2087 等公开数值比较，批量版本与逐值版本一致
+using namespace screenshot_tool;
+
+namespace {
+
+    double pqToNits(double e) {
+        const double m1 = 2610.0 / 16384.0, m2 = 2523.0 / 4096.0 * 128.0;
+        const double c1 = 3424.0 / 4096.0, c2 = 2413.0 / 4096.0 * 32.0, c3 = 2392.0 / 4096.0 * 32.0;
+        const double p = std::pow(e, 1.0 / m2);
+        return 10000.0 * std::pow(std::max(p - c1, 0.0) / (c2 - c3 * p), 1.0 / m1);
+    }
+
+    double nitsToPQ(double nits) {
+        const double m1 = 2610.0 / 16384.0, m2 = 2523.0 / 4096.0 * 128.0;
+        const double c1 = 3424.0 / 4096.0, c2 = 2413.0 / 4096.0 * 32.0, c3 = 2392.0 / 4096.0 * 32.0;
+        const double y = std::pow(nits / 10000.0, m1);
+        return std::pow((c1 + c2 * y) / (1.0 + c3 * y), m2);
+    }
+
+    double hlgToLinear(double e) {
+        const double a = 0.17883277, b = 1.0 - 4.0 * a, c = 0.5 - a * std::log(4.0 * a);
+        return e <= 0.5 ? e * e / 3.0 : (std::exp((e - c) / a) + b) / 12.0;
+    }
+
+    double linearToSRGB(double v) { return v <= 0.0031308 ? 12.92 * v : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055; }
+
+    // 在 [0, 1] 上均匀取样，长度 1027 以覆盖 SIMD 主循环之后的标量尾部
+    std::vector<float> sweep(int count = 1027) {
+        std::vector<float> v(count);
+        for (int i = 0; i < count; ++i) v[i] = static_cast<float>(i) / (count - 1);
+        return v;
+    }
+
+    void checkMatrix(ColorGamut from, ColorGamut to, const double (&expected)[9], double tol) {
+        const float* m = ColorSpace::GamutMatrix(from, to);
+        for (int i = 0; i < 9; ++i) CHECK_NEAR(m[i], expected[i], tol);
+        // D65 白点保持不变：每行之和为 1
+        for (int r = 0; r < 3; ++r) CHECK_NEAR(m[r * 3] + m[r * 3 + 1] + m[r * 3 + 2], 1.0, 1e-5);
+    }
+
+} // namespace
+
+TEST_CASE(PQReferenceValues) {
+    // ST 2084 / BT.2408 常用参考点
+    CHECK_NEAR(PQToLinear(0.0f), 0.0, 1e-6);
+    CHECK_NEAR(PQToLinear(1.0f), 10000.0, 0.5);
+    CHECK_NEAR(LinearToPQ(100.0f), 0.508078, 5e-6);
+    CHECK_NEAR(LinearToPQ(203.0f), nitsToPQ(203.0), 5e-6);     // BT.2408 参考白约 58%
+    CHECK_NEAR(LinearToPQ(203.0f), 0.58, 1e-3);
+    CHECK_NEAR(LinearToPQ(1000.0f), 0.751827, 5e-6);
+    CHECK_NEAR(LinearToPQ(10000.0f), 1.0, 1e-6);
+
+    const std::vector<float> pq = sweep();
+    std::vector<float> nits(pq.size());
+    ColorSpace::PQToLinearN(pq.data(), nits.data(), static_cast<int>(pq.size()));
+    double worst = 0.0;
+    for (size_t i = 0; i < pq.size(); ++i) {
+        const double ref = pqToNits(pq[i]);
+        worst = std::max(worst, std::fabs(nits[i] - ref) / std::max(ref, 1e-3));
+    }
+    CHECK(worst < 1e-4);
+
+    // 逆变换：0.001 .. 10000 nits 对数取样
+    std::vector<float> in(1027), out(1027);
+    for (size_t i = 0; i < in.size(); ++i) in[i] = static_cast<float>(0.001 * std::pow(1e7, static_cast<double>(i) / (in.size() - 1)));
+    ColorSpace::LinearToPQN(in.data(), out.data(), static_cast<int>(in.size()));
+    worst = 0.0;
+    for (size_t i = 0; i < in.size(); ++i) worst = std::max(worst, std::fabs(out[i] - nitsToPQ(in[i])));
+    CHECK(worst < 1e-5);
+
+    // 往返
+    ColorSpace::PQToLinearN(out.data(), out.data(), static_cast<int>(out.size()));
+    worst = 0.0;
+    for (size_t i = 0; i < in.size(); ++i) worst = std::max(worst, static_cast<double>(std::fabs(out[i] - in[i]) / std::max(in[i], 0.01f)));
+    CHECK(worst < 1e-3);
+}
+
+TEST_CASE(HLGReferenceValues) {
+    std::vector<float> e = sweep();
+    e.insert(e.end(), { -0.25f, 1.5f });     // 超出 [0, 1] 的输入先钳制
+    std::vector<float> linear(e.size());
+    ColorSpace::HLGToLinearN(e.data(), linear.data(), static_cast<int>(e.size()));
+    double worst = 0.0;
+    for (size_t i = 0; i < e.size(); ++i) {
+        worst = std::max(worst, std::fabs(linear[i] - hlgToLinear(std::clamp(static_cast<double>(e[i]), 0.0, 1.0))));
+    }
+    CHECK(worst < 1e-6);
+    // 分段点 0.5 -> 1/12，1.0 -> 1.0
+    CHECK_NEAR(linear[513], hlgToLinear(513.0 / 1026.0), 1e-6);
+    CHECK_NEAR(linear[1026], 1.0, 1e-6);
+    CHECK_EQ(linear[1027], 0.0f);
+    CHECK_NEAR(linear[1028], 1.0, 1e-6);
+    float halfPoint = 0.5f, halfLinear = 0.0f;
+    ColorSpace::HLGToLinearN(&halfPoint, &halfLinear, 1);
+    CHECK_NEAR(halfLinear, 1.0 / 12.0, 1e-7);
+}
+
+TEST_CASE(SRGBReferenceValues) {
+    std::vector<float> v = sweep();
+    v.insert(v.end(), { -0.5f, 2.0f, 0.0031308f });
+    std::vector<float> encoded(v.size());
+    ColorSpace::LinearToSRGBN(v.data(), encoded.data(), static_cast<int>(v.size()));
+    double worst = 0.0;
+    for (size_t i = 0; i < v.size(); ++i) {
+        worst = std::max(worst, std::fabs(encoded[i] - linearToSRGB(std::clamp(static_cast<double>(v[i]), 0.0, 1.0))));
+    }
+    CHECK(worst < 2e-6);
+    CHECK_NEAR(encoded[v.size() - 3], 0.0, 1e-7);
+    CHECK_NEAR(encoded[v.size() - 2], 1.0, 1e-6);
+    CHECK_NEAR(encoded[v.size() - 1], 12.92 * 0.0031308, 1e-6);    // 分段点两侧连续
+    // 18% 灰 -> 0.4614
+    float gray = 0.18f, out = 0.0f;
+    ColorSpace::LinearToSRGBN(&gray, &out, 1);
+    CHECK_NEAR(out, 0.461356, 2e-6);
+}
+
+TEST_CASE(ScRGBToNits) {
+    const uint16_t half[] = { FloatToHalf(1.0f), FloatToHalf(0.5f), FloatToHalf(12.5f), FloatToHalf(-0.25f), 0 };
+    float nits[5];
+    ColorSpace::ScRGBToNitsN(half, nits, 5);
+    CHECK_EQ(nits[0], 80.0f);
+    CHECK_EQ(nits[1], 40.0f);
+    CHECK_EQ(nits[2], 1000.0f);
+    CHECK_EQ(nits[3], -20.0f);
+    CHECK_EQ(nits[4], 0.0f);
+}
+
+TEST_CASE(GamutMatrixReferenceValues) {
+    // ITU-R BT.2087（四位小数）
+    const double rec2020To709[9] = { 1.6605, -0.5876, -0.0728, -0.1246, 1.1329, -0.0083, -0.0182, -0.1006, 1.1187 };
+    const double rec709To2020[9] = { 0.6274, 0.3293, 0.0433, 0.0691, 0.9195, 0.0114, 0.0164, 0.0880, 0.8956 };
+    // Display P3 -> sRGB（SMPTE EG 432-1 原色，D65）
+    const double p3To709[9] = { 1.2249, -0.2247, 0.0, -0.0420, 1.0419, 0.0, -0.0197, -0.0786, 1.0979 };
+    checkMatrix(ColorGamut::Rec2020, ColorGamut::Rec709, rec2020To709, 1e-4);
+    checkMatrix(ColorGamut::Rec709, ColorGamut::Rec2020, rec709To2020, 1e-4);
+    checkMatrix(ColorGamut::DisplayP3, ColorGamut::Rec709, p3To709, 5e-4);
+
+    // 正反矩阵互逆，同色域为单位阵（由双精度矩阵运算得到，允许舍入误差）
+    const float* a = ColorSpace::GamutMatrix(ColorGamut::Rec2020, ColorGamut::DisplayP3);
+    const float* b = ColorSpace::GamutMatrix(ColorGamut::DisplayP3, ColorGamut::Rec2020);
+    const float* identity = ColorSpace::GamutMatrix(ColorGamut::Rec709, ColorGamut::Rec709);
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) {
+            const double ab = a[r * 3] * b[c] + a[r * 3 + 1] * b[3 + c] + a[r * 3 + 2] * b[6 + c];
+            CHECK_NEAR(ab, r == c ? 1.0 : 0.0, 1e-5);
+            CHECK_NEAR(identity[r * 3 + c], r == c ? 1.0 : 0.0, 1e-6);
+        }
+    }
+}
+
+TEST_CASE(ConvertGamutPlanarMatchesInterleaved) {
+    constexpr int count = 1027;
+    std::vector<float> rgb(count * 3), r(count), g(count), b(count);
+    for (int i = 0; i < count; ++i) {
+        r[i] = rgb[i * 3] = std::sin(i * 0.37f) * 3.0f;
+        g[i] = rgb[i * 3 + 1] = std::cos(i * 0.11f) * 2.0f + 1.0f;
+        b[i] = rgb[i * 3 + 2] = static_cast<float>(i) / count;
+    }
+    ColorSpace::ConvertGamutN(ColorGamut::Rec2020, ColorGamut::Rec709, rgb.data(), count);
+    ColorSpace::ConvertGamutPlanar(ColorGamut::Rec2020, ColorGamut::Rec709, r.data(), g.data(), b.data(), count);
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        mismatches += std::fabs(rgb[i * 3] - r[i]) > 1e-6f || std::fabs(rgb[i * 3 + 1] - g[i]) > 1e-6f || std::fabs(rgb[i * 3 + 2] - b[i]) > 1e-6f;
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST_CASE(PQ2020ToLinearSRGBReferenceValues) {
+    // 3 x 2 的 RGBA16F PQ 图，行距带 16 字节填充：
+    // 第 0 行为 100 nits 白、0 nits 黑与 Rec.2020 纯红（100 nits），第 1 行为 50 nits 灰
+    constexpr int width = 3, height = 2, stride = width * 8 + 16;
+    std::vector<uint8_t> data(stride * height, 0xCD);
+    auto put = [&](int x, int y, float r, float g, float b) {
+        uint16_t* p = reinterpret_cast<uint16_t*>(&data[y * stride + x * 8]);
+        p[0] = FloatToHalf(LinearToPQ(r));
+        p[1] = FloatToHalf(LinearToPQ(g));
+        p[2] = FloatToHalf(LinearToPQ(b));
+        p[3] = FloatToHalf(1.0f);
+    };
+    put(0, 0, 100.0f, 100.0f, 100.0f);
+    put(1, 0, 0.0f, 0.0f, 0.0f);
+    put(2, 0, 100.0f, 0.0f, 0.0f);
+    for (int x = 0; x < width; ++x) put(x, 1, 50.0f, 50.0f, 50.0f);
+
+    std::vector<float> out(width * height * 3);
+    PQ2020ToLinearSRGB(reinterpret_cast<const uint16_t*>(data.data()), width, height, stride, 100.0f, 0.0f, out.data());
+    // PQ 码值经 FP16 存储，误差约 1e-3 相对
+    for (int c = 0; c < 3; ++c) {
+        CHECK_NEAR(out[c], 1.0, 3e-3);
+        CHECK_NEAR(out[3 + c], 0.0, 1e-6);
+    }
+    CHECK_NEAR(out[6], 1.6605, 5e-3);
+    CHECK_NEAR(out[7], -0.1246, 1e-3);
+    CHECK_NEAR(out[8], -0.0182, 1e-3);
+    for (int x = 0; x < width; ++x) {
+        for (int c = 0; c < 3; ++c) CHECK_NEAR(out[(width + x) * 3 + c], 0.5, 2e-3);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "TestUtil.hpp"
+#include "image/FrameFile.hpp"
+#include "util/MappedFile.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+// 上次冻结帧的映射文件：MappedFile 读写、FrameFile 各格式块与预览的往返，以及截断、
+// 字段越界和逐字节损坏的文件都被 Open 拒绝（或仍能安全读取），不会越界访问
+using namespace screenshot_tool;
+namespace fs = std::filesystem;
+
+namespace {
+
+    // 文件头与块记录的字段偏移（与 FrameFile.cpp 中的布局一致）
+    constexpr size_t HEADER_BYTES = 64;
+    constexpr size_t RECORD_BYTES = 64;
+    constexpr size_t H_MAGIC = 0, H_VERSION = 4, H_RIGHT = 16, H_TILE_COUNT = 32, H_PREVIEW_STRIDE = 36,
+                     H_PREVIEW_OFFSET = 40, H_FILE_BYTES = 56;
+    constexpr size_t R_LEFT = 0, R_WIDTH = 8, R_STRIDE = 16, R_FORMAT = 20, R_OFFSET = 48, R_BYTES = 56;
+
+    // 每个测试进程自己的临时目录，结束时删除
+    struct TempDir {
+        fs::path path;
+        TempDir() {
+            path = fs::temp_directory_path() / ("frame_file_test_" + std::to_string(std::random_device{}()));
+            fs::create_directories(path);
+        }
+        ~TempDir() {
+            std::error_code ec;
+            fs::remove_all(path, ec);
+        }
+    };
+
+    ImageBuffer makeImage(PixelFormat fmt, int width, int height, int padding, uint8_t seed) {
+        ImageBuffer img;
+        img.format = fmt;
+        img.width = width;
+        img.height = height;
+        img.stride = width * BytesPerPixel(fmt) + padding;
+        img.data.resize(static_cast<size_t>(img.stride) * height);
+        for (size_t i = 0; i < img.data.size(); ++i) img.data[i] = static_cast<uint8_t>(i * 31 + seed);
+        return img;
+    }
+
+    ToneMapParams params(bool hdr, float maxNits, float exposure) {
+        ToneMapParams p;
+        p.hdr = hdr;
+        p.maxNits = maxNits;
+        p.minNits = 0.05f;
+        p.exposure = exposure;
+        p.whiteNits = hdr ? 800.0f : 0.0f;
+        return p;
+    }
+
+    // L 形的四块，覆盖所有可存放的格式，其中一块带行填充
+    TiledImage makeFrame() {
+        TiledImage frame;
+        frame.AddTile(0, 0, makeImage(PixelFormat::RGBA_F16, 64, 36, 0, 1), params(true, 1000.0f, 0.0125f));
+        frame.AddTile(64, 0, makeImage(PixelFormat::BGRA8, 48, 27, 0, 2), params(false, 200.0f, 0.0f));
+        frame.AddTile(0, 36, makeImage(PixelFormat::RGB9E5, 40, 20, 16, 3), params(true, 600.0f, 0.0f));
+        frame.AddTile(-30, 10, makeImage(PixelFormat::RGBA10A2, 30, 17, 0, 4), params(true, 1500.0f, 0.002f));
+        return frame;
+    }
+
+    constexpr int LEFT = -30, TOP = 0, RIGHT = 112, BOTTOM = 56;
+
+    ImageBuffer makePreview() {
+        return makeImage(PixelFormat::RGB8, RIGHT - LEFT, BOTTOM - TOP, 0, 9);
+    }
+
+    bool sameTiles(const TiledImage& a, const TiledImage& b) {
+        if (a.Tiles().size() != b.Tiles().size()) return false;
+        for (size_t i = 0; i < a.Tiles().size(); ++i) {
+            const ImageTile& x = a.Tiles()[i];
+            const ImageTile& y = b.Tiles()[i];
+            if (x.left != y.left || x.top != y.top || x.image.format != y.image.format || x.image.width != y.image.width ||
+                x.image.height != y.image.height || x.image.stride != y.image.stride || x.image.data != y.image.data) return false;
+            if (x.params.hdr != y.params.hdr || x.params.maxNits != y.params.maxNits || x.params.minNits != y.params.minNits ||
+                x.params.exposure != y.params.exposure || x.params.whiteNits != y.params.whiteNits) return false;
+        }
+        return true;
+    }
+
+    std::vector<uint8_t> readAll(const fs::path& p) {
+        std::ifstream f(p, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(f), {});
+    }
+
+    void writeAll(const fs::path& p, const std::vector<uint8_t>& bytes) {
+        std::ofstream f(p, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    template<class T>
+    void poke(std::vector<uint8_t>& bytes, size_t offset, T value) {
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    // 写入一个修改过的副本，返回能否打开；能打开时各块也必须能完整读出
+    bool opensAfter(const fs::path& dir, const std::vector<uint8_t>& original, void (*patch)(std::vector<uint8_t>&)) {
+        std::vector<uint8_t> bytes = original;
+        patch(bytes);
+        const fs::path p = dir / "patched.bin";
+        writeAll(p, bytes);
+        FrameFile file;
+        if (!file.Open(p)) return false;
+        TiledImage tiles;
+        CHECK(file.LoadTiles(tiles));
+        return true;
+    }
+
+} // namespace
+
+TEST_CASE(MappedFileRoundTrip) {
+    TempDir dir;
+    const fs::path p = dir.path / "mapped.bin";
+    {
+        MappedFile f;
+        CHECK(f.Create(p, 10000));
+        CHECK(f.IsOpen());
+        CHECK_EQ(f.Size(), size_t(10000));
+        for (size_t i = 0; i < f.Size(); ++i) f.Data()[i] = static_cast<uint8_t>(i * 7);
+    }   // 析构时关闭映射，内容保留在文件中
+    CHECK_EQ(fs::file_size(p), uintmax_t(10000));
+
+    MappedFile r;
+    CHECK(r.OpenRead(p));
+    CHECK_EQ(r.Size(), size_t(10000));
+    int mismatches = 0;
+    for (size_t i = 0; i < r.Size(); ++i) mismatches += r.Data()[i] != static_cast<uint8_t>(i * 7);
+    CHECK_EQ(mismatches, 0);
+    r.Close();
+    CHECK(!r.IsOpen());
+    CHECK_EQ(r.Size(), size_t(0));
+
+    // 重新创建时截断为新大小
+    MappedFile again;
+    CHECK(again.Create(p, 100));
+    again.Close();
+    CHECK_EQ(fs::file_size(p), uintmax_t(100));
+}
+
+TEST_CASE(MappedFileRejectsMissingAndEmpty) {
+    TempDir dir;
+    MappedFile f;
+    CHECK(!f.OpenRead(dir.path / "missing.bin"));
+    CHECK(!f.IsOpen());
+    CHECK(!f.Create(dir.path / "zero.bin", 0));
+    writeAll(dir.path / "empty.bin", {});
+    CHECK(!f.OpenRead(dir.path / "empty.bin"));
+    CHECK(!f.Create(dir.path / "no_such_dir" / "x.bin", 16));
+    CHECK(!f.IsOpen());
+}
+
+TEST_CASE(FrameFileRoundTrip) {
+    TempDir dir;
+    const fs::path p = dir.path / "last_frame.bin";
+    const TiledImage frame = makeFrame();
+    const ImageBuffer preview = makePreview();
+    FrameFile file;
+    CHECK(file.Save(p, frame, LEFT, TOP, RIGHT, BOTTOM, 1760000000, &preview, 0x0123456789ABCDEFull));
+    CHECK(!file.IsOpen());
+
+    CHECK(file.Open(p));
+    CHECK_EQ(file.Left(), LEFT);
+    CHECK_EQ(file.Top(), TOP);
+    CHECK_EQ(file.Right(), RIGHT);
+    CHECK_EQ(file.Bottom(), BOTTOM);
+    CHECK_EQ(file.CaptureTime(), int64_t(1760000000));
+    TiledImage loaded;
+    CHECK(file.LoadTiles(loaded));
+    CHECK(sameTiles(frame, loaded));
+
+    CHECK(file.HasPreview());
+    CHECK_EQ(file.PreviewWidth(), preview.width);
+    CHECK_EQ(file.PreviewHeight(), preview.height);
+    CHECK_EQ(file.PreviewSettings(), uint64_t(0x0123456789ABCDEFull));
+    CHECK_EQ(reinterpret_cast<uintptr_t>(file.PreviewPixels()) % 64, uintptr_t(0));
+    int mismatches = 0;
+    for (int y = 0; y < preview.height; ++y) {
+        mismatches += std::memcmp(file.PreviewPixels() + static_cast<size_t>(y) * file.PreviewStride(),
+            preview.data.data() + static_cast<size_t>(y) * preview.stride, static_cast<size_t>(preview.width) * 3) != 0;
+    }
+    CHECK_EQ(mismatches, 0);
+
+    // 覆盖写入正在读取的文件之前，Save 会先关闭本对象的映射
+    CHECK(file.Save(p, frame, LEFT, TOP, RIGHT, BOTTOM, 1, nullptr, 0));
+    CHECK(file.Open(p));
+    CHECK(!file.HasPreview());
+    CHECK(file.PreviewPixels() == nullptr);
+    file.Close();
+    CHECK(!file.IsOpen());
+    CHECK(!file.LoadTiles(loaded));
+    CHECK(loaded.Empty());
+}
+
+TEST_CASE(FrameFileSkipsMismatchedPreview) {
+    TempDir dir;
+    const fs::path p = dir.path / "frame.bin";
+    const TiledImage frame = makeFrame();
+    ImageBuffer small = makeImage(PixelFormat::RGB8, 10, 10, 0, 5);
+    ImageBuffer wrongFormat = makePreview();
+    wrongFormat.format = PixelFormat::BGRA8;
+    FrameFile file;
+    for (const ImageBuffer* preview : { &small, &wrongFormat }) {
+        CHECK(file.Save(p, frame, LEFT, TOP, RIGHT, BOTTOM, 0, preview, 7));
+        CHECK(file.Open(p));
+        CHECK(!file.HasPreview());
+        CHECK_EQ(file.PreviewSettings(), uint64_t(0));
+    }
+}
+
+TEST_CASE(FrameFileSaveRejects) {
+    TempDir dir;
+    FrameFile file;
+    TiledImage empty;
+    CHECK(!file.Save(dir.path / "a.bin", empty, 0, 0, 10, 10, 0, nullptr, 0));
+
+    TiledImage compressed = makeFrame();
+    compressed.Compress();
+    CHECK(!file.Save(dir.path / "b.bin", compressed, LEFT, TOP, RIGHT, BOTTOM, 0, nullptr, 0));
+
+    TiledImage many;
+    for (int i = 0; i < 65; ++i) many.AddTile(i, 0, makeImage(PixelFormat::BGRA8, 1, 1, 0, 0), ToneMapParams{});
+    CHECK(!file.Save(dir.path / "c.bin", many, 0, 0, 65, 1, 0, nullptr, 0));
+
+    CHECK(!file.Save(dir.path / "no_such_dir" / "d.bin", makeFrame(), LEFT, TOP, RIGHT, BOTTOM, 0, nullptr, 0));
+    CHECK(!file.IsOpen());
+}
+
+TEST_CASE(FrameFileRejectsTruncation) {
+    TempDir dir;
+    const fs::path p = dir.path / "frame.bin";
+    const ImageBuffer preview = makePreview();
+    FrameFile file;
+    CHECK(file.Save(p, makeFrame(), LEFT, TOP, RIGHT, BOTTOM, 0, &preview, 1));
+    const std::vector<uint8_t> original = readAll(p);
+
+    // 截断到任意长度（含只剩半个文件头）都不能打开
+    int accepted = 0;
+    for (size_t len : { size_t(1), size_t(32), HEADER_BYTES - 1, HEADER_BYTES, HEADER_BYTES + RECORD_BYTES,
+                        original.size() / 2, original.size() - 1 }) {
+        writeAll(p, std::vector<uint8_t>(original.begin(), original.begin() + static_cast<std::ptrdiff_t>(len)));
+        if (file.Open(p)) ++accepted;
+    }
+    // 末尾多出数据同样拒绝（文件头记录了总长度）
+    std::vector<uint8_t> longer = original;
+    longer.push_back(0);
+    writeAll(p, longer);
+    if (file.Open(p)) ++accepted;
+    CHECK_EQ(accepted, 0);
+    CHECK(!file.IsOpen());
+
+    // 文件头最后写入：中途失败留下的全零文件头不被接受
+    std::vector<uint8_t> noHeader = original;
+    std::fill(noHeader.begin(), noHeader.begin() + HEADER_BYTES, uint8_t(0));
+    writeAll(p, noHeader);
+    CHECK(!file.Open(p));
+
+    writeAll(p, original);
+    CHECK(file.Open(p));
+}
+
+TEST_CASE(FrameFileRejectsBadFields) {
+    TempDir dir;
+    const fs::path p = dir.path / "frame.bin";
+    const ImageBuffer preview = makePreview();
+    FrameFile file;
+    CHECK(file.Save(p, makeFrame(), LEFT, TOP, RIGHT, BOTTOM, 0, &preview, 1));
+    const std::vector<uint8_t> original = readAll(p);
+    const fs::path& d = dir.path;
+
+    CHECK(opensAfter(d, original, [](std::vector<uint8_t>&) {}));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, H_MAGIC, 0x46545349); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, H_VERSION, 1); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint64_t>(b, H_FILE_BYTES, b.size() + 64); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, H_TILE_COUNT, 0); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, H_TILE_COUNT, 65); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, H_TILE_COUNT, 0xFFFFFFFFu); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, H_RIGHT, LEFT); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, H_PREVIEW_STRIDE, 3); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint64_t>(b, H_PREVIEW_OFFSET, b.size() - 64); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint64_t>(b, H_PREVIEW_OFFSET, ~uint64_t(0) - 16); }));
+
+    // 块记录：第二块（BGRA8）
+    constexpr size_t rec = HEADER_BYTES + RECORD_BYTES;
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, rec + R_FORMAT, 0); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint32_t>(b, rec + R_FORMAT, 99); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, rec + R_WIDTH, 0); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, rec + R_LEFT, RIGHT - 47); }));  // 超出冻结范围右边界
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, rec + R_LEFT, LEFT - 1); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, rec + R_LEFT, 0x7FFFFFF0); })); // left + width 溢出
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, rec + R_WIDTH, -48); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<int32_t>(b, rec + R_STRIDE, 48 * 4 - 1); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint64_t>(b, rec + R_BYTES, 48 * 4 * 27 + 1); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint64_t>(b, rec + R_OFFSET, b.size() - 100); }));
+    CHECK(!opensAfter(d, original, [](std::vector<uint8_t>& b) { poke<uint64_t>(b, rec + R_OFFSET, ~uint64_t(0) - 8); }));
+}
+
+TEST_CASE(FrameFileSurvivesByteCorruption) {
+    // 文件头与块记录中逐字节翻转：要么被拒绝，要么（数据字段、不影响结构的字段）仍能完整读出，
+    // 读出的块都位于文件范围内（用 AddressSanitizer 构建时越界访问会直接报错）
+    TempDir dir;
+    const fs::path p = dir.path / "frame.bin";
+    const ImageBuffer preview = makePreview();
+    const TiledImage frame = makeFrame();
+    FrameFile file;
+    CHECK(file.Save(p, frame, LEFT, TOP, RIGHT, BOTTOM, 0, &preview, 1));
+    const std::vector<uint8_t> original = readAll(p);
+    const size_t metaBytes = HEADER_BYTES + frame.Tiles().size() * RECORD_BYTES;
+
+    int rejected = 0, accepted = 0, badLoads = 0;
+    for (size_t i = 0; i < metaBytes; ++i) {
+        for (uint8_t flip : { uint8_t(0x01), uint8_t(0x80), uint8_t(0xFF) }) {
+            std::vector<uint8_t> bytes = original;
+            bytes[i] ^= flip;
+            writeAll(p, bytes);
+            if (!file.Open(p)) {
+                ++rejected;
+                continue;
+            }
+            ++accepted;
+            TiledImage loaded;
+            if (!file.LoadTiles(loaded)) ++badLoads;
+            for (const ImageTile& t : loaded.Tiles()) {
+                if (t.image.data.size() != static_cast<size_t>(t.image.stride) * t.image.height ||
+                    t.image.stride < t.image.width * BytesPerPixel(t.image.format)) ++badLoads;
+                if (t.left < file.Left() || t.top < file.Top() ||
+                    static_cast<int64_t>(t.left) + t.image.width > file.Right() ||
+                    static_cast<int64_t>(t.top) + t.image.height > file.Bottom()) ++badLoads;
+            }
+            if (file.HasPreview()) {
+                // 预览最后一行的最后一个字节可读
+                volatile uint8_t last = file.PreviewPixels()[static_cast<size_t>(file.PreviewHeight() - 1) * file.PreviewStride() +
+                    static_cast<size_t>(file.PreviewWidth()) * 3 - 1];
+                (void)last;
+            }
+        }
+    }
+    if (test::Verbose()) std::printf("  %d corruptions rejected, %d accepted\n", rejected, accepted);
+    CHECK(rejected > 0);
+    CHECK_EQ(badLoads, 0);
+}
+
+TEST_MAIN()
\ No newline at end of file
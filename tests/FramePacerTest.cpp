@@ -0,0 +1,202 @@
+#include "TestUtil.hpp"
+#include "ui/FramePacer.hpp"
+#include <cstdint>
+
+// 帧节奏 / 输入合并 / 渐变动画：用虚拟垂直同步时钟驱动，不依赖真实计时与窗口
+using namespace screenshot_tool;
+
+namespace {
+
+    // 虚拟垂直同步时钟：按给定刷新率产生帧时间戳（微秒），可注入掉帧
+    class VirtualVsync {
+    public:
+        explicit VirtualVsync(double hz) : periodUs_(1e6 / hz) {}
+
+        int64_t Next(int skipped = 0) {
+            frame_ += 1 + skipped;
+            return static_cast<int64_t>(frame_ * periodUs_ + 0.5);
+        }
+        int64_t Now() const { return static_cast<int64_t>(frame_ * periodUs_ + 0.5); }
+
+    private:
+        double periodUs_;
+        int64_t frame_ = 0;
+    };
+
+    // 模拟 Overlay 帧循环：两帧之间到达若干鼠标事件，每帧合并后取最新位置
+    struct OverlayLoop {
+        InputCoalescer input;
+        FramePacer pacer;
+        int lastX = -1;
+        int lastY = -1;
+        int framesWithInput = 0;
+
+        void Frame(int64_t nowUs) {
+            int x = 0, y = 0, merged = 0;
+            if (input.Take(x, y, merged)) {
+                lastX = x;
+                lastY = y;
+                ++framesWithInput;
+                pacer.AddCoalescedInputs(merged);
+            }
+            pacer.OnFrame(nowUs);
+        }
+    };
+
+} // namespace
+
+TEST_CASE(StatsAtSteadyRefreshRate) {
+    for (double hz : { 60.0, 144.0, 240.0 }) {
+        VirtualVsync clock(hz);
+        FramePacer pacer;
+        pacer.OnFrame(clock.Now());
+        for (int i = 0; i < 600; ++i) pacer.OnFrame(clock.Next());
+
+        const FrameStats s = pacer.Stats();
+        CHECK_EQ(s.frames, 600);
+        CHECK_NEAR(s.refreshHz, hz, hz * 0.002);
+        CHECK_NEAR(s.medianIntervalMs, 1000.0 / hz, 0.001);
+        CHECK_NEAR(s.avgIntervalMs, 1000.0 / hz, 0.001);
+        CHECK_EQ(s.lateFrames, 0);
+    }
+}
+
+TEST_CASE(DroppedFramesCountAsLate) {
+    VirtualVsync clock(60.0);
+    FramePacer pacer;
+    pacer.OnFrame(clock.Now());
+    for (int i = 0; i < 100; ++i) {
+        // 每 25 帧错过一次垂直同步（间隔变为 2 个周期）
+        pacer.OnFrame(clock.Next(i % 25 == 24 ? 1 : 0));
+    }
+
+    const FrameStats s = pacer.Stats();
+    CHECK_EQ(s.frames, 100);
+    CHECK_EQ(s.lateFrames, 4);
+    CHECK_NEAR(s.maxIntervalMs, 2000.0 / 60.0, 0.001);
+    CHECK_NEAR(s.refreshHz, 60.0, 0.1);
+}
+
+TEST_CASE(SuspendSkipsIdleGap) {
+    VirtualVsync clock(60.0);
+    FramePacer pacer;
+    pacer.OnFrame(clock.Now());
+    for (int i = 0; i < 10; ++i) pacer.OnFrame(clock.Next());
+
+    // 帧循环空闲 1 秒后恢复，空闲期不计入间隔
+    pacer.Suspend();
+    pacer.OnFrame(clock.Next(60));
+    for (int i = 0; i < 10; ++i) pacer.OnFrame(clock.Next());
+
+    const FrameStats s = pacer.Stats();
+    CHECK_EQ(s.frames, 20);
+    CHECK_EQ(s.lateFrames, 0);
+    CHECK_NEAR(s.maxIntervalMs, 1000.0 / 60.0, 0.001);
+
+    pacer.Reset();
+    CHECK_EQ(pacer.Stats().frames, 0);
+    CHECK_EQ(pacer.Stats().coalescedInputs, 0);
+}
+
+TEST_CASE(InputCoalescedPerFrame) {
+    InputCoalescer input;
+    int x = 0, y = 0, merged = -1;
+    CHECK(!input.HasPending());
+    CHECK(!input.Take(x, y, merged));
+    CHECK_EQ(merged, 0);
+
+    for (int i = 1; i <= 5; ++i) input.Push(i * 10, i * 20);
+    CHECK(input.HasPending());
+    CHECK(input.Take(x, y, merged));
+    CHECK_EQ(x, 50);
+    CHECK_EQ(y, 100);
+    CHECK_EQ(merged, 4);
+    CHECK(!input.Take(x, y, merged));
+
+    input.Push(1, 2);
+    input.Clear();
+    CHECK(!input.HasPending());
+}
+
+TEST_CASE(HighRateMouseOnVsyncLoop) {
+    // 1000 Hz 鼠标、60 Hz 刷新：每帧只处理最新位置，其余事件计为合并而不是丢弃
+    VirtualVsync clock(60.0);
+    OverlayLoop loop;
+    loop.pacer.OnFrame(clock.Now());
+
+    int events = 0;
+    int64_t mouseUs = 0;
+    for (int frame = 0; frame < 120; ++frame) {
+        const int64_t frameUs = clock.Next();
+        for (; mouseUs < frameUs; mouseUs += 1000) {
+            loop.input.Push(static_cast<int>(mouseUs / 1000), 7);
+            ++events;
+        }
+        loop.Frame(frameUs);
+        CHECK_EQ(loop.lastX, static_cast<int>((mouseUs - 1000) / 1000));
+    }
+
+    const FrameStats s = loop.pacer.Stats();
+    CHECK_EQ(loop.framesWithInput, 120);
+    CHECK_EQ(s.coalescedInputs, events - 120);
+    CHECK_EQ(s.frames, 120);
+}
+
+TEST_CASE(FadeMatchesLegacySpeed) {
+    // 旧实现每 15ms 变化 16：完整淡入 0 -> 255 约 239ms
+    FadeAnimation fade;
+    fade.Start(0, 0, 255);
+    CHECK(fade.Active());
+    CHECK_EQ(fade.Target(), 255);
+    CHECK_EQ(fade.Sample(0), 0);
+    CHECK_EQ(fade.Sample(15000), 16);
+    CHECK(fade.Active());
+
+    const int64_t durationUs = static_cast<int64_t>(255.0f / FadeAnimation::ALPHA_PER_SECOND * 1e6f);
+    CHECK_NEAR(static_cast<double>(durationUs), 239062.0, 2.0);
+    fade.Sample(durationUs - 1);
+    CHECK(fade.Active());
+    CHECK_EQ(fade.Sample(durationUs), 255);
+    CHECK(!fade.Active());
+    CHECK_EQ(fade.Sample(durationUs + 100000), 255);
+}
+
+TEST_CASE(FadeIndependentOfRefreshRate) {
+    // 同一时刻的透明度与采样频率无关，且单调推进
+    for (double hz : { 30.0, 60.0, 144.0, 360.0 }) {
+        VirtualVsync clock(hz);
+        FadeAnimation fade;
+        fade.Start(clock.Now(), 200, 0);
+        int previous = 200;
+        int frames = 0;
+        while (fade.Active()) {
+            const int64_t now = clock.Next();
+            const int alpha = fade.Sample(now);
+            CHECK(alpha <= previous);
+            const double expected = 200.0 - FadeAnimation::ALPHA_PER_SECOND * now / 1e6;
+            if (fade.Active()) CHECK_NEAR(alpha, expected, 0.5 + 1e-3);
+            previous = alpha;
+            ++frames;
+        }
+        CHECK_EQ(previous, 0);
+        // 约 187.5ms：帧数随刷新率变化，但结束时间一致
+        CHECK_NEAR(frames, 0.1875 * hz, 1.0);
+    }
+}
+
+TEST_CASE(FadeEdgeCases) {
+    FadeAnimation fade;
+    fade.Start(1000, 128, 128);
+    CHECK(!fade.Active());
+    CHECK_EQ(fade.Sample(1000), 128);
+
+    // 时钟回退（采样早于开始时间）时停留在起点
+    fade.Start(50000, 0, 255);
+    CHECK_EQ(fade.Sample(10000), 0);
+
+    fade.Stop();
+    CHECK(!fade.Active());
+    CHECK_EQ(fade.Sample(60000), 255);
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "TestUtil.hpp"
+#include "image/ColorSpace.hpp"
+#include "image/HalfFloat.hpp"
+#include "image/PixelConvert.hpp"
+#include "image/ToneMapping.hpp"
+#include <random>
+#include <vector>
+
+// 色域映射的参考值：三种方式的单像素结果、平面批量版本与标量版本一致，
+// 以及经完整 ToSRGB8 后解析路径与 3D LUT 路径对同一色域外颜色给出相同结果
+using namespace screenshot_tool;
+
+namespace {
+
+    const GamutMapping MAPPINGS[] = { GamutMapping::Preserve, GamutMapping::ACES, GamutMapping::Clip };
+    const char* const MAPPING_NAMES[] = { "preserve", "aces", "clip" };
+
+    double luma(double r, double g, double b) { return 0.2126 * r + 0.7152 * g + 0.0722 * b; }
+
+    // ACES 1.3 参考色域压缩（双精度，直接按规范公式实现）
+    void acesReference(double& r, double& g, double& b) {
+        const double threshold[3] = { 0.815, 0.803, 0.880 };
+        const double limit[3] = { 1.147, 1.264, 1.312 };
+        const double power = 1.2;
+        double* ch[3] = { &r, &g, &b };
+        const double ach = std::max({ r, g, b });
+        for (int c = 0; c < 3; ++c) {
+            const double t = threshold[c], l = limit[c];
+            const double scale = (l - t) / std::pow(std::pow((1.0 - t) / (l - t), -power) - 1.0, 1.0 / power);
+            const double dist = (ach - *ch[c]) / ach;
+            double compressed = dist;
+            if (dist >= t) {
+                const double d = (dist - t) / scale;
+                compressed = t + scale * d / std::pow(1.0 + std::pow(d, power), 1.0 / power);
+            }
+            *ch[c] = std::max(ach - compressed * ach, 0.0);
+        }
+    }
+
+    // 单色 w x 1 的 HDR10 图：Rec.2020 线性 nits -> PQ 码值
+    ImageBuffer solidHDR10(const float nits[3], int width) {
+        ImageBuffer buf;
+        buf.format = PixelFormat::RGBA10A2;
+        buf.width = width;
+        buf.height = 1;
+        buf.stride = width * 4;
+        buf.data.resize(buf.stride);
+        uint32_t code[3];
+        for (int c = 0; c < 3; ++c) code[c] = static_cast<uint32_t>(std::lround(LinearToPQ(nits[c]) * 1023.0f));
+        const uint32_t pixel = (3u << 30) | (code[0] << 20) | (code[1] << 10) | code[2];
+        for (int x = 0; x < width; ++x) std::memcpy(&buf.data[x * 4], &pixel, 4);
+        return buf;
+    }
+
+    // 同一颜色的 scRGB FP16 版本（Rec.709 原色，色域外分量为负）
+    ImageBuffer solidFP16(const float nits[3], int width) {
+        float rgb[3] = { nits[0], nits[1], nits[2] };
+        ColorSpace::ConvertGamutN(ColorGamut::Rec2020, ColorGamut::Rec709, rgb, 1);
+        ImageBuffer buf;
+        buf.format = PixelFormat::RGBA_F16;
+        buf.width = width;
+        buf.height = 1;
+        buf.stride = width * 8;
+        buf.data.resize(buf.stride);
+        const uint16_t half[4] = { FloatToHalf(rgb[0] / 80.0f), FloatToHalf(rgb[1] / 80.0f), FloatToHalf(rgb[2] / 80.0f), FloatToHalf(1.0f) };
+        for (int x = 0; x < width; ++x) std::memcpy(&buf.data[x * 8], half, 8);
+        return buf;
+    }
+
+    struct RGB8 {
+        int r, g, b;
+    };
+
+    RGB8 convert(const ImageBuffer& source, const char* mapping, int lutSize) {
+        Config config;
+        config.toneMapper = "bt2390";
+        config.gamutMapping = mapping;
+        config.colorLutSize = lutSize;
+        config.dither = false;
+        ToneMapParams params;
+        params.hdr = true;
+        params.maxNits = 1000.0f;
+        ImageBuffer buf = source;
+        CHECK(PixelConvert::ToSRGB8(source.format, buf, ToneMapRegions::Uniform(params, buf.width, buf.height), &config));
+        return { buf.data[0], buf.data[1], buf.data[2] };
+    }
+
+} // namespace
+
+TEST_CASE(InGamutColorsUnchanged) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(0.0f, 4.0f);
+    for (int i = 0; i < 1000; ++i) {
+        const float in[3] = { u(rng), u(rng), u(rng) };
+        for (GamutMapping m : { GamutMapping::Preserve, GamutMapping::Clip }) {
+            float r = in[0], g = in[1], b = in[2];
+            ColorSpace::MapGamut(r, g, b, m);
+            CHECK(r == in[0] && g == in[1] && b == in[2]);
+        }
+    }
+    // ACES 在保护区内（到灰轴的距离小于阈值）同样不变
+    float r = 0.5f, g = 0.4f, b = 0.3f;
+    ColorSpace::MapGamut(r, g, b, GamutMapping::ACES);
+    CHECK(r == 0.5f && g == 0.4f && b == 0.3f);
+}
+
+TEST_CASE(PreserveKeepsLuminanceAndHue) {
+    const float cases[][3] = { { 1.2f, -0.1f, 0.3f }, { -0.5876f, 1.1329f, -0.1006f }, { 0.05f, 0.2f, -0.8f }, { 3.0f, -0.4f, -0.2f } };
+    for (const auto& in : cases) {
+        float r = in[0], g = in[1], b = in[2];
+        ColorSpace::MapGamut(r, g, b, GamutMapping::Preserve);
+        const double y = luma(in[0], in[1], in[2]);
+        CHECK_EQ(std::min({ r, g, b }), 0.0f);
+        CHECK_NEAR(luma(r, g, b), y, 1e-5 * std::max(1.0, y));
+        // 沿灰轴方向收缩：三个通道到亮度的距离按同一比例缩小
+        const double t = (r - y) / (in[0] - y);
+        CHECK(t > 0.0 && t < 1.0);
+        CHECK_NEAR((g - y) / (in[1] - y), t, 1e-4);
+        CHECK_NEAR((b - y) / (in[2] - y), t, 1e-4);
+    }
+    // 亮度不为正时整体归零
+    float r = -1.0f, g = 0.1f, b = 0.1f;
+    ColorSpace::MapGamut(r, g, b, GamutMapping::Preserve);
+    CHECK(r == 0.0f && g == 0.0f && b == 0.0f);
+}
+
+TEST_CASE(ClipReferenceValues) {
+    float r = 1.2f, g = -0.1f, b = 0.3f;
+    ColorSpace::MapGamut(r, g, b, GamutMapping::Clip);
+    CHECK(r == 1.2f && g == 0.0f && b == 0.3f);
+    r = -0.5876f, g = 1.1329f, b = -0.1006f;
+    ColorSpace::MapGamut(r, g, b, GamutMapping::Clip);
+    CHECK(r == 0.0f && g == 1.1329f && b == 0.0f);
+}
+
+TEST_CASE(ACESReferenceValues) {
+    const float cases[][3] = {
+        { 1.2f, -0.1f, 0.3f }, { -0.5876f, 1.1329f, -0.1006f }, { 0.05f, 0.2f, -0.8f },
+        { 1.0f, 0.1f, 0.15f }, { 0.9f, 0.95f, 1.0f }, { 10.0f, -2.0f, 0.5f },
+    };
+    for (const auto& in : cases) {
+        float r = in[0], g = in[1], b = in[2];
+        ColorSpace::MapGamut(r, g, b, GamutMapping::ACES);
+        double rr = in[0], rg = in[1], rb = in[2];
+        acesReference(rr, rg, rb);
+        const double tol = 1e-5 * std::max({ 1.0, rr, rg, rb });
+        CHECK_NEAR(r, rr, tol);
+        CHECK_NEAR(g, rg, tol);
+        CHECK_NEAR(b, rb, tol);
+    }
+    // 距离等于上限的分量恰好压到色域边界（0）；阈值处开始压缩，压缩后仍单调
+    const float limit[3] = { 1.147f, 1.264f, 1.312f };
+    for (int c = 0; c < 3; ++c) {
+        float v[3] = { 1.0f, 1.0f, 1.0f };
+        v[c] = 1.0f - limit[c];
+        ColorSpace::MapGamut(v[0], v[1], v[2], GamutMapping::ACES);
+        CHECK_NEAR(v[c], 0.0, 1e-5);
+        CHECK(v[(c + 1) % 3] == 1.0f);
+    }
+    // 饱和但在色域内的颜色也会轻微收缩（与 Preserve 的区别）
+    float r = 1.0f, g = 0.02f, b = 0.05f;
+    ColorSpace::MapGamut(r, g, b, GamutMapping::ACES);
+    CHECK(r == 1.0f);
+    CHECK(g > 0.02f && b > 0.05f);
+}
+
+TEST_CASE(PlanarMatchesScalar) {
+    // 1003 个像素：覆盖 SIMD 主循环与标量尾部；分量范围包含色域外、全负与高亮
+    constexpr int count = 1003;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(-1.5f, 6.0f);
+    std::vector<float> r(count), g(count), b(count);
+    for (int i = 0; i < count; ++i) {
+        r[i] = u(rng);
+        g[i] = u(rng);
+        b[i] = u(rng);
+    }
+    r[0] = g[0] = b[0] = -0.25f;
+    for (int m = 0; m < 3; ++m) {
+        std::vector<float> pr = r, pg = g, pb = b;
+        ColorSpace::MapGamutPlanar(pr.data(), pg.data(), pb.data(), count, MAPPINGS[m]);
+        int mismatches = 0;
+        for (int i = 0; i < count; ++i) {
+            float sr = r[i], sg = g[i], sb = b[i];
+            ColorSpace::MapGamut(sr, sg, sb, MAPPINGS[m]);
+            const float tol = 1e-4f * std::max({ 1.0f, sr, sg, sb });
+            mismatches += std::fabs(pr[i] - sr) > tol || std::fabs(pg[i] - sg) > tol || std::fabs(pb[i] - sb) > tol;
+        }
+        if (mismatches) std::printf("  %s: %d planar/scalar mismatches\n", MAPPING_NAMES[m], mismatches);
+        CHECK_EQ(mismatches, 0);
+    }
+}
+
+TEST_CASE(ToSRGB8LUTAndAnalyticAgree) {
+    // Rec.2020 饱和绿、红与蓝（转到 709 后有负分量），分别以 HDR10 与 scRGB 输入
+    const float colors[][3] = { { 0.0f, 400.0f, 0.0f }, { 600.0f, 10.0f, 40.0f }, { 20.0f, 30.0f, 400.0f } };
+    for (const auto& nits : colors) {
+        for (int f = 0; f < 2; ++f) {
+            const ImageBuffer source = f == 0 ? solidHDR10(nits, 16) : solidFP16(nits, 16);
+            RGB8 results[3];
+            for (int m = 0; m < 3; ++m) {
+                const RGB8 analytic = convert(source, MAPPING_NAMES[m], 0);
+                const RGB8 lut = convert(source, MAPPING_NAMES[m], 33);
+                if (test::Verbose()) {
+                    std::printf("  %s (%g, %g, %g) %-8s analytic %3d %3d %3d  lut %3d %3d %3d\n", f == 0 ? "HDR10" : "scRGB",
+                        nits[0], nits[1], nits[2], MAPPING_NAMES[m], analytic.r, analytic.g, analytic.b, lut.r, lut.g, lut.b);
+                }
+                CHECK(std::abs(analytic.r - lut.r) <= 1 && std::abs(analytic.g - lut.g) <= 1 && std::abs(analytic.b - lut.b) <= 1);
+                results[m] = analytic;
+            }
+            // 三种映射对色域外颜色给出不同结果
+            auto same = [](const RGB8& a, const RGB8& b) { return a.r == b.r && a.g == b.g && a.b == b.b; };
+            CHECK(!same(results[0], results[1]));
+            CHECK(!same(results[0], results[2]));
+            CHECK(!same(results[1], results[2]));
+        }
+    }
+    // 纯 Rec.2020 绿（400 nits，BT.2390，峰值 1000 nits）的参考输出：Clip 只保留绿色通道，
+    // Preserve 沿等亮度线向灰轴收缩（蓝通道明显抬高），ACES 介于两者之间。两条路径都允许 ±1
+    const float green[3] = { 0.0f, 400.0f, 0.0f };
+    const RGB8 expected[3] = { { 0, 242, 155 }, { 0, 249, 51 }, { 0, 249, 0 } };
+    for (int m = 0; m < 3; ++m) {
+        for (int lutSize : { 0, 33 }) {
+            const RGB8 out = convert(solidHDR10(green, 16), MAPPING_NAMES[m], lutSize);
+            CHECK(std::abs(out.r - expected[m].r) <= 1 && std::abs(out.g - expected[m].g) <= 1 && std::abs(out.b - expected[m].b) <= 1);
+        }
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/PixelConvert.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// 金图回归：128x72 合成画面经 ToSRGB8（各采集格式，默认配置）与 ConvertToRGB8 的输出，
+// 与 tests/golden 下的二进制 PPM 比较 PSNR 与 CIE ΔE*ab。阈值容许不同编译器 / SIMD 路径的微小差异，
+// 色调曲线、色域或量化的实际改动会超限。
+// 有意改变输出时，设置环境变量 SCREENSHOT_REGENERATE_GOLDEN=1 运行一次以重写金图，并检查差异后提交
+using namespace screenshot_tool;
+
+namespace {
+
+    constexpr int WIDTH = 128;
+    constexpr int HEIGHT = 72;
+
+    struct Thresholds {
+        double minPSNR;         // dB
+        double maxMeanDeltaE;
+        double maxDeltaE;
+    };
+    constexpr Thresholds EXACT = { 50.0, 0.2, 2.0 };
+    constexpr Thresholds LUT = { 42.0, 0.5, 3.0 };     // 3D LUT 路径与解析金图比较
+
+    std::string goldenPath(const char* name) { return std::string(SCREENSHOT_GOLDEN_DIR) + "/" + name + ".ppm"; }
+
+    bool regenerate() {
+        const char* v = std::getenv("SCREENSHOT_REGENERATE_GOLDEN");
+        return v && *v && std::strcmp(v, "0") != 0;
+    }
+
+    bool writePPM(const std::string& path, const ImageBuffer& img) {
+        std::ofstream file(path, std::ios::binary);
+        file << "P6\n" << img.width << " " << img.height << "\n255\n";
+        for (int y = 0; y < img.height; ++y) {
+            file.write(reinterpret_cast<const char*>(img.data.data() + static_cast<size_t>(y) * img.stride), img.width * 3);
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool readPPM(const std::string& path, ImageBuffer& img) {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        int maxValue = 0;
+        if (!(file >> magic >> img.width >> img.height >> maxValue) || magic != "P6" || maxValue != 255) return false;
+        file.get();
+        img.format = PixelFormat::RGB8;
+        img.stride = img.width * 3;
+        img.data.resize(static_cast<size_t>(img.stride) * img.height);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(img.data.data()), static_cast<std::streamsize>(img.data.size())));
+    }
+
+    // sRGB 8bit -> CIELAB（D65）
+    void toLab(const uint8_t* rgb, double lab[3]) {
+        double lin[3];
+        for (int c = 0; c < 3; ++c) {
+            const double v = rgb[c] / 255.0;
+            lin[c] = v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+        }
+        const double xyz[3] = {
+            (0.4124564 * lin[0] + 0.3575761 * lin[1] + 0.1804375 * lin[2]) / 0.95047,
+            0.2126729 * lin[0] + 0.7151522 * lin[1] + 0.0721750 * lin[2],
+            (0.0193339 * lin[0] + 0.1191920 * lin[1] + 0.9503041 * lin[2]) / 1.08883,
+        };
+        double f[3];
+        for (int c = 0; c < 3; ++c) f[c] = xyz[c] > 216.0 / 24389.0 ? std::cbrt(xyz[c]) : (24389.0 / 27.0 * xyz[c] + 16.0) / 116.0;
+        lab[0] = 116.0 * f[1] - 16.0;
+        lab[1] = 500.0 * (f[0] - f[1]);
+        lab[2] = 200.0 * (f[1] - f[2]);
+    }
+
+    void compareWithGolden(const char* name, const ImageBuffer& actual, const Thresholds& limits, bool allowRegenerate = true) {
+        CHECK(actual.format == PixelFormat::RGB8);
+        const std::string path = goldenPath(name);
+        if (allowRegenerate && regenerate()) {
+            CHECK(writePPM(path, actual));
+            std::printf("  wrote %s\n", path.c_str());
+            return;
+        }
+        ImageBuffer golden;
+        if (!readPPM(path, golden)) {
+            test::Fail(__FILE__, __LINE__, "cannot read golden image " + path);
+            return;
+        }
+        CHECK_EQ(golden.width, actual.width);
+        CHECK_EQ(golden.height, actual.height);
+        if (golden.width != actual.width || golden.height != actual.height) return;
+
+        double squared = 0.0, sumDeltaE = 0.0, maxDeltaE = 0.0;
+        for (int y = 0; y < actual.height; ++y) {
+            const uint8_t* a = actual.data.data() + static_cast<size_t>(y) * actual.stride;
+            const uint8_t* g = golden.data.data() + static_cast<size_t>(y) * golden.stride;
+            for (int x = 0; x < actual.width; ++x) {
+                for (int c = 0; c < 3; ++c) {
+                    const double d = a[x * 3 + c] - g[x * 3 + c];
+                    squared += d * d;
+                }
+                double la[3], lg[3];
+                toLab(a + x * 3, la);
+                toLab(g + x * 3, lg);
+                const double deltaE = std::sqrt((la[0] - lg[0]) * (la[0] - lg[0]) + (la[1] - lg[1]) * (la[1] - lg[1]) + (la[2] - lg[2]) * (la[2] - lg[2]));
+                sumDeltaE += deltaE;
+                maxDeltaE = std::max(maxDeltaE, deltaE);
+            }
+        }
+        const double samples = static_cast<double>(actual.width) * actual.height;
+        const double mse = squared / (samples * 3.0);
+        const double psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : 99.0;
+        const double meanDeltaE = sumDeltaE / samples;
+        const bool ok = psnr >= limits.minPSNR && meanDeltaE <= limits.maxMeanDeltaE && maxDeltaE <= limits.maxDeltaE;
+        if (!ok || test::Verbose()) {
+            std::printf("  %-24s PSNR %5.1f dB, mean dE %.3f, max dE %.2f\n", name, psnr, meanDeltaE, maxDeltaE);
+        }
+        CHECK(psnr >= limits.minPSNR);
+        CHECK(meanDeltaE <= limits.maxMeanDeltaE);
+        CHECK(maxDeltaE <= limits.maxDeltaE);
+    }
+
+    struct Format {
+        const char* golden;
+        PixelFormat format;
+    };
+    const Format HDR_FORMATS[] = {
+        { "fp16", PixelFormat::RGBA_F16 },
+        { "hdr10", PixelFormat::RGBA10A2 },
+        { "rgb9e5", PixelFormat::RGB9E5 },
+    };
+
+    ToneMapParams hdrParams() {
+        ToneMapParams params;
+        params.hdr = true;
+        params.maxNits = 1000.0f;
+        return params;
+    }
+
+} // namespace
+
+TEST_CASE(ToSRGB8MatchesGolden) {
+    const test::SceneNits scene = test::MakeScene(WIDTH, HEIGHT);
+    Config analytic;
+    analytic.colorLutSize = 0;
+    Config lut;
+    lut.colorLutSize = 33;
+    const auto regions = ToneMapRegions::Uniform(hdrParams(), WIDTH, HEIGHT);
+    for (const auto& f : HDR_FORMATS) {
+        const std::string name = std::string("tosrgb8_") + f.golden;
+        ImageBuffer buf = test::EncodeScene(scene, f.format);
+        CHECK(PixelConvert::ToSRGB8(f.format, buf, regions, &analytic));
+        compareWithGolden(name.c_str(), buf, EXACT);
+
+        buf = test::EncodeScene(scene, f.format);
+        CHECK(PixelConvert::ToSRGB8(f.format, buf, regions, &lut));
+        compareWithGolden(name.c_str(), buf, LUT, false);
+    }
+
+    ImageBuffer desktop = test::EncodeSceneSDR(scene);
+    CHECK(PixelConvert::ToSRGB8(PixelFormat::BGRA8, desktop, false, &analytic));
+    compareWithGolden("tosrgb8_bgra8", desktop, EXACT);
+}
+
+TEST_CASE(ConvertToRGB8MatchesGolden) {
+    const test::SceneNits scene = test::MakeScene(WIDTH, HEIGHT);
+    for (const auto& f : HDR_FORMATS) {
+        ImageBuffer out;
+        CHECK(PixelConvert::ConvertToRGB8(test::EncodeScene(scene, f.format), out));
+        compareWithGolden((std::string("convert_") + f.golden).c_str(), out, EXACT);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "TestUtil.hpp"
+#include "image/HalfFloat.hpp"
+#include "image/ToneMapping.hpp"
+#include <vector>
+
+// FP16 批量解码：全部 65536 个位模式与逐个转换的 HalfToFloat 逐位比较，
+// 以及 FloatToHalf 的往返与舍入
+using namespace screenshot_tool;
+
+namespace {
+
+    uint32_t bitsOf(float f) {
+        uint32_t bits;
+        std::memcpy(&bits, &f, sizeof(bits));
+        return bits;
+    }
+
+    int countMismatches(const uint16_t* src, const float* dst, int count) {
+        int mismatches = 0;
+        for (int i = 0; i < count; ++i) {
+            if (bitsOf(dst[i]) != bitsOf(HalfToFloat(src[i]))) {
+                if (mismatches < 8) {
+                    std::printf("  0x%04X: 0x%08X, expected 0x%08X\n", src[i], bitsOf(dst[i]), bitsOf(HalfToFloat(src[i])));
+                }
+                ++mismatches;
+            }
+        }
+        return mismatches;
+    }
+
+} // namespace
+
+TEST_CASE(AllHalfValuesBitExact) {
+    std::printf("  kernel: %s\n", HalfToFloatUsesF16C() ? "F16C" : "table");
+    std::vector<uint16_t> all(65536);
+    for (int i = 0; i < 65536; ++i) all[i] = static_cast<uint16_t>(i);
+    std::vector<float> out(65536);
+    HalfToFloatN(all.data(), out.data(), 65536);
+    CHECK_EQ(countMismatches(all.data(), out.data(), 65536), 0);
+}
+
+TEST_CASE(UnalignedAndShortBatches) {
+    // 起点与长度不对齐 8 的批次（向量主循环 + 尾部），逆序排列使相邻值的指数各不相同
+    std::vector<uint16_t> all(65536 + 16);
+    for (int i = 0; i < 65536; ++i) all[i + 3] = static_cast<uint16_t>(65535 - i);
+    std::vector<float> out(all.size());
+    for (int count : { 1, 7, 8, 9, 15, 17, 1023 }) {
+        int mismatches = 0;
+        for (int start = 3; start + count <= 65536 + 3; start += count) {
+            HalfToFloatN(all.data() + start, out.data() + start, count);
+            mismatches += countMismatches(all.data() + start, out.data() + start, count);
+        }
+        CHECK_EQ(mismatches, 0);
+    }
+    // count <= 0 不写入
+    out[0] = 42.0f;
+    HalfToFloatN(all.data(), out.data(), 0);
+    HalfToFloatN(all.data(), out.data(), -5);
+    CHECK_EQ(out[0], 42.0f);
+}
+
+TEST_CASE(SignalingNaNPayloadKept) {
+    // 一组 8 个里混入 signaling NaN：F16C 会改成 quiet NaN，批量版本必须保留原载荷
+    const uint16_t src[16] = { 0x3C00, 0x7C01, 0x0001, 0xFC01, 0x7DFF, 0x7E00, 0x8000, 0x7C00,
+                               0x3555, 0x7D00, 0xC000, 0x0400, 0x03FF, 0xFDFF, 0x7BFF, 0xFBFF };
+    float out[16];
+    HalfToFloatN(src, out, 16);
+    CHECK_EQ(countMismatches(src, out, 16), 0);
+    CHECK_EQ(bitsOf(out[1]), 0x7F802000u);
+    CHECK_EQ(bitsOf(out[3]), 0xFF802000u);
+}
+
+TEST_CASE(FloatToHalfRoundTrip) {
+    // 所有非 NaN 的 FP16 值经 FP32 往返不变
+    int mismatches = 0;
+    for (int i = 0; i < 65536; ++i) {
+        const uint16_t h = static_cast<uint16_t>(i);
+        if ((h & 0x7C00) == 0x7C00 && (h & 0x3FF)) continue;
+        mismatches += FloatToHalf(HalfToFloat(h)) != h;
+    }
+    CHECK_EQ(mismatches, 0);
+    // NaN 仍为 NaN（载荷高位保留并置为 quiet）
+    CHECK_EQ(FloatToHalf(HalfToFloat(0x7C01)) & 0x7E00, 0x7E00);
+
+    // 就近舍入到偶数，溢出为 Inf，下溢到非规格化数与零
+    CHECK_EQ(FloatToHalf(1.0f + 1.0f / 2048.0f), 0x3C00);              // 恰在中点，舍向偶数
+    CHECK_EQ(FloatToHalf(1.0f + 3.0f / 2048.0f), 0x3C02);
+    CHECK_EQ(FloatToHalf(65504.0f), 0x7BFF);
+    CHECK_EQ(FloatToHalf(65519.0f), 0x7BFF);
+    CHECK_EQ(FloatToHalf(65520.0f), 0x7C00);
+    CHECK_EQ(FloatToHalf(-1e6f), 0xFC00);
+    CHECK_EQ(FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+    CHECK_EQ(FloatToHalf(std::ldexp(1.0f, -25)), 0x0000);               // 中点舍向偶数 0
+    CHECK_EQ(FloatToHalf(std::ldexp(1.5f, -25)), 0x0001);
+    CHECK_EQ(FloatToHalf(-std::ldexp(1.0f, -30)), 0x8000);
+    CHECK_EQ(FloatToHalf(std::ldexp(1023.5f, -24)), 0x0400);             // 非规格化数进位到最小规格化数
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "util/LZCodec.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// 冻结帧的 LZ 压缩：各类输入（随机、全零、重复周期、短输入、合成 HDR 画面）往返一致且不超过 LZCompressBound；
+// 输出空间不足时失败；截断、长度不符与各种结构性损坏都被拒绝，任意单比特翻转都不会写出 rawSize 之外
+using namespace screenshot_tool;
+
+namespace {
+
+    constexpr size_t kCanary = 64;
+    constexpr uint8_t kCanaryByte = 0xA5;
+
+    std::vector<uint8_t> randomBytes(size_t n, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> v(n);
+        for (auto& b : v) b = static_cast<uint8_t>(rng());
+        return v;
+    }
+
+    // 周期为 period 的重复：覆盖回溯复制与输出重叠的各种偏移
+    std::vector<uint8_t> periodic(size_t n, size_t period, uint32_t seed) {
+        const auto unit = randomBytes(period, seed);
+        std::vector<uint8_t> v(n);
+        for (size_t i = 0; i < n; ++i) v[i] = unit[i % period];
+        return v;
+    }
+
+    std::vector<uint8_t> compress(const std::vector<uint8_t>& raw) {
+        std::vector<uint8_t> out(LZCompressBound(raw.size()));
+        const size_t n = LZCompress(raw.data(), raw.size(), out.data(), out.size());
+        out.resize(n);
+        return out;
+    }
+
+    // 解压到带哨兵的缓冲区：返回解压结果，并检查 rawSize 之外没有被写入
+    bool decompress(const std::vector<uint8_t>& packed, size_t rawSize, std::vector<uint8_t>& out, bool& overrun) {
+        std::vector<uint8_t> buf(rawSize + kCanary, kCanaryByte);
+        const bool ok = LZDecompress(packed.data(), packed.size(), buf.data(), rawSize);
+        overrun = false;
+        for (size_t i = rawSize; i < buf.size(); ++i) overrun |= buf[i] != kCanaryByte;
+        buf.resize(rawSize);
+        out = std::move(buf);
+        return ok;
+    }
+
+    bool roundTrip(const std::vector<uint8_t>& raw, size_t* packedSize = nullptr) {
+        const auto packed = compress(raw);
+        if (packedSize) *packedSize = packed.size();
+        if (packed.empty() || packed.size() > LZCompressBound(raw.size())) return false;
+        std::vector<uint8_t> out;
+        bool overrun = false;
+        return decompress(packed, raw.size(), out, overrun) && !overrun && out == raw;
+    }
+
+} // namespace
+
+TEST_CASE(ShortInputsRoundTrip) {
+    // 0 ~ 64 字节：覆盖只有字面量、刚够开始匹配（MATCH_SAFE）附近的各个长度
+    for (size_t n = 0; n <= 64; ++n) {
+        CHECK(roundTrip(randomBytes(n, static_cast<uint32_t>(n))));
+        CHECK(roundTrip(std::vector<uint8_t>(n, 0)));
+        CHECK(roundTrip(periodic(n, 3, static_cast<uint32_t>(n))));
+    }
+}
+
+TEST_CASE(RandomInputStaysWithinBound) {
+    for (size_t n : { size_t(255), size_t(4096), size_t(65536 + 17), size_t(1) << 20 }) {
+        size_t packed = 0;
+        CHECK(roundTrip(randomBytes(n, 7), &packed));
+        CHECK(packed <= LZCompressBound(n));
+        if (test::Verbose()) std::printf("  random %zu -> %zu bytes\n", n, packed);
+    }
+}
+
+TEST_CASE(AllZeroCompressesHard) {
+    const size_t n = size_t(8) << 20;
+    size_t packed = 0;
+    CHECK(roundTrip(std::vector<uint8_t>(n, 0), &packed));
+    // 长匹配按 255 累加长度，约 1/255
+    CHECK(packed < n / 200);
+}
+
+TEST_CASE(RepetitivePatternsRoundTrip) {
+    // 小于 8 的周期走逐字节展开周期的路径，其余直接 8 字节复制
+    for (size_t period = 1; period <= 40; ++period) {
+        size_t packed = 0;
+        CHECK(roundTrip(periodic(100000, period, static_cast<uint32_t>(period)), &packed));
+        CHECK(packed < 100000 / 20);
+    }
+    // 回溯偏移上限附近：相同内容相隔 65535（可匹配）与 65536（超出偏移范围）
+    for (size_t distance : { size_t(65535), size_t(65536) }) {
+        auto v = randomBytes(distance * 3, 11);
+        for (size_t i = distance; i < v.size(); ++i) v[i] = v[i - distance];
+        CHECK(roundTrip(v));
+    }
+    // 长字面量与长匹配交替（长度字节超过 255 的编码）
+    std::vector<uint8_t> mixed;
+    for (int i = 0; i < 20; ++i) {
+        const auto noise = randomBytes(300 + i * 97, 100 + i);
+        mixed.insert(mixed.end(), noise.begin(), noise.end());
+        mixed.insert(mixed.end(), 600 + i * 131, static_cast<uint8_t>(i));
+    }
+    CHECK(roundTrip(mixed));
+}
+
+TEST_CASE(SyntheticFramesRoundTrip) {
+    const auto scene = test::MakeScene(640, 360);
+    for (PixelFormat fmt : { PixelFormat::RGBA_F16, PixelFormat::RGBA10A2, PixelFormat::RGB9E5 }) {
+        const ImageBuffer frame = test::EncodeScene(scene, fmt);
+        CHECK(roundTrip(frame.data));
+    }
+    CHECK(roundTrip(test::EncodeSceneSDR(scene).data));
+}
+
+TEST_CASE(CapacityTooSmallFails) {
+    for (const auto& raw : { randomBytes(5000, 3), periodic(5000, 5, 3), std::vector<uint8_t>(5000, 0) }) {
+        const auto packed = compress(raw);
+        std::vector<uint8_t> out(packed.size() + 8, 0);
+        CHECK_EQ(LZCompress(raw.data(), raw.size(), out.data(), packed.size()), packed.size());
+        CHECK_EQ(LZCompress(raw.data(), raw.size(), out.data(), packed.size() - 1), 0u);
+        CHECK_EQ(LZCompress(raw.data(), raw.size(), out.data(), 0), 0u);
+    }
+}
+
+TEST_CASE(TruncationAndWrongLengthRejected) {
+    std::vector<uint8_t> raw = periodic(3000, 7, 5);
+    const auto noise = randomBytes(700, 6);
+    raw.insert(raw.begin() + 1000, noise.begin(), noise.end());
+    const auto packed = compress(raw);
+
+    std::vector<uint8_t> out;
+    bool overrun = false;
+    for (size_t n = 0; n < packed.size(); ++n) {
+        const std::vector<uint8_t> cut(packed.begin(), packed.begin() + n);
+        CHECK(!decompress(cut, raw.size(), out, overrun));
+        CHECK(!overrun);
+    }
+    CHECK(!decompress(packed, raw.size() - 1, out, overrun));
+    CHECK(!overrun);
+    CHECK(!decompress(packed, raw.size() + 1, out, overrun));
+    CHECK(!overrun);
+}
+
+TEST_CASE(StructuralCorruptionRejected) {
+    // 手工构造的序列：token(字面量 4, 匹配 0+4) "abcd" offset 匹配；末尾一个只有字面量的序列
+    const std::vector<uint8_t> good = { 0x40, 'a', 'b', 'c', 'd', 0x04, 0x00, 0x10, 'z' };
+    std::vector<uint8_t> out;
+    bool overrun = false;
+    CHECK(decompress(good, 9, out, overrun));
+    CHECK(out == std::vector<uint8_t>({ 'a', 'b', 'c', 'd', 'a', 'b', 'c', 'd', 'z' }));
+
+    auto bad = good;
+    bad[5] = 0; bad[6] = 0;                         // 偏移为 0
+    CHECK(!decompress(bad, 9, out, overrun));
+    bad = good;
+    bad[5] = 5;                                     // 偏移超出已输出的数据
+    CHECK(!decompress(bad, 9, out, overrun));
+    bad = good;
+    bad[0] = 0x4F;                                  // 匹配长度需要扩展字节，却读到偏移后的 token
+    CHECK(!decompress(bad, 9, out, overrun));
+    CHECK(!overrun);
+    bad = good;
+    bad[0] = 0xF0;                                  // 字面量长度超出输入
+    CHECK(!decompress(bad, 9, out, overrun));
+    bad = { 0xF0, 255, 255, 255 };                  // 长度扩展字节在输入末尾中断
+    CHECK(!decompress(bad, 1000, out, overrun));
+    bad = good;
+    bad[0] = 0x41;                                  // 匹配写出超过 rawSize
+    CHECK(!decompress(bad, 9, out, overrun));
+    CHECK(!overrun);
+}
+
+TEST_CASE(MaxOffsetDecodes) {
+    // 65535 字节字面量后回溯 0xFFFF 复制到开头的 6 字节，再以 3 字节字面量结束
+    const auto lit = randomBytes(65535, 12);
+    std::vector<uint8_t> packed = { 0xF2 };
+    for (size_t len = 65535 - 15; ; len -= 255) {
+        if (len < 255) { packed.push_back(static_cast<uint8_t>(len)); break; }
+        packed.push_back(255);
+    }
+    packed.insert(packed.end(), lit.begin(), lit.end());
+    packed.insert(packed.end(), { 0xFF, 0xFF, 0x30, 'x', 'y', 'z' });
+
+    std::vector<uint8_t> expected = lit;
+    expected.insert(expected.end(), lit.begin(), lit.begin() + 6);
+    expected.insert(expected.end(), { 'x', 'y', 'z' });
+    std::vector<uint8_t> out;
+    bool overrun = false;
+    CHECK(decompress(packed, expected.size(), out, overrun));
+    CHECK(!overrun);
+    CHECK(out == expected);
+}
+
+TEST_CASE(BitFlipsNeverOverrun) {
+    // 编码不带校验，翻转字面量或改成另一个同样有效的偏移仍能解出等长的数据（完整性由帧文件的校验保证）；
+    // 但任何翻转都不能越界写，且翻转在结构字节上时大多被拒绝
+    std::vector<uint8_t> raw = periodic(2000, 13, 9);
+    const auto noise = randomBytes(300, 10);
+    raw.insert(raw.begin() + 500, noise.begin(), noise.end());
+    const auto packed = compress(raw);
+
+    std::vector<uint8_t> out;
+    int rejected = 0, flips = 0;
+    for (size_t i = 0; i < packed.size(); ++i) {
+        for (int bit = 0; bit < 8; ++bit) {
+            auto bad = packed;
+            bad[i] ^= static_cast<uint8_t>(1u << bit);
+            bool overrun = false;
+            const bool ok = decompress(bad, raw.size(), out, overrun);
+            CHECK(!overrun);
+            ++flips;
+            if (!ok) ++rejected;
+        }
+    }
+    if (test::Verbose()) std::printf("  %d of %d single-bit flips rejected\n", rejected, flips);
+    CHECK(rejected > 0);
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "TestUtil.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <type_traits>
+
+#ifdef __linux__
+#include <csignal>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// 日志：格式化子集、写线程的唤醒延迟（无丢失唤醒）、多线程顺序与队列满时的回退，
+// 以及崩溃处理在致命信号下写出已排队的记录
+using namespace screenshot_tool;
+
+namespace {
+
+    std::filesystem::path tempLogPath(const char* tag) {
+        return std::filesystem::temp_directory_path() /
+            ("screenshot_logger_test_" + std::string(tag) + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) + ".log");
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream s;
+        s << file.rdbuf();
+        return s.str();
+    }
+
+    std::uintmax_t fileSize(const std::filesystem::path& path) {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(path, ec);
+        return ec ? 0 : size;
+    }
+
+    template<class...Args>
+    std::wstring format(std::wstring_view fmt, const Args&...args) {
+        log_detail::Args captured;
+        (captured.Add(args), ...);
+        std::wstring out;
+        log_detail::FormatTo(out, fmt, captured);
+        return out;
+    }
+
+#ifdef __linux__
+    // 崩溃子进程：由 CrashHandlerWritesQueuedRecords 以环境变量启动本程序，在 main 之前执行
+    const int crashChild = [] {
+        const char* path = std::getenv("SCREENSHOT_LOGGER_CRASH_FILE");
+        if (!path) return 0;
+        Logger::EnableFileLogging(std::filesystem::path(path).wstring());
+        Logger::InstallCrashHandler();
+        for (int i = 0; i < 5; ++i) Logger::Warn(L"queued before crash {}", i);
+        std::raise(SIGSEGV);
+        return 1;
+    }();
+#endif
+
+} // namespace
+
+// 格式串由写线程稍后格式化，只接受字面量：运行时字符串无法转换为 FormatString，
+// 运行时的 wchar_t 数组虽能匹配构造函数，但 consteval 求值失败同样无法编译
+static_assert(std::is_convertible_v<const wchar_t (&)[6], log_detail::FormatString>);
+static_assert(!std::is_convertible_v<const wchar_t*, log_detail::FormatString>);
+static_assert(!std::is_convertible_v<std::wstring, log_detail::FormatString>);
+static_assert(!std::is_convertible_v<std::wstring_view, log_detail::FormatString>);
+
+TEST_CASE(FormatStringKeepsLiteral) {
+    static constexpr wchar_t table[] = L"from a constexpr table {}";
+    constexpr log_detail::FormatString literal(L"literal {}");
+    CHECK(literal.text == L"literal {}");
+    CHECK(literal.text.size() == 10);
+    CHECK(log_detail::FormatString(table).text.data() == table);
+}
+
+TEST_CASE(FormatSubset) {
+    CHECK(format(L"a {} b {}", 1, L"two") == L"a 1 b two");
+    CHECK(format(L"{{literal}} {}", true) == L"{literal} true");
+    CHECK(format(L"{:.2f} {:.0f}", 3.14159, 2.5f) == L"3.14 2");
+    CHECK(format(L"{:x} {:#x} {:#x}", 255u, 4096, -1) == L"ff 0x1000 -0x1");
+    CHECK(format(L"{} {}", -42LL, static_cast<uint8_t>(7)) == L"-42 7");
+    CHECK(format(L"{} {}", static_cast<const wchar_t*>(nullptr), L'x') == L"(null) x");
+    CHECK(format(L"missing {} {}", 1) == L"missing 1 ");
+    CHECK(format(L"{}", reinterpret_cast<void*>(static_cast<uintptr_t>(0x1234))) == L"0x1234");
+}
+
+TEST_CASE(WriterWakesPromptly) {
+    // 写线程空闲时每 200 ms 才轮询一次；若唤醒丢失，单条记录要等到下一次轮询才写出
+    const auto path = tempLogPath("wake");
+    Logger::EnableFileLogging(path.wstring());
+    double worstMs = 0.0;
+    for (int i = 0; i < 20; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));     // 让写线程进入空闲等待
+        const auto before = fileSize(path);
+        const auto start = std::chrono::steady_clock::now();
+        Logger::Warn(L"wake {}", i);
+        while (fileSize(path) == before && std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
+            std::this_thread::yield();
+        }
+        worstMs = std::max(worstMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    Logger::EnableFileLogging(L"");
+    std::filesystem::remove(path);
+    if (worstMs >= 100.0) std::printf("  worst wake latency %.1f ms\n", worstMs);
+    CHECK(worstMs < 100.0);
+}
+
+TEST_CASE(ConcurrentProducersKeepOrder) {
+    // 4 个线程各写 600 条，总数超过队列容量（1024），队列满时在调用线程上回退同步写出；
+    // 每个线程的记录都必须完整且保持先后顺序
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 600;
+    const auto path = tempLogPath("order");
+    Logger::EnableFileLogging(path.wstring());
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < PER_THREAD; ++i) Logger::Warn(L"producer {} record {}", t, i);
+        });
+    }
+    for (auto& th : threads) th.join();
+    Logger::Flush();
+    Logger::EnableFileLogging(L"");
+
+    std::istringstream lines(readFile(path));
+    std::filesystem::remove(path);
+    int next[THREADS] = {};
+    int outOfOrder = 0;
+    std::string line;
+    while (std::getline(lines, line)) {
+        int t = 0, i = 0;
+        if (std::sscanf(line.c_str(), "WARN: producer %d record %d", &t, &i) != 2 || t < 0 || t >= THREADS) continue;
+        outOfOrder += i != next[t];
+        next[t] = i + 1;
+    }
+    CHECK_EQ(outOfOrder, 0);
+    for (int t = 0; t < THREADS; ++t) CHECK_EQ(next[t], PER_THREAD);
+}
+
+#ifdef __linux__
+TEST_CASE(CrashHandlerWritesQueuedRecords) {
+    // 子进程写 5 条记录后触发 SIGSEGV：信号处理只等待写线程并追加一行预先格式化的消息
+    const auto path = tempLogPath("crash");
+    const pid_t pid = fork();
+    if (pid == 0) {
+        setenv("SCREENSHOT_LOGGER_CRASH_FILE", path.c_str(), 1);
+        execl("/proc/self/exe", "LoggerTest", static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    CHECK(pid > 0);
+    int status = 0;
+    CHECK_EQ(waitpid(pid, &status, 0), pid);
+    CHECK(WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV);
+
+    const std::string log = readFile(path);
+    std::filesystem::remove(path);
+    size_t previous = 0;
+    for (int i = 0; i < 5; ++i) {
+        const size_t at = log.find("WARN: queued before crash " + std::to_string(i) + "\n");
+        CHECK(at != std::string::npos && at >= previous);
+        previous = at;
+    }
+    const size_t crash = log.find("ERR: Fatal signal " + std::to_string(SIGSEGV) + "\n");
+    CHECK(crash != std::string::npos && crash > previous);
+}
+#endif
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/LuminanceHistogram.hpp"
+#include "image/PixelConvert.hpp"
+#include <random>
+#include <vector>
+
+// 自动曝光的亮度直方图：对数均匀分布的已知亮度，百分位误差不超过一个桶宽；
+// 范围外的值、合并与曝光推导的两种约束；以及三种采集格式经 ApplyAutoExposure 后与解析值一致
+using namespace screenshot_tool;
+
+namespace {
+
+    constexpr float BIN_STOPS = (LuminanceHistogram::MAX_LOG2_NITS - LuminanceHistogram::MIN_LOG2_NITS) /
+        LuminanceHistogram::BIN_COUNT;     // 一个桶宽（档）
+    const float PERCENTILES[] = { 1.0f, 10.0f, 25.0f, 50.0f, 75.0f, 90.0f, 99.0f, 99.5f };
+
+    float stopsApart(float a, float b) {
+        return std::abs(std::log2(a / b));
+    }
+
+    // 以 log2 亮度在 [lo, hi) 内均匀分布的 count 个样本
+    LuminanceHistogram logUniform(float lo, float hi, int count) {
+        LuminanceHistogram hist;
+        for (int i = 0; i < count; ++i) {
+            hist.Add(std::exp2(lo + (hi - lo) * (i + 0.5f) / count));
+        }
+        return hist;
+    }
+
+} // namespace
+
+TEST_CASE(EmptyHistogram) {
+    LuminanceHistogram hist;
+    CHECK_EQ(hist.Count(), 0u);
+    CHECK_EQ(hist.Percentile(50.0f), 0.0f);
+    float exposure = -1.0f, white = -1.0f;
+    CHECK(!hist.DeriveExposure(50.0f, 99.5f, exposure, white));
+    CHECK_EQ(exposure, -1.0f);
+}
+
+TEST_CASE(PercentilesOfKnownDistribution) {
+    const float lo = -2.0f, hi = 12.0f;     // 0.25 .. 4096 nits
+    const auto hist = logUniform(lo, hi, 100000);
+    CHECK_EQ(hist.Count(), 100000u);
+    float worst = 0.0f;
+    for (float p : PERCENTILES) {
+        const float expected = std::exp2(lo + (hi - lo) * p / 100.0f);
+        worst = std::max(worst, stopsApart(hist.Percentile(p), expected));
+    }
+    if (test::Verbose()) std::printf("  max percentile error %.4f stops (bin %.4f)\n", worst, BIN_STOPS);
+    CHECK(worst <= BIN_STOPS);
+
+    // 百分位随 p 单调不减
+    float previous = 0.0f;
+    bool monotonic = true;
+    for (int p = 0; p <= 100; ++p) {
+        const float v = hist.Percentile(static_cast<float>(p));
+        monotonic &= v >= previous;
+        previous = v;
+    }
+    CHECK(monotonic);
+}
+
+TEST_CASE(OutOfRangeValuesClampToEndBins) {
+    // 0、负值与 NaN 计入最低的桶，超出上限的计入最高的桶
+    LuminanceHistogram low;
+    for (float v : { 0.0f, -5.0f, NAN, 1e-6f }) low.Add(v);
+    CHECK_EQ(low.Count(), 4u);
+    CHECK(low.Percentile(100.0f) <= std::exp2(LuminanceHistogram::MIN_LOG2_NITS + BIN_STOPS) * 1.001f);
+
+    LuminanceHistogram high;
+    for (float v : { 1e5f, 1e9f, INFINITY }) high.Add(v);
+    CHECK(high.Percentile(0.0f) >= std::exp2(LuminanceHistogram::MAX_LOG2_NITS - BIN_STOPS) * 0.999f);
+    CHECK(high.Percentile(100.0f) <= std::exp2(LuminanceHistogram::MAX_LOG2_NITS) * 1.001f);
+}
+
+TEST_CASE(MergeEqualsSingleHistogram) {
+    std::mt19937 rng(29u);
+    std::uniform_real_distribution<float> stops(-5.0f, 13.0f);
+    LuminanceHistogram whole, parts[3];
+    for (int i = 0; i < 30000; ++i) {
+        const float nits = std::exp2(stops(rng));
+        whole.Add(nits);
+        parts[i % 3].Add(nits);
+    }
+    LuminanceHistogram merged;
+    for (const auto& part : parts) merged.Merge(part);
+    CHECK_EQ(merged.Count(), whole.Count());
+    for (float p : PERCENTILES) CHECK_EQ(merged.Percentile(p), whole.Percentile(p));
+}
+
+TEST_CASE(DeriveExposureConstraints) {
+    float exposure = 0.0f, white = 0.0f;
+
+    // 中位数映射到 18% 中灰，白点取高百分位
+    const auto wide = logUniform(0.0f, 10.0f, 50000);       // 1 .. 1024 nits
+    CHECK(wide.DeriveExposure(50.0f, 99.5f, exposure, white));
+    CHECK(stopsApart(exposure, 0.18f / 32.0f) <= BIN_STOPS);
+    CHECK(stopsApart(white, std::exp2(9.95f)) <= BIN_STOPS);
+
+    // 以浅色界面为主的画面：按中灰会使白点低于 1.0，改为白点映射到 1.0
+    const auto bright = logUniform(7.0f, 8.0f, 50000);      // 128 .. 256 nits
+    CHECK(bright.DeriveExposure(50.0f, 99.5f, exposure, white));
+    CHECK_NEAR(white * exposure, 1.0f, 1e-4f);
+
+    // 暗场景中的少量极亮高光：白点在色调映射输入中不超过 64
+    LuminanceHistogram dark = logUniform(-3.0f, -2.0f, 50000);
+    for (int i = 0; i < 1000; ++i) dark.Add(10000.0f);
+    CHECK(dark.DeriveExposure(50.0f, 99.9f, exposure, white));
+    CHECK(white * exposure <= 64.0f * 1.0001f);
+}
+
+TEST_CASE(AutoExposureMatchesSyntheticLuminance) {
+    // 亮度已知的灰阶画面经各采集格式编码后自动曝光：中位数与白点百分位与解析值相差不超过
+    // 一个桶宽加 1/128 EV 的量化
+    const float minNits = 1.0f, maxNits = 1000.0f;
+    const auto scene = test::MakeLuminanceRamp(1024, 64, minNits, maxNits);
+    const float key = test::RampPercentileNits(minNits, maxNits, 50.0f);
+    const float expectedWhite = test::RampPercentileNits(minNits, maxNits, 99.5f);
+    Config config;
+    config.autoExposure = true;
+    ToneMapParams hdr;
+    hdr.hdr = true;
+    for (PixelFormat fmt : { PixelFormat::RGBA_F16, PixelFormat::RGBA10A2, PixelFormat::RGB9E5 }) {
+        const ImageBuffer source = test::EncodeScene(scene, fmt);
+        auto regions = ToneMapRegions::Uniform(hdr, source.width, source.height);
+        PixelConvert::ApplyAutoExposure(fmt, source, regions, &config);
+        const ToneMapParams& params = regions.Params(0);
+        const float exposureError = stopsApart(params.exposure, 0.18f / key);
+        const float whiteError = stopsApart(params.whiteNits, expectedWhite);
+        const float bound = BIN_STOPS + 1.0f / 128.0f;
+        if (exposureError > bound || whiteError > bound || test::Verbose()) {
+            std::printf("  format %d: exposure %.5f/nit (%.4f stops off), white %.1f nits (%.4f stops off)\n",
+                static_cast<int>(fmt), params.exposure, exposureError, params.whiteNits, whiteError);
+        }
+        CHECK(exposureError <= bound);
+        CHECK(whiteError <= bound);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
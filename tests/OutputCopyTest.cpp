@@ -0,0 +1,291 @@
+#include "TestUtil.hpp"
+#include "capture/CaptureCommon.hpp"
+#include "capture/OutputCopy.hpp"
+#include "image/HalfFloat.hpp"
+#include "image/PixelConvert.hpp"
+#include "image/SharedExponent.hpp"
+#include <vector>
+
+// 用模拟的桌面复制层驱动 DXGICapture::CaptureRegion 的 CPU 侧逻辑：格式协商、混合 HDR/SDR 区域的缓冲区格式、
+// 按旋转换算子矩形、带行填充的暂存纹理逐行复制、展开与打包，以及尚未出帧时的全零检测
+using namespace screenshot_tool;
+
+namespace {
+
+    // 模拟的输出。纹理按扫描方向（旋转前）存储，与 IDXGIOutputDuplication 返回的纹理一致
+    struct FakeOutput {
+        PixelBox desktop;
+        bool hdr = false;
+        bool nativeSupported = true;
+        OutputRotation rotation = OutputRotation::Identity;
+        PixelFormat format = PixelFormat::Unknown;      // 协商结果
+        PixelFormat textureFormat = PixelFormat::Unknown; // 实际到达的纹理格式（模式切换时可能与 format 不同）
+        int texW = 0;
+        int texH = 0;
+        std::vector<uint8_t> texture;
+    };
+
+    // 虚拟桌面上 (x, y) 处的像素：同一坐标在 BGRA8 与 FP16 输出上取不同的值，alpha 不透明
+    void desktopPixel(int x, int y, PixelFormat fmt, uint8_t* px) {
+        if (fmt == PixelFormat::BGRA8) {
+            px[0] = static_cast<uint8_t>(x * 7 + y * 3);
+            px[1] = static_cast<uint8_t>(x * 5 + y * 11 + 1);
+            px[2] = static_cast<uint8_t>(x + y * 13 + 2);
+            px[3] = 255;
+        } else {
+            const uint16_t half[4] = { FloatToHalf(static_cast<float>((x + 2 * y) % 97) / 8.0f),
+                                       FloatToHalf(static_cast<float>((3 * x + y) % 61) / 32.0f),
+                                       FloatToHalf(static_cast<float>((x * y) % 41) / 4.0f - 1.0f),  // 含负值（scRGB 广色域）
+                                       FloatToHalf(1.0f) };
+            std::memcpy(px, half, sizeof(half));
+        }
+    }
+
+    // 纹理像素 (u, v) 对应的输出内桌面坐标：独立于 OutputRotation.hpp 写出的逆映射
+    void textureToDesktop(int u, int v, int deskW, int deskH, OutputRotation rot, int& x, int& y) {
+        switch (rot) {
+        case OutputRotation::Rotate90:  x = deskW - 1 - v; y = u;             break;
+        case OutputRotation::Rotate180: x = deskW - 1 - u; y = deskH - 1 - v; break;
+        case OutputRotation::Rotate270: x = v;             y = deskH - 1 - u; break;
+        default:                        x = u;             y = v;             break;
+        }
+    }
+
+    FakeOutput makeOutput(PixelBox desktop, bool hdr, OutputRotation rot = OutputRotation::Identity, bool nativeSupported = true) {
+        FakeOutput o;
+        o.desktop = desktop;
+        o.hdr = hdr;
+        o.nativeSupported = nativeSupported;
+        o.rotation = rot;
+        o.format = NegotiateCaptureFormat(hdr, nativeSupported);
+        o.textureFormat = o.format;
+        const bool swap = rot == OutputRotation::Rotate90 || rot == OutputRotation::Rotate270;
+        o.texW = swap ? desktop.Height() : desktop.Width();
+        o.texH = swap ? desktop.Width() : desktop.Height();
+        const int bpp = BytesPerPixel(o.format);
+        o.texture.resize(static_cast<size_t>(o.texW) * o.texH * bpp);
+        for (int v = 0; v < o.texH; ++v) {
+            for (int u = 0; u < o.texW; ++u) {
+                int x = 0, y = 0;
+                textureToDesktop(u, v, desktop.Width(), desktop.Height(), rot, x, y);
+                desktopPixel(desktop.left + x, desktop.top + y, o.format, &o.texture[(static_cast<size_t>(v) * o.texW + u) * bpp]);
+            }
+        }
+        return o;
+    }
+
+    std::vector<CaptureOutput> layoutOf(const std::vector<FakeOutput>& outputs) {
+        std::vector<CaptureOutput> layout;
+        for (const auto& o : outputs) layout.push_back({ o.desktop, o.format });
+        return layout;
+    }
+
+    // 与 DXGICapture::CaptureRegion 相同的流程；CopySubresourceRegion + Map 用带行填充、预先填满垃圾值的暂存缓冲模拟
+    CaptureResult fakeCapture(const std::vector<FakeOutput>& outputs, const PixelBox& region, bool compact, ImageBuffer& out) {
+        const PixelFormat fmt = CaptureBufferFormat(RegionCaptureFormat(region, layoutOf(outputs)), compact);
+        PrepareCaptureBuffer(out, fmt, region.Width(), region.Height());
+        bool allSuccess = true;
+        bool hasContent = false;
+        for (const auto& o : outputs) {
+            OutputRegion part;
+            if (!IntersectOutput(region, o.desktop, o.rotation, part)) continue;
+            if (!OutputCopyCompatible(o.textureFormat, fmt)) {
+                allSuccess = false;
+                continue;
+            }
+            const PixelBox& tb = part.texture;
+            if (tb.left < 0 || tb.top < 0 || tb.right > o.texW || tb.bottom > o.texH) {
+                allSuccess = false;
+                continue;
+            }
+            const int bpp = BytesPerPixel(o.textureFormat);
+            const std::ptrdiff_t pitch = ((static_cast<std::ptrdiff_t>(tb.Width()) * bpp + 255) / 256) * 256 + 64;
+            std::vector<uint8_t> staging(static_cast<size_t>(pitch) * tb.Height(), 0xCD);
+            for (int v = 0; v < tb.Height(); ++v) {
+                std::memcpy(&staging[static_cast<size_t>(v) * pitch],
+                            &o.texture[(static_cast<size_t>(tb.top + v) * o.texW + tb.left) * bpp],
+                            static_cast<size_t>(tb.Width()) * bpp);
+            }
+            const MappedTexture src{ staging.data(), pitch, o.textureFormat };
+            if (CopyOutputRegion(src, part, out)) hasContent = true;
+        }
+        if (!allSuccess) return CaptureResult::NeedsReinitialization;
+        if (out.data.empty() || !hasContent) return CaptureResult::TemporaryFailure;
+        return CaptureResult::Success;
+    }
+
+    // 期望值：按桌面像素的原生格式逐像素展开 / 打包，显示器之间的空洞为零
+    void expectedPixel(const std::vector<FakeOutput>& outputs, int x, int y, PixelFormat buffer, uint8_t* px) {
+        std::memset(px, 0, BytesPerPixel(buffer));
+        for (const auto& o : outputs) {
+            if (x < o.desktop.left || x >= o.desktop.right || y < o.desktop.top || y >= o.desktop.bottom) continue;
+            uint8_t native[8] = {};
+            desktopPixel(x, y, o.format, native);
+            uint16_t half[4] = {};
+            if (o.format == PixelFormat::BGRA8 && buffer != PixelFormat::BGRA8) {
+                PixelConvert::WidenBGRA8ToF16(native, half, 1);
+            } else {
+                std::memcpy(half, native, sizeof(half));
+            }
+            if (buffer == PixelFormat::RGB9E5) {
+                uint32_t packed = 0;
+                PackHalfToRGB9E5N(half, &packed, 1);
+                std::memcpy(px, &packed, sizeof(packed));
+            } else if (buffer == PixelFormat::RGBA_F16) {
+                std::memcpy(px, half, sizeof(half));
+            } else {
+                std::memcpy(px, native, BytesPerPixel(buffer));
+            }
+            return;
+        }
+    }
+
+    int countMismatches(const std::vector<FakeOutput>& outputs, const PixelBox& region, const ImageBuffer& out) {
+        const int bpp = BytesPerPixel(out.format);
+        int mismatches = 0;
+        uint8_t want[8];
+        for (int y = region.top; y < region.bottom; ++y) {
+            for (int x = region.left; x < region.right; ++x) {
+                expectedPixel(outputs, x, y, out.format, want);
+                const uint8_t* got = &out.data[static_cast<size_t>(y - region.top) * out.stride + static_cast<size_t>(x - region.left) * bpp];
+                if (std::memcmp(got, want, bpp) != 0) {
+                    if (mismatches < 4) std::printf("  mismatch at desktop (%d, %d)\n", x, y);
+                    ++mismatches;
+                }
+            }
+        }
+        return mismatches;
+    }
+
+    // 左：1920x1080 SDR；中：竖放（旋转 90）的 HDR；右上：旋转 180 的 SDR，位于负坐标且与下方输出之间有空洞；
+    // 尺寸缩小以便穷举逐像素比较
+    std::vector<FakeOutput> mixedLayout() {
+        return { makeOutput({ 0, 0, 192, 108 }, false),
+                 makeOutput({ 192, -40, 300, 152 }, true, OutputRotation::Rotate90),
+                 makeOutput({ -150, -120, -6, -39 }, false, OutputRotation::Rotate180),
+                 makeOutput({ 300, 20, 381, 164 }, true, OutputRotation::Rotate270) };
+    }
+
+} // namespace
+
+TEST_CASE(FormatNegotiation) {
+    CHECK(NativeCaptureFormat(true) == PixelFormat::RGBA_F16);
+    CHECK(NativeCaptureFormat(false) == PixelFormat::BGRA8);
+    CHECK(NegotiateCaptureFormat(true, true) == PixelFormat::RGBA_F16);
+    CHECK(NegotiateCaptureFormat(false, true) == PixelFormat::BGRA8);
+    // DuplicateOutput1 不可用时 HDR 输出也只能得到 BGRA8
+    CHECK(NegotiateCaptureFormat(true, false) == PixelFormat::BGRA8);
+    CHECK(NegotiateCaptureFormat(false, false) == PixelFormat::BGRA8);
+}
+
+TEST_CASE(RegionFormatRule) {
+    const auto outputs = mixedLayout();
+    const auto layout = layoutOf(outputs);
+    CHECK(RegionCaptureFormat({ 10, 10, 100, 100 }, layout) == PixelFormat::BGRA8);
+    CHECK(RegionCaptureFormat({ 200, 0, 250, 100 }, layout) == PixelFormat::RGBA_F16);
+    CHECK(RegionCaptureFormat({ 150, 0, 250, 100 }, layout) == PixelFormat::RGBA_F16);     // 跨 SDR / HDR
+    CHECK(RegionCaptureFormat({ -100, -100, -50, -50 }, layout) == PixelFormat::BGRA8);
+    CHECK(RegionCaptureFormat({ -100, -100, 10, 10 }, layout) == PixelFormat::BGRA8);      // 两个 SDR 加空洞
+    CHECK(RegionCaptureFormat({ -100, -100, 200, 10 }, layout) == PixelFormat::RGBA_F16);
+    CHECK(RegionCaptureFormat({ 1000, 1000, 1100, 1100 }, layout) == PixelFormat::Unknown);
+    // 半开区间：只与边界相接不算相交
+    CHECK(RegionCaptureFormat({ 100, 0, 192, 108 }, layout) == PixelFormat::BGRA8);
+    CHECK(RegionCaptureFormat({ 0, 108, 192, 200 }, layout) == PixelFormat::Unknown);
+
+    CHECK(CaptureBufferFormat(PixelFormat::RGBA_F16, true) == PixelFormat::RGB9E5);
+    CHECK(CaptureBufferFormat(PixelFormat::RGBA_F16, false) == PixelFormat::RGBA_F16);
+    CHECK(CaptureBufferFormat(PixelFormat::BGRA8, true) == PixelFormat::BGRA8);
+    CHECK(CaptureBufferFormat(PixelFormat::Unknown, true) == PixelFormat::Unknown);
+
+    ImageBuffer out;
+    PrepareCaptureBuffer(out, PixelFormat::RGB9E5, 30, 20);
+    CHECK_EQ(out.stride, 120);
+    CHECK_EQ(out.data.size(), size_t(2400));
+    PrepareCaptureBuffer(out, PixelFormat::Unknown, 30, 20);
+    CHECK(out.data.empty());
+}
+
+TEST_CASE(CopyCompatibility) {
+    const PixelFormat all[] = { PixelFormat::Unknown, PixelFormat::BGRA8, PixelFormat::RGBA_F16, PixelFormat::RGBA10A2,
+                                PixelFormat::RGB9E5, PixelFormat::RGB8 };
+    int accepted = 0;
+    for (PixelFormat src : all) {
+        for (PixelFormat buf : all) {
+            if (OutputCopyCompatible(src, buf)) ++accepted;
+        }
+    }
+    // 相同格式 5 种（Unknown 除外）+ BGRA8 -> FP16 + FP16 / BGRA8 -> RGB9E5
+    CHECK_EQ(accepted, 8);
+    CHECK(OutputCopyCompatible(PixelFormat::BGRA8, PixelFormat::RGBA_F16));
+    CHECK(OutputCopyCompatible(PixelFormat::RGBA_F16, PixelFormat::RGB9E5));
+    CHECK(OutputCopyCompatible(PixelFormat::BGRA8, PixelFormat::RGB9E5));
+    CHECK(!OutputCopyCompatible(PixelFormat::RGBA_F16, PixelFormat::BGRA8));
+    CHECK(!OutputCopyCompatible(PixelFormat::RGBA10A2, PixelFormat::RGBA_F16));
+    CHECK(!OutputCopyCompatible(PixelFormat::Unknown, PixelFormat::Unknown));
+}
+
+TEST_CASE(CopyMatchesDesktop) {
+    const auto outputs = mixedLayout();
+    const PixelBox regions[] = {
+        { 0, 0, 192, 108 },         // 整个 SDR 输出
+        { 17, 23, 61, 90 },         // SDR 内部
+        { 192, -40, 300, 152 },     // 整个旋转 90 的输出
+        { 201, -7, 233, 150 },      // 旋转 90 输出的内部
+        { 301, 21, 380, 163 },      // 旋转 270 输出的内部
+        { -150, -120, -6, -39 },    // 整个旋转 180 的输出
+        { -149, -100, -50, -40 },   // 旋转 180 输出的内部
+        { 150, -30, 350, 60 },      // 跨三个输出：BGRA8 展开为 FP16
+        { -160, -130, 400, 170 },   // 整个虚拟桌面（含空洞）
+        { 191, 107, 193, 109 },     // 2x2，跨角
+    };
+    for (bool compact : { false, true }) {
+        for (const PixelBox& r : regions) {
+            ImageBuffer out;
+            const CaptureResult result = fakeCapture(outputs, r, compact, out);
+            CHECK(result == CaptureResult::Success);
+            if (result != CaptureResult::Success) continue;
+            CHECK(out.format == CaptureBufferFormat(RegionCaptureFormat(r, layoutOf(outputs)), compact));
+            CHECK_EQ(countMismatches(outputs, r, out), 0);
+        }
+    }
+}
+
+TEST_CASE(FallbackOutputInHDRLayout) {
+    // HDR 输出上 DuplicateOutput1 失败：得到 BGRA8，与相邻 FP16 输出一起展开
+    const std::vector<FakeOutput> outputs = { makeOutput({ 0, 0, 64, 48 }, true, OutputRotation::Identity, false),
+                                              makeOutput({ 64, 0, 128, 48 }, true) };
+    const PixelBox r{ 0, 0, 128, 48 };
+    for (bool compact : { false, true }) {
+        ImageBuffer out;
+        CHECK(fakeCapture(outputs, r, compact, out) == CaptureResult::Success);
+        CHECK(out.format == (compact ? PixelFormat::RGB9E5 : PixelFormat::RGBA_F16));
+        CHECK_EQ(countMismatches(outputs, r, out), 0);
+    }
+}
+
+TEST_CASE(EmptyFrameIsTemporaryFailure) {
+    auto outputs = mixedLayout();
+    for (auto& o : outputs) std::fill(o.texture.begin(), o.texture.end(), uint8_t(0));
+    ImageBuffer out;
+    CHECK(fakeCapture(outputs, { -160, -130, 400, 170 }, false, out) == CaptureResult::TemporaryFailure);
+
+    // 只有请求区域之外有内容时仍视为尚未出帧；区域内有一个非零字节即视为有内容
+    auto& rotated = outputs[1];
+    rotated.texture[0] = 1;         // 纹理 (0, 0) = 桌面 (deskW - 1, 0)，即输出右上角
+    CHECK(fakeCapture(outputs, { 192, -40, 250, 100 }, false, out) == CaptureResult::TemporaryFailure);
+    CHECK(fakeCapture(outputs, { 250, -40, 300, -30 }, false, out) == CaptureResult::Success);
+    CHECK(fakeCapture(outputs, { 299, -40, 300, -39 }, true, out) == CaptureResult::Success);
+    CHECK(fakeCapture(outputs, { 1000, 1000, 1010, 1010 }, false, out) == CaptureResult::TemporaryFailure);
+}
+
+TEST_CASE(UnexpectedTextureFormatRejected) {
+    // 初始化后输出切换到 HDR：按 SDR 协商的区域缓冲区收到 FP16 纹理，不能写入（上层重新初始化）
+    auto outputs = mixedLayout();
+    outputs[0].textureFormat = PixelFormat::RGBA_F16;
+    ImageBuffer out;
+    CHECK(fakeCapture(outputs, { 0, 0, 100, 100 }, false, out) == CaptureResult::NeedsReinitialization);
+    // 与之不相交的区域不受影响
+    CHECK(fakeCapture(outputs, { 200, 0, 250, 100 }, false, out) == CaptureResult::Success);
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "TestUtil.hpp"
+#include "capture/OutputRotation.hpp"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// 输出旋转的坐标换算：四种旋转 x 多种尺寸穷举。像素映射须是到纹理的双射、与旋转复合一致，
+// 桌面方向右移一个像素的字节步长与映射一致，矩形映射恰好覆盖其中每个像素的映射
+using namespace screenshot_tool;
+
+namespace {
+
+    const OutputRotation ROTATIONS[] = { OutputRotation::Identity, OutputRotation::Rotate90,
+                                         OutputRotation::Rotate180, OutputRotation::Rotate270 };
+
+    bool swapsAxes(OutputRotation rot) {
+        return rot == OutputRotation::Rotate90 || rot == OutputRotation::Rotate270;
+    }
+
+    const char* nameOf(OutputRotation rot) {
+        switch (rot) {
+        case OutputRotation::Rotate90:  return "90";
+        case OutputRotation::Rotate180: return "180";
+        case OutputRotation::Rotate270: return "270";
+        default:                        return "0";
+        }
+    }
+
+    // 映射为纹理尺寸内的双射
+    bool checkBijection(int w, int h, OutputRotation rot) {
+        const int texW = swapsAxes(rot) ? h : w;
+        const int texH = swapsAxes(rot) ? w : h;
+        std::vector<uint8_t> hit(static_cast<size_t>(texW) * texH, 0);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                int u = -1, v = -1;
+                DesktopPixelToTexture(x, y, w, h, rot, u, v);
+                if (u < 0 || v < 0 || u >= texW || v >= texH || hit[static_cast<size_t>(v) * texW + u]) {
+                    std::printf("  %dx%d rot %s: (%d, %d) -> (%d, %d)\n", w, h, nameOf(rot), x, y, u, v);
+                    return false;
+                }
+                hit[static_cast<size_t>(v) * texW + u] = 1;
+            }
+        }
+        return true;   // w*h 个互不相同的落点填满 texW*texH
+    }
+
+    // 每一步与 DesktopPixelToTexture 的字节偏移差一致（含行填充）
+    bool checkStep(int w, int h, OutputRotation rot, int bpp, int padding) {
+        const std::ptrdiff_t pitch = static_cast<std::ptrdiff_t>(swapsAxes(rot) ? h : w) * bpp + padding;
+        const std::ptrdiff_t step = DesktopStepInTexture(rot, bpp, pitch);
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x + 1 < w; ++x) {
+                int u0, v0, u1, v1;
+                DesktopPixelToTexture(x, y, w, h, rot, u0, v0);
+                DesktopPixelToTexture(x + 1, y, w, h, rot, u1, v1);
+                const std::ptrdiff_t delta = (v1 - v0) * pitch + static_cast<std::ptrdiff_t>(u1 - u0) * bpp;
+                if (delta != step) {
+                    std::printf("  %dx%d rot %s bpp %d: step %td, expected %td\n", w, h, nameOf(rot), bpp, step, delta);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // 矩形映射等于其中各像素映射的包围盒，且面积相等（恰好覆盖，无多余像素），并位于纹理内
+    bool checkBox(const PixelBox& r, int w, int h, OutputRotation rot) {
+        const PixelBox t = DesktopBoxToTexture(r, w, h, rot);
+        const int texW = swapsAxes(rot) ? h : w;
+        const int texH = swapsAxes(rot) ? w : h;
+        int minU = texW, minV = texH, maxU = -1, maxV = -1;
+        for (int y = r.top; y < r.bottom; ++y) {
+            for (int x = r.left; x < r.right; ++x) {
+                int u, v;
+                DesktopPixelToTexture(x, y, w, h, rot, u, v);
+                minU = std::min(minU, u);
+                minV = std::min(minV, v);
+                maxU = std::max(maxU, u);
+                maxV = std::max(maxV, v);
+            }
+        }
+        const bool ok = t.left == minU && t.top == minV && t.right == maxU + 1 && t.bottom == maxV + 1 &&
+            t.Width() * t.Height() == r.Width() * r.Height() &&
+            t.left >= 0 && t.top >= 0 && t.right <= texW && t.bottom <= texH;
+        if (!ok) {
+            std::printf("  %dx%d rot %s: box (%d, %d, %d, %d) -> (%d, %d, %d, %d)\n", w, h, nameOf(rot),
+                r.left, r.top, r.right, r.bottom, t.left, t.top, t.right, t.bottom);
+        }
+        return ok;
+    }
+
+} // namespace
+
+TEST_CASE(PixelMappingIsBijection) {
+    int failures = 0;
+    for (OutputRotation rot : ROTATIONS) {
+        for (int h = 1; h <= 17; ++h) {
+            for (int w = 1; w <= 17; ++w) {
+                if (!checkBijection(w, h, rot)) ++failures;
+            }
+        }
+        // 常见的横放与竖放分辨率
+        for (auto size : { std::pair{ 1920, 1080 }, std::pair{ 1080, 1920 }, std::pair{ 2560, 1440 }, std::pair{ 3440, 1440 } }) {
+            if (!checkBijection(size.first, size.second, rot)) ++failures;
+        }
+    }
+    CHECK_EQ(failures, 0);
+}
+
+TEST_CASE(CornersFollowDXGIRotation) {
+    // DXGI_MODE_ROTATION_ROTATE90：纹理按扫描方向存储，桌面内容顺时针旋转 90 度显示，
+    // 故桌面左上角位于纹理左下角、桌面右上角位于纹理左上角
+    const int w = 4, h = 3;
+    struct Corner { OutputRotation rot; int x, y, u, v; };
+    const Corner corners[] = {
+        { OutputRotation::Identity,  0, 0, 0, 0 }, { OutputRotation::Identity,  3, 2, 3, 2 },
+        { OutputRotation::Rotate90,  0, 0, 0, 3 }, { OutputRotation::Rotate90,  3, 0, 0, 0 },
+        { OutputRotation::Rotate90,  0, 2, 2, 3 }, { OutputRotation::Rotate180, 0, 0, 3, 2 },
+        { OutputRotation::Rotate180, 3, 2, 0, 0 }, { OutputRotation::Rotate270, 0, 0, 2, 0 },
+        { OutputRotation::Rotate270, 3, 0, 2, 3 }, { OutputRotation::Rotate270, 0, 2, 0, 0 },
+    };
+    for (const Corner& c : corners) {
+        int u = -1, v = -1;
+        DesktopPixelToTexture(c.x, c.y, w, h, c.rot, u, v);
+        CHECK_EQ(u, c.u);
+        CHECK_EQ(v, c.v);
+    }
+}
+
+TEST_CASE(RotationsCompose) {
+    // 把映射看作对图像的变换：旋转 90 连做两次等于 180，三次等于 270，四次回到原处
+    int failures = 0;
+    for (int h = 1; h <= 9; ++h) {
+        for (int w = 1; w <= 9; ++w) {
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    int u = x, v = y, cw = w, ch = h;
+                    OutputRotation expected[] = { OutputRotation::Rotate90, OutputRotation::Rotate180,
+                                                  OutputRotation::Rotate270, OutputRotation::Identity };
+                    for (OutputRotation want : expected) {
+                        int nu, nv;
+                        DesktopPixelToTexture(u, v, cw, ch, OutputRotation::Rotate90, nu, nv);
+                        u = nu;
+                        v = nv;
+                        std::swap(cw, ch);
+                        int eu, ev;
+                        DesktopPixelToTexture(x, y, w, h, want, eu, ev);
+                        if (eu != u || ev != v) ++failures;
+                    }
+                }
+            }
+        }
+    }
+    CHECK_EQ(failures, 0);
+}
+
+TEST_CASE(StepMatchesPixelMapping) {
+    int failures = 0;
+    for (OutputRotation rot : ROTATIONS) {
+        for (int bpp : { 4, 8 }) {
+            for (int padding : { 0, 4, 256 }) {
+                for (int h = 1; h <= 12; ++h) {
+                    for (int w = 1; w <= 12; ++w) {
+                        if (!checkStep(w, h, rot, bpp, padding)) ++failures;
+                    }
+                }
+                if (!checkStep(1920, 1080, rot, bpp, padding)) ++failures;
+            }
+        }
+    }
+    CHECK_EQ(failures, 0);
+}
+
+TEST_CASE(BoxMappingCoversExactly) {
+    // 小尺寸下穷举所有非空矩形；大尺寸取边缘与内部的代表矩形
+    const int maxSize = 12;
+    int failures = 0;
+    int boxes = 0;
+    for (OutputRotation rot : ROTATIONS) {
+        for (int h = 1; h <= maxSize; ++h) {
+            for (int w = 1; w <= maxSize; ++w) {
+                for (int top = 0; top < h; ++top) {
+                    for (int bottom = top + 1; bottom <= h; ++bottom) {
+                        for (int left = 0; left < w; ++left) {
+                            for (int right = left + 1; right <= w; ++right) {
+                                ++boxes;
+                                if (!checkBox({ left, top, right, bottom }, w, h, rot)) ++failures;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        const PixelBox large[] = { { 0, 0, 1920, 1080 }, { 0, 0, 1, 1 }, { 1919, 1079, 1920, 1080 },
+                                   { 17, 1000, 1903, 1080 }, { 960, 0, 961, 1080 }, { 0, 540, 1920, 541 } };
+        for (const PixelBox& r : large) {
+            ++boxes;
+            if (!checkBox(r, 1920, 1080, rot)) ++failures;
+        }
+    }
+    if (test::Verbose()) std::printf("  %d boxes\n", boxes);
+    CHECK_EQ(failures, 0);
+}
+
+TEST_CASE(IdentityIsUnchanged) {
+    const PixelBox r{ 3, 5, 40, 17 };
+    const PixelBox t = DesktopBoxToTexture(r, 64, 32, OutputRotation::Identity);
+    CHECK(t.left == r.left && t.top == r.top && t.right == r.right && t.bottom == r.bottom);
+    CHECK_EQ(DesktopStepInTexture(OutputRotation::Identity, 8, 1024), std::ptrdiff_t(8));
+}
+
+TEST_MAIN()
\ No newline at end of file
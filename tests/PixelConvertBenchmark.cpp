@@ -0,0 +1,137 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/PixelConvert.hpp"
+#include <string>
+#include <vector>
+
+// ToSRGB8 各条路径与 ConvertToRGB8 的吞吐量：1080p / 4K / 8K 合成画面（渐变、高光、界面文字），
+// 输出 MP/s 与 ns/px。计时不含源缓冲区的复制；LUT 路径先预热一次，烘焙时间单独列出
+using namespace screenshot_tool;
+
+namespace {
+
+    struct Size {
+        const char* name;
+        int width;
+        int height;
+    };
+
+    std::vector<Size> benchmarkSizes() {
+        if (test::QuickMode()) return { { "480x270", 480, 270 } };
+        return { { "1080p", 1920, 1080 }, { "4K", 3840, 2160 }, { "8K", 7680, 4320 } };
+    }
+
+    struct Format {
+        const char* name;
+        PixelFormat format;
+    };
+    const Format HDR_FORMATS[] = {
+        { "scRGB FP16", PixelFormat::RGBA_F16 },
+        { "HDR10", PixelFormat::RGBA10A2 },
+        { "RGB9E5", PixelFormat::RGB9E5 },
+    };
+
+    ToneMapParams params(bool hdr) {
+        ToneMapParams p;
+        p.hdr = hdr;
+        p.maxNits = 1000.0f;
+        return p;
+    }
+
+    // 先转换一次预热（静态表、线程池、LUT 缓存），之后每次先复制源缓冲区（不计时）再计时转换本身，取最短耗时
+    template<class Convert>
+    double timeConversion(const ImageBuffer& source, Convert&& convert) {
+        const int repeats = test::QuickMode() ? 1 : 3;
+        double best = 1e300;
+        ImageBuffer buf = source;
+        CHECK(convert(buf));
+        for (int i = 0; i < repeats; ++i) {
+            buf = source;
+            best = std::min(best, test::BestOfMs(1, [&] { CHECK(convert(buf)); }));
+        }
+        return best;
+    }
+
+    void report(const Size& size, const std::string& path, double ms) {
+        test::ReportThroughput(std::string(size.name) + " " + path, static_cast<double>(size.width) * size.height, ms);
+    }
+
+} // namespace
+
+TEST_CASE(BenchmarkToSRGB8Paths) {
+    std::printf("  ToSRGB8 paths (default operator %s)\n", Config().toneMapper.c_str());
+    for (const auto& size : benchmarkSizes()) {
+        const test::SceneNits scene = test::MakeScene(size.width, size.height);
+        const auto hdr = ToneMapRegions::Uniform(params(true), size.width, size.height);
+        const auto sdr = ToneMapRegions::Uniform(params(false), size.width, size.height);
+        // 双显示器：左半 HDR、右半 SDR，单遍内逐区间切换内核
+        ToneMapRegions mixed;
+        mixed.SetDefault(params(false));
+        mixed.AddRegion(0, 0, size.width / 2, size.height, params(true));
+        mixed.AddRegion(size.width / 2, 0, size.width, size.height, params(false));
+        mixed.Build(0, 0, size.width, size.height);
+
+        Config analytic;
+        analytic.colorLutSize = 0;
+        Config analyticNoDither = analytic;
+        analyticNoDither.dither = false;
+        Config lut;
+        lut.colorLutSize = 33;
+        Config autoExposure = lut;
+        autoExposure.autoExposure = true;
+
+        const ImageBuffer desktop = test::EncodeSceneSDR(scene);
+        report(size, "BGRA8 SDR", timeConversion(desktop, [&](ImageBuffer& b) {
+            return PixelConvert::ToSRGB8(PixelFormat::BGRA8, b, sdr, &analytic);
+        }));
+
+        for (const auto& f : HDR_FORMATS) {
+            const ImageBuffer source = test::EncodeScene(scene, f.format);
+            auto run = [&](const char* path, const ToneMapRegions& regions, const Config& config) {
+                report(size, std::string(f.name) + " " + path, timeConversion(source, [&](ImageBuffer& b) {
+                    return PixelConvert::ToSRGB8(f.format, b, regions, &config);
+                }));
+            };
+            run("SDR desktop", sdr, analytic);
+            run("analytic", hdr, analytic);
+            run("analytic no dither", hdr, analyticNoDither);
+            run("mixed HDR/SDR", mixed, analytic);
+
+            // LUT：首次转换包含烘焙，同一配置之后命中缓存。RGB9E5 与 FP16 共用 scRGB 的格点，不再单列
+            ImageBuffer cold = source;
+            const double coldMs = test::BestOfMs(1, [&] { CHECK(PixelConvert::ToSRGB8(f.format, cold, hdr, &lut)); });
+            if (f.format != PixelFormat::RGB9E5) {
+                std::printf("  %-48s %9.2f ms (first call, includes bake)\n", (std::string(size.name) + " " + f.name + " LUT 33^3 cold").c_str(), coldMs);
+            }
+            run("LUT 33^3", hdr, lut);
+
+            // 自动曝光：直方图统计（每帧一次）+ 按新曝光烘焙的 LUT 转换
+            ToneMapRegions exposed = hdr;
+            report(size, std::string(f.name) + " auto exposure histogram", test::BestOfMs(test::QuickMode() ? 1 : 3, [&] {
+                exposed = hdr;
+                PixelConvert::ApplyAutoExposure(f.format, source, exposed, &autoExposure);
+            }));
+            run("auto exposure LUT", exposed, autoExposure);
+        }
+    }
+}
+
+TEST_CASE(BenchmarkConvertToRGB8) {
+    std::printf("  ConvertToRGB8 (raw formats to RGB8)\n");
+    for (const auto& size : benchmarkSizes()) {
+        const test::SceneNits scene = test::MakeScene(size.width, size.height);
+        std::vector<Format> formats(std::begin(HDR_FORMATS), std::end(HDR_FORMATS));
+        formats.push_back({ "BGRA8", PixelFormat::BGRA8 });
+        for (const auto& f : formats) {
+            const ImageBuffer source = f.format == PixelFormat::BGRA8 ? test::EncodeSceneSDR(scene) : test::EncodeScene(scene, f.format);
+            ImageBuffer out;
+            report(size, std::string("ConvertToRGB8 ") + f.name, test::BestOfMs(test::QuickMode() ? 1 : 3, [&] {
+                CHECK(PixelConvert::ConvertToRGB8(source, out));
+            }));
+            CHECK(out.format == PixelFormat::RGB8);
+            CHECK_EQ(out.data.size(), static_cast<size_t>(size.width) * size.height * 3);
+        }
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
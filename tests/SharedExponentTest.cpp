@@ -0,0 +1,210 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/ColorSpace.hpp"
+#include "image/HalfFloat.hpp"
+#include "image/PixelConvert.hpp"
+#include "image/SharedExponent.hpp"
+#include "image/ToneMapping.hpp"
+#include <random>
+#include <vector>
+
+// RGB9E5 打包：批量路径（FP16 解码 + 709 -> 2020 + SSE2 打包）与逐像素 PackRGB9E5 逐位比较，
+// 边界值（0、非规格化数、超出上限、NaN / Inf、负值）的钳制，往返的相对误差上界，
+// 以及冻结帧按 RGB9E5 缓存时最终 sRGB8 输出与 FP16 路径的差异
+using namespace screenshot_tool;
+
+namespace {
+
+    constexpr float MAX_RELATIVE_ERROR = 1.0f / 512.0f;    // 半个 9 位尾数步长，相对最大通道
+    constexpr int MAX_SRGB8_DELTA = 2;                     // 8 位码值，主导通道
+    constexpr double MAX_SHARE_ABOVE = 0.001;              // 全部通道中超过上限的占比
+
+    // 参考实现：逐个 HalfToFloat，整段做色域转换，再逐像素标量打包
+    std::vector<uint32_t> packReference(const std::vector<uint16_t>& half) {
+        const int n = static_cast<int>(half.size() / 4);
+        std::vector<float> planes(static_cast<size_t>(n) * 3);
+        for (int i = 0; i < n; ++i) {
+            for (int c = 0; c < 3; ++c) planes[static_cast<size_t>(c) * n + i] = HalfToFloat(half[i * 4 + c]);
+        }
+        float* r = planes.data();
+        float* g = r + n;
+        float* b = g + n;
+        ColorSpace::ConvertGamutPlanar(ColorGamut::Rec709, ColorGamut::Rec2020, r, g, b, n);
+        std::vector<uint32_t> packed(n);
+        for (int i = 0; i < n; ++i) packed[i] = PackRGB9E5(r[i], g[i], b[i]);
+        return packed;
+    }
+
+    int countMismatches(const std::vector<uint16_t>& half) {
+        const int n = static_cast<int>(half.size() / 4);
+        std::vector<uint32_t> packed(n);
+        PackHalfToRGB9E5N(half.data(), packed.data(), n);
+        const std::vector<uint32_t> expected = packReference(half);
+        int mismatches = 0;
+        for (int i = 0; i < n; ++i) {
+            if (packed[i] != expected[i]) {
+                if (mismatches < 8) {
+                    std::printf("  pixel %d (%04X %04X %04X): 0x%08X, expected 0x%08X\n", i,
+                        half[i * 4], half[i * 4 + 1], half[i * 4 + 2], packed[i], expected[i]);
+                }
+                ++mismatches;
+            }
+        }
+        return mismatches;
+    }
+
+    void pushGray(std::vector<uint16_t>& half, uint16_t v) {
+        half.insert(half.end(), { v, v, v, FloatToHalf(1.0f) });
+    }
+
+    float unpackMax(uint32_t packed) {
+        float r, g, b;
+        UnpackRGB9E5(packed, r, g, b);
+        return std::max(r, std::max(g, b));
+    }
+
+} // namespace
+
+TEST_CASE(BatchMatchesScalarForAllHalfValues) {
+    // 每个 FP16 位模式都出现在 R 通道，G / B 取随机位模式；像素数不是 4 的倍数且跨越多个分段，覆盖 SIMD 尾部
+    std::mt19937 rng(9591u);
+    const int n = 65536 + 3;
+    std::vector<uint16_t> half(static_cast<size_t>(n) * 4);
+    for (int i = 0; i < n; ++i) {
+        half[i * 4 + 0] = static_cast<uint16_t>(i);
+        half[i * 4 + 1] = static_cast<uint16_t>(rng());
+        half[i * 4 + 2] = static_cast<uint16_t>(rng());
+        half[i * 4 + 3] = FloatToHalf(1.0f);
+    }
+    CHECK_EQ(countMismatches(half), 0);
+
+    // 短段与分段边界附近的长度：SIMD 整组、纯标量尾部与跨段
+    for (int len : { 1, 3, 4, 5, 255, 256, 257, 517 }) {
+        std::vector<uint16_t> part(half.begin() + 4 * 1000, half.begin() + 4 * (1000 + len));
+        CHECK_EQ(countMismatches(part), 0);
+    }
+}
+
+TEST_CASE(EdgeValuesClamp) {
+    CHECK_EQ(unpackMax(PackRGB9E5(0.0f, 0.0f, 0.0f)), 0.0f);
+    CHECK_EQ(unpackMax(PackRGB9E5(-1.0f, -0.0f, -1e30f)), 0.0f);
+    CHECK_EQ(unpackMax(PackRGB9E5(NAN, NAN, NAN)), 0.0f);
+    CHECK_EQ(unpackMax(PackRGB9E5(-INFINITY, 0.0f, 0.0f)), 0.0f);
+    CHECK_EQ(unpackMax(PackRGB9E5(INFINITY, 0.0f, 0.0f)), RGB9E5_MAX);
+    CHECK_EQ(unpackMax(PackRGB9E5(1e6f, 1.0f, 2.0f)), RGB9E5_MAX);
+    CHECK_EQ(unpackMax(PackRGB9E5(65504.0f, 0.0f, 0.0f)), RGB9E5_MAX);     // FP16 最大值超出 RGB9E5 上限
+    CHECK_EQ(unpackMax(PackRGB9E5(RGB9E5_MAX, 0.0f, 0.0f)), RGB9E5_MAX);
+
+    // NaN 只清零自身通道
+    float r, g, b;
+    UnpackRGB9E5(PackRGB9E5(NAN, 1.0f, 0.5f), r, g, b);
+    CHECK_EQ(r, 0.0f);
+    CHECK_EQ(g, 1.0f);
+    CHECK_EQ(b, 0.5f);
+
+    // FP16 非规格化数 k * 2^-24（k < 512）在最大通道上可精确表示
+    for (int k : { 1, 2, 3, 255, 511 }) {
+        const float v = HalfToFloat(static_cast<uint16_t>(k));
+        CHECK_EQ(unpackMax(PackRGB9E5(v, 0.0f, 0.0f)), v);
+    }
+    // 更小的值舍入到 0 或最小步长
+    CHECK_EQ(unpackMax(PackRGB9E5(1e-9f, 0.0f, 0.0f)), 0.0f);
+
+    // 批量路径：灰色经 709 -> 2020（系数全为正）后的钳制
+    std::vector<uint16_t> half;
+    pushGray(half, 0x0000);     // 0
+    pushGray(half, 0x0001);     // 最小非规格化数
+    pushGray(half, 0x7BFF);     // 65504
+    pushGray(half, 0x7C00);     // +Inf
+    pushGray(half, 0xFC00);     // -Inf
+    pushGray(half, 0x7E00);     // NaN
+    pushGray(half, 0xBC00);     // -1
+    std::vector<uint32_t> packed(half.size() / 4);
+    PackHalfToRGB9E5N(half.data(), packed.data(), static_cast<int>(packed.size()));
+    CHECK_EQ(unpackMax(packed[0]), 0.0f);
+    CHECK(unpackMax(packed[1]) > 0.0f && unpackMax(packed[1]) <= HalfToFloat(0x0002));
+    CHECK_EQ(unpackMax(packed[2]), RGB9E5_MAX);
+    CHECK_EQ(unpackMax(packed[3]), RGB9E5_MAX);
+    CHECK_EQ(unpackMax(packed[4]), 0.0f);
+    CHECK_EQ(unpackMax(packed[5]), 0.0f);
+    CHECK_EQ(unpackMax(packed[6]), 0.0f);
+}
+
+TEST_CASE(RoundTripRelativeError) {
+    // 随机颜色，最大通道跨越 RGB9E5 的全部指数；误差相对最大通道
+    std::mt19937 rng(512u);
+    std::uniform_real_distribution<float> exponent(-24.0f, 15.99f);
+    std::uniform_real_distribution<float> share(0.0f, 1.0f);
+    float worst = 0.0f;
+    for (int i = 0; i < 200000; ++i) {
+        const float maxc = std::exp2(exponent(rng));
+        const float in[3] = { maxc, maxc * share(rng), maxc * share(rng) };
+        const int order = i % 3;    // 最大通道轮流出现在 R / G / B
+        const float r = in[order], g = in[(order + 1) % 3], b = in[(order + 2) % 3];
+        float out[3];
+        UnpackRGB9E5(PackRGB9E5(r, g, b), out[0], out[1], out[2]);
+        const float expected[3] = { r, g, b };
+        for (int c = 0; c < 3; ++c) {
+            // 2^-24 以下只剩最小步长，按绝对误差计
+            worst = std::max(worst, std::abs(out[c] - expected[c]) / std::max(maxc, std::exp2(-15.0f)));
+        }
+    }
+    if (test::Verbose()) std::printf("  max relative error %.6f (bound %.6f)\n", worst, MAX_RELATIVE_ERROR);
+    CHECK(worst <= MAX_RELATIVE_ERROR);
+
+    // 平面解码与逐个解码逐位一致
+    std::vector<uint32_t> packed(1027);
+    for (auto& p : packed) p = static_cast<uint32_t>(rng());
+    const int n = static_cast<int>(packed.size());
+    std::vector<float> planes(static_cast<size_t>(n) * 3);
+    UnpackRGB9E5Rec2020Planar(packed.data(), n, planes.data());
+    int mismatches = 0;
+    for (int i = 0; i < n; ++i) {
+        float r, g, b;
+        UnpackRGB9E5(packed[i], r, g, b);
+        mismatches += r != planes[i] || g != planes[n + i] || b != planes[2 * n + i];
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST_CASE(SRGB8MatchesHalfFloatPath) {
+    // 同一场景分别按 FP16 与 RGB9E5 编码，关闭抖动与 LUT 后转换为 sRGB8，逐通道比较。
+    // 共享指数下暗通道的步长随最亮通道变化，2020 -> 709 又会把亮通道的舍入混入其余通道，
+    // 因此只对不低于像素最大通道一半的通道检查码值差上限，其余通道只限制超过上限的占比
+    const auto scene = test::MakeScene(640, 360);
+    ToneMapParams params;
+    params.hdr = true;
+    params.maxNits = 1000.0f;
+    const auto regions = ToneMapRegions::Uniform(params, scene.width, scene.height);
+    for (const char* op : { "reinhard", "aces", "hable", "bt2390", "agx" }) {
+        Config config;
+        config.toneMapper = op;
+        config.dither = false;
+        config.colorLutSize = 0;
+        ImageBuffer half = test::EncodeScene(scene, PixelFormat::RGBA_F16);
+        ImageBuffer e5 = test::EncodeScene(scene, PixelFormat::RGB9E5);
+        CHECK(PixelConvert::ToSRGB8(PixelFormat::RGBA_F16, half, regions, &config));
+        CHECK(PixelConvert::ToSRGB8(PixelFormat::RGB9E5, e5, regions, &config));
+        CHECK_EQ(half.data.size(), e5.data.size());
+        int maxDominant = 0;
+        int maxAll = 0;
+        size_t above = 0;
+        for (size_t i = 0; i < half.data.size(); ++i) {
+            const float* nits = &scene.rgb[i / 3 * 3];
+            const float maxc = std::max(nits[0], std::max(nits[1], nits[2]));
+            const int d = std::abs(half.data[i] - e5.data[i]);
+            if (nits[i % 3] >= 0.5f * maxc) maxDominant = std::max(maxDominant, d);
+            maxAll = std::max(maxAll, d);
+            above += d > MAX_SRGB8_DELTA;
+        }
+        const double share = static_cast<double>(above) / half.data.size();
+        const bool ok = maxDominant <= MAX_SRGB8_DELTA && share <= MAX_SHARE_ABOVE;
+        if (!ok || test::Verbose()) {
+            std::printf("  %-8s dominant channels max %d LSB, all channels max %d LSB, >%d %.4f%%\n", op,
+                maxDominant, maxAll, MAX_SRGB8_DELTA, 100.0 * share);
+        }
+        CHECK(ok);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "TestUtil.hpp"
+#include "image/EdgeIndex.hpp"
+#include "ui/SnapIndex.hpp"
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// 边缘索引与选区吸附：与逐像素参考实现逐点对比，并在大尺寸合成帧上测量构建耗时与查询开销
+using namespace screenshot_tool;
+
+namespace {
+
+    struct RGBImage {
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> data;
+
+        RGBImage(int w, int h, uint8_t fill) : width(w), height(h), data(static_cast<size_t>(w) * h * 3, fill) {}
+        int Stride() const { return width * 3; }
+
+        void FillRect(int l, int t, int r, int b, uint8_t cr, uint8_t cg, uint8_t cb) {
+            for (int y = std::max(t, 0); y < std::min(b, height); ++y) {
+                for (int x = std::max(l, 0); x < std::min(r, width); ++x) {
+                    uint8_t* p = &data[(static_cast<size_t>(y) * width + x) * 3];
+                    p[0] = cr;
+                    p[1] = cg;
+                    p[2] = cb;
+                }
+            }
+        }
+    };
+
+    // 合成桌面：渐变背景 + 若干重叠窗口（标题栏、按钮、文字状细条）
+    RGBImage syntheticDesktop(int width, int height, uint32_t seed) {
+        RGBImage img(width, height, 0);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                uint8_t* p = &img.data[(static_cast<size_t>(y) * width + x) * 3];
+                p[0] = static_cast<uint8_t>(40 + 60 * x / width);
+                p[1] = static_cast<uint8_t>(50 + 50 * y / height);
+                p[2] = 110;
+            }
+        }
+        std::mt19937 rng(seed);
+        const int windows = 6 + width / 400;
+        for (int i = 0; i < windows; ++i) {
+            const int w = width / 6 + static_cast<int>(rng() % (width / 3));
+            const int h = height / 6 + static_cast<int>(rng() % (height / 3));
+            const int l = static_cast<int>(rng() % (width - w));
+            const int t = static_cast<int>(rng() % (height - h));
+            img.FillRect(l, t, l + w, t + h, 240, 240, 240);
+            img.FillRect(l, t, l + w, t + 30, 32, 96, 200);
+            for (int line = t + 50; line + 12 < t + h; line += 22) {
+                for (int word = l + 12; word + 40 < l + w; word += 60) {
+                    img.FillRect(word, line, word + 36 + static_cast<int>(rng() % 16), line + 2, 20, 20, 20);
+                }
+            }
+        }
+        return img;
+    }
+
+    // 参考实现：整幅计算 Sobel 后按与 EdgeIndex 相同的规则做非极大值抑制
+    struct ReferenceEdges {
+        int width;
+        int height;
+        std::vector<uint8_t> vertical;      // 1 = (x, y) 为竖直边缘
+        std::vector<uint8_t> horizontal;    // 1 = (x, y) 为水平边缘
+
+        ReferenceEdges(const RGBImage& img, int threshold) : width(img.width), height(img.height) {
+            auto luma = [&](int x, int y) {
+                y = std::clamp(y, 0, height - 1);
+                const uint8_t* p = &img.data[(static_cast<size_t>(y) * width + x) * 3];
+                return (p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8;
+            };
+            auto grad = [&](int x, int y, int& ax, int& ay) {
+                ax = ay = 0;
+                if (x <= 0 || x >= width - 1) return;
+                const int gx = (luma(x + 1, y - 1) + 2 * luma(x + 1, y) + luma(x + 1, y + 1)) -
+                               (luma(x - 1, y - 1) + 2 * luma(x - 1, y) + luma(x - 1, y + 1));
+                const int gy = (luma(x - 1, y + 1) + 2 * luma(x, y + 1) + luma(x + 1, y + 1)) -
+                               (luma(x - 1, y - 1) + 2 * luma(x, y - 1) + luma(x + 1, y - 1));
+                ax = std::abs(gx);
+                ay = std::abs(gy);
+            };
+
+            vertical.assign(static_cast<size_t>(width) * height, 0);
+            horizontal.assign(static_cast<size_t>(width) * height, 0);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 1; x < width - 1; ++x) {
+                    int gx, gy, lx, ly, rx, ry, ux, uy, dx, dy;
+                    grad(x, y, gx, gy);
+                    grad(x - 1, y, lx, ly);
+                    grad(x + 1, y, rx, ry);
+                    grad(x, y - 1, ux, uy);
+                    grad(x, y + 1, dx, dy);
+                    const size_t i = static_cast<size_t>(y) * width + x;
+                    vertical[i] = gx >= threshold && gx >= gy && gx >= lx && gx > rx;
+                    horizontal[i] = gy >= threshold && gy > gx && gy >= uy && gy > dy;
+                }
+            }
+        }
+    };
+
+    void checkAgainstReference(const RGBImage& img, int threshold) {
+        EdgeIndex index;
+        index.Build(img.data.data(), img.width, img.height, img.Stride(), threshold);
+        ReferenceEdges ref(img, threshold);
+
+        int mismatches = 0;
+        size_t refCount = 0;
+        for (int y = 0; y < img.height; ++y) {
+            for (int x = 0; x < img.width; ++x) {
+                const size_t i = static_cast<size_t>(y) * img.width + x;
+                int out = 0;
+                const bool v = index.NearestVertical(x, y, 0, out);
+                const bool h = index.NearestHorizontal(x, y, 0, out);
+                mismatches += (v != (ref.vertical[i] != 0)) + (h != (ref.horizontal[i] != 0));
+                refCount += ref.vertical[i] + ref.horizontal[i];
+            }
+        }
+        CHECK_EQ(mismatches, 0);
+        CHECK_EQ(index.EdgeCount(), refCount);
+    }
+
+} // namespace
+
+TEST_CASE(StepEdgesAtExpectedPositions) {
+    RGBImage img(200, 120, 0);
+    img.FillRect(100, 40, 200, 120, 255, 255, 255);
+
+    EdgeIndex index;
+    index.Build(img.data.data(), img.width, img.height, img.Stride());
+    CHECK(!index.Empty());
+
+    int out = -1;
+    // 黑白交界的竖直边缘落在第一列白色像素上
+    CHECK(index.NearestVertical(90, 80, 16, out));
+    CHECK_EQ(out, 100);
+    CHECK(!index.NearestVertical(80, 80, 16, out));
+    CHECK(index.NearestHorizontal(150, 30, 16, out));
+    CHECK_EQ(out, 40);
+    // 平坦区域没有边缘
+    CHECK(!index.NearestVertical(50, 10, 40, out));
+    CHECK(!index.NearestHorizontal(50, 10, 40, out));
+    // 越界查询
+    CHECK(!index.NearestVertical(90, -1, 16, out));
+    CHECK(!index.NearestHorizontal(-1, 30, 16, out));
+}
+
+TEST_CASE(MatchesReferenceSobel) {
+    checkAgainstReference(syntheticDesktop(640, 400, 1), EdgeIndex::DEFAULT_THRESHOLD);
+    checkAgainstReference(syntheticDesktop(333, 517, 2), 64);
+    // 多线程分段边界附近：行数不是分段大小的整数倍
+    checkAgainstReference(syntheticDesktop(257, 131, 3), EdgeIndex::DEFAULT_THRESHOLD);
+}
+
+TEST_CASE(RejectsUnsupportedSizes) {
+    RGBImage tiny(2, 2, 128);
+    EdgeIndex index;
+    index.Build(tiny.data.data(), 2, 2, 6);
+    CHECK(index.Empty());
+    index.Build(nullptr, 100, 100, 300);
+    CHECK(index.Empty());
+    RGBImage wide(65536, 3, 0);
+    index.Build(wide.data.data(), wide.width, wide.height, wide.Stride());
+    CHECK(index.Empty());
+}
+
+TEST_CASE(SnapPrefersWindowEdges) {
+    SnapIndex snap;
+    // Z 序：上层在前
+    snap.SetWindows({ { 100, 100, 300, 250 }, { 50, 50, 400, 400 } });
+
+    SnapRect hit;
+    CHECK(snap.WindowAt(150, 150, hit));
+    CHECK_EQ(hit.left, 100);
+    CHECK(snap.WindowAt(60, 60, hit));
+    CHECK_EQ(hit.left, 50);
+    CHECK(!snap.WindowAt(10, 10, hit));
+
+    int x = 105, y = 245;
+    snap.SnapPoint(x, y, 8);
+    CHECK_EQ(x, 100);
+    CHECK_EQ(y, 250);
+
+    // 边只在其覆盖范围内吸附
+    x = 103;
+    y = 20;
+    snap.SnapPoint(x, y, 8);
+    CHECK_EQ(x, 103);
+    CHECK_EQ(y, 20);
+
+    // 两条边都在半径内时取最近的
+    x = 296;
+    y = 200;
+    snap.SnapPoint(x, y, 200);
+    CHECK_EQ(x, 300);
+}
+
+TEST_CASE(SnapFallsBackToImageEdges) {
+    RGBImage img(300, 200, 0);
+    img.FillRect(120, 0, 300, 200, 255, 255, 255);
+    EdgeIndex edges;
+    edges.Build(img.data.data(), img.width, img.height, img.Stride());
+
+    SnapIndex snap;
+    snap.SetEdges(std::move(edges));
+    // 客户区坐标 + offset = 图像坐标
+    snap.SetEdgeOffset(20, 0);
+    int x = 95, y = 50;
+    snap.SnapPoint(x, y, 8);
+    CHECK_EQ(x, 100);
+    CHECK_EQ(y, 50);
+
+    // 窗口边优先于图像边缘
+    snap.SetWindows({ { 94, 0, 200, 100 } });
+    x = 97;
+    snap.SnapPoint(x, y, 8);
+    CHECK_EQ(x, 94);
+
+    snap.Clear();
+    CHECK(snap.Edges().Empty());
+    x = 97;
+    snap.SnapPoint(x, y, 8);
+    CHECK_EQ(x, 97);
+}
+
+TEST_CASE(BenchmarkLargeFrames) {
+    struct Size {
+        const char* name;
+        int width;
+        int height;
+    };
+    std::vector<Size> sizes{ { "1080p", 1920, 1080 } };
+    if (!test::QuickMode()) {
+        sizes.push_back({ "4K", 3840, 2160 });
+        sizes.push_back({ "8K", 7680, 4320 });
+        sizes.push_back({ "3x4K span", 11520, 2160 });
+    }
+
+    std::printf("  EdgeIndex::Build / SnapIndex::SnapPoint\n");
+    for (const auto& size : sizes) {
+        const RGBImage img = syntheticDesktop(size.width, size.height, 7);
+        EdgeIndex index;
+        const double buildMs = test::BestOfMs(test::QuickMode() ? 1 : 3, [&] {
+            index.Build(img.data.data(), img.width, img.height, img.Stride());
+        });
+        test::ReportThroughput(std::string(size.name) + " build", static_cast<double>(size.width) * size.height, buildMs);
+        std::printf("  %-48s %9zu edges %9.2f MB\n", "", index.EdgeCount(), index.MemoryBytes() / 1048576.0);
+        CHECK(index.EdgeCount() > 0);
+        // 压缩索引远小于原图
+        CHECK(index.MemoryBytes() < img.data.size() / 4);
+
+        // 拖动时的逐次查询：伪随机光标轨迹
+        SnapIndex snap;
+        snap.SetEdges(std::move(index));
+        constexpr int QUERIES = 200000;
+        std::mt19937 rng(11);
+        std::vector<int> points(QUERIES * 2);
+        for (int i = 0; i < QUERIES; ++i) {
+            points[i * 2] = static_cast<int>(rng() % size.width);
+            points[i * 2 + 1] = static_cast<int>(rng() % size.height);
+        }
+        long long checksum = 0;
+        const double queryMs = test::BestOfMs(3, [&] {
+            for (int i = 0; i < QUERIES; ++i) {
+                int x = points[i * 2], y = points[i * 2 + 1];
+                snap.SnapPoint(x, y, 12);
+                checksum += x + y;
+            }
+        });
+        std::printf("  %-48s %9.1f ns/query\n", (std::string(size.name) + " snap query").c_str(), queryMs * 1e6 / QUERIES);
+        CHECK(checksum != 0);
+        CHECK(queryMs * 1e6 / QUERIES < 5000.0);
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
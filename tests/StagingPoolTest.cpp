@@ -0,0 +1,182 @@
+#include "TestUtil.hpp"
+#include "capture/StagingPool.hpp"
+#include <vector>
+
+// 回读暂存纹理池：用假纹理模拟“每次热键重新枚举输出并重建复制接口，再抓取”的过程，
+// 检查重复截图不重新分配纹理、尺寸或格式变化时才重新分配、超时复用只在内容有效且覆盖请求时发生，
+// 以及空闲回收 / 设备重建时的释放
+using namespace screenshot_tool;
+
+namespace {
+
+    struct FakeTexture {
+        int id = 0;
+        explicit operator bool() const { return id != 0; }
+    };
+
+    using Pool = StagingPool<FakeTexture>;
+
+    constexpr uint32_t kBGRA8 = 87;     // DXGI_FORMAT_B8G8R8A8_UNORM
+    constexpr uint32_t kFP16 = 10;      // DXGI_FORMAT_R16G16B16A16_FLOAT
+
+    struct FakeDevice {
+        int created = 0;
+        bool fail = false;
+
+        FakeTexture Create(uint32_t, int, int) {
+            if (fail) return {};
+            return { ++created };
+        }
+    };
+
+    struct Output {
+        StagingKey key;
+        uint32_t format;
+    };
+
+    std::vector<Output> twoOutputs() {
+        return { { { 0x100000001ull, L"\\\\.\\DISPLAY1" }, kFP16 }, { { 0x100000001ull, L"\\\\.\\DISPLAY2" }, kBGRA8 } };
+    }
+
+    // 一次热键：Initialize 重建复制接口（保留的内容作废），然后每个输出取到新帧并复制 box
+    void hotkey(Pool& pool, FakeDevice& device, const std::vector<Output>& outputs, const PixelBox& box) {
+        for (const Output& o : outputs) pool.At(o.key).valid = false;
+        for (const Output& o : outputs) {
+            auto* slot = pool.Acquire(o.key, o.format, box.Width(), box.Height(), o.format == kFP16 ? 8 : 4,
+                [&](uint32_t f, int w, int h) { return device.Create(f, w, h); });
+            CHECK(slot != nullptr);
+            if (!slot) continue;
+            slot->box = box;
+            slot->valid = true;
+        }
+    }
+
+} // namespace
+
+TEST_CASE(RepeatedHotkeysDoNotReallocate) {
+    Pool pool;
+    FakeDevice device;
+    const auto outputs = twoOutputs();
+    const PixelBox full{ 0, 0, 3840, 2160 };
+
+    hotkey(pool, device, outputs, full);
+    CHECK_EQ(pool.Allocations(), 2u);
+    CHECK_EQ(pool.Bytes(), size_t(3840) * 2160 * (8 + 4));
+    const FakeTexture first = pool.At(outputs[0].key).texture;
+
+    for (int i = 0; i < 5; ++i) hotkey(pool, device, outputs, full);
+    // 较小的选区放得下，同样复用
+    hotkey(pool, device, outputs, { 100, 100, 900, 700 });
+    CHECK_EQ(pool.Allocations(), 2u);
+    CHECK_EQ(device.created, 2);
+    CHECK_EQ(pool.At(outputs[0].key).texture.id, first.id);
+    CHECK_EQ(pool.Bytes(), size_t(3840) * 2160 * (8 + 4));
+}
+
+TEST_CASE(GrowOrFormatChangeReallocatesAndDropsContent) {
+    Pool pool;
+    FakeDevice device;
+    const StagingKey key{ 7, L"\\\\.\\DISPLAY1" };
+    auto create = [&](uint32_t f, int w, int h) { return device.Create(f, w, h); };
+
+    auto* slot = pool.Acquire(key, kBGRA8, 800, 600, 4, create);
+    slot->box = { 0, 0, 800, 600 };
+    slot->valid = true;
+
+    CHECK(pool.Acquire(key, kBGRA8, 800, 601, 4, create) == slot);      // 槽位不变，纹理换新
+    CHECK_EQ(pool.Allocations(), 2u);
+    CHECK(!slot->valid);
+    CHECK_EQ(slot->width, 800);
+    CHECK_EQ(slot->height, 601);
+
+    slot->valid = true;
+    pool.Acquire(key, kFP16, 10, 10, 8, create);        // 更小但格式不同
+    CHECK_EQ(pool.Allocations(), 3u);
+    CHECK(!slot->valid);
+    CHECK_EQ(pool.Bytes(), size_t(10) * 10 * 8);
+}
+
+TEST_CASE(HoldsOnlyValidCoveringContent) {
+    Pool pool;
+    FakeDevice device;
+    const StagingKey key{ 7, L"\\\\.\\DISPLAY1" };
+    auto* slot = pool.Acquire(key, kBGRA8, 1000, 500, 4, [&](uint32_t f, int w, int h) { return device.Create(f, w, h); });
+    slot->box = { 200, 100, 1200, 600 };
+
+    CHECK(!slot->Holds({ 300, 200, 400, 300 }));        // 尚未复制
+    slot->valid = true;
+    CHECK(slot->Holds({ 200, 100, 1200, 600 }));
+    CHECK(slot->Holds({ 300, 200, 400, 300 }));
+    CHECK(!slot->Holds({ 199, 200, 400, 300 }));
+    CHECK(!slot->Holds({ 300, 200, 1201, 300 }));
+    CHECK(!slot->Holds({ 300, 99, 400, 300 }));
+    CHECK(!slot->Holds({ 300, 200, 400, 601 }));
+
+    // 下一次热键：重建复制接口时旧内容作废，新帧复制后只覆盖新的子矩形；纹理一直是同一张
+    hotkey(pool, device, { { key, kBGRA8 } }, { 0, 0, 10, 10 });
+    CHECK_EQ(pool.Allocations(), 1u);
+    CHECK(slot->Holds({ 2, 2, 8, 8 }));
+    CHECK(!slot->Holds({ 300, 200, 400, 300 }));
+}
+
+TEST_CASE(ReleaseAndClear) {
+    Pool pool;
+    FakeDevice device;
+    const auto outputs = twoOutputs();
+    hotkey(pool, device, outputs, { 0, 0, 640, 480 });
+    Pool::Slot* slot = &pool.At(outputs[1].key);
+
+    // 空闲回收：纹理释放、槽位保留，下次抓取重新分配
+    pool.Release();
+    CHECK_EQ(pool.Bytes(), 0u);
+    CHECK(!slot->texture);
+    CHECK(!slot->Holds({ 0, 0, 1, 1 }));
+    CHECK(&pool.At(outputs[1].key) == slot);
+    hotkey(pool, device, outputs, { 0, 0, 640, 480 });
+    CHECK_EQ(pool.Allocations(), 4u);
+
+    // 设备重建：纹理属于旧设备，全部丢弃
+    pool.Clear();
+    CHECK_EQ(pool.Bytes(), 0u);
+    CHECK(!pool.At(outputs[0].key).texture);
+}
+
+TEST_CASE(SlotsAreKeyedByAdapterAndOutput) {
+    Pool pool;
+    FakeDevice device;
+    auto create = [&](uint32_t f, int w, int h) { return device.Create(f, w, h); };
+    const StagingKey a{ 1, L"\\\\.\\DISPLAY1" }, b{ 2, L"\\\\.\\DISPLAY1" }, c{ 1, L"\\\\.\\DISPLAY2" };
+
+    Pool::Slot* sa = pool.Acquire(a, kBGRA8, 64, 64, 4, create);
+    Pool::Slot* sb = pool.Acquire(b, kBGRA8, 64, 64, 4, create);
+    // 之后加入的槽位不会移动已有槽位
+    for (int i = 0; i < 32; ++i) pool.At({ 100 + static_cast<uint64_t>(i), L"x" });
+    Pool::Slot* sc = pool.Acquire(c, kBGRA8, 64, 64, 4, create);
+    CHECK(sa != sb && sa != sc && sb != sc);
+    CHECK(&pool.At(a) == sa);
+    CHECK_EQ(sa->texture.id, 1);
+    CHECK_EQ(sb->texture.id, 2);
+    CHECK_EQ(sc->texture.id, 3);
+    CHECK_EQ(pool.Allocations(), 3u);
+}
+
+TEST_CASE(CreateFailureLeavesNoTexture) {
+    Pool pool;
+    FakeDevice device;
+    const StagingKey key{ 1, L"\\\\.\\DISPLAY1" };
+    auto create = [&](uint32_t f, int w, int h) { return device.Create(f, w, h); };
+
+    pool.Acquire(key, kBGRA8, 64, 64, 4, create)->valid = true;
+    device.fail = true;
+    CHECK(pool.Acquire(key, kBGRA8, 128, 128, 4, create) == nullptr);
+    CHECK(!pool.At(key).texture);
+    CHECK(!pool.At(key).Holds({ 0, 0, 1, 1 }));
+    CHECK_EQ(pool.Bytes(), 0u);
+    CHECK_EQ(pool.Allocations(), 1u);
+
+    device.fail = false;
+    CHECK(pool.Acquire(key, kBGRA8, 32, 32, 4, create) != nullptr);
+    CHECK_EQ(pool.Allocations(), 2u);
+}
+
+TEST_MAIN()
\ No newline at end of file
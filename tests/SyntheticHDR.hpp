@@ -0,0 +1,208 @@
+#pragma once
+#include "image/ColorSpace.hpp"
+#include "image/HalfFloat.hpp"
+#include "image/ImageBuffer.hpp"
+#include "image/SharedExponent.hpp"
+#include "image/ToneMapping.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// 合成 HDR 测试画面：场景先以 Rec.2020 线性 nits 生成，再编码为采集格式
+// （RGBA_F16 = scRGB，RGBA10A2 = HDR10 PQ，RGB9E5 = 紧凑缓存）。
+// 画面自上而下分为三段：
+//   渐变 —— 中性灰 0..4000 nits 对数渐变与 Rec.2020 边界附近的饱和色相环
+//   高光 —— 5 nits 暗背景上的高斯高光点，峰值 600..10000 nits
+//   界面 —— 200 nits 白底窗口、标题栏与 1~2 像素宽的文字笔画
+namespace screenshot_tool::test {
+
+    struct SceneNits {
+        int width = 0;
+        int height = 0;
+        std::vector<float> rgb;     // Rec.2020 线性 nits，交错 RGB
+
+        float* At(int x, int y) { return &rgb[(static_cast<size_t>(y) * width + x) * 3]; }
+    };
+
+    inline void hueToRGB(float h, float& r, float& g, float& b) {
+        const float k[3] = { 5.0f, 3.0f, 1.0f };
+        float* out[3] = { &r, &g, &b };
+        for (int c = 0; c < 3; ++c) {
+            const float v = std::fmod(k[c] + h * 6.0f, 6.0f);
+            *out[c] = 1.0f - std::max(0.0f, std::min({ v, 4.0f - v, 1.0f }));
+        }
+    }
+
+    inline SceneNits MakeScene(int width, int height) {
+        SceneNits s;
+        s.width = width;
+        s.height = height;
+        s.rgb.assign(static_cast<size_t>(width) * height * 3, 0.0f);
+
+        const int gradientEnd = height / 3;
+        const int specularEnd = 2 * height / 3;
+        for (int y = 0; y < gradientEnd; ++y) {
+            const bool neutral = y < gradientEnd / 2;
+            for (int x = 0; x < width; ++x) {
+                const float t = (x + 0.5f) / width;
+                const float nits = 0.05f * std::pow(80000.0f, t);     // 0.05 .. 4000 nits
+                float* p = s.At(x, y);
+                if (neutral) {
+                    p[0] = p[1] = p[2] = nits;
+                } else {
+                    // 色相沿 y 变化，饱和度接近 Rec.2020 边界
+                    float r, g, b;
+                    hueToRGB(static_cast<float>(y - gradientEnd / 2) / std::max(1, gradientEnd - gradientEnd / 2), r, g, b);
+                    p[0] = nits * (0.02f + 0.98f * r);
+                    p[1] = nits * (0.02f + 0.98f * g);
+                    p[2] = nits * (0.02f + 0.98f * b);
+                }
+            }
+        }
+
+        for (int y = gradientEnd; y < specularEnd; ++y) {
+            for (int x = 0; x < width; ++x) {
+                float* p = s.At(x, y);
+                p[0] = p[1] = p[2] = 5.0f;
+            }
+        }
+        // 高光点：位置与峰值由简单的整数哈希决定，保证各平台一致
+        const int spots = std::max(8, width * (specularEnd - gradientEnd) / 20000);
+        for (int i = 0; i < spots; ++i) {
+            uint32_t h = static_cast<uint32_t>(i) * 2654435761u;
+            const int cx = static_cast<int>(h % static_cast<uint32_t>(width));
+            h = h * 1664525u + 1013904223u;
+            const int cy = gradientEnd + static_cast<int>(h % static_cast<uint32_t>(std::max(1, specularEnd - gradientEnd)));
+            h = h * 1664525u + 1013904223u;
+            const float peak = 600.0f + static_cast<float>(h % 9400u);
+            const float tint[3] = { 1.0f, (h >> 8) % 2 ? 0.85f : 1.0f, (h >> 9) % 2 ? 0.6f : 1.0f };
+            const int radius = 2 + static_cast<int>((h >> 12) % 6u);
+            for (int y = std::max(gradientEnd, cy - 3 * radius); y < std::min(specularEnd, cy + 3 * radius + 1); ++y) {
+                for (int x = std::max(0, cx - 3 * radius); x < std::min(width, cx + 3 * radius + 1); ++x) {
+                    const float d2 = static_cast<float>((x - cx) * (x - cx) + (y - cy) * (y - cy));
+                    const float w = std::exp(-d2 / (2.0f * radius * radius));
+                    float* p = s.At(x, y);
+                    for (int c = 0; c < 3; ++c) p[c] += peak * tint[c] * w;
+                }
+            }
+        }
+
+        for (int y = specularEnd; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                float* p = s.At(x, y);
+                p[0] = 30.0f;
+                p[1] = 34.0f;
+                p[2] = 40.0f;
+            }
+        }
+        const int panelW = std::max(64, width / 4);
+        const int panelH = std::max(24, (height - specularEnd) - 16);
+        for (int px = 8; px + panelW <= width; px += panelW + 16) {
+            const int top = specularEnd + 8;
+            for (int y = top; y < std::min(height, top + panelH); ++y) {
+                for (int x = px; x < px + panelW; ++x) {
+                    float* p = s.At(x, y);
+                    const bool title = y < top + 12;
+                    p[0] = title ? 20.0f : 200.0f;
+                    p[1] = title ? 60.0f : 200.0f;
+                    p[2] = title ? 160.0f : 200.0f;
+                    // 文字笔画：每 10 行一行字，字宽 5 像素、笔画 1~2 像素
+                    const int ly = y - top - 16;
+                    const int lx = x - px - 6;
+                    if (!title && ly >= 0 && ly % 10 < 7 && lx >= 0 && lx % 7 < 5) {
+                        const int gx = lx % 7;
+                        const int gy = ly % 10;
+                        const uint32_t glyph = static_cast<uint32_t>(lx / 7 * 31 + ly / 10 * 17) * 2246822519u;
+                        if (gx == 0 || gy == 0 || (glyph >> (gx + gy * 3)) & 1u) {
+                            p[0] = p[1] = p[2] = 2.0f;
+                        }
+                    }
+                }
+            }
+        }
+        return s;
+    }
+
+    // 亮度已知的中性灰画面：每行相同，亮度沿 x 在 [minNits, maxNits] 内按对数均匀分布，
+    // 因此第 p 百分位的亮度为 RampPercentileNits(minNits, maxNits, p)
+    inline SceneNits MakeLuminanceRamp(int width, int height, float minNits, float maxNits) {
+        SceneNits s;
+        s.width = width;
+        s.height = height;
+        s.rgb.resize(static_cast<size_t>(width) * height * 3);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const float t = (x + 0.5f) / width;
+                float* p = s.At(x, y);
+                p[0] = p[1] = p[2] = minNits * std::pow(maxNits / minNits, t);
+            }
+        }
+        return s;
+    }
+
+    inline float RampPercentileNits(float minNits, float maxNits, float percent) {
+        return minNits * std::pow(maxNits / minNits, percent / 100.0f);
+    }
+
+    // Rec.2020 nits -> 指定采集格式
+    inline ImageBuffer EncodeScene(const SceneNits& s, PixelFormat fmt) {
+        ImageBuffer buf;
+        buf.format = fmt;
+        buf.width = s.width;
+        buf.height = s.height;
+        buf.stride = s.width * BytesPerPixel(fmt);
+        buf.data.resize(static_cast<size_t>(buf.stride) * s.height);
+        const size_t pixels = static_cast<size_t>(s.width) * s.height;
+
+        if (fmt == PixelFormat::RGBA10A2) {
+            auto* dst = reinterpret_cast<uint32_t*>(buf.data.data());
+            for (size_t i = 0; i < pixels; ++i) {
+                uint32_t code[3];
+                for (int c = 0; c < 3; ++c) {
+                    code[c] = static_cast<uint32_t>(std::lround(LinearToPQ(std::max(s.rgb[i * 3 + c], 0.0f)) * 1023.0f));
+                }
+                dst[i] = (3u << 30) | (code[0] << 20) | (code[1] << 10) | code[2];
+            }
+            return buf;
+        }
+
+        // scRGB：Rec.709 原色，1.0 = 80 nits（色域外为负值）
+        std::vector<uint16_t> half(pixels * 4);
+        std::vector<float> rgb(s.rgb);
+        ColorSpace::ConvertGamutN(ColorGamut::Rec2020, ColorGamut::Rec709, rgb.data(), static_cast<int>(pixels));
+        for (size_t i = 0; i < pixels; ++i) {
+            for (int c = 0; c < 3; ++c) half[i * 4 + c] = FloatToHalf(rgb[i * 3 + c] / 80.0f);
+            half[i * 4 + 3] = FloatToHalf(1.0f);
+        }
+        if (fmt == PixelFormat::RGBA_F16) {
+            std::memcpy(buf.data.data(), half.data(), buf.data.size());
+        } else {
+            PackHalfToRGB9E5N(half.data(), reinterpret_cast<uint32_t*>(buf.data.data()), static_cast<int>(pixels));
+        }
+        return buf;
+    }
+
+    // SDR 桌面（BGRA8）：200 nits 映射为白色，钳制后 sRGB 编码
+    inline ImageBuffer EncodeSceneSDR(const SceneNits& s) {
+        ImageBuffer buf;
+        buf.format = PixelFormat::BGRA8;
+        buf.width = s.width;
+        buf.height = s.height;
+        buf.stride = s.width * 4;
+        buf.data.resize(static_cast<size_t>(buf.stride) * s.height);
+        const size_t pixels = static_cast<size_t>(s.width) * s.height;
+        std::vector<float> rgb(s.rgb);
+        ColorSpace::ConvertGamutN(ColorGamut::Rec2020, ColorGamut::Rec709, rgb.data(), static_cast<int>(pixels));
+        for (size_t i = 0; i < pixels; ++i) {
+            for (int c = 0; c < 3; ++c) {
+                const float v = LinearToSRGB(std::clamp(rgb[i * 3 + c] / 200.0f, 0.0f, 1.0f));
+                buf.data[i * 4 + 2 - c] = static_cast<uint8_t>(std::lround(v * 255.0f));
+            }
+            buf.data[i * 4 + 3] = 255;
+        }
+        return buf;
+    }
+
+} // namespace screenshot_tool::test
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+#include "util/Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 极简测试框架：每个测试文件编译为一个可执行程序，由 ctest 运行，返回非 0 表示失败。
+// 不依赖第三方库，任何能编译 screenshot_core 的工具链都能构建。
+//   TEST_CASE(name) { CHECK(...); }   注册一个用例
+//   <exe> [--quick] [--verbose] [filter]
+//     --quick：基准只跑最小规模（ctest 默认）；--verbose：保留被测代码的 Debug/Info 日志；
+//     filter：只运行名称包含该串的用例
+namespace screenshot_tool::test {
+
+    struct Case {
+        const char* name;
+        void (*fn)();
+    };
+
+    inline std::vector<Case>& Registry() {
+        static std::vector<Case> cases;
+        return cases;
+    }
+
+    inline int& Failures() {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool& QuickMode() {
+        static bool quick = false;
+        return quick;
+    }
+
+    inline bool& Verbose() {
+        static bool verbose = false;
+        return verbose;
+    }
+
+    struct Registrar {
+        Registrar(const char* name, void (*fn)()) { Registry().push_back({ name, fn }); }
+    };
+
+    inline void Fail(const char* file, int line, const std::string& what) {
+        std::fprintf(stderr, "%s:%d: %s\n", file, line, what.c_str());
+        ++Failures();
+    }
+
+    inline int RunAll(int argc, char** argv) {
+        const char* filter = nullptr;
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--quick") == 0) {
+                QuickMode() = true;
+            } else if (std::strcmp(argv[i], "--verbose") == 0) {
+                Verbose() = true;
+            } else {
+                filter = argv[i];
+            }
+        }
+        if (!Verbose()) Logger::SetLevel(LogLevel::Warn);
+
+        int failedCases = 0;
+        for (const auto& c : Registry()) {
+            if (filter && !std::strstr(c.name, filter)) continue;
+            const int before = Failures();
+            c.fn();
+            const bool ok = Failures() == before;
+            if (!ok) ++failedCases;
+            std::printf("[%s] %s\n", ok ? " OK " : "FAIL", c.name);
+        }
+        std::printf("%d case(s) failed\n", failedCases);
+        return failedCases == 0 ? 0 : 1;
+    }
+
+    // 基准计时：重复 repeats 次取最短耗时（毫秒），减少调度噪声
+    template<class Fn>
+    double BestOfMs(int repeats, Fn&& fn) {
+        double best = 1e300;
+        for (int i = 0; i < repeats; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // 按 "名称  MP/s  ns/px" 格式输出一行吞吐量
+    inline void ReportThroughput(const std::string& name, double pixels, double ms) {
+        const double mpps = ms > 0.0 ? pixels / (ms * 1000.0) : 0.0;
+        const double nsPerPixel = pixels > 0.0 ? ms * 1e6 / pixels : 0.0;
+        std::printf("  %-48s %9.2f ms %9.1f MP/s %8.2f ns/px\n", name.c_str(), ms, mpps, nsPerPixel);
+    }
+
+} // namespace screenshot_tool::test
+
+#define TEST_CASE(name)                                                                     \
+    static void name();                                                                     \
+    static ::screenshot_tool::test::Registrar name##_registrar(#name, &name);                \
+    static void name()
+
+#define CHECK(cond)                                                                         \
+    do {                                                                                    \
+        if (!(cond)) ::screenshot_tool::test::Fail(__FILE__, __LINE__, "CHECK(" #cond ") failed"); \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                      \
+    do {                                                                                    \
+        const auto va_ = (a);                                                               \
+        const auto vb_ = (b);                                                               \
+        if (!(va_ == vb_)) {                                                                \
+            ::screenshot_tool::test::Fail(__FILE__, __LINE__, "CHECK_EQ(" #a ", " #b ") failed: " + \
+                std::to_string(va_) + " != " + std::to_string(vb_));                        \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tol)                                                               \
+    do {                                                                                    \
+        const double va_ = static_cast<double>(a);                                          \
+        const double vb_ = static_cast<double>(b);                                          \
+        if (!(std::fabs(va_ - vb_) <= (tol))) {                                             \
+            ::screenshot_tool::test::Fail(__FILE__, __LINE__, "CHECK_NEAR(" #a ", " #b ", " #tol ") failed: " + \
+                std::to_string(va_) + " vs " + std::to_string(vb_));                        \
+        }                                                                                   \
+    } while (0)
+
+#define TEST_MAIN() int main(int argc, char** argv) { return ::screenshot_tool::test::RunAll(argc, argv); }
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/PixelConvert.hpp"
+#include "image/TiledImage.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 冻结帧缓存：按外接矩形分配的稠密缓冲区与按显示器分块的 TiledImage 对比内存与耗时。
+// 布局为错位 / L 形的 HDR（FP16）+ SDR（BGRA8）双屏；稠密缓冲区因混合格式整块为 FP16，
+// 计时包括拼装（SDR 展开为 FP16、空洞清零）、全零检查、自动曝光和整个范围的 sRGB8 转换
+using namespace screenshot_tool;
+
+namespace {
+
+    struct Monitor {
+        int left, top, width, height;
+        bool hdr;
+    };
+
+    struct Layout {
+        const char* name;
+        std::vector<Monitor> monitors;
+    };
+
+    // 完整尺寸：4K HDR 主屏 + 1440p SDR 副屏；快速模式按 1/8 缩小
+    std::vector<Layout> layouts() {
+        const int s = test::QuickMode() ? 8 : 1;
+        return {
+            { "L-shaped (4K HDR + 1440p SDR below right)", { { 0, 0, 3840 / s, 2160 / s, true }, { 3840 / s, 2160 / s, 2560 / s, 1440 / s, false } } },
+            { "staggered (1440p SDR left, 4K HDR raised)", { { 0, 720 / s, 2560 / s, 1440 / s, false }, { 2560 / s, 0, 3840 / s, 2160 / s, true } } },
+            { "L-shaped, three (2x 1440p SDR + 4K HDR)", { { 0, 0, 2560 / s, 1440 / s, false }, { 0, 1440 / s, 2560 / s, 1440 / s, false },
+                                                             { 2560 / s, 2880 / s - 2160 / s, 3840 / s, 2160 / s, true } } },
+        };
+    }
+
+    ToneMapParams paramsFor(const Monitor& m) {
+        ToneMapParams p;
+        p.hdr = m.hdr;
+        p.maxNits = m.hdr ? 1000.0f : 200.0f;
+        return p;
+    }
+
+    // 每个显示器的原生帧（HDR 为 scRGB FP16，SDR 为 BGRA8），内容为合成画面
+    std::vector<ImageBuffer> makeFrames(const Layout& layout) {
+        std::vector<ImageBuffer> frames;
+        for (const Monitor& m : layout.monitors) {
+            const auto scene = test::MakeScene(m.width, m.height);
+            frames.push_back(m.hdr ? test::EncodeScene(scene, PixelFormat::RGBA_F16) : test::EncodeSceneSDR(scene));
+        }
+        return frames;
+    }
+
+    struct Bounds {
+        int left = 0, top = 0, right = 0, bottom = 0;
+        int Width() const { return right - left; }
+        int Height() const { return bottom - top; }
+    };
+
+    Bounds boundsOf(const Layout& layout) {
+        Bounds b{ layout.monitors[0].left, layout.monitors[0].top, layout.monitors[0].left, layout.monitors[0].top };
+        for (const Monitor& m : layout.monitors) {
+            b.left = std::min(b.left, m.left);
+            b.top = std::min(b.top, m.top);
+            b.right = std::max(b.right, m.left + m.width);
+            b.bottom = std::max(b.bottom, m.top + m.height);
+        }
+        return b;
+    }
+
+    // 原先的做法：外接矩形一整块 FP16，SDR 输出展开，空洞为零，按区域表分别色调映射
+    bool denseConvert(const Layout& layout, const std::vector<ImageBuffer>& frames, const Config& config,
+        ImageBuffer& out, size_t& bytes) {
+        const Bounds b = boundsOf(layout);
+        ImageBuffer dense;
+        dense.format = PixelFormat::RGBA_F16;
+        dense.width = b.Width();
+        dense.height = b.Height();
+        dense.stride = dense.width * 8;
+        dense.data.assign(static_cast<size_t>(dense.stride) * dense.height, 0);
+        bytes = dense.data.size();
+
+        ToneMapRegions regions;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const Monitor& m = layout.monitors[i];
+            const ImageBuffer& f = frames[i];
+            for (int y = 0; y < m.height; ++y) {
+                uint8_t* dst = dense.data.data() + static_cast<size_t>(m.top - b.top + y) * dense.stride + static_cast<size_t>(m.left - b.left) * 8;
+                const uint8_t* src = f.data.data() + static_cast<size_t>(y) * f.stride;
+                if (f.format == PixelFormat::BGRA8) {
+                    PixelConvert::WidenBGRA8ToF16(src, reinterpret_cast<uint16_t*>(dst), m.width);
+                } else {
+                    std::memcpy(dst, src, static_cast<size_t>(m.width) * 8);
+                }
+            }
+            regions.AddRegion(m.left, m.top, m.left + m.width, m.top + m.height, paramsFor(m));
+        }
+        regions.Build(b.left, b.top, b.Width(), b.Height());
+
+        // CaptureRegion 原先对整个缓冲区（含空洞）做全零检查
+        if (std::all_of(dense.data.begin(), dense.data.end(), [](uint8_t v) { return v == 0; })) return false;
+        PixelConvert::ApplyAutoExposure(dense.format, dense, regions, &config);
+        if (!PixelConvert::ToSRGB8(dense.format, dense, regions, &config)) return false;
+        out = std::move(dense);
+        return true;
+    }
+
+    // 现在的做法：每个显示器一块，保持原生格式，按块自动曝光，取区域时由覆盖它的块拼接
+    bool tiledConvert(const Layout& layout, const std::vector<ImageBuffer>& frames, const Config& config,
+        ImageBuffer& out, size_t& bytes) {
+        const Bounds b = boundsOf(layout);
+        TiledImage tiled;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const Monitor& m = layout.monitors[i];
+            tiled.AddTile(m.left, m.top, frames[i], paramsFor(m));
+        }
+        bytes = tiled.RawBytes();
+        tiled.ApplyAutoExposure(&config);
+        return tiled.ToSRGB8(b.left, b.top, b.Width(), b.Height(), out, &config);
+    }
+
+    int maxDifference(const ImageBuffer& a, const ImageBuffer& b) {
+        if (a.data.size() != b.data.size()) return 256;
+        int worst = 0;
+        for (size_t i = 0; i < a.data.size(); ++i) worst = std::max(worst, std::abs(int(a.data[i]) - int(b.data[i])));
+        return worst;
+    }
+
+} // namespace
+
+TEST_CASE(BenchmarkLShapedLayouts) {
+    const int repeats = test::QuickMode() ? 1 : 3;
+    Config analytic;
+    Config autoExposure;
+    autoExposure.autoExposure = true;
+
+    for (const Layout& layout : layouts()) {
+        const auto frames = makeFrames(layout);
+        const Bounds b = boundsOf(layout);
+        std::printf("  %s, bounding box %dx%d\n", layout.name, b.Width(), b.Height());
+
+        for (const Config* config : { &analytic, &autoExposure }) {
+            const char* label = config->autoExposure ? "auto exposure" : "fixed exposure";
+            ImageBuffer dense, tiled;
+            size_t denseBytes = 0, tiledBytes = 0;
+            // 预热（静态表、线程池）
+            CHECK(denseConvert(layout, frames, *config, dense, denseBytes));
+            CHECK(tiledConvert(layout, frames, *config, tiled, tiledBytes));
+            const double denseMs = test::BestOfMs(repeats, [&] { CHECK(denseConvert(layout, frames, *config, dense, denseBytes)); });
+            const double tiledMs = test::BestOfMs(repeats, [&] { CHECK(tiledConvert(layout, frames, *config, tiled, tiledBytes)); });
+
+            const double pixels = static_cast<double>(b.Width()) * b.Height();
+            test::ReportThroughput(std::string("dense ") + label, pixels, denseMs);
+            test::ReportThroughput(std::string("tiled ") + label, pixels, tiledMs);
+            std::printf("  %-48s %9.1f MB -> %.1f MB (%.0f%%)\n", "cache memory", denseBytes / 1048576.0, tiledBytes / 1048576.0,
+                100.0 * static_cast<double>(tiledBytes) / static_cast<double>(denseBytes));
+
+            // 分块只保存显示器矩形且保持原生格式，内存必然更小。固定曝光时两种做法的输出只差舍入；
+            // 自动曝光按行抽样，块不从外接矩形的抽样行开始时曝光略有不同，不做比较
+            CHECK(tiledBytes < denseBytes);
+            if (!config->autoExposure) {
+                const int diff = maxDifference(dense, tiled);
+                if (diff > 1) std::printf("  max difference %d\n", diff);
+                CHECK(diff <= 1);
+            }
+        }
+    }
+}
+
+TEST_MAIN()
+
+TEST_CASE(CropMatchesFullFrameExactly) {
+    // 选区直接从块存储转换，与从整帧（overlay 背景）裁剪逐字节相同：抖动按虚拟桌面坐标定位，与转换范围无关。
+    // 布局整体平移到负坐标且不与抖动平铺对齐
+    Config config;
+    for (const Layout& base : layouts()) {
+        Layout layout = base;
+        for (Monitor& m : layout.monitors) {
+            m.left -= 1931;
+            m.top -= 77;
+        }
+        const auto frames = makeFrames(layout);
+        const Bounds b = boundsOf(layout);
+        TiledImage tiled;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            const Monitor& m = layout.monitors[i];
+            tiled.AddTile(m.left, m.top, frames[i], paramsFor(m));
+        }
+        ImageBuffer full;
+        CHECK(tiled.ToSRGB8(b.left, b.top, b.Width(), b.Height(), full, &config));
+
+        const int w = b.Width(), h = b.Height();
+        const Bounds crops[] = {
+            { b.left + 1, b.top + 3, b.left + w / 3, b.top + h / 5 },
+            { b.left + w / 2 - 17, b.top + h / 2 - 9, b.left + w / 2 + 23, b.top + h / 2 + 31 },   // 跨越显示器边界
+            { b.right - 5, b.bottom - 7, b.right, b.bottom },
+            { b.left + 63, b.top + 65, b.left + 64, b.top + 66 },
+        };
+        for (const Bounds& c : crops) {
+            ImageBuffer crop;
+            if (!tiled.ToSRGB8(c.left, c.top, c.Width(), c.Height(), crop, &config)) continue;   // 整个落在空洞中
+            int mismatches = 0;
+            for (int y = 0; y < c.Height(); ++y) {
+                const uint8_t* fromFull = full.data.data() + static_cast<size_t>(c.top - b.top + y) * full.stride +
+                    static_cast<size_t>(c.left - b.left) * 3;
+                if (std::memcmp(fromFull, crop.data.data() + static_cast<size_t>(y) * crop.stride, static_cast<size_t>(c.Width()) * 3) != 0) {
+                    ++mismatches;
+                }
+            }
+            CHECK_EQ(mismatches, 0);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "TestUtil.hpp"
+#include "SyntheticHDR.hpp"
+#include "image/PixelConvert.hpp"
+#include <string>
+#include <vector>
+
+// 色调映射算子 × 采集格式 × 分辨率 的吞吐量矩阵（解析内核，不使用 3D LUT），
+// 以及各算子在中性灰渐变上的基本性质
+using namespace screenshot_tool;
+
+namespace {
+
+    const char* const OPERATORS[] = { "reinhard", "reinhardextended", "aces", "hable", "bt2390", "agx" };
+
+    struct Format {
+        const char* name;
+        PixelFormat format;
+    };
+    const Format FORMATS[] = {
+        { "scRGB FP16", PixelFormat::RGBA_F16 },
+        { "HDR10", PixelFormat::RGBA10A2 },
+        { "RGB9E5", PixelFormat::RGB9E5 },
+    };
+
+    Config analyticConfig(const char* op, bool dither) {
+        Config config;
+        config.toneMapper = op;
+        config.colorLutSize = 0;
+        config.dither = dither;
+        return config;
+    }
+
+    ToneMapParams hdrParams() {
+        ToneMapParams params;
+        params.hdr = true;
+        params.maxNits = 1000.0f;
+        return params;
+    }
+
+} // namespace
+
+TEST_CASE(NeutralRampIsMonotonic) {
+    // 中性灰渐变行（场景第 0 行）：输出单调不减、三通道相等，暗端接近黑、亮端接近白
+    const test::SceneNits scene = test::MakeScene(1024, 12);
+    for (const char* op : OPERATORS) {
+        const Config config = analyticConfig(op, false);
+        for (const auto& f : FORMATS) {
+            ImageBuffer buf = test::EncodeScene(scene, f.format);
+            CHECK(PixelConvert::ToSRGB8(f.format, buf, ToneMapRegions::Uniform(hdrParams(), buf.width, buf.height), &config));
+            CHECK(buf.format == PixelFormat::RGB8);
+            int previous = 0;
+            int violations = 0;
+            int grayErrors = 0;
+            for (int x = 0; x < buf.width; ++x) {
+                const uint8_t* p = &buf.data[x * 3];
+                violations += p[1] + 1 < previous;     // 量化误差允许 1 个码值
+                grayErrors += std::abs(p[0] - p[1]) > 1 || std::abs(p[2] - p[1]) > 1;
+                previous = std::max(previous, static_cast<int>(p[1]));
+            }
+            if (violations || grayErrors) std::printf("  %s / %s: %d non-monotonic, %d non-gray\n", op, f.name, violations, grayErrors);
+            CHECK_EQ(violations, 0);
+            CHECK_EQ(grayErrors, 0);
+            CHECK(buf.data[1] <= 8);
+            CHECK(buf.data[(buf.width - 1) * 3 + 1] >= 200);
+        }
+    }
+}
+
+TEST_CASE(BenchmarkOperatorMatrix) {
+    struct Size {
+        const char* name;
+        int width;
+        int height;
+    };
+    std::vector<Size> sizes;
+    if (test::QuickMode()) {
+        sizes.push_back({ "480x270", 480, 270 });
+    } else {
+        sizes.push_back({ "1080p", 1920, 1080 });
+        sizes.push_back({ "4K", 3840, 2160 });
+        sizes.push_back({ "8K", 7680, 4320 });
+    }
+
+    std::printf("  ToSRGB8 analytic kernels (operator x format x resolution)\n");
+    for (const auto& size : sizes) {
+        const test::SceneNits scene = test::MakeScene(size.width, size.height);
+        const auto regions = ToneMapRegions::Uniform(hdrParams(), size.width, size.height);
+        for (const auto& f : FORMATS) {
+            const ImageBuffer source = test::EncodeScene(scene, f.format);
+            for (const char* op : OPERATORS) {
+                const Config config = analyticConfig(op, true);
+                ImageBuffer buf;
+                bool ok = true;
+                const double ms = test::BestOfMs(test::QuickMode() ? 1 : 3, [&] {
+                    buf = source;
+                    ok &= PixelConvert::ToSRGB8(f.format, buf, regions, &config);
+                });
+                CHECK(ok);
+                test::ReportThroughput(std::string(size.name) + " " + f.name + " " + op,
+                    static_cast<double>(size.width) * size.height, ms);
+            }
+        }
+    }
+}
+
+TEST_MAIN()
\ No newline at end of file
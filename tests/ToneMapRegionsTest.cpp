@@ -0,0 +1,169 @@
+#include "TestUtil.hpp"
+#include "image/ToneMapRegions.hpp"
+#include <random>
+#include <vector>
+
+// 区域查找表：按行分带的区间与逐像素“先登记的区域优先、否则默认参数”的参考结果逐像素比较，
+// 覆盖空区域集、重叠区域、超出缓冲区边缘与完全在外的区域，以及带 / 区间的结构约束
+using namespace screenshot_tool;
+
+namespace {
+
+    // 参数以 maxNits 区分，便于与参考结果比较而不依赖下标
+    struct Rect {
+        int left, top, right, bottom;
+        float nits;
+    };
+
+    ToneMapParams paramsWith(float nits) {
+        ToneMapParams params;
+        params.hdr = true;
+        params.maxNits = nits;
+        return params;
+    }
+
+    constexpr float DEFAULT_NITS = 80.0f;
+
+    ToneMapRegions build(const std::vector<Rect>& rects, int left, int top, int width, int height) {
+        ToneMapRegions regions;
+        regions.SetDefault(paramsWith(DEFAULT_NITS));
+        for (const Rect& r : rects) regions.AddRegion(r.left, r.top, r.right, r.bottom, paramsWith(r.nits));
+        regions.Build(left, top, width, height);
+        return regions;
+    }
+
+    float referenceNits(const std::vector<Rect>& rects, int x, int y) {
+        for (const Rect& r : rects) {
+            if (r.right > r.left && r.bottom > r.top && x >= r.left && x < r.right && y >= r.top && y < r.bottom) return r.nits;
+        }
+        return DEFAULT_NITS;
+    }
+
+    // 带连续覆盖 [0, height)，每带的区间连续覆盖 [0, width) 且相邻区间参数不同；逐像素与参考一致
+    int countMismatches(const ToneMapRegions& regions, const std::vector<Rect>& rects, int left, int top, int width, int height) {
+        int mismatches = 0;
+        const auto& bands = regions.Bands();
+        int y = 0;
+        for (const auto& band : bands) {
+            mismatches += band.y0 != y || band.y1 <= band.y0;
+            const ToneMapRegions::Span* spans = regions.Spans(band);
+            int x = 0;
+            for (uint32_t i = 0; i < band.spanCount; ++i) {
+                mismatches += spans[i].x0 != x || spans[i].x1 <= spans[i].x0;
+                mismatches += i > 0 && spans[i].param == spans[i - 1].param;
+                mismatches += spans[i].param >= regions.ParamCount();
+                x = spans[i].x1;
+            }
+            mismatches += x != width;
+            y = band.y1;
+        }
+        mismatches += y != height;
+        if (mismatches) return mismatches;
+
+        for (int py = 0; py < height; ++py) {
+            const auto& band = regions.BandAt(py);
+            mismatches += py < band.y0 || py >= band.y1;
+            const ToneMapRegions::Span* spans = regions.Spans(band);
+            for (uint32_t i = 0; i < band.spanCount; ++i) {
+                for (int px = spans[i].x0; px < spans[i].x1; ++px) {
+                    const float expected = referenceNits(rects, left + px, top + py);
+                    if (regions.Params(spans[i].param).maxNits != expected) {
+                        if (mismatches < 8) {
+                            std::printf("  (%d, %d): %.0f nits, expected %.0f\n", px, py,
+                                regions.Params(spans[i].param).maxNits, expected);
+                        }
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+        return mismatches;
+    }
+
+} // namespace
+
+TEST_CASE(EmptyRegionSetUsesDefault) {
+    const auto regions = build({}, 0, 0, 64, 48);
+    CHECK(regions.Matches(64, 48));
+    CHECK(!regions.Matches(64, 47));
+    CHECK_EQ(regions.ParamCount(), 1u);
+    CHECK_EQ(regions.Bands().size(), 1u);
+    CHECK_EQ(regions.Bands()[0].spanCount, 1u);
+    CHECK_EQ(countMismatches(regions, {}, 0, 0, 64, 48), 0);
+
+    const auto uniform = ToneMapRegions::Uniform(paramsWith(400.0f), 10, 3);
+    CHECK(uniform.Matches(10, 3) && uniform.AnyHDR());
+    CHECK_EQ(uniform.Params(uniform.Spans(uniform.BandAt(2))[0].param).maxNits, 400.0f);
+
+    // 空矩形不登记；空缓冲区不生成查找表
+    ToneMapRegions degenerate;
+    degenerate.AddRegion(10, 10, 10, 20, paramsWith(100.0f));
+    degenerate.AddRegion(10, 20, 30, 5, paramsWith(100.0f));
+    CHECK_EQ(degenerate.ParamCount(), 1u);
+    CHECK(!degenerate.AnyHDR());
+    degenerate.Build(0, 0, 0, 10);
+    CHECK(!degenerate.Matches(0, 10));
+    CHECK(degenerate.Bands().empty());
+}
+
+TEST_CASE(OverlappingRegionsFirstWins) {
+    // 两个显示器区域部分重叠，另一个完全包含在第一个之内：重叠部分取先登记的区域
+    const std::vector<Rect> rects = {
+        { 0, 0, 60, 40, 1000.0f },
+        { 40, 20, 100, 80, 600.0f },
+        { 10, 10, 30, 30, 300.0f },     // 被第一个区域完全遮住
+        { 70, 0, 100, 30, 1000.0f },    // 与第一个参数相同但不相邻
+    };
+    const auto regions = build(rects, 0, 0, 100, 80);
+    CHECK_EQ(countMismatches(regions, rects, 0, 0, 100, 80), 0);
+    CHECK_EQ(regions.Params(regions.Spans(regions.BandAt(15))[0].param).maxNits, 1000.0f);
+
+    // 同一区域被遮住部分两侧的区间合并：第二个区域与第一个重叠的行内，第一个区域仍只有一个区间
+    const std::vector<Rect> covered = { { 0, 0, 100, 20, 500.0f }, { 40, 10, 60, 30, 700.0f } };
+    const auto merged = build(covered, 0, 0, 100, 30);
+    CHECK_EQ(countMismatches(merged, covered, 0, 0, 100, 30), 0);
+    CHECK_EQ(merged.Bands().size(), 3u);
+    CHECK_EQ(merged.BandAt(15).spanCount, 1u);
+    CHECK_EQ(merged.BandAt(25).spanCount, 3u);
+}
+
+TEST_CASE(RegionsClippedAtBufferEdges) {
+    // 虚拟桌面原点为负（主显示器右侧以外有副屏），缓冲区只截取其中一部分
+    const std::vector<Rect> rects = {
+        { -1920, -200, 0, 880, 400.0f },    // 左侧显示器，上下都超出缓冲区
+        { 0, 0, 2560, 1440, 1000.0f },      // 主显示器，右下超出
+        { 3000, 0, 4000, 100, 200.0f },     // 完全在缓冲区右侧
+        { -500, -300, -400, -10, 250.0f },  // 完全在缓冲区上方
+    };
+    const int left = -100, top = -50, width = 300, height = 200;
+    const auto regions = build(rects, left, top, width, height);
+    CHECK_EQ(countMismatches(regions, rects, left, top, width, height), 0);
+    CHECK(regions.Matches(width, height));
+
+    // 缓冲区左上角落在主显示器上方的空洞：默认参数
+    CHECK_EQ(regions.Params(regions.Spans(regions.BandAt(0))[regions.BandAt(0).spanCount - 1].param).maxNits, DEFAULT_NITS);
+
+    // 越界查询：负行落在第一带，超出高度落在最后一带
+    CHECK(&regions.BandAt(height + 5) == &regions.Bands().back());
+    CHECK(&regions.BandAt(-1) == &regions.Bands().front());
+}
+
+TEST_CASE(RandomLayoutsMatchReference) {
+    std::mt19937 rng(28u);
+    const int layouts = test::QuickMode() ? 200 : 2000;
+    int mismatches = 0;
+    for (int n = 0; n < layouts; ++n) {
+        std::uniform_int_distribution<int> coord(-80, 200);
+        std::vector<Rect> rects(rng() % 6);
+        for (size_t i = 0; i < rects.size(); ++i) {
+            const int a = coord(rng), b = coord(rng), c = coord(rng), d = coord(rng);
+            rects[i] = { std::min(a, b), std::min(c, d), std::max(a, b), std::max(c, d), 100.0f * (i + 2) };
+        }
+        const int left = coord(rng) / 2, top = coord(rng) / 2;
+        const int width = 1 + static_cast<int>(rng() % 120), height = 1 + static_cast<int>(rng() % 120);
+        mismatches += countMismatches(build(rects, left, top, width, height), rects, left, top, width, height);
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST_MAIN()
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "TestUtil.hpp"
+#include "util/Trace.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <latch>
+#include <sstream>
+#include <thread>
+
+// 阶段追踪：环形缓冲区回绕后只保留最近的事件、截图序号随 BeginCapture / EndCapture 推进、
+// 快照按开始时间排序，以及多线程写入（含写入期间并发快照）时事件不丢失、不撕裂。
+// 全局状态在用例之间共享，各用例用自己的阶段名过滤快照
+using namespace screenshot_tool;
+
+namespace {
+
+    constexpr uint64_t PAYLOAD_KEY = 0x9E3779B97F4A7C15ull;     // durationNs = startNs ^ KEY，用于识别撕裂的事件
+
+    std::vector<Trace::Event> eventsNamed(const char* name) {
+        std::vector<Trace::Event> out;
+        for (const auto& e : Trace::Snapshot()) {
+            if (e.name == name) out.push_back(e);
+        }
+        return out;
+    }
+
+    void recordTagged(const char* name, uint64_t start) {
+        Trace::Record(name, start, start ^ PAYLOAD_KEY);
+    }
+
+    bool isSorted(const std::vector<Trace::Event>& events) {
+        for (size_t i = 1; i < events.size(); ++i) {
+            if (events[i - 1].startNs > events[i].startNs) return false;
+        }
+        return true;
+    }
+
+} // namespace
+
+TEST_CASE(RingKeepsMostRecentAfterWraparound) {
+    static const char* const NAME = "wraparound";
+    constexpr uint64_t EXTRA = 100;
+    std::thread writer([] {
+        for (uint64_t i = 0; i < Trace::RING_CAPACITY + EXTRA; ++i) recordTagged(NAME, 1000 + i);
+    });
+    writer.join();
+
+    // 回绕后最旧的槽位视为可能正被覆盖，不计入快照
+    const auto events = eventsNamed(NAME);
+    CHECK_EQ(events.size(), Trace::RING_CAPACITY - 1);
+    if (events.size() != Trace::RING_CAPACITY - 1) return;
+    for (size_t i = 0; i < events.size(); ++i) {
+        CHECK_EQ(events[i].startNs, 1000 + EXTRA + 1 + i);
+        CHECK_EQ(events[i].durationNs, events[i].startNs ^ PAYLOAD_KEY);
+        CHECK_EQ(events[i].threadId, events[0].threadId);
+    }
+}
+
+TEST_CASE(CaptureIdsFollowBeginAndEnd) {
+    static const char* const NAME = "capture stage";
+    Trace::SetEnabled(true);
+    const auto jsonPath = std::filesystem::temp_directory_path() /
+        ("screenshot_trace_test_" + std::to_string(Trace::NowNs()) + ".json");
+    Trace::SetOutputFile(jsonPath);
+
+    uint32_t ids[2] = {};
+    for (uint32_t& id : ids) {
+        Trace::BeginCapture();
+        { TraceScope scope(NAME); }
+        { TraceScope scope(NAME); }
+        Trace::EndCapture(L"test");
+        const auto events = eventsNamed(NAME);
+        CHECK(!events.empty());
+        if (!events.empty()) id = events.back().captureId;
+    }
+    Trace::SetOutputFile({});
+
+    // 每次截图的事件都带本次序号，序号逐次加一
+    CHECK(ids[0] != 0);
+    CHECK_EQ(ids[1], ids[0] + 1);
+    const auto events = eventsNamed(NAME);
+    CHECK_EQ(events.size(), 4u);
+    CHECK(isSorted(events));
+    if (events.size() == 4) {
+        CHECK_EQ(events[0].captureId, ids[0]);
+        CHECK_EQ(events[1].captureId, ids[0]);
+        CHECK_EQ(events[2].captureId, ids[1]);
+        CHECK_EQ(events[3].captureId, ids[1]);
+        CHECK(events[1].startNs >= events[0].startNs + events[0].durationNs);
+    }
+
+    // EndCapture 导出 Chrome trace JSON
+    std::ifstream file(jsonPath, std::ios::binary);
+    std::ostringstream json;
+    json << file.rdbuf();
+    file.close();
+    CHECK(json.str().starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    CHECK(json.str().find("\"name\":\"capture stage\"") != std::string::npos);
+    CHECK(json.str().ends_with("\n]}\n"));
+    std::filesystem::remove(jsonPath);
+
+    // 关闭后 TraceScope 不记录
+    Trace::SetEnabled(false);
+    { TraceScope scope(NAME); }
+    CHECK_EQ(eventsNamed(NAME).size(), 4u);
+}
+
+TEST_CASE(ConcurrentWritersKeepEveryEvent) {
+    static const char* const NAME = "concurrent";
+    constexpr int THREADS = 8;
+    const uint64_t perThread = test::QuickMode() ? 1000 : 4000;    // 不超过环容量，全部保留
+    // 线程退出后环形缓冲区归还复用，写完后等所有线程都写完再退出，各自占用一个缓冲区
+    std::latch done(THREADS);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t) {
+        writers.emplace_back([t, perThread, &done] {
+            for (uint64_t i = 0; i < perThread; ++i) recordTagged(NAME, (i << 8) | t);
+            done.arrive_and_wait();
+        });
+    }
+    for (auto& w : writers) w.join();
+
+    const auto events = eventsNamed(NAME);
+    CHECK_EQ(events.size(), THREADS * perThread);
+    CHECK(isSorted(events));
+
+    // 同一写线程的事件共用一个线程序号，各线程序号互不相同，且每个事件恰好出现一次
+    std::vector<uint32_t> threadIds(THREADS, 0);
+    std::vector<uint8_t> seen(THREADS * perThread, 0);
+    bool consistent = true;
+    for (const auto& e : events) {
+        const int t = static_cast<int>(e.startNs & 0xFF);
+        const uint64_t i = e.startNs >> 8;
+        if (t >= THREADS || i >= perThread || e.durationNs != (e.startNs ^ PAYLOAD_KEY)) {
+            consistent = false;
+            continue;
+        }
+        if (threadIds[t] == 0) threadIds[t] = e.threadId;
+        consistent &= threadIds[t] == e.threadId;
+        consistent &= ++seen[i * THREADS + t] == 1;
+    }
+    CHECK(consistent);
+    std::sort(threadIds.begin(), threadIds.end());
+    CHECK(std::adjacent_find(threadIds.begin(), threadIds.end()) == threadIds.end());
+}
+
+TEST_CASE(SnapshotDuringWritesDropsOverwrittenSlots) {
+    // 写线程持续回绕时反复快照：复制期间被覆盖的槽位必须丢弃，保留的事件都是完整写入的，
+    // 且每个线程保留的序号连续、不超过环容量
+    static const char* const NAME = "snapshot race";
+    constexpr int THREADS = 4;
+    const int snapshots = test::QuickMode() ? 20 : 200;
+    std::atomic<bool> stop{ false };
+    std::vector<std::thread> writers;
+    for (int t = 0; t < THREADS; ++t) {
+        writers.emplace_back([t, &stop] {
+            for (uint64_t i = 0; !stop.load(std::memory_order_relaxed); ++i) recordTagged(NAME, (i << 8) | t);
+        });
+    }
+
+    bool consistent = true;
+    for (int s = 0; s < snapshots; ++s) {
+        std::vector<std::vector<uint64_t>> perThread(THREADS);
+        for (const auto& e : eventsNamed(NAME)) {
+            const int t = static_cast<int>(e.startNs & 0xFF);
+            if (t >= THREADS || e.durationNs != (e.startNs ^ PAYLOAD_KEY)) {
+                consistent = false;
+                continue;
+            }
+            perThread[t].push_back(e.startNs >> 8);
+        }
+        for (const auto& seq : perThread) {
+            consistent &= seq.size() < Trace::RING_CAPACITY;
+            for (size_t i = 1; i < seq.size(); ++i) consistent &= seq[i] == seq[i - 1] + 1;
+        }
+    }
+    stop.store(true);
+    for (auto& w : writers) w.join();
+    CHECK(consistent);
+}
+
+TEST_MAIN()
\ No newline at end of file